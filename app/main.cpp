@@ -3,10 +3,12 @@
 #include <cstdint>
 #include <cstring>
 #include <cassert>
+#include <cstdlib>
 
 #include "startup.h"
 #include "storage/pathresolver.h"
 #include "storage/filesystem.h"
+#include "storage/correlationencoding.h"
 #include <getopt.h>
 
 enum RunState: uint8_t {
@@ -18,14 +20,59 @@ enum RunState: uint8_t {
 	ERROR = 0x80			// 0b10000000
 };
 
+/// Largest number of threads accepted by -t, far above any machine (each thread has its own stack)
+const long MAX_THREAD_COUNT = 4096;
+
+/// Codes of the options which have only the long form
+enum LongOption {
+	OPTION_BBOX = 0x100,
+	OPTION_TIME,
+	OPTION_GRID_STRIDE,
+	OPTION_CACHE_SIZE,
+	OPTION_RESUME,
+	OPTION_CHECKPOINT_INTERVAL,
+	OPTION_SHARD,
+	OPTION_MERGE,
+	OPTION_DTYPE,
+	OPTION_LANDMARKS,
+	OPTION_MDS,
+	OPTION_SAMMON_TOLERANCE,
+	OPTION_WARM_START
+};
+
 void showUsage() {
 	std::cerr << "Usage: telcon-explorer [action] [flags] -v variableName -l level fileName.nc" << std::endl;
 	std::cerr << "By default (when no action is specified), ";
 	std::cerr << "application assumes the precompute is performed and loads the main window." << std::endl;
 	std::cerr << "Flags:" << std::endl;
 	std::cerr << "\t-N (--northOnly) use only northern hemisphere portion of the data file (unstable)" << std::endl;
+	std::cerr << "\t--bbox lon0,lon1,lat0,lat1 use only the points in the box (lon0 > lon1 crosses the seam)" << std::endl;
+	std::cerr << "\t--time start:end:stride use only the time steps start..end-1 with the stride (end, stride optional)" << std::endl;
+	std::cerr << "\t--grid-stride N use only every N-th latitude and longitude" << std::endl;
+	std::cerr << "Precompute flags:" << std::endl;
+	std::cerr << "\t-t N (--threads N) number of threads for computing correlations (0 - all cores, default 1)" << std::endl;
+	std::cerr << "\t-m MB (--memory-budget MB) stream the correlations to disk using at most about MB megabytes" << std::endl;
+	std::cerr << "\t-k K (--top-k K) store only the K most negative correlations of every point (sparse file)" << std::endl;
+	std::cerr << "\t-K K (--top-k-positive K) with -k, store also the K most positive correlations of every point" << std::endl;
+	std::cerr << "\t-U (--update) update the precomputed files with the time steps appended since the last update" << std::endl;
+	std::cerr << "\t-T (--tc-only) compute only teleconnectivity and autocorrelations, store no correlations" << std::endl;
+	std::cerr << "\t-z (--compress) store the correlations compressed, each value within 5e-4" << std::endl;
+	std::cerr << "\t--dtype TYPE store the correlations as float32 (default), float16, int16 or int8" << std::endl;
+	std::cerr << "\t-L N (--max-lag N) compute also the most negative correlations over lags -N..N time steps" << std::endl;
+	std::cerr << "\t--landmarks N project through N landmarks instead of all pairs of points (at least 3)" << std::endl;
+	std::cerr << "\t--mds project with classical MDS instead of Sammon's mapping" << std::endl;
+	std::cerr << "\t--sammon-tolerance T stop Sammon's mapping once an iteration improves the stress by less than T (e.g. 1e-3)" << std::endl;
+	std::cerr << "\t--warm-start FILE refine the projection FILE of an earlier precompute instead of projecting anew" << std::endl;
+	std::cerr << "\t--cache-size MB size of the cache of precomputed files (default 0 - no cache)" << std::endl;
+	std::cerr << "\t--resume continue an interrupted precompute from its checkpoint" << std::endl;
+	std::cerr << "\t--checkpoint-interval S save the progress of the precompute every S seconds (0 - never, default 600)" << std::endl;
+	std::cerr << "\t--shard i/n compute only part i (0..n-1) of n parts of the correlations, to be merged with --merge" << std::endl;
+	std::cerr << "Show flags:" << std::endl;
+	std::cerr << "\t-g (--lagged) show the lagged correlations (precomputed with -L) and their lags" << std::endl;
+	std::cerr << "\t--dtype TYPE keep correlations stored as float32 in memory as float16, int16 or int8" << std::endl;
 	std::cerr << "Actions (cannot be combined):" << std::endl;
 	std::cerr << "\t-P               precompute" << std::endl;
+	std::cerr << "\t--merge          precompute, reading the correlations from the shards computed with --shard" << std::endl;
 	std::cerr << "\t-u               load region explorer" << std::endl;
 	std::cerr << "\t-r               load ui test" << std::endl;
 }
@@ -46,6 +93,10 @@ int main(int argc, char *argv[])
 	char* levelValue = 0;
 	char* fileName = 0;
 	bool northOnly = false; // work only with northern hemisphere
+	bool lagged = false; // show the lagged correlations
+	VCGL::PrecomputeOptions precomputeOptions;
+	VCGL::DataSubset subset;
+	VCGL::CorrelationDataType dtype = VCGL::CORRELATION_FLOAT32;
 
 	enum RunState state = DEFAULT;
 	int returnValue = 0;
@@ -60,11 +111,33 @@ int main(int argc, char *argv[])
 				{"precompute", no_argument, 0, 'P'},
 				{"var", required_argument, 0, 'v'},
 				{"level", required_argument, 0, 'l'},
+				{"threads", required_argument, 0, 't'},
+				{"memory-budget", required_argument, 0, 'm'},
+				{"tc-only", no_argument, 0, 'T'},
+				{"update", no_argument, 0, 'U'},
+				{"top-k", required_argument, 0, 'k'},
+				{"top-k-positive", required_argument, 0, 'K'},
+				{"compress", no_argument, 0, 'z'},
+				{"max-lag", required_argument, 0, 'L'},
+				{"lagged", no_argument, 0, 'g'},
+				{"bbox", required_argument, 0, OPTION_BBOX},
+				{"time", required_argument, 0, OPTION_TIME},
+				{"grid-stride", required_argument, 0, OPTION_GRID_STRIDE},
+				{"cache-size", required_argument, 0, OPTION_CACHE_SIZE},
+				{"resume", no_argument, 0, OPTION_RESUME},
+				{"checkpoint-interval", required_argument, 0, OPTION_CHECKPOINT_INTERVAL},
+				{"shard", required_argument, 0, OPTION_SHARD},
+				{"merge", no_argument, 0, OPTION_MERGE},
+				{"dtype", required_argument, 0, OPTION_DTYPE},
+				{"landmarks", required_argument, 0, OPTION_LANDMARKS},
+				{"mds", no_argument, 0, OPTION_MDS},
+				{"sammon-tolerance", required_argument, 0, OPTION_SAMMON_TOLERANCE},
+				{"warm-start", required_argument, 0, OPTION_WARM_START},
 				{"help", no_argument, 0, 'h'},
 				{0, 0, 0, 0}
 		};
 
-		c = getopt_long(argc, argv, "NPv:l:t:ur", longOptions, &optionIndex);
+		c = getopt_long(argc, argv, "NPv:l:t:m:Tk:K:zUL:gur", longOptions, &optionIndex);
 		switch (c) {
 		case 'h':
 			showUsage();
@@ -86,8 +159,9 @@ int main(int argc, char *argv[])
 			break;
 		case 'P':
 			std::cerr << "option precompute" << std::endl;
-			// accept the action only when in default state, otherwise fail
-			if (state == DEFAULT) {
+			// accept the action only when in default state (or implied by --update, --shard, --merge), otherwise fail
+			if (state == DEFAULT || (state == PRECOMPUTE && (precomputeOptions.update
+					|| precomputeOptions.shardCount > 0 || precomputeOptions.merge))) {
 				state = PRECOMPUTE;
 			}
 			else {
@@ -103,6 +177,91 @@ int main(int argc, char *argv[])
 			std::cerr << "level is " << optarg << std::endl;
 			levelValue = optarg;
 			break;
+		case 't':
+			{
+				char* end = 0;
+				long threads = strtol(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || threads < 0 || threads > MAX_THREAD_COUNT) {
+					std::cerr << "ERROR: number of threads must be an integer from 0 to " << MAX_THREAD_COUNT << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "number of threads is " << threads << std::endl;
+					precomputeOptions.threadCount = static_cast<unsigned>(threads);
+				}
+			}
+			break;
+		case 'm':
+			{
+				char* end = 0;
+				long long megabytes = strtoll(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || megabytes <= 0) {
+					std::cerr << "ERROR: memory budget must be a positive number of megabytes" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "memory budget is " << megabytes << " MB" << std::endl;
+					precomputeOptions.memoryBudget = static_cast<std::size_t>(megabytes) << 20;
+				}
+			}
+			break;
+		case 'k':
+		case 'K':
+			{
+				char* end = 0;
+				long count = strtol(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || count <= 0) {
+					std::cerr << "ERROR: number of kept correlations must be a positive integer" << std::endl;
+					state = ERROR;
+				}
+				else if (c == 'k') {
+					std::cerr << "keeping " << count << " lowest correlations per point" << std::endl;
+					precomputeOptions.lowestCount = static_cast<std::size_t>(count);
+				}
+				else {
+					std::cerr << "keeping " << count << " highest correlations per point" << std::endl;
+					precomputeOptions.highestCount = static_cast<std::size_t>(count);
+				}
+			}
+			break;
+		case 'z':
+			std::cerr << "option compress" << std::endl;
+			precomputeOptions.compress = true;
+			break;
+		case 'U':
+			std::cerr << "option update" << std::endl;
+			precomputeOptions.update = true;
+			// implies the precompute action
+			if (state == DEFAULT || state == PRECOMPUTE) {
+				state = PRECOMPUTE;
+			}
+			else {
+				std::cerr << "ERROR: actions cannot be combined" << std::endl;
+				state = ERROR;
+			}
+			break;
+		case 'T':
+			std::cerr << "option tc-only" << std::endl;
+			precomputeOptions.teleconnectivityOnly = true;
+			break;
+		case 'L':
+			{
+				char* end = 0;
+				long lag = strtol(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || lag <= 0 || lag > 32767) {
+					std::cerr << "ERROR: maximal lag must be a positive integer (at most 32767)" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "maximal lag is " << lag << std::endl;
+					precomputeOptions.maxLag = static_cast<int>(lag);
+				}
+			}
+			break;
+		case 'g':
+			std::cerr << "option lagged" << std::endl;
+			lagged = true;
+			break;
 		case 'u':
 			std::cerr << "option UI test" << std::endl;
 			// accept the action only when in default state, otherwise fail
@@ -125,6 +284,145 @@ int main(int argc, char *argv[])
 				state = ERROR;
 			}
 			break;
+		case OPTION_BBOX:
+			if (!subset.parseBox(optarg)) {
+				std::cerr << "ERROR: the box must be given as lon0,lon1,lat0,lat1 with -90 <= lat0 <= lat1 <= 90" << std::endl;
+				state = ERROR;
+			}
+			break;
+		case OPTION_TIME:
+			if (!subset.parseTime(optarg)) {
+				std::cerr << "ERROR: the time range must be given as start:end:stride with start < end and stride > 0" << std::endl;
+				state = ERROR;
+			}
+			break;
+		case OPTION_GRID_STRIDE:
+			if (!subset.parseGridStride(optarg)) {
+				std::cerr << "ERROR: grid stride must be a positive integer" << std::endl;
+				state = ERROR;
+			}
+			break;
+		case OPTION_CACHE_SIZE:
+			{
+				char* end = 0;
+				long long megabytes = strtoll(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || megabytes < 0) {
+					std::cerr << "ERROR: cache size must be a non-negative number of megabytes" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "cache size is " << megabytes << " MB" << std::endl;
+					precomputeOptions.cacheBudget = static_cast<std::size_t>(megabytes) << 20;
+				}
+			}
+			break;
+		case OPTION_RESUME:
+			std::cerr << "option resume" << std::endl;
+			precomputeOptions.resume = true;
+			break;
+		case OPTION_CHECKPOINT_INTERVAL:
+			{
+				char* end = 0;
+				long seconds = strtol(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || seconds < 0) {
+					std::cerr << "ERROR: checkpoint interval must be a non-negative number of seconds" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "checkpoint interval is " << seconds << " s" << std::endl;
+					precomputeOptions.checkpointInterval = static_cast<unsigned>(seconds);
+				}
+			}
+			break;
+		case OPTION_SHARD:
+			{
+				char* end = 0;
+				long index = strtol(optarg, &end, 10);
+				long count = 0;
+				if (end != optarg && *end == '/') {
+					char* countStart = end + 1;
+					count = strtol(countStart, &end, 10);
+					if (end == countStart) {
+						count = 0;
+					}
+				}
+				if (*end != '\0' || index < 0 || count <= 0 || index >= count || count > 65535) {
+					std::cerr << "ERROR: the shard must be given as i/n with 0 <= i < n (n at most 65535)" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "computing shard " << index << " of " << count << std::endl;
+					precomputeOptions.shardIndex = static_cast<unsigned>(index);
+					precomputeOptions.shardCount = static_cast<unsigned>(count);
+					// implies the precompute action
+					if (state == DEFAULT || state == PRECOMPUTE) {
+						state = PRECOMPUTE;
+					}
+					else {
+						std::cerr << "ERROR: actions cannot be combined" << std::endl;
+						state = ERROR;
+					}
+				}
+			}
+			break;
+		case OPTION_MERGE:
+			std::cerr << "option merge" << std::endl;
+			precomputeOptions.merge = true;
+			// the precompute action, reading the shards
+			if (state == DEFAULT || state == PRECOMPUTE) {
+				state = PRECOMPUTE;
+			}
+			else {
+				std::cerr << "ERROR: actions cannot be combined" << std::endl;
+				state = ERROR;
+			}
+			break;
+		case OPTION_DTYPE:
+			if (!VCGL::parseCorrelationDataType(optarg, &dtype)) {
+				std::cerr << "ERROR: the type must be float32, float16, int16 or int8" << std::endl;
+				state = ERROR;
+			}
+			else {
+				std::cerr << "storing correlations as " << optarg << std::endl;
+				precomputeOptions.dtype = dtype;
+			}
+			break;
+		case OPTION_LANDMARKS:
+			{
+				char* end = 0;
+				long landmarks = strtol(optarg, &end, 10);
+				if (end == optarg || *end != '\0' || landmarks < 3) {
+					std::cerr << "ERROR: number of landmarks must be an integer of at least 3" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "projecting through " << landmarks << " landmarks" << std::endl;
+					precomputeOptions.landmarkCount = static_cast<size_t>(landmarks);
+				}
+			}
+			break;
+		case OPTION_MDS:
+			std::cerr << "option mds" << std::endl;
+			precomputeOptions.classicalMDS = true;
+			break;
+		case OPTION_SAMMON_TOLERANCE:
+			{
+				char* end = 0;
+				double tolerance = strtod(optarg, &end);
+				if (end == optarg || *end != '\0' || !(tolerance >= 0.0 && tolerance < 1.0)) {
+					std::cerr << "ERROR: tolerance of Sammon's mapping must be a number from 0 to 1" << std::endl;
+					state = ERROR;
+				}
+				else {
+					std::cerr << "tolerance of Sammon's mapping is " << tolerance << std::endl;
+					precomputeOptions.sammonTolerance = tolerance;
+				}
+			}
+			break;
+		case OPTION_WARM_START:
+			std::cerr << "warm start from the projection " << optarg << std::endl;
+			precomputeOptions.warmStart = optarg;
+			break;
 		case '?':
 			std::cerr << "unrecognized option" << std::endl;
 			break;
@@ -135,6 +433,54 @@ int main(int argc, char *argv[])
 		}
 	} while (c != -1);
 
+	// the update appends new time steps, which a fixed time range would not follow
+	if (precomputeOptions.update && (subset.timeStart != 0 || subset.timeEnd != 0 || subset.timeStride != 1)) {
+		std::cerr << "ERROR: --time cannot be combined with --update" << std::endl;
+		state = ERROR;
+	}
+
+	if (precomputeOptions.merge && precomputeOptions.shardCount > 0) {
+		std::cerr << "ERROR: --shard and --merge cannot be combined, merge after all shards are computed" << std::endl;
+		state = ERROR;
+	}
+	if (precomputeOptions.update && (precomputeOptions.merge || precomputeOptions.shardCount > 0)) {
+		std::cerr << "ERROR: --shard and --merge cannot be combined with --update" << std::endl;
+		state = ERROR;
+	}
+
+	// only the full correlations are compressed, and the update rewrites them as a triangle
+	if (precomputeOptions.compress && (precomputeOptions.update || precomputeOptions.lowestCount > 0
+			|| precomputeOptions.teleconnectivityOnly)) {
+		std::cerr << "ERROR: -z cannot be combined with -U, -k or -T" << std::endl;
+		state = ERROR;
+	}
+	// the most positive correlations are kept next to the lowest ones in the sparse file only
+	if (precomputeOptions.highestCount > 0 && precomputeOptions.lowestCount == 0) {
+		std::cerr << "ERROR: -K requires -k" << std::endl;
+		state = ERROR;
+	}
+	// the type applies to the triangle only
+	if (dtype != VCGL::CORRELATION_FLOAT32 && (precomputeOptions.compress || precomputeOptions.lowestCount > 0
+			|| precomputeOptions.teleconnectivityOnly)) {
+		std::cerr << "ERROR: --dtype cannot be combined with -z, -k or -T" << std::endl;
+		state = ERROR;
+	}
+
+	if (precomputeOptions.classicalMDS && precomputeOptions.landmarkCount > 0) {
+		std::cerr << "ERROR: --mds and --landmarks cannot be combined" << std::endl;
+		state = ERROR;
+	}
+	// only Sammon's mapping of all pairs continues a layout
+	if (!precomputeOptions.warmStart.empty() && (precomputeOptions.classicalMDS || precomputeOptions.landmarkCount > 0)) {
+		std::cerr << "ERROR: --warm-start cannot be combined with --mds or --landmarks" << std::endl;
+		state = ERROR;
+	}
+
+	// the errors are reported above, nothing is run
+	if (state == ERROR) {
+		return 1;
+	}
+
 	if (optind + 1 > argc && state != UI_TEST) {
 		std::cerr << "Missing fileName.nc" << std::endl;
 		showUsage();
@@ -148,7 +494,7 @@ int main(int argc, char *argv[])
 	// if requested - precompute
 	if (state & PRECOMPUTE) {
 		//std::cerr << "running precompute..."  << std::endl;
-		returnValue = VCGL::Startup::runPrecompute(fileName, varName, levelValue, northOnly);
+		returnValue = VCGL::Startup::runPrecompute(fileName, varName, levelValue, northOnly, precomputeOptions, subset);
 	}
 
 	// if requested - test (pass on parameters)
@@ -165,7 +511,7 @@ int main(int argc, char *argv[])
 	// by default, load the main UI
 	if ((state == DEFAULT) && (0 == returnValue)) {
 		//std::cerr << "running show..."  << std::endl;
-		returnValue = VCGL::Startup::runShow(fileName, varName, levelValue, northOnly);
+		returnValue = VCGL::Startup::runShow(fileName, varName, levelValue, northOnly, lagged, subset, dtype);
 	}
 
 	return returnValue;
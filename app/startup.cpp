@@ -14,7 +14,19 @@
 #include "storage/filesystem.h"
 
 #include "process/precompute.h"
+#include "process/laggedcorrelation.h"
 #include "storage/precomputeddata.h"
+#include "projection/distancematrix.h"
+#include "storage/correlationstore.h"
+#include "storage/sparsecorrelationstore.h"
+#include "storage/compressedcorrelationstore.h"
+#include "storage/correlationencoding.h"
+#include "storage/precomputecache.h"
+#include "storage/precomputecheckpoint.h"
+#include "storage/correlationshard.h"
+#include "projection/sammon.h"
+#include "projection/sammoncontroller.h"
+#include "process/progressbar.h"
 
 #include <sstream>
 
@@ -24,12 +36,19 @@
 
 #include <string>
 
-#include <time.h>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <csignal>
+#include <sys/stat.h>
+#include <limits>
+#include <algorithm>
 
 #include "exploration/maps/maplayoutview.h"
 #include "exploration/explorationwidget.h"
 #include "exploration/explorationmodel.h"
 #include "exploration/explorationmodelimpl.h"
+#include "exploration/explorationloader.h"
 #include "exploration/fakeexplorationmodel.h"
 
 #include "colorizer/icolorizer.h"
@@ -46,14 +65,34 @@
 #include "preferences/preferencepane.h"
 #include "exploration/regions/regionsearchexplorer.h"
 
+// wall clock time, the precompute stages may run on several threads
+typedef std::chrono::steady_clock Clock;
+
+/// Version of the precompute algorithms in the cache key: increase when the results of a run change
+const std::uint64_t PRECOMPUTE_CACHE_VERSION = 2;
+
+/// Budget of the sparse, sharded and update precomputes when none is given: blocks of rows, not the matrix
+const size_t DEFAULT_SPARSE_MEMORY_BUDGET = size_t(1) << 30;
+
+float secondsSince(Clock::time_point start) {
+	return std::chrono::duration<float>(Clock::now() - start).count();
+}
+
 void generateFilenames_var_level(
 		const std::string& fileName,
 		const std::string& varName,
 		const std::string& level,
 		bool northOnly,
+		const VCGL::DataSubset& subset,
 		std::string& fnCorrelation,
 		std::string& fnAutocorr,
-		std::string& fnProjection) {
+		std::string& fnProjection,
+		std::string& fnTeleconnectivity,
+		std::string& fnStatistics,
+		std::string& fnLaggedCorrelation,
+		std::string& fnLags,
+		std::string& fnCheckpoint,
+		std::string& fnShards) {
 	std::string fnRoot = VCGL::stringExtractFilenameNoExt(fileName);
 
 	std::stringstream basestr;
@@ -64,16 +103,759 @@ void generateFilenames_var_level(
 	if (northOnly) {
 		basestr << "_nh";
 	}
+	basestr << subset.fileNameTag();
 
 	fnCorrelation = basestr.str() + "_correlation.txt";
 	fnAutocorr = basestr.str() + "_autocorr.txt";
 	fnProjection = basestr.str() + "_projection.txt";
+	fnTeleconnectivity = basestr.str() + "_teleconn.txt";
+	fnStatistics = basestr.str() + "_stats.bin";
+	fnLaggedCorrelation = basestr.str() + "_lagcorr.bin";
+	fnLags = basestr.str() + "_lags.bin";
+	fnCheckpoint = basestr.str() + "_checkpoint.bin";
+	fnShards = basestr.str() + "_shard";
+}
+
+/// Record of the used part of the data file for the headers of the correlation files
+VCGL::GridSubsetRecord subsetRecord(const VCGL::GridSelection& selection) {
+	VCGL::GridSubsetRecord record = VCGL::GridSubsetRecord::whole();
+	record.latStart = selection.latStart;
+	record.latStride = selection.latStride;
+	record.lonStart = selection.lonStart;
+	record.lonStride = selection.lonStride;
+	record.timeStart = selection.timeStart;
+	record.timeCount = selection.timeCount;
+	record.timeStride = selection.timeStride;
+	return record;
+}
+
+/// Name of the copy of the streamed rows kept with the checkpoint of a sparse precompute (for the projection)
+std::string checkpointRowsFileName(const std::string& fnCheckpoint) {
+	return fnCheckpoint + ".rows";
+}
+
+/*! @brief Saves the progress of the streamed correlations with the checkpoint
+ *
+ * Added after the other consumers, it sees every block of rows once they have
+ * all taken it: the files are flushed and the collected minima (and kept
+ * correlations) are stored with the number of rows done.
+ */
+class CorrelationCheckpointer: public VCGL::CorrelationRowConsumer {
+public:
+	CorrelationCheckpointer(VCGL::CheckpointSaver& saver,
+			const VCGL::TeleconnectivityMinima& minima,
+			const VCGL::TopCorrelations* pTop,
+			const std::vector<VCGL::CorrelationTriangleWriter*>& writers)
+	: saver(saver), minima(minima), pTop(pTop), writers(writers) {}
+
+	virtual void consumeRows(size_t /*rowBegin*/, size_t rowEnd, const float* /*values*/) override {
+		if (!saver.due()) {
+			return;
+		}
+		for (size_t i = 0; i<writers.size(); i++) {
+			if (!writers[i]->flush()) {
+				return;
+			}
+		}
+		std::ostringstream state;
+		minima.saveState(state);
+		if (pTop) {
+			pTop->saveState(state);
+		}
+		saver.checkpoint.correlationState = state.str();
+		saver.checkpoint.correlationRows = rowEnd;
+		saver.save();
+	}
+
+private:
+	VCGL::CheckpointSaver& saver;
+	const VCGL::TeleconnectivityMinima& minima;
+	const VCGL::TopCorrelations* pTop;
+	std::vector<VCGL::CorrelationTriangleWriter*> writers;
+};
+
+/// Whether the store holds all correlations (a triangle or compressed file, as opposed to a sparse one)
+bool isCompleteStore(const VCGL::CorrelationStore* pStore, size_t npoints) {
+	return pStore && pStore->pointCount() == npoints
+			&& (dynamic_cast<const VCGL::CorrelationTriangleStore*>(pStore)
+					|| dynamic_cast<const VCGL::QuantizedTriangleStore*>(pStore)
+					|| dynamic_cast<const VCGL::CompressedCorrelationStore*>(pStore));
+}
+
+/// Report how much the stored correlations differ from the computed ones, when they are not stored as floats
+void reportQuantizationError(const VCGL::PrecomputeOptions& options, const VCGL::QuantizationError& error) {
+	const VCGL::CorrelationDataType dtype = static_cast<VCGL::CorrelationDataType>(options.dtype);
+	if (dtype == VCGL::CORRELATION_FLOAT32) {
+		return;
+	}
+	std::cout << "Correlations stored as " << VCGL::correlationDataTypeName(dtype)
+			<< ": largest error " << error.maxError << ", RMS error " << error.rms()
+			<< " over " << error.count << " values (bound " << VCGL::correlationEncodingError(dtype) << ")" << std::endl;
+}
+
+/// Fill the distance matrix from a complete triangle or compressed file, false if it cannot be read
+bool fillDistanceMatrix(const std::string& fileName, VCGL::DistanceMatrixFiller& filler, size_t npoints) {
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(fileName);
+	if (!isCompleteStore(pStore.get(), npoints)) {
+		return false;
+	}
+	const VCGL::CorrelationTriangleStore* pTriangle = dynamic_cast<const VCGL::CorrelationTriangleStore*>(pStore.get());
+	if (pTriangle) {
+		filler.consumeRows(0, npoints, pTriangle->matrix().data());
+		return true;
+	}
+	//row x of the triangle is the start of full row x
+	std::vector<float> row(npoints);
+	for (size_t x = 0; x<npoints; x++) {
+		pStore->row(x, row.data());
+		filler.consumeRows(x, x+1, row.data());
+	}
+	return true;
+}
+
+/*! @brief Rewrite a complete triangle file in the compressed format
+ *
+ * The compressed file is written next to the triangle and replaces it when complete.
+ * @return false if the triangle cannot be read or the compressed file cannot be written
+ */
+bool compressCorrelationFile(const std::string& fileName, size_t nlat, size_t nlon,
+		const VCGL::GridSubsetRecord& subset, size_t memoryBudget) {
+	const std::string partName = fileName + ".part";
+	{
+		std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(fileName);
+		const VCGL::CorrelationTriangleStore* pTriangle = dynamic_cast<const VCGL::CorrelationTriangleStore*>(pStore.get());
+		if (!pTriangle || !VCGL::storeCorrelationsCompressed(pTriangle->matrix(), nlat, nlon, partName, subset, memoryBudget)) {
+			return false;
+		}
+	}
+	return rename(partName.c_str(), fileName.c_str()) == 0;
+}
+
+/*! @brief Streaming part of the precompute: correlations go straight to disk block by block
+ *
+ * With options.lowestCount set, only the strongest partners of every point are
+ * collected and stored to fnCorrelation as a sparse file at the end; with
+ * options.teleconnectivityOnly, no correlations are stored.
+ * Teleconnectivity is collected on the way and stored to fnTeleconnectivity.
+ * The distance matrix for the projection is filled on the way as well,
+ * if it fits into the memory budget together with the data and the projection
+ * does not go through landmarks.
+ * With pShards, the rows are read from the shards instead of being computed.
+ *
+ * The progress is saved with the checkpoint of the saver. A checkpoint with
+ * rows done continues after them; with the correlations complete, only the
+ * distance matrix is filled again from the files.
+ *
+ * @return The distance matrix, or null when it did not fit
+ */
+std::unique_ptr<VCGL::DistanceMatrix> precomputeStreaming(
+		const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		int nlon,
+		int nlat,
+		const VCGL::PrecomputeOptions& options,
+		const std::string& fnCorrelation,
+		const std::string& fnTeleconnectivity,
+		const VCGL::GridSubsetRecord& subset,
+		VCGL::CheckpointSaver& saver,
+		const VCGL::CorrelationShardSet* pShards) {
+	const size_t npoints = static_cast<size_t>(nlat) * nlon;
+	const size_t dataBytes = npoints * data.stride() * sizeof(float);
+	const size_t dmatBytes = VCGL::triangleOffset(npoints) * sizeof(float);
+	VCGL::PrecomputeCheckpoint& checkpoint = saver.checkpoint;
+
+	std::unique_ptr<VCGL::DistanceMatrix> pdmat;
+	size_t correlationBudget = options.memoryBudget > dataBytes ? options.memoryBudget - dataBytes : 0;
+	if (!options.teleconnectivityOnly && options.landmarkCount == 0 && dmatBytes < correlationBudget / 2) {
+		VCGL::DistanceMatrix* pNew = 0;
+		VCGL::DistanceMatrix::forGrid(nlon, nlat, "correlation", &pNew);
+		pdmat.reset(pNew);
+		correlationBudget -= dmatBytes;
+	}
+	std::unique_ptr<VCGL::DistanceMatrixFiller> pFiller;
+	if (pdmat) {
+		pFiller.reset(new VCGL::DistanceMatrixFiller(*pdmat));
+	}
+
+	const bool sparse = options.lowestCount > 0 && !options.teleconnectivityOnly;
+	const bool dense = options.lowestCount == 0 && !options.teleconnectivityOnly;
+	//rows of a sparse file are kept for the distance matrix, to be able to continue
+	const bool keepRows = sparse && pdmat && (saver.enabled() || checkpoint.correlationRows > 0);
+	const std::string fnRows = checkpointRowsFileName(saver.fileName());
+
+	if (checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::CORRELATIONS)) {
+		if (!pdmat) {
+			return pdmat;
+		}
+		if (fillDistanceMatrix(sparse ? fnRows : fnCorrelation, *pFiller, npoints)) {
+			std::cout << "Correlations were computed before, distance matrix read from the files" << std::endl;
+			return pdmat;
+		}
+		std::cerr << "WARNING: the correlations of the checkpoint cannot be read, computing them again" << std::endl;
+		checkpoint.completedStages &= ~VCGL::PrecomputeCheckpoint::CORRELATIONS;
+		checkpoint.correlationRows = 0;
+	}
+
+	std::unique_ptr<VCGL::CorrelationTriangleWriter> pWriter;
+	std::unique_ptr<VCGL::CorrelationTriangleWriter> pRows;
+	std::unique_ptr<VCGL::TopCorrelations> pTop;
+	std::unique_ptr<VCGL::TeleconnectivityMinima> pMinima;
+
+	//continue from the checkpoint
+	size_t firstRow = checkpoint.correlationRows;
+	if (firstRow > 0) {
+		std::istringstream state(checkpoint.correlationState);
+		pMinima.reset(new VCGL::TeleconnectivityMinima(npoints));
+		bool bResumed = pMinima->restoreState(state);
+		if (sparse) {
+			pTop.reset(new VCGL::TopCorrelations(npoints, options.lowestCount, options.highestCount));
+			bResumed = bResumed && pTop->restoreState(state);
+		}
+		else if (bResumed && dense) {
+			pWriter.reset(new VCGL::CorrelationTriangleWriter(fnCorrelation, nlat, nlon, subset, firstRow, pFiller.get(),
+					static_cast<VCGL::CorrelationDataType>(options.dtype)));
+			bResumed = pWriter->good();
+		}
+		if (bResumed && keepRows) {
+			pRows.reset(new VCGL::CorrelationTriangleWriter(fnRows, nlat, nlon, subset, firstRow, pFiller.get()));
+			bResumed = pRows->good();
+		}
+		if (bResumed) {
+			std::cout << "Continuing the correlations from row " << firstRow << " of " << npoints << std::endl;
+		}
+		else {
+			std::cerr << "WARNING: the checkpoint does not fit the files, computing the correlations from the start" << std::endl;
+			firstRow = 0;
+			pWriter.reset();
+			pRows.reset();
+		}
+	}
+	if (firstRow == 0) {
+		pMinima.reset(new VCGL::TeleconnectivityMinima(npoints));
+		if (sparse) {
+			pTop.reset(new VCGL::TopCorrelations(npoints, options.lowestCount, options.highestCount));
+		}
+		else if (dense) {
+			pWriter.reset(new VCGL::CorrelationTriangleWriter(fnCorrelation, nlat, nlon, subset,
+					static_cast<VCGL::CorrelationDataType>(options.dtype)));
+		}
+		if (keepRows) {
+			pRows.reset(new VCGL::CorrelationTriangleWriter(fnRows, nlat, nlon, subset));
+		}
+	}
+
+	VCGL::CorrelationRowFanOut consumers;
+	std::vector<VCGL::CorrelationTriangleWriter*> writers;
+	if (sparse) {
+		consumers.add(*pTop);
+	}
+	else if (pWriter) {
+		consumers.add(*pWriter);
+		writers.push_back(pWriter.get());
+	}
+	consumers.add(*pMinima);
+	if (pFiller) {
+		consumers.add(*pFiller);
+	}
+	if (pRows) {
+		consumers.add(*pRows);
+		writers.push_back(pRows.get());
+	}
+	CorrelationCheckpointer checkpointer(saver, *pMinima, pTop.get(), writers);
+	consumers.add(checkpointer);
+
+	Clock::time_point start_corr = Clock::now();
+	bool bStored = true;
+	if (pShards) {
+		std::cout << "Merging " << pShards->shardCount() << " shards of the correlations to file: " << fnCorrelation.c_str() << "..." << std::endl;
+		if (!pShards->replay(firstRow, consumers)) {
+			//nothing is stored from damaged shards, the checkpoint keeps the rows before them
+			return pdmat;
+		}
+	}
+	else {
+		std::cout << "Computing and storing correlations to file: " << fnCorrelation.c_str() << "..." << std::endl;
+		computeCorrelationsStreaming(data, validityMask, correlationBudget, options.threadCount, consumers, firstRow);
+	}
+	if (sparse) {
+		VCGL::SparseCorrelationRows rows;
+		pTop->collect(rows);
+		pTop.reset();
+		std::cout << "keeping " << rows.values.size() << " of " << 2*VCGL::triangleOffset(npoints) << " correlations" << std::endl;
+		bStored = VCGL::storeSparseCorrelations(rows, nlat, nlon, options.lowestCount, options.highestCount, fnCorrelation, subset);
+	}
+	else if (pWriter) {
+		reportQuantizationError(options, pWriter->quantizationError());
+		bStored = pWriter->close();
+		if (bStored && options.compress) {
+			std::cout << "Compressing correlations..." << std::endl;
+			bStored = compressCorrelationFile(fnCorrelation, nlat, nlon, subset, options.memoryBudget);
+		}
+	}
+	if (!bStored) {
+		std::cerr << "ERROR: failed to write " << fnCorrelation << std::endl;
+	}
+	float seconds_corr = secondsSince(start_corr);
+	std::cout << "...completed in " << seconds_corr << " seconds" << std::endl;
+
+	std::cout << "Storing teleconnectivity to file: " << fnTeleconnectivity << "..." << std::endl;
+	storeTeleconnectivity(pMinima->minima(), pMinima->partners(), fnTeleconnectivity);
+	std::cout << "...stored." << std::endl;
+
+	if (bStored && (!pRows || pRows->close())) {
+		checkpoint.complete(VCGL::PrecomputeCheckpoint::CORRELATIONS);
+		checkpoint.correlationRows = 0;
+		checkpoint.correlationState.clear();
+		saver.save();
+	}
+
+	return pdmat;
+}
+
+/*! @brief Teleconnectivity and autocorrelations without loading the whole field
+ *
+ * The data are read in bands of latitudes (see VCGL::DataBandReader) sized so that
+ * the about four bands held by computeTeleconnectivityMinima fit the memory budget.
+ */
+void precomputeTeleconnectivityBanded(VCGL::TCStorage& storage,
+		const VCGL::PrecomputeOptions& options,
+		const std::string& fnAutocorr,
+		const std::string& fnTeleconnectivity) {
+	VCGL::DataBandReader bands = storage.readBands(options.memoryBudget / 4);
+	std::cout << "Reading data of size: nlat = " << bands.nlat() << ", nlon = " << bands.nlon()
+			<< ", ntime = " << bands.timeCount() << " in " << bands.bandCount() << " band(s)" << std::endl;
+
+	//points with too many missing values are excluded
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(bands, validityMask);
+
+	//compute teleconnectivity
+	std::cout << "Computing teleconnectivity..." << std::endl;
+	Clock::time_point start_tc = Clock::now();
+	VCGL::TeleconnectivityMinima minima(0);
+	computeTeleconnectivityMinima(bands, validityMask, options.threadCount, minima);
+	float seconds_tc = secondsSince(start_tc);
+	std::cout << "...completed in " << seconds_tc << " seconds" << std::endl;
+
+	//store teleconnectivity
+	std::cout << "Storing teleconnectivity to file: " << fnTeleconnectivity << "..." << std::endl;
+	storeTeleconnectivity(minima.minima(), minima.partners(), fnTeleconnectivity);
+	std::cout << "...stored." << std::endl;
+
+	//compute autocorrelations
+	std::cout << "Computing autocorrelations..." << std::endl;
+	Clock::time_point start_acorr = Clock::now();
+	std::vector<float> autocorrelations;
+	computeAutocorrelations(bands, autocorrelations, validityMask, options.threadCount);
+	float seconds_acorr = secondsSince(start_acorr);
+	std::cout << "...completed in " << seconds_acorr << " seconds" << std::endl;
+
+	//store autocorrelations
+	std::cout << "Storing autocorrelations to file: " << fnAutocorr << "..." << std::endl;
+	storeAutocorrelations(autocorrelations, fnAutocorr);
+	std::cout << "...stored." << std::endl;
+}
+
+/*! @brief Incremental precompute: only the time steps added since the last run are read
+ *
+ * The sufficient statistics of the correlations (see VCGL::CorrelationStatistics) are kept
+ * in fnStatistics. When the file is missing, all time steps are accumulated and it is created.
+ * The correlations (none with options.teleconnectivityOnly), teleconnectivity and autocorrelations
+ * are then rewritten from the statistics; the projection is not updated.
+ * Every file is written next to its old version and replaces it when all are written,
+ * the statistics last, so a failed update is repeated in full by the next one.
+ *
+ * @return false on error
+ */
+bool precomputeUpdate(VCGL::TCStorage& storage,
+		const VCGL::PrecomputeOptions& options,
+		const std::string& fnStatistics,
+		const std::string& fnCorrelation,
+		const std::string& fnAutocorr,
+		const std::string& fnTeleconnectivity) {
+	//the statistics hold all time steps of the file
+	VCGL::GridSelection selection;
+	storage.selection(selection);
+	VCGL::GridSubsetRecord subset = subsetRecord(selection);
+	subset.timeStart = 0;
+	subset.timeCount = 0;
+
+	VCGL::CorrelationStatistics statistics;
+	size_t firstStep = 0;
+	if (readCorrelationStatistics(fnStatistics, statistics)) {
+		firstStep = statistics.sampleCount();
+		std::cout << "Statistics of " << firstStep << " time steps read from " << fnStatistics << std::endl;
+	}
+	else {
+		std::cout << "No statistics in " << fnStatistics << ", accumulating all time steps" << std::endl;
+	}
+
+	const size_t ntime = storage.getNTime();
+	if (ntime < firstStep) {
+		std::cerr << "ERROR: the data file has " << ntime << " time steps, fewer than the statistics" << std::endl;
+		return false;
+	}
+	if (ntime == firstStep) {
+		std::cout << "No new time steps, nothing to update" << std::endl;
+		return true;
+	}
+
+	//load the new time steps only
+	std::cout << "Loading time steps " << firstStep << ".." << ntime-1 << "..." << std::endl;
+	VCGL::TimeSeriesField data;
+	storage.loadData(data, firstStep, ntime-firstStep);
+	const size_t nlat = data.nlat();
+	const size_t nlon = data.nlon();
+	if (nlat == 0 || nlon == 0 || (firstStep > 0 && (nlat != statistics.nlat() || nlon != statistics.nlon()))) {
+		std::cerr << "ERROR: the data grid does not match the statistics" << std::endl;
+		return false;
+	}
+	// the running sums cannot skip time steps, points with missing values are excluded for good
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(data, validityMask, 1.0f);
+
+	std::cout << "Updating statistics..." << std::endl;
+	Clock::time_point start_stats = Clock::now();
+	statistics.accumulate(data, validityMask, options.threadCount);
+	data.clear();
+	std::cout << "...completed in " << secondsSince(start_stats) << " seconds" << std::endl;
+
+	//rewrite correlations and teleconnectivity, each output to a .part file first
+	const std::string partSuffix = ".part";
+	const size_t npoints = nlat*nlon;
+	// blocks of rows as in the streaming precompute, never the whole triangle at once
+	const size_t memoryBudget = options.memoryBudget > 0 ? options.memoryBudget : DEFAULT_SPARSE_MEMORY_BUDGET;
+	const size_t blockRows = std::max<size_t>(1, memoryBudget / (npoints*sizeof(float)));
+
+	std::unique_ptr<VCGL::CorrelationTriangleWriter> pWriter;
+	std::unique_ptr<VCGL::TopCorrelations> pTop;
+	VCGL::TeleconnectivityMinima minima(npoints);
+	VCGL::CorrelationRowFanOut consumers;
+	if (options.teleconnectivityOnly) {
+		std::cout << "Computing teleconnectivity..." << std::endl;
+	}
+	else if (options.lowestCount > 0) {
+		pTop.reset(new VCGL::TopCorrelations(npoints, options.lowestCount, options.highestCount));
+		consumers.add(*pTop);
+	}
+	else {
+		pWriter.reset(new VCGL::CorrelationTriangleWriter(fnCorrelation + partSuffix, nlat, nlon, subset,
+				static_cast<VCGL::CorrelationDataType>(options.dtype)));
+		consumers.add(*pWriter);
+	}
+	consumers.add(minima);
+
+	if (!options.teleconnectivityOnly) {
+		std::cout << "Storing correlations to file: " << fnCorrelation << "..." << std::endl;
+	}
+	statistics.emitCorrelations(blockRows, options.threadCount, consumers);
+	bool bStored = true;
+	if (pTop) {
+		VCGL::SparseCorrelationRows rows;
+		pTop->collect(rows);
+		bStored = VCGL::storeSparseCorrelations(rows, nlat, nlon, options.lowestCount, options.highestCount,
+				fnCorrelation + partSuffix, subset);
+	}
+	else if (pWriter) {
+		reportQuantizationError(options, pWriter->quantizationError());
+		bStored = pWriter->close();
+	}
+
+	std::vector<float> autocorrelations;
+	statistics.autocorrelations(autocorrelations);
+
+	// the statistics go last: until they are replaced, the next update recomputes all outputs
+	std::vector<std::string> outputs;
+	if (!options.teleconnectivityOnly) {
+		outputs.push_back(fnCorrelation);
+	}
+	outputs.push_back(fnTeleconnectivity);
+	outputs.push_back(fnAutocorr);
+	outputs.push_back(fnStatistics);
+	const char* failedName = bStored ? 0 : fnCorrelation.c_str();
+	if (!failedName && !storeTeleconnectivity(minima.minima(), minima.partners(), fnTeleconnectivity + partSuffix)) {
+		failedName = fnTeleconnectivity.c_str();
+	}
+	if (!failedName && !storeAutocorrelations(autocorrelations, fnAutocorr + partSuffix)) {
+		failedName = fnAutocorr.c_str();
+	}
+	if (!failedName && !storeCorrelationStatistics(statistics, fnStatistics + partSuffix)) {
+		failedName = fnStatistics.c_str();
+	}
+	for (size_t k = 0; !failedName && k<outputs.size(); k++) {
+		const std::string partName = outputs[k] + partSuffix;
+		if (rename(partName.c_str(), outputs[k].c_str()) != 0) {
+			failedName = outputs[k].c_str();
+		}
+	}
+	if (failedName) {
+		std::cerr << "ERROR: failed to write " << failedName << ", the statistics are not updated" << std::endl;
+		for (size_t k = 0; k<outputs.size(); k++) {
+			std::remove((outputs[k] + partSuffix).c_str());
+		}
+		return false;
+	}
+	if (!options.teleconnectivityOnly) {
+		std::cout << "...stored." << std::endl;
+	}
+	std::cout << "Teleconnectivity, autocorrelations and statistics stored to files: " << fnTeleconnectivity << ", "
+			<< fnAutocorr << ", " << fnStatistics << std::endl;
+
+	std::cout << "The projection is not updated, run the full precompute to refresh it" << std::endl;
+	return true;
+}
+
+/*! @brief Saves the projection after the Sammon iterations with the checkpoint
+ *
+ * The points are kept in double precision, so continuing gives the same projection.
+ * The state of cancelled iterations is saved at once.
+ */
+class ProjectionCheckpointer: public LSP::SammonObserver {
+public:
+	ProjectionCheckpointer(VCGL::CheckpointSaver& saver, const LSP::SammonController& controller)
+	: saver(saver), controller(controller) {}
+
+	virtual void iterationDone(int iterations, const QVector<LSP::TSPoint>& points) override {
+		if (!saver.due() && !controller.cancelled()) {
+			return;
+		}
+		VCGL::PrecomputeCheckpoint& checkpoint = saver.checkpoint;
+		checkpoint.projection.resize(2*points.size());
+		for (int i = 0; i<points.size(); i++) {
+			checkpoint.projection[2*i] = points[i].getX();
+			checkpoint.projection[2*i+1] = points[i].getY();
+		}
+		checkpoint.projectionIteration = iterations;
+		saver.save();
+	}
+
+private:
+	VCGL::CheckpointSaver& saver;
+	const LSP::SammonController& controller;
+};
+
+/*! @brief While in scope, Ctrl+C (SIGINT) cancels the Sammon iterations instead of terminating
+ *
+ * The iterations stop after the current one, a second Ctrl+C terminates as usual.
+ */
+class InterruptibleProjection {
+public:
+	explicit InterruptibleProjection(LSP::SammonController& controller) {
+		pController = &controller;
+		previousHandler = std::signal(SIGINT, interrupt);
+	}
+
+	~InterruptibleProjection() {
+		std::signal(SIGINT, previousHandler);
+		pController = 0;
+	}
+
+private:
+	static void interrupt(int) {
+		std::signal(SIGINT, SIG_DFL);
+		if (pController) {
+			pController->cancel();
+		}
+	}
+
+	static LSP::SammonController* volatile pController;
+	void (*previousHandler)(int);
+};
+
+LSP::SammonController* volatile InterruptibleProjection::pController = 0;
+
+/// Whether the file exists and was modified at the given time or later
+bool modifiedSince(const std::string& fileName, std::time_t time) {
+	struct stat buffer;
+	return stat(fileName.c_str(), &buffer) == 0 && buffer.st_mtime >= time;
 }
 
-void precompute_var_level(const char * dataFN,
+/// Key of a precompute (see VCGL::PrecomputeCacheKey), false if the data file cannot be read
+bool precomputeKey(const char* dataFN,
 		const char* varName,
-		const char* level = 0,
-		bool northOnly = false) {
+		const char* level,
+		bool northOnly,
+		const VCGL::PrecomputeOptions& options,
+		const VCGL::DataSubset& subset,
+		VCGL::PrecomputeCacheKey& key) {
+	if (!key.addDataFile(dataFN)) {
+		return false;
+	}
+	key.add("precompute.version", PRECOMPUTE_CACHE_VERSION);
+	key.add("correlation.version", VCGL::CORRELATION_FILE_VERSION);
+	key.add("sparse.version", VCGL::SPARSE_CORRELATION_FILE_VERSION);
+	key.add("compressed.version", VCGL::COMPRESSED_CORRELATION_FILE_VERSION);
+	key.add("variable", varName);
+	key.add("level", level ? level : "");
+	key.add("northOnly", northOnly);
+	key.add("subset", subset.fileNameTag());
+	key.add("teleconnectivityOnly", options.teleconnectivityOnly);
+	key.add("lowestCount", options.lowestCount);
+	key.add("highestCount", options.highestCount);
+	key.add("maxLag", static_cast<std::uint64_t>(options.maxLag));
+	key.add("compress", options.compress);
+	key.add("dtype", options.dtype);
+	key.add("landmarks", options.landmarkCount);
+	key.add("mds", options.classicalMDS);
+	std::ostringstream tolerance;
+	tolerance << options.sammonTolerance;
+	key.add("sammonTolerance", tolerance.str());
+	key.add("warmStart", options.warmStart);
+	return true;
+}
+
+/*! @brief Key of the correlations of a precompute, false if the data file cannot be read
+ *
+ * Unlike precomputeKey, only what the correlations depend on: shards of the same
+ * data can be merged into dense, sparse or teleconnectivity files alike.
+ */
+bool shardKey(const char* dataFN,
+		const char* varName,
+		const char* level,
+		bool northOnly,
+		const VCGL::DataSubset& subset,
+		VCGL::PrecomputeCacheKey& key) {
+	if (!key.addDataFile(dataFN)) {
+		return false;
+	}
+	key.add("precompute.version", PRECOMPUTE_CACHE_VERSION);
+	key.add("shard.version", VCGL::CORRELATION_SHARD_VERSION);
+	key.add("variable", varName);
+	key.add("level", level ? level : "");
+	key.add("northOnly", northOnly);
+	key.add("subset", subset.fileNameTag());
+	return true;
+}
+
+/*! @brief Compute one shard of the correlations (see options.shardIndex) to its own file
+ *
+ * Shards are computed by independent processes, e.g. the tasks of a job array
+ * sharing the file system, and merged by a precompute with options.merge.
+ * They are not checkpointed: an interrupted shard is computed again.
+ *
+ * @return false on error
+ */
+bool precomputeShard(VCGL::TCStorage& storage,
+		const VCGL::PrecomputeOptions& options,
+		const std::string& fnShards,
+		const std::string& key,
+		const VCGL::GridSubsetRecord& subset) {
+	VCGL::TimeSeriesField data;
+	storage.loadData(data);
+	std::cout << "Read data of size: nlat = " << data.nlat() << ", nlon = " << data.nlon()
+			<< ", ntime = " << data.timeCount() << std::endl;
+
+	//points with too many missing values are excluded
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(data, validityMask);
+
+	const std::string fnShard = VCGL::correlationShardFileName(fnShards, options.shardIndex);
+	VCGL::CorrelationShardWriter writer(fnShard, data.nlat(), data.nlon(), subset, key,
+			options.shardIndex, options.shardCount);
+	std::cout << "Computing rows " << writer.rowBegin() << ".." << writer.rowEnd() << " of shard "
+			<< options.shardIndex << "/" << options.shardCount << " to file: " << fnShard << "..." << std::endl;
+	Clock::time_point start_corr = Clock::now();
+	const size_t memoryBudget = options.memoryBudget > 0 ? options.memoryBudget : DEFAULT_SPARSE_MEMORY_BUDGET;
+	computeCorrelationsStreaming(data, validityMask, memoryBudget, options.threadCount, writer,
+			writer.rowBegin(), writer.rowEnd());
+	if (!writer.close()) {
+		std::cerr << "ERROR: failed to write " << fnShard << std::endl;
+		return false;
+	}
+	float seconds_corr = secondsSince(start_corr);
+	std::cout << "...completed in " << seconds_corr << " seconds" << std::endl;
+	return true;
+}
+
+/// Read a complete correlation triangle or compressed file into the matrix, false if it cannot be read
+bool readCorrelationMatrix(const std::string& fileName, size_t npoints, VCGL::SymmetricMatrix<float>& correlationMatrix) {
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(fileName);
+	if (!isCompleteStore(pStore.get(), npoints)) {
+		return false;
+	}
+	correlationMatrix.resize(npoints);
+	const VCGL::CorrelationTriangleStore* pTriangle = dynamic_cast<const VCGL::CorrelationTriangleStore*>(pStore.get());
+	if (pTriangle) {
+		std::copy(pTriangle->matrix().data(), pTriangle->matrix().data() + VCGL::triangleOffset(npoints), correlationMatrix.data());
+		return true;
+	}
+	std::vector<float> row(npoints);
+	for (size_t x = 0; x<npoints; x++) {
+		pStore->row(x, row.data());
+		std::copy(row.begin(), row.begin() + x, correlationMatrix.data() + VCGL::triangleOffset(x));
+	}
+	return true;
+}
+
+/*! @brief Layout of an earlier precompute to refine, remapped to the grid of this one (see remapProjection)
+ *
+ * The grid of the earlier projection is that of the correlation file stored with it,
+ * without one the projection has to be of the same grid.
+ *
+ * @param fnProjection Binary projection file of the earlier precompute
+ * @param warmStart (output) Starting projection of the nlat*nlon points
+ * @return false (reported) if there is nothing to start from
+ */
+bool readWarmStart(const std::string& fnProjection,
+		const VCGL::GridSubsetRecord& subset, size_t nlat, size_t nlon, size_t fileNlon,
+		std::vector<VCGL::ProjectedPointInfo>& warmStart) {
+	std::vector<VCGL::ProjectedPointInfo> previous;
+	if (!readProjectionResults(fnProjection, previous)) {
+		std::cerr << "WARNING: cannot read the projection " << fnProjection << ", no warm start" << std::endl;
+		return false;
+	}
+
+	VCGL::GridSubsetRecord previousSubset = subset;
+	size_t previousNlat = nlat;
+	size_t previousNlon = nlon;
+	const std::string suffix = "_projection.txt";
+	if (fnProjection.size() > suffix.size()
+			&& fnProjection.compare(fnProjection.size() - suffix.size(), suffix.size(), suffix) == 0) {
+		const std::string fnCorrelation = fnProjection.substr(0, fnProjection.size() - suffix.size()) + "_correlation.txt";
+		VCGL::GridSubsetRecord record;
+		size_t recordNlat = 0;
+		size_t recordNlon = 0;
+		if (VCGL::readGridSubset(fnCorrelation, record, &recordNlat, &recordNlon) && recordNlat*recordNlon == previous.size()) {
+			previousSubset = record;
+			previousNlat = recordNlat;
+			previousNlon = recordNlon;
+		}
+	}
+	if (previousNlat*previousNlon != previous.size()) {
+		std::cerr << "WARNING: the grid of the projection " << fnProjection << " is not known, no warm start" << std::endl;
+		return false;
+	}
+
+	const size_t matched = remapProjection(previous, previousSubset, previousNlon, subset, nlat, nlon, fileNlon, warmStart);
+	if (matched == 0) {
+		std::cerr << "WARNING: no point of the projection " << fnProjection << " is in the grid, no warm start" << std::endl;
+		return false;
+	}
+	std::cout << "Warm start from the projection " << fnProjection << ", " << matched << " of "
+			<< nlat*nlon << " points found in it" << std::endl;
+	return true;
+}
+
+/*! @brief Precompute the files of a variable (at a level)
+ *
+ * Unless options.checkpointInterval is 0, the progress is saved to the
+ * checkpoint file: the finished stages, the rows of the streamed correlations
+ * (-m, -k) and the Sammon iterations. With options.resume, a checkpoint of the
+ * same precompute (same data and parameters) is continued. The checkpoint is
+ * removed when the precompute is complete.
+ *
+ * With options.shardCount set, only the shard of the correlations is computed;
+ * with options.merge, the correlations are read from all shards instead.
+ *
+ * @return When the computation of the files started (by the first run, when continued),
+ * 			or -1 if they were not computed
+ */
+std::time_t precompute_var_level(const char * dataFN,
+		const char* varName,
+		const char* level,
+		bool northOnly,
+		const VCGL::PrecomputeOptions& options,
+		const VCGL::DataSubset& subset) {
 	std::string fileName(dataFN);
 	std::string varNameStr(varName);
 	std::string levelStr;
@@ -86,13 +868,26 @@ void precompute_var_level(const char * dataFN,
 	std::string fnCorrelation;
 	std::string fnAutocorr;
 	std::string fnProjection;
+	std::string fnTeleconnectivity;
+	std::string fnStatistics;
+	std::string fnLaggedCorrelation;
+	std::string fnLags;
+	std::string fnCheckpoint;
+	std::string fnShards;
 	generateFilenames_var_level(fileName,
 			varNameStr,
 			levelStr,
 			northOnly,
+			subset,
 			fnCorrelation,
 			fnAutocorr,
-			fnProjection);
+			fnProjection,
+			fnTeleconnectivity,
+			fnStatistics,
+			fnLaggedCorrelation,
+			fnLags,
+			fnCheckpoint,
+			fnShards);
 
 	std::cout << "Correlation file name: " << fnCorrelation.c_str() << std::endl;
 	std::cout << "Projection file name: " << fnProjection.c_str() << std::endl;
@@ -102,81 +897,388 @@ void precompute_var_level(const char * dataFN,
 
 	VCGL::NCFileDataStorage* pncf = new VCGL::NCFileDataStorage(fileName.c_str());
 	pncf->initVariable(varNameStr.c_str(), levelValue);
-	VCGL::TCStorage storage(pncf, northOnly); // takes ownership of pncf pointer
+	pncf->setThreadCount(options.threadCount);
+	VCGL::TCStorage storage(pncf, northOnly, subset); // takes ownership of pncf pointer
 
-	std::vector< std::vector< std::vector<float> > > data; //= ncf.loadData(0, ncf.getNLat());
-	storage.loadData(data);
+	VCGL::GridSelection selection;
+	if (!storage.selection(selection)) {
+		std::cerr << "ERROR: the selected part of the data has fewer than two latitudes or longitudes, or no time steps" << std::endl;
+		return -1;
+	}
+	const VCGL::GridSubsetRecord subsetHeader = subsetRecord(selection);
+
+	if (options.update) {
+		if (options.maxLag > 0) {
+			std::cerr << "WARNING: lagged correlations are not updated incrementally, run the full precompute with -L" << std::endl;
+		}
+		const std::time_t start = std::time(0);
+		return precomputeUpdate(storage, options, fnStatistics, fnCorrelation, fnAutocorr, fnTeleconnectivity) ? start : -1;
+	}
 
+	VCGL::CorrelationShardSet shards;
+	if (options.shardCount > 0 || options.merge) {
+		VCGL::PrecomputeCacheKey correlationKey;
+		if (!shardKey(dataFN, varName, level, northOnly, subset, correlationKey)) {
+			std::cerr << "ERROR: cannot read the data file " << dataFN << std::endl;
+			return -1;
+		}
+		if (!options.merge) {
+			const std::time_t start = std::time(0);
+			return precomputeShard(storage, options, fnShards, correlationKey.hash(), subsetHeader) ? start : -1;
+		}
+		//all shards are checked before anything is computed
+		if (!shards.open(fnShards, selection.latCount, selection.lonCount, subsetHeader, correlationKey.hash())) {
+			return -1;
+		}
+	}
 
-	int nlat = 0, nlon = 0, ntime = 0;
+	if (options.teleconnectivityOnly && options.memoryBudget > 0 && options.maxLag == 0 && !options.merge) {
+		const std::time_t start = std::time(0);
+		precomputeTeleconnectivityBanded(storage, options, fnAutocorr, fnTeleconnectivity);
+		return start;
+	}
 
-	nlat = data.size();
-	if (nlat) { nlon = data[0].size(); }
-	if (nlat && nlon) { ntime = data[0][0].size(); }
+	//checkpoint to continue from, or a new one
+	VCGL::PrecomputeCacheKey key;
+	const bool hasKey = precomputeKey(dataFN, varName, level, northOnly, options, subset, key);
+	VCGL::PrecomputeCheckpoint checkpoint;
+	if (options.resume) {
+		if (hasKey && checkpoint.load(fnCheckpoint) && checkpoint.key == key.hash()) {
+			std::cout << "Continuing the precompute from the checkpoint " << fnCheckpoint << std::endl;
+		}
+		else {
+			std::cerr << "WARNING: no checkpoint of this precompute in " << fnCheckpoint << ", starting from the beginning" << std::endl;
+			checkpoint = VCGL::PrecomputeCheckpoint();
+		}
+	}
+	else if (checkpoint.load(fnCheckpoint)) {
+		std::cerr << "WARNING: the checkpoint " << fnCheckpoint << " is replaced, use --resume to continue it" << std::endl;
+		checkpoint = VCGL::PrecomputeCheckpoint();
+	}
+	if (checkpoint.key.empty()) {
+		checkpoint.key = key.hash();
+		checkpoint.startTime = std::time(0);
+	}
+	VCGL::CheckpointSaver saver(fnCheckpoint, hasKey ? options.checkpointInterval : 0, checkpoint);
 
-	std::cout << "Read data of size: nlat = " << nlat << ", nlon = " << nlon << ", ntime = " << ntime << std::endl;
+	//the layout to refine, read before the files of this precompute are replaced
+	std::vector<VCGL::ProjectedPointInfo> warmStart;
+	if (!options.warmStart.empty()) {
+		readWarmStart(options.warmStart, subsetHeader, selection.latCount, selection.lonCount, storage.getNLon(), warmStart);
+	}
 
-	//TODO: correct validity if necessary
-		std::vector< std::vector<bool> > validityMask;
-		const std::vector<bool> vmpar_init(nlon, true);
-	   validityMask.resize(nlat, vmpar_init);
-
-	//compute correlations
-	std::cout << "Computing correlations..." << std::endl;
-	clock_t start_corr = clock();
-	std::vector< std::vector<float> > correlationMatrix;
-	computeCorrelations(data, correlationMatrix, validityMask);
-	clock_t end_corr = clock();
-	float seconds_corr = ((float)(end_corr - start_corr)) / CLOCKS_PER_SEC;
-	std::cout << "...completed in " << seconds_corr << " seconds" << std::endl;
+	VCGL::TimeSeriesField data;
+	storage.loadData(data);
 
-	//store correlations
-	std::cout << "Storing correlations to file: " << fnCorrelation.c_str() << "..." << std::endl;
-	storeCorrelationsTriangle(correlationMatrix, fnCorrelation.c_str());
-	std::cout << "...stored." << std::endl;
+	const int nlat = data.nlat();
+	const int nlon = data.nlon();
+	const int ntime = data.timeCount();
 
+	std::cout << "Read data of size: nlat = " << nlat << ", nlon = " << nlon << ", ntime = " << ntime << std::endl;
 
-	//compute autocorrelations
-	std::cout << "Computing autocorrelations..." << std::endl;
-	clock_t start_acorr = clock();
-	std::vector<float> autocorrelations;
-	computeAutocorrelations(data, autocorrelations, validityMask);
-	clock_t end_acorr = clock();
-	float seconds_acorr = ((float)(end_acorr - start_acorr)) / CLOCKS_PER_SEC;
-	std::cout << "...completed in " << seconds_acorr << " seconds" << std::endl;
+	//points with too many missing values are excluded
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(data, validityMask);
+
+	const bool inMemory = !options.teleconnectivityOnly && options.memoryBudget == 0 && options.lowestCount == 0
+			&& !options.merge;
+	const bool needsProjection = !options.teleconnectivityOnly && !checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::PROJECTION);
+
+	VCGL::SymmetricMatrix<float> correlationMatrix;
+	std::unique_ptr<VCGL::DistanceMatrix> pdmat;
+	bool bFailed = false;	//a stage failed, its files are missing
+	if (inMemory && checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::CORRELATIONS)) {
+		//the matrix is needed only for the projection
+		if (needsProjection && !readCorrelationMatrix(fnCorrelation, static_cast<size_t>(nlat)*nlon, correlationMatrix)) {
+			std::cerr << "WARNING: the correlations of the checkpoint cannot be read, computing them again" << std::endl;
+			checkpoint.completedStages &= ~VCGL::PrecomputeCheckpoint::CORRELATIONS;
+		}
+	}
+	if (options.teleconnectivityOnly && checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::CORRELATIONS)) {
+		std::cout << "Teleconnectivity was computed before" << std::endl;
+	}
+	else if (options.teleconnectivityOnly && !options.merge) {
+		//compute teleconnectivity
+		std::cout << "Computing teleconnectivity..." << std::endl;
+		Clock::time_point start_tc = Clock::now();
+		VCGL::TeleconnectivityMinima minima(0);
+		computeTeleconnectivityMinima(data, validityMask, options.threadCount, minima);
+		float seconds_tc = secondsSince(start_tc);
+		std::cout << "...completed in " << seconds_tc << " seconds" << std::endl;
+
+		//store teleconnectivity
+		std::cout << "Storing teleconnectivity to file: " << fnTeleconnectivity << "..." << std::endl;
+		storeTeleconnectivity(minima.minima(), minima.partners(), fnTeleconnectivity);
+		std::cout << "...stored." << std::endl;
+		checkpoint.complete(VCGL::PrecomputeCheckpoint::CORRELATIONS);
+		saver.save();
+	}
+	else if (inMemory && checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::CORRELATIONS)) {
+		std::cout << "Correlations were computed before" << std::endl;
+	}
+	else if (inMemory) {
+		//compute correlations
+		std::cout << "Computing correlations..." << std::endl;
+		Clock::time_point start_corr = Clock::now();
+		computeCorrelations(data, correlationMatrix, validityMask, options.threadCount);
+		float seconds_corr = secondsSince(start_corr);
+		std::cout << "...completed in " << seconds_corr << " seconds" << std::endl;
+
+		//store correlations
+		std::cout << "Storing correlations to file: " << fnCorrelation.c_str() << "..." << std::endl;
+		VCGL::QuantizationError error;
+		const bool bStored = options.compress
+				? VCGL::storeCorrelationsCompressed(correlationMatrix.view(), nlat, nlon, fnCorrelation, subsetHeader)
+				: storeCorrelationsVersioned(correlationMatrix, nlat, nlon, fnCorrelation, subsetHeader,
+						static_cast<VCGL::CorrelationDataType>(options.dtype), &error);
+		reportQuantizationError(options, error);
+		if (bStored) {
+			std::cout << "...stored." << std::endl;
+			checkpoint.complete(VCGL::PrecomputeCheckpoint::CORRELATIONS);
+			saver.save();
+		}
+		else {
+			std::cerr << "ERROR: failed to write " << fnCorrelation << std::endl;
+			bFailed = true;
+		}
+	}
+	else {
+		VCGL::PrecomputeOptions streamingOptions = options;
+		if (streamingOptions.memoryBudget == 0) {
+			//the merge computes no correlations, without a budget the distance matrix is always kept
+			streamingOptions.memoryBudget = options.merge ? std::numeric_limits<size_t>::max() : DEFAULT_SPARSE_MEMORY_BUDGET;
+		}
+		pdmat = precomputeStreaming(data, validityMask, nlon, nlat, streamingOptions, fnCorrelation, fnTeleconnectivity,
+				subsetHeader, saver, options.merge ? &shards : 0);
+		if (!checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::CORRELATIONS)) {
+			if (options.merge) {
+				return -1;
+			}
+			bFailed = true;
+		}
+	}
 
-	//store autocorrelations
-	std::cout << "Storing autocorrelations to file: " << fnAutocorr << "..." << std::endl;
-	storeAutocorrelations(autocorrelations, fnAutocorr);
-	std::cout << "...stored." << std::endl;
 
+	if (!checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::AUTOCORRELATIONS)) {
+		//compute autocorrelations
+		std::cout << "Computing autocorrelations..." << std::endl;
+		Clock::time_point start_acorr = Clock::now();
+		std::vector<float> autocorrelations;
+		computeAutocorrelations(data, autocorrelations, validityMask, options.threadCount);
+		float seconds_acorr = secondsSince(start_acorr);
+		std::cout << "...completed in " << seconds_acorr << " seconds" << std::endl;
+
+		//store autocorrelations
+		std::cout << "Storing autocorrelations to file: " << fnAutocorr << "..." << std::endl;
+		storeAutocorrelations(autocorrelations, fnAutocorr);
+		std::cout << "...stored." << std::endl;
+		checkpoint.complete(VCGL::PrecomputeCheckpoint::AUTOCORRELATIONS);
+		saver.save();
+	}
 
-	//compute projection
-	std::cout << "Computing projection..." << std::endl;
-	clock_t start_proj = clock();
+	if (options.maxLag > 0 && !checkpoint.isCompleted(VCGL::PrecomputeCheckpoint::LAGGED_CORRELATIONS)) {
+		//compute lagged correlations
+		std::cout << "Computing lagged correlations..." << std::endl;
+		Clock::time_point start_lag = Clock::now();
+		VCGL::LaggedCorrelations lagged;
+		computeLaggedCorrelations(data, validityMask, options.maxLag, options.threadCount, lagged);
+		float seconds_lag = secondsSince(start_lag);
+		std::cout << "...completed in " << seconds_lag << " seconds" << std::endl;
+
+		//store lagged correlations and lags
+		std::cout << "Storing lagged correlations to file: " << fnLaggedCorrelation << "..." << std::endl;
+		if (storeCorrelationsVersioned(lagged.minima, nlat, nlon, fnLaggedCorrelation, subsetHeader)
+				&& storeLags(lagged.lags, lagged.minima.size(), lagged.maxLag, fnLags)) {
+			std::cout << "...stored." << std::endl;
+			checkpoint.complete(VCGL::PrecomputeCheckpoint::LAGGED_CORRELATIONS);
+			saver.save();
+		}
+		else {
+			std::cerr << "ERROR: failed to write " << fnLaggedCorrelation << " or " << fnLags << std::endl;
+			bFailed = true;
+		}
+	}
 
-	std::vector<VCGL::ProjectedPointInfo> projectionResults;
-	projectCorrelationMatrix(correlationMatrix, nlon, nlat, projectionResults);
+	if (needsProjection) {
+		//progress of the Sammon iterations, Ctrl+C stops them with a checkpoint to continue from
+		LSP::SammonController sammonController(options.sammonTolerance, [](const LSP::SammonProgress& progress) {
+			progress_bar(progress.iterations, progress.maxIterations);
+			if (progress.last) {
+				std::cout << std::endl;
+			}
+		});
+		ProjectionCheckpointer projectionCheckpointer(saver, sammonController);
+
+		//compute projection, continuing the iterations of the checkpoint or refining the warm start
+		std::vector<VCGL::ProjectedPointInfo> projectionResults;
+		int firstIteration = 0;
+		if (checkpoint.projectionIteration > 0 && checkpoint.projection.size() == 2*static_cast<size_t>(nlat)*nlon) {
+			firstIteration = checkpoint.projectionIteration;
+			projectionResults.resize(static_cast<size_t>(nlat)*nlon);
+			for (size_t i = 0; i<projectionResults.size(); i++) {
+				projectionResults[i].pt = LSP::TSPoint(checkpoint.projection[2*i], checkpoint.projection[2*i+1]);
+			}
+			std::cout << "Continuing the projection from iteration " << firstIteration << std::endl;
+		}
+		else if (!warmStart.empty()) {
+			firstIteration = sammonController.warmStartIteration();
+			projectionResults.swap(warmStart);
+			std::cout << "Refining the warm start from iteration " << firstIteration << std::endl;
+		}
+
+		std::cout << "Computing projection..." << std::endl;
+		Clock::time_point start_proj = Clock::now();
+
+		bool bProjected = true;
+		if (options.classicalMDS && inMemory) {
+			projectCorrelationMatrixMDS(correlationMatrix, nlon, nlat, projectionResults, options.threadCount);
+		}
+		else if (options.classicalMDS && pdmat) {
+			projectDMATMDS(*pdmat, projectionResults, options.threadCount);
+		}
+		else if (options.landmarkCount > 0 && inMemory) {
+			projectLandmarks(correlationMatrix, nlon, nlat, options.landmarkCount, projectionResults, options.threadCount);
+		}
+		else if (options.landmarkCount > 0) {
+			//the correlations with the landmarks are computed again from the data
+			projectLandmarks(data, validityMask, options.landmarkCount, projectionResults, options.threadCount);
+		}
+		else if (inMemory) {
+			InterruptibleProjection interruptible(sammonController);
+			projectCorrelationMatrix(correlationMatrix, nlon, nlat, projectionResults, &projectionCheckpointer, firstIteration,
+					options.threadCount, &sammonController);
+		}
+		else if (pdmat) {
+			InterruptibleProjection interruptible(sammonController);
+			std::vector<VCGL::strType> ptNames;
+			pdmat->getObjectIDs(ptNames);
+			projectDMAT(ptNames, *pdmat, projectionResults, &projectionCheckpointer, firstIteration, options.threadCount,
+					&sammonController);
+		}
+		else {
+			std::cerr << "WARNING: distance matrix does not fit the memory budget, projection skipped" << std::endl;
+			bProjected = false;
+		}
+
+		if (sammonController.cancelled()) {
+			//the checkpoint is kept, nothing is stored
+			if (saver.enabled()) {
+				std::cerr << "Projection interrupted after iteration " << sammonController.iterations()
+						<< ", continue with --resume" << std::endl;
+			}
+			else {
+				std::cerr << "Projection interrupted after iteration " << sammonController.iterations() << std::endl;
+			}
+			return -1;
+		}
+
+		if (bProjected) {
+			float seconds_proj = secondsSince(start_proj);
+			std::cout << "...completed in " << seconds_proj << " seconds" << std::endl;
+
+			//store projection
+			std::cout << "Storing projection to file: " << fnProjection.c_str() << "..." << std::endl;
+			storeProjectionResults(fnProjection.c_str(), projectionResults);
+			std::cout << "...stored." << std::endl;
+		}
+	}
 
-	clock_t end_proj = clock();
-	float seconds_proj = ((float)(end_proj - start_proj)) / CLOCKS_PER_SEC;
-	std::cout << "...completed in " << seconds_proj << " seconds" << std::endl;
+	//all done, unless stages failed (reported above): their checkpoint is kept for --resume
+	if (bFailed) {
+		return -1;
+	}
+	saver.remove();
+	remove(checkpointRowsFileName(fnCheckpoint).c_str());
+	return checkpoint.startTime;
+}
 
-	//store projection
-	std::cout << "Storing projection to file: " << fnProjection.c_str() << "..." << std::endl;
-	storeProjectionResults(fnProjection.c_str(), projectionResults);
-	std::cout << "...stored." << std::endl;
+/*! @brief Precompute through the cache: files of an identical earlier precompute are copied instead
+ *
+ * The key holds the fingerprint of the data file and every parameter on which
+ * the results depend (not the number of threads). The update (-U) keeps its
+ * own statistics and is not cached, nor are the shards (the merged files are)
+ * or a precompute refining the projection of another one (--warm-start).
+ *
+ * @return false if the precompute failed (reported)
+ */
+bool precompute_cached(const char * dataFN,
+		const char* varName,
+		const char* level = 0,
+		bool northOnly = false,
+		const VCGL::PrecomputeOptions& options = VCGL::PrecomputeOptions(),
+		const VCGL::DataSubset& subset = VCGL::DataSubset()) {
+	VCGL::PrecomputeCacheKey key;
+	if (options.update || options.cacheBudget == 0 || (options.shardCount > 0 && !options.merge) || !options.warmStart.empty()
+			|| !precomputeKey(dataFN, varName, level, northOnly, options, subset, key)) {
+		return precompute_var_level(dataFN, varName, level, northOnly, options, subset) != static_cast<std::time_t>(-1);
+	}
+
+	std::string fnCorrelation;
+	std::string fnAutocorr;
+	std::string fnProjection;
+	std::string fnTeleconnectivity;
+	std::string fnStatistics;
+	std::string fnLaggedCorrelation;
+	std::string fnLags;
+	std::string fnCheckpoint;
+	std::string fnShards;
+	generateFilenames_var_level(dataFN,
+			varName,
+			level ? level : "",
+			northOnly,
+			subset,
+			fnCorrelation,
+			fnAutocorr,
+			fnProjection,
+			fnTeleconnectivity,
+			fnStatistics,
+			fnLaggedCorrelation,
+			fnLags,
+			fnCheckpoint,
+			fnShards);
+	const std::vector<VCGL::CachedFile> files = {
+			VCGL::CachedFile("correlation", fnCorrelation),
+			VCGL::CachedFile("autocorr", fnAutocorr),
+			VCGL::CachedFile("projection", fnProjection),
+			VCGL::CachedFile("teleconn", fnTeleconnectivity),
+			VCGL::CachedFile("lagcorr", fnLaggedCorrelation),
+			VCGL::CachedFile("lags", fnLags) };
+
+	VCGL::FileSystem fs;
+	VCGL::PathResolver pr(fs);
+	VCGL::PrecomputeCache cache(pr.getCacheDir(), options.cacheBudget);
+	if (cache.restore(key, files)) {
+		std::cout << "Precomputed files restored from the cache " << cache.directory()
+				<< " (entry " << key.hash() << ")" << std::endl;
+		return true;
+	}
+
+	const std::time_t start = precompute_var_level(dataFN, varName, level, northOnly, options, subset);
+	if (start == static_cast<std::time_t>(-1)) {
+		return false;
+	}
 
+	// the budget is not in the key: a run that skipped the projection for it is not the same precompute
+	if (!options.teleconnectivityOnly && !modifiedSince(fnProjection, start)) {
+		std::cout << "The projection was skipped, the files are not stored in the cache" << std::endl;
+		return true;
+	}
+	const std::size_t count = cache.store(key, files, start);
+	if (count > 0) {
+		std::cout << "Stored " << count << " precomputed files in the cache " << cache.directory() << std::endl;
+	}
+	return true;
 }
 
 namespace VCGL {
 
-int Startup::runPrecompute(char* fileName, char* variableName, char* levelValue, bool northOnly) {
-	precompute_var_level(fileName, variableName, levelValue, northOnly);
-	return 0;
+int Startup::runPrecompute(char* fileName, char* variableName, char* levelValue, bool northOnly,
+		const PrecomputeOptions& options, const DataSubset& subset) {
+	return precompute_cached(fileName, variableName, levelValue, northOnly, options, subset) ? 0 : 1;
 }
 
-int Startup::runShow(char* fileName, char* variableName, char* levelValue, bool northOnly) {
+int Startup::runShow(char* fileName, char* variableName, char* levelValue, bool northOnly, bool lagged,
+		const DataSubset& subset, CorrelationDataType memoryType) {
 	int retVal = 0;
 
 	int argcFake = 0;
@@ -189,6 +1291,12 @@ int Startup::runShow(char* fileName, char* variableName, char* levelValue, bool
 	std::string fnCorrelation;
 	std::string fnAutocorr;
 	std::string fnProjection;
+	std::string fnTeleconnectivity;
+	std::string fnStatistics;
+	std::string fnLaggedCorrelation;
+	std::string fnLags;
+	std::string fnCheckpoint;
+	std::string fnShards;
 
 	int lvlValue = -1;
 	if (levelValue != 0) {
@@ -200,9 +1308,16 @@ int Startup::runShow(char* fileName, char* variableName, char* levelValue, bool
 			strVar,
 			strLVL,
 			northOnly,
+			subset,
 			fnCorrelation,
 			fnAutocorr,
-			fnProjection);
+			fnProjection,
+			fnTeleconnectivity,
+			fnStatistics,
+			fnLaggedCorrelation,
+			fnLags,
+			fnCheckpoint,
+			fnShards);
 
 	FileSystem fs;
 	PathResolver pr(fs);
@@ -211,6 +1326,18 @@ int Startup::runShow(char* fileName, char* variableName, char* levelValue, bool
 	pr.findDependency(std::string(fnCorrelation), strFN, fnCorrelation);
 	pr.findDependency(std::string(fnAutocorr), strFN, fnAutocorr);
 	pr.findDependency(std::string(fnProjection), strFN, fnProjection);
+	const bool hasTeleconnectivity = pr.findDependency(std::string(fnTeleconnectivity), strFN, fnTeleconnectivity);
+	if (lagged) {
+		if (pr.findDependency(std::string(fnLaggedCorrelation), strFN, fnLaggedCorrelation)
+				&& pr.findDependency(std::string(fnLags), strFN, fnLags)) {
+			// the teleconnectivity then follows from the lagged correlations
+			fnCorrelation = fnLaggedCorrelation;
+		}
+		else {
+			std::cerr << "WARNING: no lagged correlations found (precompute with -L), showing the correlations at lag 0" << std::endl;
+			lagged = false;
+		}
+	}
 
 	std::cout << "Data file: " << strFN.c_str() << std::endl;
 	std::cout << "Correlation file name: " << fnCorrelation.c_str() << std::endl;
@@ -222,28 +1349,46 @@ int Startup::runShow(char* fileName, char* variableName, char* levelValue, bool
 	std::cerr << "Using land contours file " << pathContours << std::endl;
 
 	{ // development version
-		ExplorationModel* pem = new ExplorationModelImpl();
+		const Clock::time_point start = Clock::now();
+		ExplorationModelImpl* pImpl = new ExplorationModelImpl();
+		pImpl->setInMemoryDataType(memoryType);
+		ExplorationModel* pem = pImpl;
 
 		VCGL::NCFileDataStorage* pncf = new VCGL::NCFileDataStorage(strFN.c_str());
 		pncf->initVariable(strVar.c_str(), lvlValue);
-		VCGL::TCStorage storage(pncf, northOnly); // takes ownership of pncf pointer
+		VCGL::TCStorage storage(pncf, northOnly, subset); // takes ownership of pncf pointer
 
+		// the grid lays out the views, the other files are loaded while they are shown
 		pem->loadGrid(storage);
-		//pem->loadGrid(strFN);
-		pem->loadCorrelations(fnCorrelation);
-		pem->loadAutocorrelations(fnAutocorr);
-		pem->loadContours(pathContours);
-		pem->loadProjection(fnProjection);
 
-		pem->computeStatisticalSignificanceMask(0.99); // prepare statistical significance
-		pem->setThreshold(0.0); // perform region search
+		ExplorationFiles files;
+		files.correlations = fnCorrelation;
+		if (hasTeleconnectivity && !lagged) {
+			std::cout << "Teleconnectivity file name: " << fnTeleconnectivity << std::endl;
+			files.teleconnectivity = fnTeleconnectivity;
+		}
+		if (lagged) {
+			std::cout << "Lags file name: " << fnLags << std::endl;
+			files.lags = fnLags;
+		}
+		files.autocorrelations = fnAutocorr;
+		files.contours = pathContours;
+		files.projection = fnProjection;
 
 		ExplorationWidget ew;
 		ew.move(200,200);
 		ew.setModel(pem);
+
+		// destroyed before the widget, which owns the model
+		ExplorationLoader loader(pImpl, files);
+		QObject::connect(&loader, SIGNAL(stageLoaded(int)), &ew, SLOT(updateAllViews()));
+		QObject::connect(&loader, SIGNAL(loadingStateChanged(const QString&)), &ew, SLOT(showLoadingState(const QString&)));
+		loader.start();
+
 		ew.show();
 		ew.resize(ew.width()+1, ew.height()+1);
 		ew.resize(ew.width()-1, ew.height()-1);
+		std::cout << "Window shown after " << secondsSince(start) << " seconds" << std::endl;
 
 		retVal = a.exec();
 	}
@@ -265,6 +1410,12 @@ int Startup::runRegionExplorer(char* fileName, char* variableName, char* levelVa
 	std::string fnCorrelation;
 	std::string fnAutocorr;
 	std::string fnProjection;
+	std::string fnTeleconnectivity;
+	std::string fnStatistics;
+	std::string fnLaggedCorrelation;
+	std::string fnLags;
+	std::string fnCheckpoint;
+	std::string fnShards;
 	int lvlValue = -1;
 
 	if (fileName != 0) {
@@ -282,9 +1433,16 @@ int Startup::runRegionExplorer(char* fileName, char* variableName, char* levelVa
 			strVar,
 			strLVL,
 			northOnly,
+			VCGL::DataSubset(),
 			fnCorrelation,
 			fnAutocorr,
-			fnProjection);
+			fnProjection,
+			fnTeleconnectivity,
+			fnStatistics,
+			fnLaggedCorrelation,
+			fnLags,
+			fnCheckpoint,
+			fnShards);
 
 	FileSystem fs;
 	PathResolver pr(fs);
@@ -292,6 +1450,7 @@ int Startup::runRegionExplorer(char* fileName, char* variableName, char* levelVa
 	pr.find(std::string(strFN), strFN);
 	pr.findDependency(std::string(fnCorrelation), strFN, fnCorrelation);
 	pr.findDependency(std::string(fnAutocorr), strFN, fnAutocorr);
+	const bool hasTeleconnectivity = pr.findDependency(std::string(fnTeleconnectivity), strFN, fnTeleconnectivity);
 
 	std::cout << "Data file: " << strFN.c_str() << std::endl;
 	std::cout << "Correlation file name: " << fnCorrelation.c_str() << std::endl;
@@ -310,6 +1469,10 @@ int Startup::runRegionExplorer(char* fileName, char* variableName, char* levelVa
 
 		pem->loadGrid(storage);
 		//pem->loadGrid(strFN);
+		if (hasTeleconnectivity) {
+			std::cout << "Teleconnectivity file name: " << fnTeleconnectivity << std::endl;
+			pem->loadTeleconnectivity(fnTeleconnectivity);
+		}
 		pem->loadCorrelations(fnCorrelation);
 		pem->loadAutocorrelations(fnAutocorr);
 		pem->loadContours(pathContours);
@@ -7,6 +7,10 @@
 #ifndef STARTUP_H_
 #define STARTUP_H_
 
+#include "process/precompute.h"
+#include "storage/datasubset.h"
+#include "storage/correlationstore.h"
+
 namespace VCGL {
 
 class Startup {
@@ -14,12 +18,17 @@ public:
 	static int runPrecompute(char* fileName,
 			char* variableName,
 			char* levelValue = 0,
-			bool northOnly = false );
+			bool northOnly = false,
+			const PrecomputeOptions& options = PrecomputeOptions(),
+			const DataSubset& subset = DataSubset() );
 
 	static int runShow(char* fileName,
 			char* variableName,
 			char* levelValue = 0,
-			bool northOnly = false );
+			bool northOnly = false,
+			bool lagged = false,
+			const DataSubset& subset = DataSubset(),
+			CorrelationDataType memoryType = CORRELATION_FLOAT32 );
 
 	static int runRegionExplorer(char* fileName,
 			char* variableName,
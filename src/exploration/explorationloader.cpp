@@ -0,0 +1,188 @@
+/*! @file explorationloader.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Loading of the precomputed files in the background while the exploration window is shown
+ */
+
+#include "explorationloader.h"
+
+#include <QMetaObject>
+#include <QStringList>
+
+#include <chrono>
+#include <iostream>
+
+namespace VCGL {
+
+namespace {
+	float secondsSince(const std::chrono::steady_clock::time_point& start) {
+		return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+ExplorationLoader::ExplorationLoader(ExplorationModelImpl* pModel, const ExplorationFiles& files, QObject* parent)
+: QObject(parent), pModel(pModel), files(files), grid(pModel->getGrid()), nlat(pModel->nlat()), nlon(pModel->nlon()),
+  inMemoryType(pModel->inMemoryDataType()), bCancelled(false), pending(STAGE_COUNT, false) {
+
+	pending[CONTOURS] = !files.contours.empty();
+	pending[TELECONNECTIVITY] = !files.correlations.empty();
+	pending[CORRELATIONS] = !files.correlations.empty();
+	pending[LAGS] = !files.lags.empty();
+	pending[AUTOCORRELATIONS] = !files.autocorrelations.empty();
+	pending[PROJECTION] = !files.projection.empty();
+}
+
+ExplorationLoader::~ExplorationLoader() {
+	bCancelled = true;
+	for (unsigned j=0; j<threads.size(); j++) {
+		threads[j].join();
+	}
+}
+
+void ExplorationLoader::start() {
+	if (pending[CONTOURS]) {
+		threads.push_back(std::thread(&ExplorationLoader::readContours, this));
+	}
+	if (pending[CORRELATIONS]) {
+		threads.push_back(std::thread(&ExplorationLoader::readCorrelations, this));
+	}
+	if (pending[LAGS]) {
+		threads.push_back(std::thread(&ExplorationLoader::readLags, this));
+	}
+	if (pending[AUTOCORRELATIONS]) {
+		threads.push_back(std::thread(&ExplorationLoader::readAutocorrelations, this));
+	}
+	if (pending[PROJECTION]) {
+		threads.push_back(std::thread(&ExplorationLoader::readProjection, this));
+	}
+	emit loadingStateChanged(pendingStages());
+}
+
+bool ExplorationLoader::isComplete() const {
+	for (unsigned j=0; j<pending.size(); j++) {
+		if (pending[j]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+QString ExplorationLoader::pendingStages() const {
+	QStringList names;
+	for (int stage=0; stage<STAGE_COUNT; stage++) {
+		if (pending[stage]) {
+			names << stageName(static_cast<Stage>(stage));
+		}
+	}
+	return names.join(", ");
+}
+
+const char* ExplorationLoader::stageName(Stage stage) {
+	switch (stage) {
+	case CONTOURS:
+		return "contours";
+	case TELECONNECTIVITY:
+		return "teleconnectivity";
+	case CORRELATIONS:
+		return "correlations";
+	case LAGS:
+		return "lags";
+	case AUTOCORRELATIONS:
+		return "autocorrelations";
+	case PROJECTION:
+		return "projection";
+	default:
+		return "";
+	}
+}
+
+void ExplorationLoader::adoptStage(int stage) {
+	switch (stage) {
+	case CONTOURS:
+		pModel->adoptContours(std::move(contours));
+		break;
+	case TELECONNECTIVITY:
+		pModel->adoptTeleconnectivity(std::move(teleconnectivity));
+		break;
+	case CORRELATIONS:
+		pModel->adoptCorrelations(std::move(correlations));
+		break;
+	case LAGS:
+		pModel->adoptLags(std::move(lags));
+		break;
+	case AUTOCORRELATIONS:
+		pModel->adoptAutocorrelations(std::move(autocorrelations));
+		break;
+	case PROJECTION:
+		pModel->adoptProjection(std::move(projectionData));
+		break;
+	default:
+		return;
+	}
+	pending[stage] = false;
+	emit stageLoaded(stage);
+	emit loadingStateChanged(pendingStages());
+}
+
+void ExplorationLoader::stageRead(Stage stage) {
+	// queued, so the model takes the result over on the loader's thread once its event loop runs
+	QMetaObject::invokeMethod(this, "adoptStage", Qt::QueuedConnection, Q_ARG(int, stage));
+}
+
+void ExplorationLoader::readContours() {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ExplorationModelImpl::readContours(files.contours, grid, contours);
+	std::cout << "Contours read in " << secondsSince(start) << " seconds" << std::endl;
+	stageRead(CONTOURS);
+}
+
+void ExplorationLoader::readCorrelations() {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	// a teleconnectivity file spares deriving it from all correlations
+	bool bTeleconnectivity = !files.teleconnectivity.empty()
+			&& ExplorationModelImpl::readTeleconnectivity(files.teleconnectivity, nlat, nlon, teleconnectivity);
+	if (bTeleconnectivity) {
+		std::cout << "Teleconnectivity read in " << secondsSince(start) << " seconds" << std::endl;
+		stageRead(TELECONNECTIVITY);
+	}
+
+	correlations = ExplorationModelImpl::readCorrelations(files.correlations, nlat*nlon, inMemoryType);
+	std::cout << "Correlations opened in " << secondsSince(start) << " seconds" << std::endl;
+	// the store is shared with the model, which does not change it, so the teleconnectivity
+	// is derived from it while it is shown (even after the model let it go)
+	const std::shared_ptr<const CorrelationStore> pStore = correlations;
+	stageRead(CORRELATIONS);
+
+	if (!bTeleconnectivity) {
+		if (pStore && ExplorationModelImpl::computeTeleconnectivity(*pStore, nlat, nlon, teleconnectivity, &bCancelled)) {
+			std::cout << "Teleconnectivity derived in " << secondsSince(start) << " seconds" << std::endl;
+		}
+		else if (bCancelled) {
+			return;
+		}
+		// without correlations the teleconnectivity stays empty
+		stageRead(TELECONNECTIVITY);
+	}
+}
+
+void ExplorationLoader::readLags() {
+	ExplorationModelImpl::readLags(files.lags, nlat*nlon, lags);
+	stageRead(LAGS);
+}
+
+void ExplorationLoader::readAutocorrelations() {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ExplorationModelImpl::readAutocorrelations(files.autocorrelations, nlat*nlon, autocorrelations);
+	std::cout << "Autocorrelations read in " << secondsSince(start) << " seconds" << std::endl;
+	stageRead(AUTOCORRELATIONS);
+}
+
+void ExplorationLoader::readProjection() {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ExplorationModelImpl::readProjection(files.projection, nlat, nlon, projectionData);
+	std::cout << "Projection read in " << secondsSince(start) << " seconds" << std::endl;
+	stageRead(PROJECTION);
+}
+
+} /* namespace VCGL */
@@ -0,0 +1,118 @@
+/*! @file explorationloader.h
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Loading of the precomputed files in the background while the exploration window is shown
+ */
+
+#ifndef EXPLORATIONLOADER_H_
+#define EXPLORATIONLOADER_H_
+
+#include <QObject>
+#include <QString>
+
+#include "explorationmodelimpl.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VCGL {
+
+/// Names of the files shown in the exploration window (an empty name is not loaded)
+struct ExplorationFiles {
+	std::string correlations;
+	std::string teleconnectivity;	///< precomputed teleconnectivity, otherwise it is derived from the correlations
+	std::string lags;
+	std::string autocorrelations;
+	std::string projection;
+	std::string contours;
+};
+
+/*! @brief Loads the files into a model whose grid is loaded, each file on a thread of its own.
+ *
+ * The files do not depend on each other except for the teleconnectivity: it is read from its
+ * file before the correlations are opened, and derived from them only if the file is missing
+ * or does not match. A stage reads into the loader without touching the model; the model
+ * takes over the result on the thread of the loader (the GUI thread) and stageLoaded is
+ * emitted, so the views fill in as the stages complete in whatever order.
+ */
+class ExplorationLoader: public QObject {
+	Q_OBJECT
+public:
+	/// Parts of the model filled by the loader
+	enum Stage {
+		CONTOURS,
+		TELECONNECTIVITY,
+		CORRELATIONS,
+		LAGS,
+		AUTOCORRELATIONS,
+		PROJECTION,
+		STAGE_COUNT
+	};
+
+	/*! @brief Constructor
+	 *
+	 * @param pModel Model with the grid loaded; it must outlive the loader
+	 */
+	ExplorationLoader(ExplorationModelImpl* pModel, const ExplorationFiles& files, QObject* parent = 0);
+	/// Stops deriving the teleconnectivity and waits for the threads still reading
+	virtual ~ExplorationLoader();
+
+	/// Start reading the files
+	void start();
+
+	/// Whether the model took over all stages
+	bool isComplete() const;
+
+	/// Names of the stages not yet taken over by the model, separated by commas
+	QString pendingStages() const;
+
+	/// Name of the stage
+	static const char* stageName(Stage stage);
+
+signals:
+	/// The model took over the stage
+	void stageLoaded(int stage);
+	/// The stages not yet loaded changed (empty when complete)
+	void loadingStateChanged(const QString& pendingStages);
+
+private slots:
+	/// Hand the result of the stage to the model
+	void adoptStage(int stage);
+
+private:
+	/// Tell the loader's thread that the stage is read
+	void stageRead(Stage stage);
+
+	void readContours();
+	void readCorrelations();
+	void readLags();
+	void readAutocorrelations();
+	void readProjection();
+
+	ExplorationModelImpl* pModel;
+	ExplorationFiles files;
+	MapGrid grid;
+	std::size_t nlat;
+	std::size_t nlon;
+	CorrelationDataType inMemoryType;
+
+	std::vector<std::thread> threads;
+	std::atomic<bool> bCancelled;
+	std::vector<bool> pending;	///< stages not yet taken over, only used on the loader's thread
+
+	// results of the stages, each written by its thread before stageRead
+	std::vector< std::vector<QPointF> > contours;
+	ExplorationModelImpl::TeleconnectivityMaps teleconnectivity;
+	std::shared_ptr<const CorrelationStore> correlations;	///< shared with the model, which does not change it
+	std::vector<int16_t> lags;
+	std::vector<float> autocorrelations;
+	std::vector< std::vector<QPointF> > projectionData;
+};
+
+} /* namespace VCGL */
+
+#endif /* EXPLORATIONLOADER_H_ */
@@ -27,6 +27,14 @@ bool ExplorationModel::getClosestPointTeleconnectivityValue(const QPointF& /*poi
 	return false;
 }
 
+bool ExplorationModel::loadLags(const std::string& /*lagsFileName*/) {
+	return false;
+}
+
+bool ExplorationModel::getClosestPointLag(const QPointF& /*point*/, int* /*pLag*/) const {
+	return false;
+}
+
 void ExplorationModel::getSelectionMask(std::vector< std::vector<bool> >& selectionMask) const {
 	selectionMask.clear();
 }
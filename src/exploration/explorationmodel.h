@@ -40,6 +40,21 @@ public:
 	/// Load precomputed correlations data from the specified file
 	virtual void loadCorrelations(const std::string& correlationsFileName) = 0;
 
+	/*! @brief Load precomputed teleconnectivity from the specified file
+	 *
+	 * Must be called after the grid and before loadCorrelations,
+	 * which then does not derive the teleconnectivity from the correlations.
+	 * @return false if the file does not match the grid
+	 */
+	virtual bool loadTeleconnectivity(const std::string& teleconnectivityFileName) = 0;
+
+	/*! @brief Load the lags of the lagged correlations (see computeLaggedCorrelations)
+	 *
+	 * Used together with the lagged correlation file given to loadCorrelations.
+	 * @return false if the file does not match the grid or lags are not supported
+	 */
+	virtual bool loadLags(const std::string& lagsFileName);
+
 	/// Load precomputed correlations data from the specified file
 	virtual void loadAutocorrelations(const std::string& autocorrFileName) = 0;
 
@@ -87,6 +102,14 @@ public:
 	 */
 	virtual bool getClosestPointTeleconnectivityValue(const QPointF& point, float* pValue) const;
 
+	/*! @brief Get the lag of the correlation between the reference point and the point closest to the specified one
+	 *
+	 * @param[in] point  Coordinates of a point as a (lon, lat)-pair
+	 * @param[out] pLag Pointer to an int receiving the lag in time steps (positive if the point follows the reference point)
+	 * @return true if lags are loaded, false otherwise
+	 */
+	virtual bool getClosestPointLag(const QPointF& point, int* pLag) const;
+
 	/*! @brief Get current selection mask.
 	 *
 	 *	@attention Two-dimensional vector has [iLat][iLon]-indices.
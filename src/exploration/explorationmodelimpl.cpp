@@ -10,6 +10,7 @@
 #include "storage/ncfiledatastorage.h"
 #include "storage/tcstorage.h"
 #include "storage/precomputeddata.h"
+#include "storage/correlationencoding.h"
 #include "storage/read.h"
 
 #include <string>
@@ -21,6 +22,7 @@
 #include "projection/tspoint.h"
 
 #include "process/regionsearch.h"
+#include "process/precompute.h"
 
 #include <gsl/gsl_cdf.h>
 #include <gsl/gsl_randist.h>
@@ -33,6 +35,10 @@ namespace VCGL {
 
 ExplorationModelImpl::ExplorationModelImpl():
 		refPtIndices(0,0),
+		refPtChosen(false),
+		tcLoaded(false),
+		inMemoryType(CORRELATION_FLOAT32),
+		significanceLevel(0.0f),
 		nRegions(0),
 		numSelectedPoints(0) {
 
@@ -65,69 +71,271 @@ void ExplorationModelImpl::loadGrid(const std::string& fileName) {
 
 void ExplorationModelImpl::loadCorrelations(const std::string& correlationsFileName) {
 	assert(nlat() > 0 && nlon() > 0);
-	readCorrelationTriangle(correlationsFileName.c_str(), correlations);
-
-	unsigned npoints = nlat()*nlon();
-	assert(correlations.size() == npoints);
-	assert(correlations[0].size() == npoints);
+	adoptCorrelations(readCorrelations(correlationsFileName, nlat()*nlon(), inMemoryType));
+	if (!correlations) {
+		std::cerr << "No correlations, the maps stay empty" << std::endl;
+		return;
+	}
 
-	computeTeleconnectivity();
+	if (!tcLoaded) {
+		TeleconnectivityMaps maps;
+		computeTeleconnectivity(*correlations, nlat(), nlon(), maps);
+		adoptTeleconnectivity(std::move(maps));
+	}
+}
 
-	QPoint highestTCindices{0,0};
-	float maxTC = 0.0;
-	for (unsigned i=0; i<nlat(); i++) {
-		for(unsigned j=0; j<nlon(); j++) {
-			if (tc[i][j] > maxTC) {
-				maxTC = tc[i][j];
-				highestTCindices = QPoint{(int)j,(int)i};
-			}
-		}
+bool ExplorationModelImpl::loadTeleconnectivity(const std::string& teleconnectivityFileName) {
+	assert(nlat() > 0 && nlon() > 0);
+	TeleconnectivityMaps maps;
+	tcLoaded = readTeleconnectivity(teleconnectivityFileName, nlat(), nlon(), maps);
+	if (tcLoaded) {
+		adoptTeleconnectivity(std::move(maps));
 	}
-	selectReferencePoint( indicesToCoordinates(highestTCindices) );
-	//refPtIndices = highestTCindices;
+	return tcLoaded;
 }
 
-void ExplorationModelImpl::loadAutocorrelations(const std::string& autocorrFileName) {
+bool ExplorationModelImpl::loadLags(const std::string& lagsFileName) {
 	assert(nlat() > 0 && nlon() > 0);
-	readAutocorrelations(autocorrFileName, autocorrelations);
+	std::vector<int16_t> values;
+	const bool bLoaded = readLags(lagsFileName, nlat()*nlon(), values);
+	adoptLags(std::move(values));
+	return bLoaded;
+}
 
-	unsigned npoints = nlat()*nlon();
-	assert(autocorrelations.size() == npoints);
+void ExplorationModelImpl::loadAutocorrelations(const std::string& autocorrFileName) {
+	assert(nlat() > 0 && nlon() > 0);
+	std::vector<float> values;
+	readAutocorrelations(autocorrFileName, nlat()*nlon(), values);
+	assert(values.size() == nlat()*nlon());
+	adoptAutocorrelations(std::move(values));
 }
 
 void ExplorationModelImpl::loadContours(const std::string& contoursFileName) {
-	readContours(contoursFileName.c_str(), contours);
-	clipContours(grid, contours);
+	std::vector< std::vector<QPointF> > clipped;
+	readContours(contoursFileName, grid, clipped);
+	adoptContours(std::move(clipped));
 }
 
 void ExplorationModelImpl::loadProjection(const std::string& projectionFileName) {
 	assert(nlon()>0 && nlat()>0);
-	if (nlon()>0 && nlat()>0) {
-		std::vector<VCGL::ProjectedPointInfo> projection;
-		loadProjectionLonLat(projectionFileName.c_str(), nlon(), nlat(), projection);
+	std::vector< std::vector<QPointF> > points;
+	readProjection(projectionFileName, nlat(), nlon(), points);
+	adoptProjection(std::move(points));
+}
 
-		projectionData.clear();
-		projectionData.resize(nlat(), std::vector<QPointF>(nlon(), QPointF(0,0)));
-		for (unsigned i=0; i<nlat(); i++) {
-			for (unsigned j=0; j<nlon(); j++) {
-				int index = i*nlon() + j;
-				LSP::TSPoint & pt = projection[index].pt;
-				projectionData[i][j] = QPointF{ pt.getX(), pt.getY() };
+std::unique_ptr<CorrelationStore> ExplorationModelImpl::readCorrelations(const std::string& correlationsFileName,
+		std::size_t npoints, CorrelationDataType dtype) {
+	std::unique_ptr<CorrelationStore> store = openCorrelationStore(correlationsFileName);
+	if (!store || store->pointCount() != npoints) {
+		std::cerr << "Correlation file " << correlationsFileName << " cannot be read or does not match the grid" << std::endl;
+		return std::unique_ptr<CorrelationStore>();
+	}
+
+	const CorrelationTriangleStore* pTriangle = dynamic_cast<const CorrelationTriangleStore*>(store.get());
+	if (dtype != CORRELATION_FLOAT32 && pTriangle) {
+		std::cout << "Keeping the correlations as " << correlationDataTypeName(dtype) << std::endl;
+		store.reset(new QuantizedTriangleStore(pTriangle->matrix(), dtype));
+	}
+	return store;
+}
+
+bool ExplorationModelImpl::readTeleconnectivity(const std::string& teleconnectivityFileName,
+		std::size_t nlat, std::size_t nlon, TeleconnectivityMaps& maps) {
+	std::vector<float> minima;
+	std::vector<int> partners;
+	::readTeleconnectivity(teleconnectivityFileName, minima, partners);
+
+	const unsigned npoints = nlat*nlon;
+	if (minima.size() != npoints) {
+		std::cerr << "Teleconnectivity file " << teleconnectivityFileName
+				<< " does not match the grid, it will be computed from the correlations" << std::endl;
+		return false;
+	}
+
+	maps.tc.assign(nlat, std::vector<float>(nlon, 0));
+	maps.tcindices.assign(nlat, std::vector<QPoint>(nlon, QPoint(-1,-1)));
+	for (unsigned i=0; i<npoints; i++) {
+		int ptlat = i / nlon;
+		int ptlon = i % nlon;
+
+		int qlat = partners[i] / nlon;
+		int qlon = partners[i] % nlon;
+
+		maps.tc[ptlat][ptlon] = fabs(minima[i]);
+		maps.tcindices[ptlat][ptlon] = QPoint(qlon, qlat);
+	}
+	return true;
+}
+
+bool ExplorationModelImpl::computeTeleconnectivity(const CorrelationStore& correlations, std::size_t nlat, std::size_t nlon,
+		TeleconnectivityMaps& maps, const std::atomic<bool>* pCancelled) {
+	//find teleconnectivity & tc-indices
+	const unsigned npoints = nlat*nlon;
+	maps.tc.assign(nlat, std::vector<float>(nlon, 0));
+	maps.tcindices.assign(nlat, std::vector<QPoint>(nlon, QPoint(-1,-1)));
+
+	std::vector<float> minima(npoints, 1.0f);
+	std::vector<size_t> partners(npoints);
+	const CorrelationTriangleStore* pTriangle = dynamic_cast<const CorrelationTriangleStore*>(&correlations);
+	const QuantizedTriangleStore* pQuantized = dynamic_cast<const QuantizedTriangleStore*>(&correlations);
+	if (pTriangle || pQuantized) {
+		// one pass along the packed triangle, every value counts for both of its points;
+		// a full row of the triangle is mostly a column of it
+		TeleconnectivityMinima triangleMinima(npoints);
+		std::vector<float> decoded(pQuantized ? npoints : 0);
+		for (unsigned i=0; i<npoints; i++) {
+			if (pCancelled && *pCancelled) {
+				return false;
+			}
+			if (pTriangle) {
+				triangleMinima.consumeRows(i, i+1, pTriangle->matrix().data() + triangleOffset(i));
+			}
+			else {
+				pQuantized->triangleRow(i, decoded.data());
+				triangleMinima.consumeRows(i, i+1, decoded.data());
+			}
+		}
+		minima = triangleMinima.minima();
+		std::copy(triangleMinima.partners().begin(), triangleMinima.partners().end(), partners.begin());
+	}
+	else {
+		// sparse and compressed stores keep the minima of their rows
+		for (unsigned i=0; i<npoints; i++) {
+			if (pCancelled && *pCancelled) {
+				return false;
+			}
+			correlations.rowMinimum(i, &minima[i], &partners[i]);
+		}
+	}
+
+	for (unsigned i=0; i<npoints; i++) {
+		int ptlat = i / nlon;
+		int ptlon = i % nlon;
+
+		int qlat = partners[i] / nlon;
+		int qlon = partners[i] % nlon;
+
+		maps.tc[ptlat][ptlon] = fabs(minima[i]);
+		maps.tcindices[ptlat][ptlon] = QPoint(qlon, qlat);
+	}
+	return true;
+}
+
+bool ExplorationModelImpl::readLags(const std::string& lagsFileName, std::size_t npoints, std::vector<int16_t>& lags) {
+	size_t filePoints = 0;
+	int maxLag = 0;
+	if (!::readLags(lagsFileName, lags, &filePoints, &maxLag) || filePoints != npoints) {
+		std::cerr << "Lags file " << lagsFileName << " does not match the grid, lags are not shown" << std::endl;
+		lags.clear();
+		return false;
+	}
+	std::cout << "Lags up to " << maxLag << " time steps loaded" << std::endl;
+	return true;
+}
+
+bool ExplorationModelImpl::readAutocorrelations(const std::string& autocorrFileName, std::size_t npoints,
+		std::vector<float>& autocorrelations) {
+	::readAutocorrelations(autocorrFileName, autocorrelations);
+	if (autocorrelations.size() != npoints) {
+		std::cerr << "Autocorrelation file " << autocorrFileName << " does not match the grid" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ExplorationModelImpl::readProjection(const std::string& projectionFileName, std::size_t nlat, std::size_t nlon,
+		std::vector< std::vector<QPointF> >& projectionData) {
+	std::vector<VCGL::ProjectedPointInfo> projection;
+	loadProjectionLonLat(projectionFileName.c_str(), nlon, nlat, projection);
+
+	projectionData.clear();
+	if (projection.size() != nlat*nlon) {
+		std::cerr << "Projection file " << projectionFileName << " does not match the grid" << std::endl;
+		return;
+	}
+	projectionData.resize(nlat, std::vector<QPointF>(nlon, QPointF(0,0)));
+	for (unsigned i=0; i<nlat; i++) {
+		for (unsigned j=0; j<nlon; j++) {
+			int index = i*nlon + j;
+			LSP::TSPoint & pt = projection[index].pt;
+			projectionData[i][j] = QPointF{ pt.getX(), pt.getY() };
+		}
+	}
+}
+
+void ExplorationModelImpl::readContours(const std::string& contoursFileName, const MapGrid& clGrid,
+		std::vector< std::vector<QPointF> >& contours) {
+	::readContours(contoursFileName.c_str(), contours);
+	clipContours(clGrid, contours);
+}
+
+void ExplorationModelImpl::adoptCorrelations(std::shared_ptr<const CorrelationStore> store) {
+	correlations = std::move(store);
+	updateDerived();
+}
+
+void ExplorationModelImpl::adoptTeleconnectivity(TeleconnectivityMaps&& maps) {
+	tc = std::move(maps.tc);
+	tcindices = std::move(maps.tcindices);
+
+	// the teleconnectivity arriving late does not override the point the user has chosen
+	if (!refPtChosen) {
+		QPoint highestTCindices{0,0};
+		float maxTC = 0.0;
+		for (unsigned i=0; i<tc.size(); i++) {
+			for(unsigned j=0; j<tc[i].size(); j++) {
+				if (tc[i][j] > maxTC) {
+					maxTC = tc[i][j];
+					highestTCindices = QPoint{(int)j,(int)i};
+				}
 			}
 		}
+		refPtIndices = highestTCindices;
 	}
+	updateDerived();
+}
+
+void ExplorationModelImpl::adoptLags(std::vector<int16_t>&& lags) {
+	this->lags = std::move(lags);
+}
+
+void ExplorationModelImpl::adoptAutocorrelations(std::vector<float>&& autocorrelations) {
+	this->autocorrelations = std::move(autocorrelations);
+	updateDerived();
+}
+
+void ExplorationModelImpl::adoptProjection(std::vector< std::vector<QPointF> >&& projectionData) {
+	this->projectionData = std::move(projectionData);
+}
+
+void ExplorationModelImpl::adoptContours(std::vector< std::vector<QPointF> >&& contours) {
+	this->contours = std::move(contours);
+}
+
+void ExplorationModelImpl::updateDerived() {
+	if (significanceLevel > 0.0f) {
+		computeStatisticalSignificanceMask(significanceLevel);
+	}
+	setThreshold(threshold);
+	buildCorrelationChain();
+}
+
+bool ExplorationModelImpl::canFindRegions() const {
+	return !tc.empty() && correlations && autocorrelations.size() == nlat()*nlon();
 }
 
 void ExplorationModelImpl::setThreshold(float newValue) {
 	ExplorationModel::setThreshold(newValue);
-	VCGL::RegionSearch rs;
-	nRegions = rs.findRegions(tc, tcindices, threshold, regionMap, rc, (RSHelper*)this);
+	if (canFindRegions()) {
+		VCGL::RegionSearch rs;
+		nRegions = rs.findRegions(tc, tcindices, threshold, regionMap, rc, (RSHelper*)this);
+	}
 }
 
 bool ExplorationModelImpl::getClosestPointCorrelationValue(const QPointF& point, float* pValue) const {
 	bool bFound = false;
 	assert(nlon()>0 && nlat()>0);
-	if (nlon()>0 && nlat()>0) {
+	if (nlon()>0 && nlat()>0 && correlations) {
 		QPoint indices = findClosestPointIndices(point);
 
 		*pValue = getCorrelationValue(refPtIndices, indices);
@@ -136,11 +344,28 @@ bool ExplorationModelImpl::getClosestPointCorrelationValue(const QPointF& point,
 	return bFound;
 }
 
+bool ExplorationModelImpl::getClosestPointLag(const QPointF& point, int* pLag) const {
+	if (lags.empty()) {
+		return false;
+	}
+	QPoint indices = findClosestPointIndices(point);
+	const size_t ref = refPtIndices.y()*nlon() + refPtIndices.x();
+	const size_t pt = indices.y()*nlon() + indices.x();
+	if (ref == pt) {
+		*pLag = 0;
+	}
+	else {
+		// a positive stored lag means that the lower index follows the higher one
+		*pLag = (ref > pt) ? lags[triangleOffset(ref) + pt] : -lags[triangleOffset(pt) + ref];
+	}
+	return true;
+}
+
 bool ExplorationModelImpl::getClosestPointTeleconnectivityValue(const QPointF& point, float* pValue) const {
 	bool bFound = false;
 	assert(nlon()>0 && nlat()>0);
-	assert(nlat() == tc.size() && nlon() == tc[0].size());
-	if (nlon()>0 && nlat()>0) {
+	assert(tc.empty() || (nlat() == tc.size() && nlon() == tc[0].size()));
+	if (nlon()>0 && nlat()>0 && !tc.empty()) {
 		QPoint indices = findClosestPointIndices(point);
 
 		*pValue = tc[indices.y()][indices.x()];
@@ -160,11 +385,13 @@ void ExplorationModelImpl::getSelectionMask(std::vector< std::vector<bool> >& se
 
 void ExplorationModelImpl::getCorrelationMapColors(std::vector< std::vector<float> >& colorData) const {
 	colorData.clear();
+	if (!correlations) {
+		return;
+	}
 	colorData.resize(nlat(), std::vector<float>(nlon(), 0));
 
-	const std::vector<float>& map = correlations[refPtIndices.y()*nlon()+refPtIndices.x()];
-
-	assert(map.size() == nlat()*nlon());
+	std::vector<float> map(nlat()*nlon());
+	correlations->row(refPtIndices.y()*nlon()+refPtIndices.x(), map.data());
 
 	for (unsigned i=0; i < nlat(); i++) {
 		for (unsigned j=0; j< nlon(); j++) {
@@ -175,9 +402,13 @@ void ExplorationModelImpl::getCorrelationMapColors(std::vector< std::vector<floa
 }
 
 void ExplorationModelImpl::computeStatisticalSignificanceMask(float ssLevel) {
+	significanceLevel = ssLevel;
+	statisticalSignificanceMask.clear();
+	if (tc.empty() || autocorrelations.size() != nlat()*nlon()) {
+		return;
+	}
 
 	assert(nlat() == tc.size() && nlon() == tc[0].size());
-	statisticalSignificanceMask.clear();
 	statisticalSignificanceMask.resize(nlat(), std::vector<bool>(nlon(), false));
 
 	for (unsigned i=0; i<nlat(); i++) {
@@ -206,8 +437,11 @@ void ExplorationModelImpl::getStatisticalSignificanceMask(std::vector< std::vect
 }
 
 void ExplorationModelImpl::getTeleconnectivityMapColors(std::vector< std::vector<float> >& colorData) const {
-	assert(nlat() == tc.size() && nlon() == tc[0].size());
 	colorData = tc;
+	if (tc.empty()) {
+		return;
+	}
+	assert(nlat() == tc.size() && nlon() == tc[0].size());
 
 	//filter the values below threshold
 	for (unsigned i=0; i<nlat(); i++) {
@@ -253,8 +487,11 @@ void ExplorationModelImpl::getCorrelationMapChainLinks(std::vector<VCGL::Annotat
 }
 
 void ExplorationModelImpl::getCorrelationChainProjection(std::vector< QPointF >& chainProjection) const {
-	assert(nlat() == projectionData.size() && nlon() == projectionData[0].size());
 	chainProjection.clear();
+	if (projectionData.empty()) {
+		return;
+	}
+	assert(nlat() == projectionData.size() && nlon() == projectionData[0].size());
 	for (unsigned i=0; i<chosenPoints.size(); i++) {
 		const QPointF& projectedPoint = projectionData[ chosenPoints[i].y() ][ chosenPoints[i].x() ];
 		chainProjection.push_back( projectedPoint );
@@ -306,6 +543,7 @@ void ExplorationModelImpl::selectReferencePoint( const QPointF& pointCoordinates
 		QPoint indices = findClosestPointIndices(pointCoordinates);
 
 		refPtIndices = indices;
+		refPtChosen = true;
 
 		buildCorrelationChain();
 	}
@@ -316,6 +554,9 @@ QPointF ExplorationModelImpl::getReferencePoint() const {
 }
 
 QPointF ExplorationModelImpl::getReferencePointProjection() const {
+	if (projectionData.empty()) {
+		return QPointF(0.0f, 0.0f);
+	}
 	assert(nlat() == projectionData.size() && nlon() == projectionData[0].size());
 	assert(refPtIndices.x()>=0 && refPtIndices.y()>=0);
 	assert(nlat() > (unsigned)refPtIndices.y() && nlon() > (unsigned)refPtIndices.x());
@@ -323,6 +564,9 @@ QPointF ExplorationModelImpl::getReferencePointProjection() const {
 }
 
 void ExplorationModelImpl::selectRegionAtPoint(const QPointF& point, bool bSelectWholeComponent) {
+	if (regionMap.empty()) {
+		return;
+	}
 	QPoint indices = findClosestPointIndices(point);
 
 	std::vector< std::vector<bool> > newSelectionMask (nlat(), std::vector<bool>(nlon(), false));
@@ -396,7 +640,7 @@ bool ExplorationModelImpl::pointsEqual(const QPointF& a, const QPointF& b) const
 }
 
 float ExplorationModelImpl::getCorrelationValue( const QPoint& aIndices, const QPoint& bIndices ) const {
-	return correlations[aIndices.y()*nlon()+aIndices.x()][bIndices.y()*nlon()+bIndices.x()];
+	return correlations->value(aIndices.y()*nlon()+aIndices.x(), bIndices.y()*nlon()+bIndices.x());
 }
 
 bool ExplorationModelImpl::xLooped() const {
@@ -407,8 +651,7 @@ bool ExplorationModelImpl::isCorrelationSignificant(const QPoint& aIndices, cons
 	const float ssLevel = 0.995; //TODO: change to user-defined?
 
 	size_t npoints = nlat()*nlon();
-	assert (correlations.size() == npoints);
-	assert (correlations[0].size() == npoints);
+	assert (correlations && correlations->pointCount() == npoints);
 	assert (autocorrelations.size() == npoints);
 
 	int indexA = aIndices.y()*nlon()+aIndices.x();
@@ -472,6 +715,9 @@ void ExplorationModelImpl::buildCorrelationChain() {
 	//find NCORRELATIONPOINTS links from the reference point to the most negatively correlated
 	const int MAXCORRELATIONPOINTS = 100;
 	chosenPoints.clear();
+	if (tcindices.empty() || !correlations) {
+		return;
+	}
 
 	QPoint lastPoint = refPtIndices;
 	chosenPoints.push_back( lastPoint );
@@ -481,15 +727,18 @@ void ExplorationModelImpl::buildCorrelationChain() {
 	const QPoint indexFirstLink = tcindices[refPtIndices.y()][refPtIndices.x()];
 	float lastCorrelationValue = getCorrelationValue(refPtIndices, indexFirstLink);
 
+	std::vector<float> lastRow(nlat()*nlon());
 	while (chainLength < MAXCORRELATIONPOINTS && lastCorrelationValue < getThreshold() ) {
 
 		QPoint minPt = lastPoint;
 		float corrValue = 1.0f;
+		// one row read per step, the store may be sparse or mapped from disk
+		correlations->row(lastPoint.y()*nlon()+lastPoint.x(), lastRow.data());
 
 		for (unsigned y=0; y<nlat(); y++) {
 			for (unsigned x=0; x<nlon(); x++) {
 				QPoint newPt{(int)x, (int)y};
-				if (getCorrelationValue(lastPoint,newPt) < corrValue) {
+				if (lastRow[y*nlon()+x] < corrValue) {
 
 					//check that the point was not yet selected
 					bool bPointIsNew = true;
@@ -501,7 +750,7 @@ void ExplorationModelImpl::buildCorrelationChain() {
 
 					if (bPointIsNew) {
 						minPt = newPt;
-						corrValue = getCorrelationValue(lastPoint,newPt);
+						corrValue = lastRow[y*nlon()+x];
 					}
 				}
 			}
@@ -516,36 +765,6 @@ void ExplorationModelImpl::buildCorrelationChain() {
 	}
 }
 
-void ExplorationModelImpl::computeTeleconnectivity() {
-	//find teleconnectivity & tc-indices
-	const unsigned npoints = nlat()*nlon();
-	tc.clear();
-	tcindices.clear();
-
-	tc.resize(nlat(), std::vector<float>(nlon(), 0));
-	tcindices.resize(nlat(), std::vector<QPoint>(nlon(), QPoint(-1,-1)));
-
-	for (unsigned i=0; i<npoints; i++) {
-		float minCorr = 1.0f;
-		int minIndex = i;
-		for (unsigned j=0; j<npoints; j++) {
-			if (correlations[i][j] < minCorr) {
-				minCorr = correlations[i][j];
-				minIndex = j;
-			}
-		}
-
-		int ptlat = i / nlon();
-		int ptlon = i % nlon();
-
-		int qlat = minIndex / nlon();
-		int qlon = minIndex % nlon();
-
-		tc[ptlat][ptlon] = fabs(minCorr);
-		tcindices[ptlat][ptlon] = QPoint(qlon, qlat);
-	}
-}
-
 bool ExplorationModelImpl::ttest(float ssLevel, double t, float df, bool directional) const {
 	bool bSignificant = false;
 
@@ -10,6 +10,10 @@
 
 #include "explorationmodel.h"
 #include "process/regionsearch.h"
+#include "storage/correlationstore.h"
+
+#include <memory>
+#include <atomic>
 
 namespace VCGL {
 
@@ -29,11 +33,85 @@ public:
 	virtual void loadContours(const std::string& contoursFileName) override;
 	/// @copydoc ExplorationModel::loadCorrelations
 	virtual void loadCorrelations(const std::string& correlationsFileName) override;
+	/// @copydoc ExplorationModel::loadTeleconnectivity
+	virtual bool loadTeleconnectivity(const std::string& teleconnectivityFileName) override;
+	/// @copydoc ExplorationModel::loadLags
+	virtual bool loadLags(const std::string& lagsFileName) override;
 	/// @copydoc ExplorationModel::loadAutocorrelations
 	virtual void loadAutocorrelations(const std::string& autocorrFileName) override;
 	/// @copydoc ExplorationModel::loadProjection
 	virtual void loadProjection(const std::string& projectionFileName) override;
 
+	/*! @brief Type in which loadCorrelations keeps full correlations stored as floats
+	 *
+	 * With a type other than float32, a triangle of floats is encoded once it is loaded
+	 * and the rows are decoded from it as they are shown (in half or a quarter of the memory).
+	 * Files stored in another type or format are kept as they are.
+	 */
+	void setInMemoryDataType(CorrelationDataType dtype) { inMemoryType = dtype; }
+	/// Type set with setInMemoryDataType
+	CorrelationDataType inMemoryDataType() const { return inMemoryType; }
+
+	/// Teleconnectivity of every point and the point where it is reached, indexed [iLat][iLon]
+	struct TeleconnectivityMaps {
+		std::vector< std::vector<float> > tc;
+		std::vector< std::vector<QPoint> > tcindices;
+	};
+
+	/*! @name Reading without the model
+	 * These functions touch no model, so they may run on another thread while the model
+	 * is shown; the results are handed to the model with the adopt functions.
+	 * The load functions above are a read followed by an adopt.
+	 */
+	///@{
+	/// Open the correlation file (0 if it cannot be read), encoded in memory as dtype (see setInMemoryDataType)
+	static std::unique_ptr<CorrelationStore> readCorrelations(const std::string& correlationsFileName,
+			std::size_t npoints, CorrelationDataType dtype);
+	/// Read the teleconnectivity file, false if it does not match the grid
+	static bool readTeleconnectivity(const std::string& teleconnectivityFileName, std::size_t nlat, std::size_t nlon,
+			TeleconnectivityMaps& maps);
+	/*! @brief Compute teleconnectivity for points.
+	 *
+	 * For each point, its teleconnectivity is the absolute value of the most negative correlation
+	 * with another point. For the exploration purposes, it is required to know the point to which
+	 * the point of interest exposes that amount of teleconnectivity.
+	 *
+	 * @param pCancelled If given and set while computing, false is returned with the maps incomplete
+	 */
+	static bool computeTeleconnectivity(const CorrelationStore& correlations, std::size_t nlat, std::size_t nlon,
+			TeleconnectivityMaps& maps, const std::atomic<bool>* pCancelled = 0);
+	/// Read the lags file, false if it does not match the grid
+	static bool readLags(const std::string& lagsFileName, std::size_t npoints, std::vector<int16_t>& lags);
+	/// Read the autocorrelations file, false if it does not match the grid
+	static bool readAutocorrelations(const std::string& autocorrFileName, std::size_t npoints, std::vector<float>& autocorrelations);
+	/// Read the projection file as (x,y) of every point, indexed [iLat][iLon]
+	static void readProjection(const std::string& projectionFileName, std::size_t nlat, std::size_t nlon,
+			std::vector< std::vector<QPointF> >& projectionData);
+	/// Read the land contours and clip them to the grid
+	static void readContours(const std::string& contoursFileName, const MapGrid& clGrid,
+			std::vector< std::vector<QPointF> >& contours);
+	///@}
+
+	/*! @name Taking over data read without the model
+	 * The model shows whatever it has so far: the maps stay empty until their data arrive,
+	 * and the significance, the regions and the correlation chain are computed as soon as
+	 * the data they need are all there.
+	 */
+	///@{
+	/// Take over the correlations (0 - none), which the model shares but never changes
+	void adoptCorrelations(std::shared_ptr<const CorrelationStore> store);
+	/// Take over the teleconnectivity and, unless the user has chosen one, select the point with the highest one as the reference point
+	void adoptTeleconnectivity(TeleconnectivityMaps&& maps);
+	/// Take over the lags of the lagged correlations
+	void adoptLags(std::vector<int16_t>&& lags);
+	/// Take over the autocorrelations
+	void adoptAutocorrelations(std::vector<float>&& autocorrelations);
+	/// Take over the projection
+	void adoptProjection(std::vector< std::vector<QPointF> >&& projectionData);
+	/// Take over the (clipped) land contours
+	void adoptContours(std::vector< std::vector<QPointF> >&& contours);
+	///@}
+
 	/// @copydoc ExplorationModel::setThreshold
 	virtual void setThreshold(float newValue) override;
 
@@ -41,6 +119,8 @@ public:
 	virtual bool getClosestPointCorrelationValue(const QPointF& point, float* pValue) const override;
 	/// @copydoc ExplorationModel::getClosestPointTeleconnectivityValue
 	virtual bool getClosestPointTeleconnectivityValue(const QPointF& point, float* pValue) const override;
+	/// @copydoc ExplorationModel::getClosestPointLag
+	virtual bool getClosestPointLag(const QPointF& point, int* pLag) const override;
 
 	/// @copydoc ExplorationModel::getSelectionMask
 	virtual void getSelectionMask(std::vector< std::vector<bool> >& selectionMask) const override;
@@ -110,14 +190,11 @@ private:
 	/// Build the correlation chain (@see ExplorationModel::getCorrelationMapChainLinks)
 	void buildCorrelationChain();
 
-	/*! @brief Compute teleconnectivity for points.
-	 *
-	 * For each point, its teleconnectivity is the absolute value of the most negative correlation
-	 * with another point. For the exploration purposes, it is required to know the point to which
-	 * the point of interest exposes that amount of teleconnectivity.
-	 *
-	 */
-	void computeTeleconnectivity();
+	/// Compute the significance, the regions and the chain, as far as their data are loaded
+	void updateDerived();
+
+	/// Regions are found with the teleconnectivity, the correlations and the autocorrelations
+	bool canFindRegions() const;
 
 	/*! @brief Perform the Student t-test of statistical significance
 	 *
@@ -138,12 +215,13 @@ private:
 	 * @param[in,out] clContours	Collection of contours, on input containing all possible contours,
 	 * 								on output containing the clipped contours
 	 */
-	void clipContours(const MapGrid& clGrid, std::vector< std::vector<QPointF> >& clContours);
+	static void clipContours(const MapGrid& clGrid, std::vector< std::vector<QPointF> >& clContours);
 
 	QPoint refPtIndices;	///< (iLon,iLat) - indices of the reference point cell in the longitude/latitude arrays of the grid
+	bool refPtChosen;	///< the reference point was selected by the user, not taken from the teleconnectivity
 
 	/*!
-	 * A matrix containing all pairwise correlations between points.
+	 * All pairwise correlations between points (mapped from the precomputed file when possible).
 	 * The size of matrix is npoints x npoints, where npoints = nlat*nlon,
 	 * and each individual point is assigned an id = iLat*nlon + iLon.
 	 * (
@@ -155,7 +233,13 @@ private:
 	 * 		id   - point's identifier
 	 * 	)
 	 */
-	std::vector< std::vector<float> > correlations;
+	std::shared_ptr<const CorrelationStore> correlations;
+
+	/*!
+	 * Lags of the lagged correlations, packed like the strictly lower triangle of correlations
+	 * (empty unless loadLags succeeded)
+	 */
+	std::vector< int16_t > lags;
 
 	/*!
 	 *  A vector of correlations of all points to themselves with a lag 1
@@ -183,6 +267,15 @@ private:
 	 */
 	std::vector< std::vector<QPoint> > tcindices;
 
+	/// tc and tcindices were read from a precomputed file
+	bool tcLoaded;
+
+	/// type of the full correlations held by the model, see setInMemoryDataType
+	CorrelationDataType inMemoryType;
+
+	/// level of the statistical significance last requested (0 - none yet)
+	float significanceLevel;
+
 	/// number of regions found in the teleconnectivity map
 	unsigned nRegions;
 
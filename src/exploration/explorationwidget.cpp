@@ -32,6 +32,7 @@ ExplorationWidget::ExplorationWidget(QWidget *parent)
 	: QWidget(parent), pModel(0), pPreferencePane(0), selectionMode(MSM_REFERENCE_POINT)
 {
 	ui.setupUi(this);
+	loadedTitle = windowTitle();
 
 	ui.rbtnRefPoint->setChecked( selectionMode == MSM_REFERENCE_POINT );
 	ui.rbtnRegion->setChecked( selectionMode == MSM_REGION );
@@ -119,6 +120,17 @@ void ExplorationWidget::update() {
 	updateAllViews();
 }
 
+void ExplorationWidget::showLoadingState(const QString& pendingStages) {
+	if (pendingStages.isEmpty()) {
+		setWindowTitle(loadedTitle);
+	}
+	else {
+		setWindowTitle(QString("%1 - loading %2...").arg(loadedTitle, pendingStages));
+	}
+	// the region explorer takes the model as it is when opened
+	ui.btnRegions->setEnabled(pendingStages.isEmpty());
+}
+
 void ExplorationWidget::getGrid(VCGL::MapGrid& grid) {
 	if (pModel != 0) {
 		grid = pModel->getGrid();
@@ -135,6 +147,12 @@ void ExplorationWidget::on_mapCorrelation_getPointValue(const QPointF& point, fl
 	}
 }
 
+void ExplorationWidget::on_mapCorrelation_getPointLag(const QPointF& point, int* pLag, bool* pbOK) {
+	if (pModel != 0) {
+		*pbOK = pModel->getClosestPointLag(point, pLag);
+	}
+}
+
 void ExplorationWidget::on_mapTeleconnectivity_getPointValue(const QPointF& point, float* pValue, bool* pbOK) {
 	if (pModel != 0) {
 		*pbOK = pModel->getClosestPointTeleconnectivityValue(point, pValue);
@@ -172,7 +190,10 @@ void ExplorationWidget::on_mapCorrelation_updateMapRequest(VCGL::MapSubview* pMa
 		pModel->getSelectionMask(selectionMask);
 		pModel->getCorrelationMapColors(colorData);
 
-		pMap->drawColor(&preferences.correlationViewTF, colorData, grid, selectionMask);
+		// empty while the correlations are loading
+		if (!colorData.empty()) {
+			pMap->drawColor(&preferences.correlationViewTF, colorData, grid, selectionMask);
+		}
 		pMap->drawLandContours(grid, pModel->getContours());
 
 		pMap->drawGrid(grid);
@@ -246,7 +267,9 @@ void ExplorationWidget::on_mapTeleconnectivity_updateMapRequest(VCGL::MapSubview
 			}
 		}
 
-		pMap->drawColor(&preferences.teleconnectivityViewTF, colorData, grid, selectionMask);
+		if (!colorData.empty()) {
+			pMap->drawColor(&preferences.teleconnectivityViewTF, colorData, grid, selectionMask);
+		}
 
 		pMap->drawLandContours(grid, pModel->getContours());
 
@@ -305,7 +328,7 @@ void ExplorationWidget::on_wProjection_updateProjectionRequest(VCGL::ProjectionV
 
 		const float pxRatio = devicePixelRatio();
 
-		if (projectionData.size() > 0) {
+		if (projectionData.size() > 0 && colorData.size() > 0) {
 			pProjectionView->drawProjection(projectionData,
 					colorData,
 					selectionMask,
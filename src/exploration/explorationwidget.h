@@ -47,9 +47,6 @@ public:
     /// Assign a model (object containing application data and algorithms)
     void setModel(VCGL::ExplorationModel* pModel);
 
-    /// Request the controller to update all of its views
-    void updateAllViews();
-
 	void update();
 
 protected slots:
@@ -70,6 +67,9 @@ protected slots:
 	 */
 	void on_mapCorrelation_getPointValue(const QPointF& point, float* pValue, bool* pbOK);
 
+	/// Get lag of the correlation with the reference point for the specified point
+	void on_mapCorrelation_getPointLag(const QPointF& point, int* pLag, bool* pbOK);
+
 	/// Get teleconnectivity value for the specified point
 	void on_mapTeleconnectivity_getPointValue(const QPointF& point, float* pValue, bool* pbOK);
 
@@ -142,6 +142,13 @@ protected slots:
 public slots:
 	/// show this widget
 	void show();
+	/// Request the controller to update all of its views
+	void updateAllViews();
+	/*! @brief Show which data the model is still loading
+	 *
+	 * @param pendingStages Names of the data not yet loaded (empty - all loaded)
+	 */
+	void showLoadingState(const QString& pendingStages);
 protected:
 	/// process keyboard event
 	void keyPressEvent ( QKeyEvent * event ) override;
@@ -175,6 +182,7 @@ private:
     VCGL::ExplorationModel* pModel;	///< MVC-model for the aplication
     PreferencePane* pPreferencePane; ///< Dialog for modifying the preferences
 	MouseSelectionMode selectionMode; ///< Mode of selecting (refPoint, region, ...)
+	QString loadedTitle; ///< Window title once all data are loaded
 };
 
 #endif // EXPLORATIONWIDGET_H
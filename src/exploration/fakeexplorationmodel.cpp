@@ -49,6 +49,7 @@ void FakeExplorationModel::loadGrid(const std::string& /*fileName*/){
 void FakeExplorationModel::loadContours(const std::string& /*contoursFileName*/){ }
 
 void FakeExplorationModel::loadCorrelations(const std::string& /*correlationsFileName*/){ }
+bool FakeExplorationModel::loadTeleconnectivity(const std::string& /*teleconnectivityFileName*/){ return false; }
 
 void FakeExplorationModel::loadAutocorrelations(const std::string& /*autocorrFileName*/){ }
 
@@ -28,6 +28,8 @@ public:
 	virtual void loadContours(const std::string& contoursFileName) override;
 	/// @copydoc ExplorationModel::loadCorrelations
 	virtual void loadCorrelations(const std::string& correlationsFileName) override;
+	/// @copydoc ExplorationModel::loadTeleconnectivity
+	virtual bool loadTeleconnectivity(const std::string& teleconnectivityFileName) override;
 	/// @copydoc ExplorationModel::loadAutocorrelations
 	virtual void loadAutocorrelations(const std::string& autocorrFileName) override;
 	/// @copydoc ExplorationModel::loadProjection
@@ -39,7 +39,10 @@ float MapGrid::lonRange() const {
 
 bool MapGrid::loopedLon() const {
 	unsigned nlon = lons.size();
-	assert(nlon > 2);
+	if (nlon < 3) {
+		// e.g. a small region of the grid
+		return false;
+	}
 
 	float lonFullRange = 360.0;
 	float dx = lons[1]-lons[0]; // change in a grid step
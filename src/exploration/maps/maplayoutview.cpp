@@ -234,6 +234,12 @@ void MapLayoutView::mousePressEvent(QMouseEvent *event)
 			 if (bOK) {
 				 message.append( QString(", value=%1").arg(QString::number(value, 'f', 2)) );
 			 }
+			 bool bLagOK = false;
+			 int lag = 0;
+			 emit getPointLag(point, &lag, &bLagOK);
+			 if (bLagOK) {
+				 message.append( QString(", lag=%1").arg(lag) );
+			 }
 			QToolTip::showText( mapToGlobal(event->pos()), message );
 		 }
 		 else {
@@ -51,6 +51,9 @@ signals:
 	/// Request the data value at the given coordinate
 	void getPointValue(const QPointF& point, float* pValue, bool* pbOK);
 
+	/// Request the lag of the correlation at the given coordinate
+	void getPointLag(const QPointF& point, int* pLag, bool* pbOK);
+
 	/// Request selection of the point at the given coordinates
 	void selectPoint(const QPointF& point);
 
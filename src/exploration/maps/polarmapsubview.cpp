@@ -54,6 +54,10 @@ bool PolarMapSubview::getPointCoordinates(const MapGrid& grid,
 
 				float latPos = r/rmax;
 				float lonValueEst = phi * 180.0 * M_1_PI;
+				if (lonValueEst < grid.lonMin()) {
+					// regions across the seam have longitudes past 360
+					lonValueEst += 360.0;
+				}
 				float latValueEst = latCenter - latPos * (latCenter-latMin);
 
 				if (lonValueEst >= grid.lonMin() && lonValueEst <= grid.lonMax()
@@ -0,0 +1,77 @@
+/*!	@file alignedbuffer.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Fixed-size heap buffer aligned for vector loads
+ */
+
+#ifndef ALIGNEDBUFFER_H_
+#define ALIGNEDBUFFER_H_
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace VCGL {
+
+/*! @brief Heap array of trivially copyable values, aligned to ALIGNMENT bytes.
+ *
+ * Contents are zero-initialized, so that padding past the logical
+ * end of a row can be read by vector kernels without a tail loop.
+ */
+template<typename T>
+class AlignedBuffer {
+public:
+	static const std::size_t ALIGNMENT = 64; ///< cache line, also enough for AVX-512 loads
+
+	AlignedBuffer(): ptr(0), count(0) {}
+	explicit AlignedBuffer(std::size_t size): ptr(0), count(0) { resize(size); }
+	~AlignedBuffer() { std::free(ptr); }
+
+	AlignedBuffer(AlignedBuffer&& other): ptr(other.ptr), count(other.count) {
+		other.ptr = 0;
+		other.count = 0;
+	}
+	AlignedBuffer& operator=(AlignedBuffer&& other) {
+		if (this != &other) {
+			std::free(ptr);
+			ptr = other.ptr;
+			count = other.count;
+			other.ptr = 0;
+			other.count = 0;
+		}
+		return *this;
+	}
+
+	/// Reallocate for the given number of elements; old contents are discarded
+	void resize(std::size_t size) {
+		std::free(ptr);
+		ptr = 0;
+		count = 0;
+		if (size > 0) {
+			void* p = 0;
+			if (posix_memalign(&p, ALIGNMENT, size*sizeof(T)) != 0) {
+				throw std::bad_alloc();
+			}
+			std::memset(p, 0, size*sizeof(T));
+			ptr = static_cast<T*>(p);
+			count = size;
+		}
+	}
+
+	std::size_t size() const { return count; }
+	T* data() { return ptr; }
+	const T* data() const { return ptr; }
+	T& operator[](std::size_t i) { return ptr[i]; }
+	const T& operator[](std::size_t i) const { return ptr[i]; }
+
+private:
+	AlignedBuffer(const AlignedBuffer&);
+	AlignedBuffer& operator=(const AlignedBuffer&);
+
+	T* ptr;
+	std::size_t count;
+};
+
+} // namespace VCGL
+
+#endif // ALIGNEDBUFFER_H_
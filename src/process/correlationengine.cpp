@@ -0,0 +1,368 @@
+/*!	@file correlationengine.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Blocked computation of Pearson correlations on standardized time series
+ */
+
+#include "correlationengine.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TELCON_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace VCGL {
+
+StandardizedSeries::StandardizedSeries()
+: npoints(0), ntime(0), rowStride(0) {}
+
+void StandardizedSeries::assign(const TimeSeriesField& data, const std::vector< std::vector<bool> >& validityMask) {
+	const std::size_t nlon = data.nlon();
+
+	npoints = data.pointCount();
+	ntime = data.timeCount();
+	rowStride = (ntime + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+	values.resize(npoints * rowStride);
+	gapOffsets.clear();
+	gapSteps.clear();
+	gapped.clear();
+
+	std::vector<std::uint32_t> missing;
+	for (std::size_t pt = 0; pt<npoints; pt++) {
+		const std::size_t ptLat = pt / nlon;
+		const std::size_t ptLon = pt % nlon;
+		if (!validityMask[ptLat][ptLon]) {
+			continue; // stays a zero row
+		}
+
+		SeriesSpan<const float> ts = data.series(pt);
+		missing.clear();
+		double sum = 0.0;
+		for (std::size_t t=0; t<ntime; t++) {
+			if (std::isnan(ts[t])) {
+				missing.push_back(static_cast<std::uint32_t>(t));
+			}
+			else {
+				sum += ts[t];
+			}
+		}
+		const std::size_t validCount = ntime - missing.size();
+		if (validCount < 2) {
+			continue; // correlation undefined
+		}
+		const double average = sum / validCount;
+
+		double sumSq = 0.0;
+		for (std::size_t t=0; t<ntime; t++) {
+			if (!std::isnan(ts[t])) {
+				const double d = ts[t] - average;
+				sumSq += d*d;
+			}
+		}
+		if (sumSq <= 0.0) {
+			continue; // constant series, correlation undefined
+		}
+
+		const double scale = 1.0 / std::sqrt(sumSq);
+		float* dst = values.data() + pt*rowStride;
+		for (std::size_t t=0; t<ntime; t++) {
+			dst[t] = std::isnan(ts[t]) ? 0.0f : static_cast<float>((ts[t] - average) * scale);
+		}
+
+		if (!missing.empty()) {
+			if (gapOffsets.empty()) {
+				gapOffsets.assign(npoints+1, 0);
+			}
+			gapOffsets[pt+1] = missing.size();
+			gapSteps.insert(gapSteps.end(), missing.begin(), missing.end());
+			gapped.push_back(pt);
+		}
+	}
+	for (std::size_t pt = 1; pt<gapOffsets.size(); pt++) {
+		gapOffsets[pt] += gapOffsets[pt-1];
+	}
+}
+
+float StandardizedSeries::pairwiseComplete(std::size_t x, std::size_t y, float dot) const {
+	const float* rx = row(x);
+	const float* ry = row(y);
+	const std::uint32_t* gx = gapSteps.data() + gapOffsets[x];
+	const std::uint32_t* gxEnd = gapSteps.data() + gapOffsets[x+1];
+	const std::uint32_t* gy = gapSteps.data() + gapOffsets[y];
+	const std::uint32_t* gyEnd = gapSteps.data() + gapOffsets[y+1];
+
+	// rows are zero at their own gaps, sum to 0 and have unit norm over their valid steps:
+	// remove the steps where the other series is missing
+	double sumX = 0.0, sumSqX = 1.0;
+	for (const std::uint32_t* g = gy; g<gyEnd; g++) {
+		sumX -= rx[*g];
+		sumSqX -= static_cast<double>(rx[*g])*rx[*g];
+	}
+	double sumY = 0.0, sumSqY = 1.0;
+	for (const std::uint32_t* g = gx; g<gxEnd; g++) {
+		sumY -= ry[*g];
+		sumSqY -= static_cast<double>(ry[*g])*ry[*g];
+	}
+
+	// number of steps missing in either series
+	std::size_t shared = 0;
+	while (gx<gxEnd && gy<gyEnd) {
+		if (*gx < *gy) { gx++; }
+		else if (*gy < *gx) { gy++; }
+		else { shared++; gx++; gy++; }
+	}
+	const double n = static_cast<double>(ntime) - (gapOffsets[x+1]-gapOffsets[x]) - (gapOffsets[y+1]-gapOffsets[y]) + shared;
+	if (n < 2.0) {
+		return 0.0f;
+	}
+
+	const double varX = n*sumSqX - sumX*sumX;
+	const double varY = n*sumSqY - sumY*sumY;
+	if (varX <= 0.0 || varY <= 0.0) {
+		return 0.0f;
+	}
+	return static_cast<float>((n*dot - sumX*sumY) / std::sqrt(varX*varY));
+}
+
+namespace {
+
+	float dotScalar(const float* x, const float* y, std::size_t n) {
+		float sum = 0.0f;
+		for (std::size_t t=0; t<n; t++) {
+			sum += x[t]*y[t];
+		}
+		return sum;
+	}
+
+	void dot4Scalar(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+			std::size_t n, float* out) {
+		float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+		for (std::size_t t=0; t<n; t++) {
+			const float xt = x[t];
+			s0 += xt*y0[t];
+			s1 += xt*y1[t];
+			s2 += xt*y2[t];
+			s3 += xt*y3[t];
+		}
+		out[0] = s0;
+		out[1] = s1;
+		out[2] = s2;
+		out[3] = s3;
+	}
+
+	const CorrelationKernel scalarKernel = { "scalar", dotScalar, dot4Scalar };
+
+#ifdef TELCON_X86_KERNELS
+
+	__attribute__((target("avx2,fma")))
+	inline float hsum256(__m256 v) {
+		__m128 lo = _mm256_castps256_ps128(v);
+		__m128 hi = _mm256_extractf128_ps(v, 1);
+		lo = _mm_add_ps(lo, hi);
+		__m128 shuf = _mm_movehdup_ps(lo);
+		__m128 sums = _mm_add_ps(lo, shuf);
+		shuf = _mm_movehl_ps(shuf, sums);
+		sums = _mm_add_ss(sums, shuf);
+		return _mm_cvtss_f32(sums);
+	}
+
+	__attribute__((target("avx2,fma")))
+	float dotAVX2(const float* x, const float* y, std::size_t n) {
+		__m256 acc = _mm256_setzero_ps();
+		for (std::size_t t=0; t<n; t+=8) {
+			acc = _mm256_fmadd_ps(_mm256_load_ps(x+t), _mm256_load_ps(y+t), acc);
+		}
+		return hsum256(acc);
+	}
+
+	__attribute__((target("avx2,fma")))
+	void dot4AVX2(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+			std::size_t n, float* out) {
+		__m256 a0 = _mm256_setzero_ps();
+		__m256 a1 = _mm256_setzero_ps();
+		__m256 a2 = _mm256_setzero_ps();
+		__m256 a3 = _mm256_setzero_ps();
+		for (std::size_t t=0; t<n; t+=8) {
+			const __m256 xt = _mm256_load_ps(x+t);
+			a0 = _mm256_fmadd_ps(xt, _mm256_load_ps(y0+t), a0);
+			a1 = _mm256_fmadd_ps(xt, _mm256_load_ps(y1+t), a1);
+			a2 = _mm256_fmadd_ps(xt, _mm256_load_ps(y2+t), a2);
+			a3 = _mm256_fmadd_ps(xt, _mm256_load_ps(y3+t), a3);
+		}
+		out[0] = hsum256(a0);
+		out[1] = hsum256(a1);
+		out[2] = hsum256(a2);
+		out[3] = hsum256(a3);
+	}
+
+	const CorrelationKernel avx2Kernel = { "avx2", dotAVX2, dot4AVX2 };
+
+	__attribute__((target("avx512f")))
+	inline float hsum512(__m512 v) {
+		// the 512->256 bit casts trip -Wuninitialized in some GCC headers, go through memory
+		alignas(64) float lanes[16];
+		_mm512_store_ps(lanes, v);
+		return hsum256(_mm256_add_ps(_mm256_load_ps(lanes), _mm256_load_ps(lanes+8)));
+	}
+
+	__attribute__((target("avx512f")))
+	float dotAVX512(const float* x, const float* y, std::size_t n) {
+		__m512 acc = _mm512_setzero_ps();
+		for (std::size_t t=0; t<n; t+=16) {
+			acc = _mm512_fmadd_ps(_mm512_load_ps(x+t), _mm512_load_ps(y+t), acc);
+		}
+		return hsum512(acc);
+	}
+
+	__attribute__((target("avx512f")))
+	void dot4AVX512(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+			std::size_t n, float* out) {
+		__m512 a0 = _mm512_setzero_ps();
+		__m512 a1 = _mm512_setzero_ps();
+		__m512 a2 = _mm512_setzero_ps();
+		__m512 a3 = _mm512_setzero_ps();
+		for (std::size_t t=0; t<n; t+=16) {
+			const __m512 xt = _mm512_load_ps(x+t);
+			a0 = _mm512_fmadd_ps(xt, _mm512_load_ps(y0+t), a0);
+			a1 = _mm512_fmadd_ps(xt, _mm512_load_ps(y1+t), a1);
+			a2 = _mm512_fmadd_ps(xt, _mm512_load_ps(y2+t), a2);
+			a3 = _mm512_fmadd_ps(xt, _mm512_load_ps(y3+t), a3);
+		}
+		out[0] = hsum512(a0);
+		out[1] = hsum512(a1);
+		out[2] = hsum512(a2);
+		out[3] = hsum512(a3);
+	}
+
+	const CorrelationKernel avx512Kernel = { "avx512", dotAVX512, dot4AVX512 };
+
+#endif // TELCON_X86_KERNELS
+
+	/// L2 budget for the column rows of one tile
+	const std::size_t TILE_CACHE_BYTES = 256*1024;
+	const std::size_t MIN_TILE = 8;
+	const std::size_t MAX_TILE = 512;
+}
+
+unsigned long long TriangleTile::pairCount() const {
+	unsigned long long count = 0;
+	for (std::size_t x = rowBegin; x<rowEnd; x++) {
+		const std::size_t yEnd = std::min(colEnd, x);
+		if (yEnd > colBegin) {
+			count += yEnd - colBegin;
+		}
+	}
+	return count;
+}
+
+std::vector<TriangleTile> makeTriangleTiles(std::size_t npoints, std::size_t tileSize) {
+	return makeTriangleTiles(0, npoints, tileSize);
+}
+
+std::vector<TriangleTile> makeTriangleTiles(std::size_t firstRow, std::size_t lastRow, std::size_t tileSize) {
+	std::vector<TriangleTile> tiles;
+	std::vector<TriangleTile> diagonalTiles;
+	for (std::size_t rowBegin = firstRow; rowBegin<lastRow; rowBegin+=tileSize) {
+		const std::size_t rowEnd = std::min(lastRow, rowBegin+tileSize);
+		for (std::size_t colBegin = 0; colBegin<rowEnd; colBegin+=tileSize) {
+			const std::size_t colEnd = std::min(rowEnd, colBegin+tileSize);
+			const TriangleTile tile = { rowBegin, rowEnd, colBegin, colEnd };
+			if (colEnd > rowBegin) { // crosses the diagonal
+				diagonalTiles.push_back(tile);
+			}
+			else {
+				tiles.push_back(tile);
+			}
+		}
+	}
+	// the last row of tiles may be shorter, keep the order by cost stable
+	std::stable_sort(tiles.begin(), tiles.end(), [](const TriangleTile& a, const TriangleTile& b) {
+		return a.pairCount() > b.pairCount();
+	});
+	std::stable_sort(diagonalTiles.begin(), diagonalTiles.end(), [](const TriangleTile& a, const TriangleTile& b) {
+		return a.pairCount() > b.pairCount();
+	});
+	tiles.insert(tiles.end(), diagonalTiles.begin(), diagonalTiles.end());
+	return tiles;
+}
+
+CorrelationEngine::CorrelationEngine(const StandardizedSeries& series)
+: series(series), pKernel(&selectKernel()), tile(MIN_TILE) {
+	const std::size_t rowBytes = std::max<std::size_t>(series.stride(), 1) * sizeof(float);
+	tile = std::min(MAX_TILE, std::max(MIN_TILE, TILE_CACHE_BYTES / rowBytes));
+}
+
+void CorrelationEngine::computeTile(std::size_t rowBegin, std::size_t rowEnd,
+		std::size_t colBegin, std::size_t colEnd,
+		float* out, std::size_t outStride) const {
+	const std::size_t n = series.stride();
+	const CorrelationKernel& k = *pKernel;
+	const std::vector<std::size_t>& gapped = series.gappedPoints();
+
+	for (std::size_t x = rowBegin; x<rowEnd; x++) {
+		const float* rx = series.row(x);
+		float* dst = out + (x-rowBegin)*outStride - colBegin;
+		const std::size_t yEnd = std::min(colEnd, x);
+
+		std::size_t y = colBegin;
+		for (; y+4 <= yEnd; y+=4) {
+			k.dot4(rx, series.row(y), series.row(y+1), series.row(y+2), series.row(y+3), n, dst+y);
+		}
+		for (; y<yEnd; y++) {
+			dst[y] = k.dot(rx, series.row(y), n);
+		}
+
+		if (gapped.empty() || colBegin >= yEnd) {
+			continue;
+		}
+		if (series.hasGaps(x)) {
+			for (y = colBegin; y<yEnd; y++) {
+				dst[y] = series.pairwiseComplete(x, y, dst[y]);
+			}
+		}
+		else {
+			std::vector<std::size_t>::const_iterator it = std::lower_bound(gapped.begin(), gapped.end(), colBegin);
+			for (; it != gapped.end() && *it < yEnd; ++it) {
+				dst[*it] = series.pairwiseComplete(x, *it, dst[*it]);
+			}
+		}
+	}
+}
+
+std::vector<const CorrelationKernel*> CorrelationEngine::availableKernels() {
+	std::vector<const CorrelationKernel*> kernels;
+	kernels.push_back(&scalarKernel);
+#ifdef TELCON_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		kernels.push_back(&avx2Kernel);
+	}
+	if (__builtin_cpu_supports("avx512f")) {
+		kernels.push_back(&avx512Kernel);
+	}
+#endif
+	return kernels;
+}
+
+const CorrelationKernel& CorrelationEngine::selectKernel() {
+	std::vector<const CorrelationKernel*> kernels = availableKernels();
+	const CorrelationKernel* pSelected = kernels.back();
+
+	const char* requested = getenv("TELCON_KERNEL");
+	if (requested) {
+		for (unsigned j=0; j<kernels.size(); j++) {
+			if (0 == strcmp(kernels[j]->name, requested)) {
+				pSelected = kernels[j];
+			}
+		}
+	}
+	return *pSelected;
+}
+
+} // namespace VCGL
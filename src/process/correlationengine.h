@@ -0,0 +1,170 @@
+/*!	@file correlationengine.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Blocked computation of Pearson correlations on standardized time series
+ */
+
+#ifndef CORRELATIONENGINE_H_
+#define CORRELATIONENGINE_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "typedefs.h"
+#include "alignedbuffer.h"
+#include "timeseriesfield.h"
+
+namespace VCGL {
+
+/*! @brief Time series of all grid points, standardized once and stored as a point-by-time matrix.
+ *
+ * Each valid series is shifted to zero mean and scaled to unit norm, so that the
+ * Pearson coefficient of two points is the plain dot product of their rows.
+ * Rows are padded with zeros to a multiple of ROW_ALIGNMENT values and start
+ * on a cache line boundary. Invalid points (and constant series) are stored as
+ * zero rows and thus get zero correlation with every other point.
+ *
+ * Missing values (NaN) are allowed: such a series is standardized over its
+ * valid time steps and stored with zeros at the gaps, and the time steps of
+ * the gaps are kept in a sparse list. The dot product of two rows then sums
+ * over the steps valid in both, and pairwiseComplete() turns it into the
+ * Pearson coefficient over exactly these steps at a cost proportional to the
+ * number of gaps, so sparse gaps keep the speed of the dense path.
+ */
+class StandardizedSeries {
+public:
+	static const std::size_t ROW_ALIGNMENT = 16; ///< row length granularity, in floats (one AVX-512 register)
+
+	StandardizedSeries();
+
+	/*! @brief Standardize the given data
+	 *
+	 * @param data 3D data array, indices LAT, LON, TIME
+	 * @param validityMask flags for the points to be used, indices LAT, LON
+	 */
+	void assign(const TimeSeriesField& data, const std::vector< std::vector<bool> >& validityMask);
+
+	/// Number of grid points (rows)
+	std::size_t pointCount() const { return npoints; }
+	/// Number of time steps in each series
+	std::size_t timeCount() const { return ntime; }
+	/// Distance between consecutive rows, in floats (multiple of ROW_ALIGNMENT)
+	std::size_t stride() const { return rowStride; }
+	/// Standardized series of the point with id = iLat*nlon + iLon
+	const float* row(std::size_t pt) const { return values.data() + pt*rowStride; }
+
+	/// Whether the series of the point has missing time steps
+	bool hasGaps(std::size_t pt) const { return gapOffsets.size() > 0 && gapOffsets[pt+1] > gapOffsets[pt]; }
+	/// Ids of the points with missing time steps, in increasing order
+	const std::vector<std::size_t>& gappedPoints() const { return gapped; }
+
+	/*! @brief Pearson coefficient of points x and y over the time steps valid in both
+	 *
+	 * @param dot Dot product of the rows of x and y
+	 * @return 0 if fewer than two common steps remain or either series is constant on them
+	 */
+	float pairwiseComplete(std::size_t x, std::size_t y, float dot) const;
+
+private:
+	std::size_t npoints;
+	std::size_t ntime;
+	std::size_t rowStride;
+	AlignedBuffer<float> values;
+	std::vector<std::size_t> gapOffsets;	///< gaps of point pt are gapSteps[gapOffsets[pt]..gapOffsets[pt+1]), empty without gaps
+	std::vector<std::uint32_t> gapSteps;	///< missing time steps, increasing within each point
+	std::vector<std::size_t> gapped;
+};
+
+/*! @brief Set of dot product routines for one instruction set.
+ *
+ * All routines accumulate every dot product in the same order,
+ * so dot() and dot4() give bit-identical values for the same pair of rows.
+ */
+struct CorrelationKernel {
+	const char* name; ///< instruction set name: "scalar", "avx2", "avx512"
+
+	/// dot product of two rows of length n (n is a multiple of StandardizedSeries::ROW_ALIGNMENT)
+	float (*dot)(const float* x, const float* y, std::size_t n);
+
+	/// four dot products of x with y0..y3, results in out[0..3]
+	void (*dot4)(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+			std::size_t n, float* out);
+};
+
+/*! @brief Rectangular piece of the lower triangle of a correlation matrix
+ *
+ * Covers rows [rowBegin, rowEnd) and columns [colBegin, colEnd),
+ * of which only the entries with column < row belong to the triangle.
+ */
+struct TriangleTile {
+	std::size_t rowBegin;
+	std::size_t rowEnd;
+	std::size_t colBegin;
+	std::size_t colEnd;
+
+	/// Number of pairs (column < row) in this tile
+	unsigned long long pairCount() const;
+};
+
+/*! @brief Split the lower triangle of an npoints x npoints matrix into tiles
+ *
+ * @param npoints Number of points
+ * @param tileSize Number of rows and columns of a full tile
+ * @return Tiles ordered from the most to the least expensive
+ * 			(full tiles first, then the ones on the diagonal)
+ */
+std::vector<TriangleTile> makeTriangleTiles(std::size_t npoints, std::size_t tileSize);
+
+/*! @brief Split rows [firstRow, lastRow) of the lower triangle into tiles
+ *
+ * Same as makeTriangleTiles(npoints, tileSize) restricted to a block of rows;
+ * row boundaries of the tiles are counted from firstRow.
+ */
+std::vector<TriangleTile> makeTriangleTiles(std::size_t firstRow, std::size_t lastRow, std::size_t tileSize);
+
+/*! @brief Computes correlations of all pairs of standardized series in cache-sized tiles.
+ *
+ * Only the lower triangle (column < row) is computed, the rest follows from symmetry.
+ * Pairs involving a series with missing values are corrected to the pairwise-complete
+ * coefficient (see StandardizedSeries::pairwiseComplete).
+ * The kernel is picked at runtime from the instruction sets supported by the CPU;
+ * environment variable TELCON_KERNEL=scalar|avx2|avx512 restricts the choice.
+ */
+class CorrelationEngine {
+public:
+	explicit CorrelationEngine(const StandardizedSeries& series);
+
+	/// Use the specified kernel instead of the automatically selected one
+	void useKernel(const CorrelationKernel& kernel) { pKernel = &kernel; }
+	/// Currently used kernel
+	const CorrelationKernel& kernel() const { return *pKernel; }
+
+	/// Number of rows (and columns) per tile, chosen so that a tile of rows stays in L2 cache
+	std::size_t tileSize() const { return tile; }
+
+	/*! @brief Compute correlations of one tile of the lower triangle
+	 *
+	 * For every row x in [rowBegin, rowEnd) and column y in [colBegin, min(colEnd, x)),
+	 * the value is written to out[(x-rowBegin)*outStride + (y-colBegin)].
+	 * Other entries of out are not touched.
+	 */
+	void computeTile(std::size_t rowBegin, std::size_t rowEnd,
+			std::size_t colBegin, std::size_t colEnd,
+			float* out, std::size_t outStride) const;
+
+	/// Best kernel supported by this CPU (respecting TELCON_KERNEL)
+	static const CorrelationKernel& selectKernel();
+
+	/// All kernels supported by this CPU, from the simplest to the widest
+	static std::vector<const CorrelationKernel*> availableKernels();
+
+private:
+	const StandardizedSeries& series;
+	const CorrelationKernel* pKernel;
+	std::size_t tile;
+};
+
+} // namespace VCGL
+
+#endif // CORRELATIONENGINE_H_
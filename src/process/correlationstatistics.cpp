@@ -0,0 +1,213 @@
+/*!	@file correlationstatistics.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Sufficient statistics of the correlations, updatable with new time steps
+ */
+
+#include "correlationstatistics.h"
+#include "precompute.h"
+#include "threadpool.h"
+#include "progressbar.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+namespace VCGL {
+
+namespace {
+	/// Rows of the pair sums per task
+	const std::size_t ROW_CHUNK = 64;
+
+	/// Centered sum of squares, <= 0 for a constant series
+	inline double centeredSumSq(const PointStatistics& p, std::size_t n) {
+		return p.sumSq - p.sum*p.sum/n;
+	}
+}
+
+CorrelationStatistics::CorrelationStatistics()
+: latCount(0), lonCount(0), samples(0), products(0.0) {
+}
+
+void CorrelationStatistics::accumulate(const TimeSeriesField& data,
+		const std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount) {
+	const std::size_t nlat = data.nlat();
+	const std::size_t nlon = data.nlon();
+	const std::size_t npoints = data.pointCount();
+	const std::size_t ntime = data.timeCount();
+	if (npoints == 0 || ntime == 0) {
+		return;
+	}
+
+	const bool bFirst = (samples == 0);
+	if (bFirst) {
+		latCount = nlat;
+		lonCount = nlon;
+		points.assign(npoints, PointStatistics());
+		valid.assign(npoints, 1);
+		products = SymmetricMatrix<double>(npoints, 0.0, 0.0);
+	}
+	assert(nlat == latCount && nlon == lonCount);
+
+	// centered new values, zero rows for invalid points
+	std::vector<double> deviations(npoints*ntime, 0.0);
+	for (std::size_t pt = 0; pt<npoints; pt++) {
+		SeriesSpan<const float> ts = data.series(pt);
+		PointStatistics& p = points[pt];
+		if (!validityMask[pt / nlon][pt % nlon]) {
+			valid[pt] = 0;
+		}
+		if (!valid[pt]) {
+			continue;
+		}
+
+		if (bFirst) {
+			double sum = 0.0;
+			for (std::size_t t = 0; t<ntime; t++) {
+				sum += ts[t];
+			}
+			p.center = sum / ntime;
+			p.first = ts[0] - p.center;
+		}
+		else {
+			p.sumLag += p.last * (ts[0] - p.center);
+		}
+
+		double* dev = &deviations[pt*ntime];
+		for (std::size_t t = 0; t<ntime; t++) {
+			dev[t] = ts[t] - p.center;
+			p.sum += dev[t];
+			p.sumSq += dev[t]*dev[t];
+		}
+		for (std::size_t t = 0; t+1<ntime; t++) {
+			p.sumLag += dev[t]*dev[t+1];
+		}
+		p.last = dev[ntime-1];
+	}
+
+	// pair sums: the only part quadratic in the number of points, linear in the new steps
+	ThreadPool pool(threadCount);
+	const std::size_t chunkCount = (npoints + ROW_CHUNK - 1) / ROW_CHUNK;
+	ProgressReporter progress(static_cast<unsigned long long>(npoints)*(npoints-1)/2);
+	// the last chunks have the longest rows, start with them
+	pool.parallelFor(chunkCount, [&](std::size_t task) {
+		const std::size_t chunk = chunkCount - 1 - task;
+		const std::size_t rowEnd = std::min(npoints, (chunk+1)*ROW_CHUNK);
+		unsigned long long pairs = 0;
+		for (std::size_t x = chunk*ROW_CHUNK; x<rowEnd; x++) {
+			if (!valid[x]) {
+				continue;
+			}
+			const double* dx = &deviations[x*ntime];
+			double* row = products.triangleRow(x);
+			for (std::size_t y = 0; y<x; y++) {
+				const double* dy = &deviations[y*ntime];
+				double s = 0.0;
+				for (std::size_t t = 0; t<ntime; t++) {
+					s += dx[t]*dy[t];
+				}
+				row[y] += s;
+			}
+			pairs += x;
+		}
+		progress.advance(pairs);
+	});
+	progress.finish();
+
+	samples += ntime;
+}
+
+float CorrelationStatistics::correlation(std::size_t i, std::size_t j) const {
+	if (i == j) {
+		return 1.0f;
+	}
+	if (!valid[i] || !valid[j]) {
+		return 0.0f;
+	}
+	const PointStatistics& a = points[i];
+	const PointStatistics& b = points[j];
+	const double varA = centeredSumSq(a, samples);
+	const double varB = centeredSumSq(b, samples);
+	if (varA <= 0.0 || varB <= 0.0) {
+		return 0.0f;
+	}
+	const double cov = products(i, j) - a.sum*b.sum/samples;
+	return static_cast<float>(cov / std::sqrt(varA*varB));
+}
+
+void CorrelationStatistics::emitCorrelations(std::size_t blockRows, unsigned threadCount,
+		CorrelationRowConsumer& consumer) const {
+	const std::size_t npoints = pointCount();
+	blockRows = std::max<std::size_t>(blockRows, 1);
+
+	// 1/sqrt of the centered sums of squares, 0 where the correlation is undefined
+	std::vector<double> scale(npoints, 0.0);
+	for (std::size_t pt = 0; pt<npoints; pt++) {
+		const double var = centeredSumSq(points[pt], samples);
+		if (valid[pt] && var > 0.0) {
+			scale[pt] = 1.0 / std::sqrt(var);
+		}
+	}
+
+	ThreadPool pool(threadCount);
+	std::vector<float> block;
+	for (std::size_t blockBegin = 0; blockBegin<npoints; blockBegin+=blockRows) {
+		const std::size_t blockEnd = std::min(npoints, blockBegin+blockRows);
+		const std::size_t blockOffset = triangleOffset(blockBegin);
+		block.resize(triangleOffset(blockEnd) - blockOffset);
+
+		pool.parallelFor(blockEnd-blockBegin, [&](std::size_t r) {
+			const std::size_t x = blockBegin + r;
+			const double* sums = products.triangleRow(x);
+			float* out = &block[triangleOffset(x) - blockOffset];
+			const double meanX = points[x].sum / samples;
+			for (std::size_t y = 0; y<x; y++) {
+				const double cov = sums[y] - meanX*points[y].sum;
+				out[y] = static_cast<float>(cov * scale[x] * scale[y]);
+			}
+		});
+		consumer.consumeRows(blockBegin, blockEnd, block.data());
+	}
+}
+
+void CorrelationStatistics::autocorrelations(std::vector<float>& result) const {
+	const std::size_t npoints = pointCount();
+	result.assign(npoints, 0.0f);
+	if (samples < 2) {
+		return;
+	}
+
+	// x = steps 0..n-2, y = steps 1..n-1
+	const double m = samples - 1;
+	for (std::size_t pt = 0; pt<npoints; pt++) {
+		if (!valid[pt]) {
+			continue;
+		}
+		const PointStatistics& p = points[pt];
+		const double sumX = p.sum - p.last;
+		const double sumY = p.sum - p.first;
+		const double nom = p.sumLag - sumX*sumY/m;
+		const double denomX = (p.sumSq - p.last*p.last) - sumX*sumX/m;
+		const double denomY = (p.sumSq - p.first*p.first) - sumY*sumY/m;
+		if (denomX <= 0.0 || denomY <= 0.0) {
+			continue;
+		}
+		result[pt] = static_cast<float>(nom / std::sqrt(denomX*denomY));
+	}
+}
+
+void CorrelationStatistics::assign(std::size_t nlat, std::size_t nlon, std::size_t sampleCount,
+		std::vector<PointStatistics>&& pointStatistics,
+		std::vector<std::uint8_t>&& validity,
+		SymmetricMatrix<double>&& pairSums) {
+	assert(pointStatistics.size() == nlat*nlon && validity.size() == nlat*nlon && pairSums.size() == nlat*nlon);
+	latCount = nlat;
+	lonCount = nlon;
+	samples = sampleCount;
+	points = std::move(pointStatistics);
+	valid = std::move(validity);
+	products = std::move(pairSums);
+}
+
+} // namespace VCGL
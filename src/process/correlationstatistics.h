@@ -0,0 +1,99 @@
+/*!	@file correlationstatistics.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Sufficient statistics of the correlations, updatable with new time steps
+ */
+
+#ifndef CORRELATIONSTATISTICS_H_
+#define CORRELATIONSTATISTICS_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "typedefs.h"
+#include "symmetricmatrix.h"
+#include "timeseriesfield.h"
+
+namespace VCGL {
+
+struct CorrelationRowConsumer;
+
+/*! @brief Running sums of a single time series
+ *
+ * Values are shifted by center (the mean of the first accumulated samples)
+ * before summing, which keeps the sums well conditioned for data far from zero.
+ */
+struct PointStatistics {
+	double center;	///< shift subtracted from every value
+	double sum;		///< sum of x-center
+	double sumSq;	///< sum of (x-center)^2
+	double sumLag;	///< sum of (x[t]-center)*(x[t+1]-center)
+	double first;	///< first value minus center
+	double last;	///< last value minus center
+};
+
+/*! @brief Sums from which the correlations and autocorrelations of all points follow
+ *
+ * Besides the per-point sums, the sum of products of every pair is kept
+ * (a packed triangle of doubles, twice the size of the correlation file).
+ * Appending time steps costs time proportional to the number of new steps.
+ */
+class CorrelationStatistics {
+public:
+	CorrelationStatistics();
+
+	/*! @brief Add the time steps of data, which follow all the steps accumulated so far
+	 *
+	 * The first call fixes the grid and the centers. A point invalid in any slice stays invalid.
+	 *
+	 * @param data 3D data array, indices LAT, LON, TIME
+	 * @param validityMask flags for the points to be used, indices LAT, LON
+	 * @param threadCount number of threads (0 - one per hardware thread)
+	 */
+	void accumulate(const TimeSeriesField& data,
+			const std::vector< std::vector<bool> >& validityMask,
+			unsigned threadCount);
+
+	/// Correlation of points i and j (0 if either is invalid or constant)
+	float correlation(std::size_t i, std::size_t j) const;
+
+	/*! @brief Pass the lower triangle of the correlation matrix to the consumer
+	 *
+	 * @param blockRows number of rows computed and passed at once
+	 * @param threadCount number of threads (0 - one per hardware thread)
+	 */
+	void emitCorrelations(std::size_t blockRows, unsigned threadCount, CorrelationRowConsumer& consumer) const;
+
+	/// Lag-1 autocorrelation of every point (0 for invalid points)
+	void autocorrelations(std::vector<float>& result) const;
+
+	std::size_t nlat() const { return latCount; }
+	std::size_t nlon() const { return lonCount; }
+	std::size_t pointCount() const { return points.size(); }
+	/// Number of accumulated time steps
+	std::size_t sampleCount() const { return samples; }
+
+	const std::vector<PointStatistics>& pointStatistics() const { return points; }
+	const std::vector<std::uint8_t>& validity() const { return valid; }
+	/// Sums of (x-center)*(y-center) of all pairs
+	const SymmetricMatrix<double>& pairSums() const { return products; }
+
+	/// Restore statistics saved earlier (see storeCorrelationStatistics)
+	void assign(std::size_t nlat, std::size_t nlon, std::size_t sampleCount,
+			std::vector<PointStatistics>&& pointStatistics,
+			std::vector<std::uint8_t>&& validity,
+			SymmetricMatrix<double>&& pairSums);
+
+private:
+	std::size_t latCount;
+	std::size_t lonCount;
+	std::size_t samples;
+	std::vector<PointStatistics> points;
+	std::vector<std::uint8_t> valid;
+	SymmetricMatrix<double> products;
+};
+
+} // namespace VCGL
+
+#endif // CORRELATIONSTATISTICS_H_
@@ -0,0 +1,199 @@
+/*!	@file laggedcorrelation.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Lagged cross-correlation of all pairs of points, by dot products or via FFT
+ */
+
+#include "laggedcorrelation.h"
+#include "correlationengine.h"
+#include "threadpool.h"
+#include "progressbar.h"
+
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+namespace VCGL {
+
+namespace {
+	/// Rows and columns of a tile of pairs
+	const std::size_t LAG_TILE = 64;
+
+	/// Smallest power of two not below n
+	std::size_t powerOfTwoAtLeast(std::size_t n) {
+		std::size_t m = 1;
+		while (m < n) {
+			m *= 2;
+		}
+		return m;
+	}
+
+	/*! Product conj(A)*B of two radix-2 halfcomplex spectra of length m
+	 *
+	 * Layout: [0] real of frequency 0, [k] and [m-k] real and imaginary of frequency k,
+	 * [m/2] real of the Nyquist frequency.
+	 */
+	void conjugateProduct(const double* a, const double* b, double* out, std::size_t m) {
+		out[0] = a[0]*b[0];
+		for (std::size_t k = 1; k<m/2; k++) {
+			const double ar = a[k], ai = a[m-k];
+			const double br = b[k], bi = b[m-k];
+			out[k] = ar*br + ai*bi;
+			out[m-k] = ar*bi - ai*br;
+		}
+		if (m > 1) {
+			out[m/2] = a[m/2]*b[m/2];
+		}
+	}
+
+	/// Zero-padded radix-2 spectra of length m of points [begin, end), one after another
+	void transformSeries(const StandardizedSeries& series, std::size_t begin, std::size_t end, std::size_t m, double* out) {
+		const std::size_t ntime = series.timeCount();
+		for (std::size_t pt = begin; pt<end; pt++) {
+			double* s = out + (pt-begin)*m;
+			const float* values = series.row(pt);
+			std::copy(values, values + ntime, s);
+			gsl_fft_real_radix2_transform(s, 1, m);
+		}
+	}
+
+	/*! Whether the lags of a pair are cheaper as SIMD dot products than as one inverse FFT
+	 *
+	 * The transform takes about 5*m*log2(m) scalar operations, a dot product about ntime < m
+	 * vector ones; counting a vector operation as a few scalar ones, the dot products
+	 * win while there are at most 2*log2(m) lags.
+	 */
+	bool directLagsCheaper(int maxLag, std::size_t m) {
+		std::size_t log2m = 0;
+		while ((std::size_t(1) << log2m) < m) {
+			log2m++;
+		}
+		return static_cast<std::size_t>(2*maxLag + 1) <= 2*log2m;
+	}
+}
+
+void computeLaggedCorrelations(const TimeSeriesField& data,
+		const std::vector< std::vector<bool> >& validityMask,
+		int maxLag,
+		unsigned threadCount,
+		LaggedCorrelations& result) {
+	StandardizedSeries series;
+	series.assign(data, validityMask);
+
+	const std::size_t npoints = series.pointCount();
+	const std::size_t ntime = series.timeCount();
+	maxLag = std::max(0, std::min<int>(maxLag, static_cast<int>(ntime)-1));
+	maxLag = std::min(maxLag, 32767);
+
+	// padding to ntime+maxLag keeps the circular correlation free of wrap-around within the window
+	const std::size_t m = powerOfTwoAtLeast(ntime + maxLag);
+	const bool bDirect = directLagsCheaper(maxLag, m);
+
+	ThreadPool pool(threadCount);
+	if (bDirect) {
+		std::cout << "lags -" << maxLag << ".." << maxLag << ", dot products, "
+				<< pool.threadCount() << " thread(s)" << std::endl;
+	}
+	else {
+		std::cout << "lags -" << maxLag << ".." << maxLag << ", FFT length " << m << ", "
+				<< pool.threadCount() << " thread(s)" << std::endl;
+	}
+
+	result.maxLag = maxLag;
+	result.minima = SymmetricMatrix<float>(npoints, 1.0f);
+	result.lags.assign(triangleOffset(npoints), 0);
+
+	// lags in the order of preference for ties: 0, -1, 1, -2, 2, ...
+	std::vector<int> lagOrder(1, 0);
+	for (int l = 1; l<=maxLag; l++) {
+		lagOrder.push_back(-l);
+		lagOrder.push_back(l);
+	}
+	const std::size_t nlags = lagOrder.size();
+	const std::size_t stride = series.stride();
+	const CorrelationKernel& kernel = CorrelationEngine::selectKernel();
+
+	const std::vector<TriangleTile> tiles = makeTriangleTiles(npoints, LAG_TILE);
+	ProgressReporter progress(static_cast<unsigned long long>(npoints)*(npoints-1)/2);
+	pool.parallelFor(tiles.size(), [&](std::size_t t) {
+		const TriangleTile& tl = tiles[t];
+		if (bDirect) {
+			// the column shifted by every lag, zero outside the overlap: c[L] = x . y shifted by L
+			AlignedBuffer<float> shifted(nlags*stride);
+			std::vector<float> c(nlags);
+			for (std::size_t y = tl.colBegin; y<tl.colEnd && y+1<tl.rowEnd; y++) {
+				const float* values = series.row(y);
+				for (std::size_t k = 0; k<nlags; k++) {
+					const int l = lagOrder[k];
+					float* s = shifted.data() + k*stride;
+					const std::size_t from = l < 0 ? -l : 0;
+					const std::size_t to = l > 0 ? ntime - l : ntime;
+					std::fill(s, s + from, 0.0f);
+					std::copy(values + from + l, values + to + l, s + from);
+					std::fill(s + to, s + stride, 0.0f);
+				}
+				for (std::size_t x = std::max(tl.rowBegin, y+1); x<tl.rowEnd; x++) {
+					const float* rx = series.row(x);
+					std::size_t k = 0;
+					for (; k+4 <= nlags; k+=4) {
+						const float* s = shifted.data() + k*stride;
+						kernel.dot4(rx, s, s + stride, s + 2*stride, s + 3*stride, stride, &c[k]);
+					}
+					for (; k<nlags; k++) {
+						c[k] = kernel.dot(rx, shifted.data() + k*stride, stride);
+					}
+
+					float minValue = 2.0f;
+					int minLag = 0;
+					for (k = 0; k<nlags; k++) {
+						if (c[k] < minValue) {
+							minValue = c[k];
+							minLag = lagOrder[k];
+						}
+					}
+					result.minima.triangleRow(x)[y] = minValue;
+					result.lags[triangleOffset(x) + y] = static_cast<std::int16_t>(minLag);
+				}
+			}
+			progress.advance(tl.pairCount());
+			return;
+		}
+
+		// forward transforms of the rows and columns of the tile, so the spectra stay within two tiles per thread
+		std::vector<double> rowSpectra((tl.rowEnd - tl.rowBegin)*m, 0.0);
+		std::vector<double> colSpectra((tl.colEnd - tl.colBegin)*m, 0.0);
+		transformSeries(series, tl.rowBegin, tl.rowEnd, m, rowSpectra.data());
+		transformSeries(series, tl.colBegin, tl.colEnd, m, colSpectra.data());
+
+		std::vector<double> product(m);
+		for (std::size_t x = tl.rowBegin; x<tl.rowEnd; x++) {
+			const std::size_t yEnd = std::min(tl.colEnd, x);
+			float* minima = result.minima.triangleRow(x);
+			std::int16_t* lags = &result.lags[triangleOffset(x)];
+			for (std::size_t y = tl.colBegin; y<yEnd; y++) {
+				// cross-correlation c[L] = sum_t x[t]*y[t+L], negative L at the end
+				conjugateProduct(&rowSpectra[(x - tl.rowBegin)*m], &colSpectra[(y - tl.colBegin)*m], product.data(), m);
+				gsl_fft_halfcomplex_radix2_inverse(product.data(), 1, m);
+
+				double minValue = 2.0;
+				int minLag = 0;
+				for (int l: lagOrder) {
+					const double c = product[l >= 0 ? l : m+l];
+					if (c < minValue) {
+						minValue = c;
+						minLag = l;
+					}
+				}
+				minima[y] = static_cast<float>(minValue);
+				lags[y] = static_cast<std::int16_t>(minLag);
+			}
+		}
+		progress.advance(tl.pairCount());
+	});
+	progress.finish();
+}
+
+} // namespace VCGL
@@ -0,0 +1,68 @@
+/*!	@file laggedcorrelation.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Lagged cross-correlation of all pairs of points, by dot products or via FFT
+ */
+
+#ifndef LAGGEDCORRELATION_H_
+#define LAGGEDCORRELATION_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "typedefs.h"
+#include "symmetricmatrix.h"
+#include "timeseriesfield.h"
+
+namespace VCGL {
+
+/*! @brief Most negative cross-correlation of every pair of points over a window of lags
+ *
+ * The lag of pair (x,y) is L when the correlation of x[t] with y[t+L] is the minimum,
+ * i.e. a positive lag means that y follows x. lag(y,x) = -lag(x,y).
+ */
+struct LaggedCorrelations {
+	SymmetricMatrix<float> minima;	///< minimal correlation over the lags
+	std::vector<std::int16_t> lags;	///< packed like minima: lag(x,y) for x > y at triangleOffset(x)+y
+	int maxLag;	///< the window is -maxLag..maxLag
+
+	LaggedCorrelations(): maxLag(0) {}
+
+	/// Lag of the minimum of pair (x,y)
+	int lag(std::size_t x, std::size_t y) const {
+		if (x == y) {
+			return 0;
+		}
+		return (x > y) ? lags[triangleOffset(x) + y] : -lags[triangleOffset(y) + x];
+	}
+};
+
+/*! @brief Compute the cross-correlations of all pairs over lags -maxLag..maxLag
+ *
+ * The series are standardized as in computeCorrelations. For short windows, every lag
+ * of a pair is a dot product with the lag-shifted series (the SIMD kernels of
+ * CorrelationEngine); for long ones, each tile of pairs transforms its series
+ * (zero-padded real FFT) and every pair takes one inverse transform of the
+ * product of the spectra, so the spectra of two tiles per thread are held at a time.
+ * The correlation at lag L is the sum of a[t]*b[t+L] over
+ * the overlap of the standardized series, so it equals the Pearson coefficient
+ * at lag 0 and is damped by the shrinking overlap at larger lags.
+ * Ties are resolved towards the smaller |L|, then towards the negative lag.
+ * The result does not depend on the number of threads.
+ *
+ * @param data 3D data array, indices LAT, LON, TIME
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param maxLag largest lag in time steps (limited to ntime-1)
+ * @param threadCount number of threads (0 - one per hardware thread)
+ * @param result output
+ */
+void computeLaggedCorrelations(const TimeSeriesField& data,
+		const std::vector< std::vector<bool> >& validityMask,
+		int maxLag,
+		unsigned threadCount,
+		LaggedCorrelations& result);
+
+} // namespace VCGL
+
+#endif // LAGGEDCORRELATION_H_
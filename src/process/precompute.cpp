@@ -8,197 +8,797 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#include <cmath>
 #include <vector>
 #include <cassert>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
 #include "progressbar.h"
+#include "correlationengine.h"
+#include "threadpool.h"
 
 #include "projection/distancematrix.h"
+#include "storage/sparsecorrelationstore.h"
+#include "storage/correlationstore.h"
+#include "storage/databandreader.h"
 #include "projection/projectedpointinfo.h"
 #include "projection/sammon.h"
+#include "projection/parallelsammon.h"
+#include "projection/sammoncontroller.h"
+#include "projection/landmarkprojection.h"
+#include "projection/classicalmds.h"
 
 #include <sstream>
 
 
+namespace {
+	/// Smallest tile worth a task of its own
+	const size_t MIN_PARALLEL_TILE = 32;
+	/// Points per task in the autocorrelation stage
+	const size_t AUTOCORRELATION_CHUNK = 1024;
+
+	/// Shrink the cache-sized tile until every thread gets several tiles to balance
+	size_t parallelTileSize(size_t npoints, size_t cacheTile, unsigned threadCount) {
+		size_t tile = cacheTile;
+		while (tile > MIN_PARALLEL_TILE) {
+			const size_t tileRows = (npoints + tile - 1) / tile;
+			if (tileRows*(tileRows+1)/2 >= 8*static_cast<size_t>(threadCount)) {
+				break;
+			}
+			tile /= 2;
+		}
+		return std::max<size_t>(tile, 1);
+	}
+
+	/// Lag-1 autocorrelation over the pairs of consecutive time steps which are both valid
+	float lag1AutocorrelationWithGaps(VCGL::SeriesSpan<const float> ts) {
+		const size_t ntime = ts.size();
+		double n = 0.0, sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumYY = 0.0, sumXY = 0.0;
+		for (size_t t=0; t+1<ntime; t++) {
+			if (std::isnan(ts[t]) || std::isnan(ts[t+1])) {
+				continue;
+			}
+			const double x = ts[t], y = ts[t+1];
+			n += 1.0;
+			sumX += x;
+			sumY += y;
+			sumXX += x*x;
+			sumYY += y*y;
+			sumXY += x*y;
+		}
+		const double varX = n*sumXX - sumX*sumX;
+		const double varY = n*sumYY - sumY*sumY;
+		if (n < 2.0 || varX <= 0.0 || varY <= 0.0) {
+			return 0.0f;
+		}
+		return static_cast<float>((n*sumXY - sumX*sumY) / sqrt(varX*varY));
+	}
+
+	/// Lag-1 autocorrelation of a single time series
+	float lag1Autocorrelation(VCGL::SeriesSpan<const float> ts) {
+		const int ntime = ts.size();
+		if (std::any_of(ts.begin(), ts.end(), [](float v) { return std::isnan(v); })) {
+			return lag1AutocorrelationWithGaps(ts);
+		}
+
+		float sum = 0.0f;
+		for (int t=0; t<ntime; t++) {
+			sum += ts[t];
+		}
+		const float average = sum / ntime;
+
+		//x starts with timestep 0, y starts with timestep 1, length ntime-1
+
+		//adjust averages
+		float avX = (average * ntime - ts[ntime-1]) / (ntime-1);
+		float avY = (average * ntime - ts[0]) / (ntime-1);
+
+		float nom = 0.0f;
+		float denomX = 0.0f;
+		float denomY = 0.0f;
+
+		for (int t=0; t<ntime-1; t++) {
+			float dx = ts[t]-avX;
+			float dy = ts[t+1]-avY;
+			nom += dx*dy;
+			denomX += dx*dx;
+			denomY += dy*dy;
+		}
+
+		return nom / sqrt(denomX*denomY);
+	}
+}
+
 /** @brief Compute correlation matrix of all pairs of time series
+ *
+ * Series are standardized once (see VCGL::StandardizedSeries), then the lower
+ * triangle is split into tiles, which are computed on a work-stealing pool with
+ * the fastest available dot product kernel. Every value is computed by the same
+ * kernel in the same order whichever thread picks its tile, so the result does
+ * not depend on the number of threads.
  *
  * @param data 3D data array, indices LAT, LON, TIME
- * @param correlationMatrix output - symmetric square matrix with correlations
+ * @param correlationMatrix output - symmetric matrix with correlations
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param threadCount number of threads (0 - one per hardware thread)
  */
 void computeCorrelations(
-		const std::vector< std::vector< std::vector<float> > >& data,
-		std::vector< std::vector<float> >& correlationMatrix,
-		std::vector< std::vector<bool> >& validityMask) {
-
-	const int nlat = data.size();
-	const int nlon = data[0].size();
-	const int ntime = data[0][0].size();
-
-   //compute the correlation matrix
-   const int npoints = nlat * nlon;
-
-   const int totalNumIterations = npoints*(npoints-1)/2;
-   progress_bar(0, totalNumIterations);
-
-   std::vector<float> averages(npoints, 0.0f);
-
-   correlationMatrix.clear();
-   correlationMatrix.resize(npoints, std::vector<float>(npoints, 0.0f));
-
-   //compute averages
-   for (int pt = 0; pt<npoints; pt++) {
-	   int ptLat = pt / nlon;
-	   int ptLon = pt % nlon;
-	   float sum = 0.0f;
-	   if (validityMask[ptLat][ptLon]) {
-		   for (int t=0; t<ntime; t++) {
-			   sum += data[ptLat][ptLon][t];
-		   }
-		   averages[pt] = sum / ntime;
-	   }
-   }
-
-   float minval = 1.0;
-   float maxval = 0.0;
-
-   int currIteration = 0;
-   for (int x = 0; x<npoints; x++) {
-	   correlationMatrix[x][x] = 1.0;
-	   for (int y = 0; y<x; y++) {
-		   int xLat = x / nlon;
-		   int xLon = x % nlon;
-		   int yLat = y / nlon;
-		   int yLon = y % nlon;
-
-		   float nom = 0.0f;
-		   float denomX = 0.0f;
-		   float denomY = 0.0f;
-
-		   //compute and assign correlation only if both points are valid
-		   //otherwise leave default value (zero correlation)
-		   if (validityMask[xLat][xLon] && validityMask[yLat][yLon]) {
-			   for (int t=0; t<ntime; t++) {
-				   float dx = data[xLat][xLon][t]-averages[x];
-				   float dy = data[yLat][yLon][t]-averages[y];
-				   nom += dx*dy;
-				   denomX += dx*dx;
-				   denomY += dy*dy;
-			   }
-			   float corrValue = nom / sqrt(denomX*denomY);
-			   correlationMatrix[x][y] = corrValue;
-			   correlationMatrix[y][x] = corrValue;
-
-			   if (minval > correlationMatrix[x][y]) {
-				   minval = correlationMatrix[x][y];
-			   }
-			   if (maxval < correlationMatrix[x][y]) {
-				   maxval = correlationMatrix[x][y];
-			   }
-		   }
-		   currIteration++;
-		   progress_bar(currIteration, totalNumIterations);
-      }
-   }
-   std::cout << std::endl; // for the progress bar
-
-   std::cout << "min=" << minval << ", max=" << maxval << std::endl;
-}
-
-void computeAutocorrelations(const std::vector< std::vector< std::vector<float> > >& data,
+		const VCGL::TimeSeriesField& data,
+		VCGL::SymmetricMatrix<float>& correlationMatrix,
+		std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount) {
+
+	VCGL::StandardizedSeries series;
+	series.assign(data, validityMask);
+
+	const size_t npoints = series.pointCount();
+
+	VCGL::ThreadPool pool(threadCount);
+	VCGL::CorrelationEngine engine(series);
+	const size_t tile = parallelTileSize(npoints, engine.tileSize(), pool.threadCount());
+	const std::vector<VCGL::TriangleTile> tiles = VCGL::makeTriangleTiles(npoints, tile);
+	std::cout << "using " << engine.kernel().name << " kernel, "
+			<< pool.threadCount() << " thread(s), "
+			<< tiles.size() << " tiles of size " << tile << std::endl;
+
+	correlationMatrix = VCGL::SymmetricMatrix<float>(npoints, 1.0f, 0.0f);
+
+	ProgressReporter progress(static_cast<unsigned long long>(npoints)*(npoints-1)/2);
+
+	// per-tile extremes, reduced after the parallel part
+	std::vector<float> tileMin(tiles.size(), 1.0f);
+	std::vector<float> tileMax(tiles.size(), 0.0f);
+
+	pool.parallelFor(tiles.size(), [&](size_t t) {
+		const VCGL::TriangleTile& tl = tiles[t];
+		const size_t width = tl.colEnd - tl.colBegin;
+		std::vector<float> tileValues((tl.rowEnd - tl.rowBegin)*width);
+		engine.computeTile(tl.rowBegin, tl.rowEnd, tl.colBegin, tl.colEnd, tileValues.data(), width);
+
+		float minval = 1.0;
+		float maxval = 0.0;
+		for (size_t x = tl.rowBegin; x<tl.rowEnd; x++) {
+			const size_t yEnd = std::min(tl.colEnd, x);
+			const float* values = &tileValues[(x-tl.rowBegin)*width];
+			// tiles are disjoint, so no two threads write the same element
+			float* matrixRow = correlationMatrix.triangleRow(x);
+			for (size_t y = tl.colBegin; y<yEnd; y++) {
+				const float corrValue = values[y-tl.colBegin];
+				matrixRow[y] = corrValue;
+
+				if (minval > corrValue) {
+					minval = corrValue;
+				}
+				if (maxval < corrValue) {
+					maxval = corrValue;
+				}
+			}
+		}
+		tileMin[t] = minval;
+		tileMax[t] = maxval;
+		progress.advance(tl.pairCount());
+	});
+	progress.finish();
+
+	float minval = 1.0;
+	float maxval = 0.0;
+	for (size_t t = 0; t<tiles.size(); t++) {
+		minval = std::min(minval, tileMin[t]);
+		maxval = std::max(maxval, tileMax[t]);
+	}
+	std::cout << "min=" << minval << ", max=" << maxval << std::endl;
+}
+
+void computeCorrelationsStreaming(
+		const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		size_t memoryBudget,
+		unsigned threadCount,
+		VCGL::CorrelationRowConsumer& consumer,
+		size_t firstRow,
+		size_t lastRow) {
+
+	VCGL::StandardizedSeries series;
+	series.assign(data, validityMask);
+
+	const size_t npoints = series.pointCount();
+	const size_t rowEnd = std::min(lastRow, npoints);
+
+	VCGL::ThreadPool pool(threadCount);
+	VCGL::CorrelationEngine engine(series);
+	const size_t tile = parallelTileSize(npoints, engine.tileSize(), pool.threadCount());
+
+	// whatever the standardized series leave of the budget goes to one block of rows
+	const size_t seriesBytes = npoints * series.stride() * sizeof(float);
+	const size_t rowBytes = std::max<size_t>(npoints, 1) * sizeof(float);
+	size_t blockRows = (memoryBudget > seriesBytes) ? (memoryBudget - seriesBytes) / rowBytes : 0;
+	if (blockRows < tile) {
+		std::cerr << "WARNING: memory budget too small, using blocks of " << tile << " rows" << std::endl;
+		blockRows = tile;
+	}
+	else {
+		blockRows -= blockRows % tile;
+	}
+
+	std::cout << "using " << engine.kernel().name << " kernel, "
+			<< pool.threadCount() << " thread(s), "
+			<< "blocks of " << blockRows << " rows, tiles of size " << tile << std::endl;
+
+	ProgressReporter progress(VCGL::triangleOffset(rowEnd) - VCGL::triangleOffset(std::min(firstRow, rowEnd)));
+
+	std::vector<float> block;
+	for (size_t blockBegin = firstRow; blockBegin<rowEnd; blockBegin+=blockRows) {
+		const size_t blockEnd = std::min(rowEnd, blockBegin+blockRows);
+		const size_t blockOffset = VCGL::triangleOffset(blockBegin);
+		block.resize(VCGL::triangleOffset(blockEnd) - blockOffset);
+
+		const std::vector<VCGL::TriangleTile> tiles = VCGL::makeTriangleTiles(blockBegin, blockEnd, tile);
+		pool.parallelFor(tiles.size(), [&](size_t t) {
+			const VCGL::TriangleTile& tl = tiles[t];
+			const size_t width = tl.colEnd - tl.colBegin;
+			std::vector<float> tileValues((tl.rowEnd - tl.rowBegin)*width);
+			engine.computeTile(tl.rowBegin, tl.rowEnd, tl.colBegin, tl.colEnd, tileValues.data(), width);
+
+			for (size_t x = tl.rowBegin; x<tl.rowEnd; x++) {
+				const size_t yEnd = std::min(tl.colEnd, x);
+				if (yEnd > tl.colBegin) {
+					std::copy(&tileValues[(x-tl.rowBegin)*width], &tileValues[(x-tl.rowBegin)*width] + (yEnd-tl.colBegin),
+							&block[VCGL::triangleOffset(x) - blockOffset + tl.colBegin]);
+				}
+			}
+			progress.advance(tl.pairCount());
+		});
+
+		consumer.consumeRows(blockBegin, blockEnd, block.data());
+	}
+	progress.finish();
+}
+
+namespace VCGL {
+
+TeleconnectivityMinima::TeleconnectivityMinima(size_t npoints)
+: minCorrelations(npoints, 1.0f), partnerIndices(npoints) {
+	for (size_t pt = 0; pt<npoints; pt++) {
+		partnerIndices[pt] = static_cast<int>(pt);
+	}
+}
+
+void TeleconnectivityMinima::consumeRows(size_t rowBegin, size_t rowEnd, const float* values) {
+	const float* rowValues = values;
+	for (size_t x = rowBegin; x<rowEnd; x++) {
+		for (size_t y = 0; y<x; y++) {
+			offer(x, y, rowValues[y]);
+			offer(y, x, rowValues[y]);
+		}
+		rowValues += x;
+	}
+}
+
+namespace {
+	template<typename T>
+	void writeVector(std::ostream& out, const std::vector<T>& values) {
+		const std::uint64_t count = values.size();
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		out.write(reinterpret_cast<const char*>(values.data()), count*sizeof(T));
+	}
+
+	/// Read a vector written by writeVector, false unless it has the size of the given one
+	template<typename T>
+	bool readVector(std::istream& in, std::vector<T>& values) {
+		std::uint64_t count = 0;
+		in.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!in || count != values.size()) {
+			return false;
+		}
+		in.read(reinterpret_cast<char*>(values.data()), count*sizeof(T));
+		return static_cast<bool>(in);
+	}
+}
+
+void TeleconnectivityMinima::saveState(std::ostream& out) const {
+	writeVector(out, minCorrelations);
+	writeVector(out, partnerIndices);
+}
+
+bool TeleconnectivityMinima::restoreState(std::istream& in) {
+	return readVector(in, minCorrelations) && readVector(in, partnerIndices);
+}
+
+namespace {
+	// the "better" candidate goes first: lower (higher) value, then smaller index;
+	// used as heap order, this keeps the worst of the kept candidates on top
+	struct LowerFirst {
+		template<typename C> bool operator()(const C& a, const C& b) const {
+			return a.value < b.value || (a.value == b.value && a.index < b.index);
+		}
+	};
+	struct HigherFirst {
+		template<typename C> bool operator()(const C& a, const C& b) const {
+			return a.value > b.value || (a.value == b.value && a.index < b.index);
+		}
+	};
+
+	template<typename C, typename Order>
+	void offerBounded(C* heap, std::uint32_t& size, std::size_t capacity, const C& candidate, Order order) {
+		if (size < capacity) {
+			heap[size++] = candidate;
+			std::push_heap(heap, heap+size, order);
+		}
+		else if (capacity > 0 && order(candidate, heap[0])) {
+			std::pop_heap(heap, heap+size, order);
+			heap[size-1] = candidate;
+			std::push_heap(heap, heap+size, order);
+		}
+	}
+}
+
+TopCorrelations::TopCorrelations(size_t npoints, size_t lowestCount, size_t highestCount)
+: npoints(npoints), nLowest(lowestCount), nHighest(highestCount),
+  lowest(npoints*lowestCount), highest(npoints*highestCount),
+  lowestSize(npoints, 0), highestSize(npoints, 0) {
+	assert(npoints <= UINT32_MAX);
+}
+
+void TopCorrelations::consumeRows(size_t rowBegin, size_t rowEnd, const float* values) {
+	const float* rowValues = values;
+	for (size_t x = rowBegin; x<rowEnd; x++) {
+		for (size_t y = 0; y<x; y++) {
+			offer(x, y, rowValues[y]);
+			offer(y, x, rowValues[y]);
+		}
+		rowValues += x;
+	}
+}
+
+inline void TopCorrelations::offer(size_t pt, size_t other, float value) {
+	if (value != value) { // NaN of a constant series
+		return;
+	}
+	const Candidate candidate = { value, static_cast<std::uint32_t>(other) };
+	offerBounded(&lowest[pt*nLowest], lowestSize[pt], nLowest, candidate, LowerFirst());
+	offerBounded(&highest[pt*nHighest], highestSize[pt], nHighest, candidate, HigherFirst());
+}
+
+void TopCorrelations::saveState(std::ostream& out) const {
+	writeVector(out, lowest);
+	writeVector(out, highest);
+	writeVector(out, lowestSize);
+	writeVector(out, highestSize);
+}
+
+bool TopCorrelations::restoreState(std::istream& in) {
+	return readVector(in, lowest) && readVector(in, highest)
+			&& readVector(in, lowestSize) && readVector(in, highestSize);
+}
+
+void TopCorrelations::collect(SparseCorrelationRows& rows) const {
+	// count the entries of every row, each kept pair goes to both of its rows
+	std::vector<std::uint64_t> counts(npoints, 0);
+	for (size_t pt = 0; pt<npoints; pt++) {
+		for (size_t k = 0; k<lowestSize[pt]; k++) {
+			counts[pt]++;
+			counts[lowest[pt*nLowest+k].index]++;
+		}
+		for (size_t k = 0; k<highestSize[pt]; k++) {
+			counts[pt]++;
+			counts[highest[pt*nHighest+k].index]++;
+		}
+	}
+
+	std::vector<std::uint64_t> offsets(npoints+1, 0);
+	for (size_t pt = 0; pt<npoints; pt++) {
+		offsets[pt+1] = offsets[pt] + counts[pt];
+	}
+	std::vector<Candidate> entries(offsets[npoints]);
+	std::vector<std::uint64_t> fill(offsets.begin(), offsets.end()-1);
+	for (size_t pt = 0; pt<npoints; pt++) {
+		const std::uint32_t self = static_cast<std::uint32_t>(pt);
+		for (size_t k = 0; k<lowestSize[pt]; k++) {
+			const Candidate& c = lowest[pt*nLowest+k];
+			entries[fill[pt]++] = c;
+			entries[fill[c.index]++] = Candidate{ c.value, self };
+		}
+		for (size_t k = 0; k<highestSize[pt]; k++) {
+			const Candidate& c = highest[pt*nHighest+k];
+			entries[fill[pt]++] = c;
+			entries[fill[c.index]++] = Candidate{ c.value, self };
+		}
+	}
+
+	// sort every row by column and drop the pairs kept from both sides
+	rows.offsets.assign(1, 0);
+	rows.offsets.reserve(npoints+1);
+	rows.columns.clear();
+	rows.values.clear();
+	for (size_t pt = 0; pt<npoints; pt++) {
+		std::sort(entries.begin()+offsets[pt], entries.begin()+offsets[pt+1],
+				[](const Candidate& a, const Candidate& b) { return a.index < b.index; });
+		for (std::uint64_t k = offsets[pt]; k<offsets[pt+1]; k++) {
+			if (k == offsets[pt] || entries[k].index != entries[k-1].index) {
+				rows.columns.push_back(entries[k].index);
+				rows.values.push_back(entries[k].value);
+			}
+		}
+		rows.offsets.push_back(rows.columns.size());
+	}
+}
+
+void DistanceMatrixFiller::consumeRows(size_t rowBegin, size_t rowEnd, const float* values) {
+	const float* rowValues = values;
+	for (size_t x = rowBegin; x<rowEnd; x++) {
+		for (size_t y = 0; y<x; y++) {
+			dmat.setDistanceByIndices(x, y, DistanceMatrix::distanceFromCorrelation(rowValues[y]));
+		}
+		rowValues += x;
+	}
+}
+
+void CorrelationRowFanOut::consumeRows(size_t rowBegin, size_t rowEnd, const float* values) {
+	for (size_t j = 0; j<consumers.size(); j++) {
+		consumers[j]->consumeRows(rowBegin, rowEnd, values);
+	}
+}
+
+} // namespace VCGL
+
+namespace {
+	/*! Reduce tiles of correlations to the minima of their rows and columns
+	 *
+	 * Point k of the series is point globalIds[k] of the minima (k itself if globalIds is empty);
+	 * the ids must increase with k, so that ties resolve as in the whole matrix.
+	 */
+	void reduceTilesToMinima(const VCGL::CorrelationEngine& engine,
+			const std::vector<VCGL::TriangleTile>& tiles,
+			size_t tile,
+			size_t npoints,
+			const std::vector<size_t>& globalIds,
+			VCGL::ThreadPool& pool,
+			ProgressReporter& progress,
+			VCGL::TeleconnectivityMinima& minima) {
+		const auto globalId = [&globalIds](size_t k) { return globalIds.empty() ? k : globalIds[k]; };
+
+		// one lock per band of tile rows, guarding the minima of the points in the band
+		std::vector<std::mutex> bandLocks((npoints + tile - 1) / tile);
+
+		pool.parallelFor(tiles.size(), [&](size_t t) {
+			const VCGL::TriangleTile& tl = tiles[t];
+			const size_t height = tl.rowEnd - tl.rowBegin;
+			const size_t width = tl.colEnd - tl.colBegin;
+			std::vector<float> tileValues(height*width);
+			engine.computeTile(tl.rowBegin, tl.rowEnd, tl.colBegin, tl.colEnd, tileValues.data(), width);
+
+			// minima within the tile, merged below only where some correlation is below 1
+			std::vector<float> rowMin(height, 1.0f), colMin(width, 1.0f);
+			std::vector<size_t> rowPartner(height, 0), colPartner(width, 0);
+			for (size_t x = tl.rowBegin; x<tl.rowEnd; x++) {
+				const size_t yEnd = std::min(tl.colEnd, x);
+				const float* values = &tileValues[(x-tl.rowBegin)*width];
+				for (size_t y = tl.colBegin; y<yEnd; y++) {
+					const float corrValue = values[y-tl.colBegin];
+					// candidates come in increasing index order, strict comparison keeps the first one
+					if (corrValue < rowMin[x-tl.rowBegin]) {
+						rowMin[x-tl.rowBegin] = corrValue;
+						rowPartner[x-tl.rowBegin] = y;
+					}
+					if (corrValue < colMin[y-tl.colBegin]) {
+						colMin[y-tl.colBegin] = corrValue;
+						colPartner[y-tl.colBegin] = x;
+					}
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(bandLocks[tl.rowBegin / tile]);
+				for (size_t k = 0; k<height; k++) {
+					if (rowMin[k] < 1.0f) {
+						minima.offer(globalId(tl.rowBegin+k), globalId(rowPartner[k]), rowMin[k]);
+					}
+				}
+			}
+			{
+				std::lock_guard<std::mutex> lock(bandLocks[tl.colBegin / tile]);
+				for (size_t k = 0; k<width; k++) {
+					if (colMin[k] < 1.0f) {
+						minima.offer(globalId(tl.colBegin+k), globalId(colPartner[k]), colMin[k]);
+					}
+				}
+			}
+			progress.advance(tl.pairCount());
+		});
+	}
+
+	/// Rows [latBegin, latEnd) of the validity mask
+	std::vector< std::vector<bool> > maskRows(const std::vector< std::vector<bool> >& validityMask,
+			size_t latBegin, size_t latEnd) {
+		return std::vector< std::vector<bool> >(validityMask.begin() + latBegin, validityMask.begin() + latEnd);
+	}
+
+	/// Series of the points of first followed by those of second
+	VCGL::TimeSeriesField joinBands(const VCGL::TimeSeriesField& first, const VCGL::TimeSeriesField& second) {
+		VCGL::TimeSeriesField joined(first.nlat() + second.nlat(), first.nlon(), first.timeCount());
+		std::copy(first.data(), first.data() + first.pointCount()*first.stride(), joined.data());
+		std::copy(second.data(), second.data() + second.pointCount()*second.stride(),
+				joined.data() + first.pointCount()*joined.stride());
+		return joined;
+	}
+}
+
+void computeTeleconnectivityMinima(
+		const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount,
+		VCGL::TeleconnectivityMinima& minima) {
+
+	VCGL::StandardizedSeries series;
+	series.assign(data, validityMask);
+
+	const size_t npoints = series.pointCount();
+	minima = VCGL::TeleconnectivityMinima(npoints);
+
+	VCGL::ThreadPool pool(threadCount);
+	VCGL::CorrelationEngine engine(series);
+	const size_t tile = parallelTileSize(npoints, engine.tileSize(), pool.threadCount());
+	const std::vector<VCGL::TriangleTile> tiles = VCGL::makeTriangleTiles(npoints, tile);
+	std::cout << "using " << engine.kernel().name << " kernel, "
+			<< pool.threadCount() << " thread(s), "
+			<< tiles.size() << " tiles of size " << tile << std::endl;
+
+	ProgressReporter progress(static_cast<unsigned long long>(npoints)*(npoints-1)/2);
+	reduceTilesToMinima(engine, tiles, tile, npoints, std::vector<size_t>(), pool, progress, minima);
+	progress.finish();
+}
+
+void computeTeleconnectivityMinima(
+		VCGL::DataBandReader& bands,
+		std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount,
+		VCGL::TeleconnectivityMinima& minima) {
+
+	const size_t npoints = bands.pointCount();
+	const size_t nbands = bands.bandCount();
+	minima = VCGL::TeleconnectivityMinima(npoints);
+
+	VCGL::ThreadPool pool(threadCount);
+	std::cout << nbands << " band(s) of " << bands.bandLats() << " latitude(s), "
+			<< pool.threadCount() << " thread(s)" << std::endl;
+
+	ProgressReporter progress(static_cast<unsigned long long>(npoints)*(npoints-1)/2);
+	for (size_t i = 0; i<nbands; i++) {
+		const VCGL::TimeSeriesField rowBand = bands.readBand(i);
+		const size_t ni = rowBand.pointCount();
+
+		// band i with itself, then with every earlier band j: series of band j followed by those of band i
+		for (size_t j = i+1; j-- > 0; ) {
+			VCGL::TimeSeriesField columnBand;
+			std::vector< std::vector<bool> > pairMask;
+			std::vector<size_t> globalIds;
+			size_t nj = 0;
+			if (j != i) {
+				columnBand = bands.readBand(j);
+				nj = columnBand.pointCount();
+				pairMask = maskRows(validityMask, bands.latBegin(j), bands.latEnd(j));
+				for (size_t k = 0; k<nj; k++) {
+					globalIds.push_back(bands.pointBegin(j) + k);
+				}
+			}
+			const std::vector< std::vector<bool> > rowMask = maskRows(validityMask, bands.latBegin(i), bands.latEnd(i));
+			pairMask.insert(pairMask.end(), rowMask.begin(), rowMask.end());
+			for (size_t k = 0; k<ni; k++) {
+				globalIds.push_back(bands.pointBegin(i) + k);
+			}
+
+			VCGL::StandardizedSeries series;
+			if (j != i) {
+				series.assign(joinBands(columnBand, rowBand), pairMask);
+				columnBand.clear();
+			}
+			else {
+				series.assign(rowBand, pairMask);
+			}
+			VCGL::CorrelationEngine engine(series);
+			const size_t tile = parallelTileSize(nj+ni, engine.tileSize(), pool.threadCount());
+
+			std::vector<VCGL::TriangleTile> tiles;
+			if (j == i) {
+				tiles = VCGL::makeTriangleTiles(ni, tile);
+			}
+			else {
+				// rows of band i, columns of band j only
+				for (VCGL::TriangleTile tl: VCGL::makeTriangleTiles(nj, nj+ni, tile)) {
+					if (tl.colBegin < nj) {
+						tl.colEnd = std::min(tl.colEnd, nj);
+						tiles.push_back(tl);
+					}
+				}
+			}
+			reduceTilesToMinima(engine, tiles, tile, nj+ni, globalIds, pool, progress, minima);
+		}
+	}
+	progress.finish();
+}
+
+namespace {
+	/// Validity of the points of data, stored to the rows from latOffset on
+	void markValidPoints(const VCGL::TimeSeriesField& data,
+			size_t latOffset,
+			float minValidFraction,
+			std::vector< std::vector<bool> >& validityMask,
+			size_t& invalidCount,
+			size_t& gappedCount) {
+		for (size_t lat = 0; lat<data.nlat(); lat++) {
+			std::vector<bool>& maskRow = validityMask[latOffset + lat];
+			for (size_t lon = 0; lon<data.nlon(); lon++) {
+				VCGL::SeriesSpan<const float> ts = data.series(lat, lon);
+				const size_t validCount = std::count_if(ts.begin(), ts.end(), [](float v) { return !std::isnan(v); });
+				maskRow[lon] = (validCount >= 2 && validCount >= minValidFraction*ts.size());
+				if (!maskRow[lon]) {
+					invalidCount++;
+				}
+				else if (validCount < ts.size()) {
+					gappedCount++;
+				}
+			}
+		}
+	}
+
+	void reportMissingValues(size_t invalidCount, size_t gappedCount) {
+		if (invalidCount > 0 || gappedCount > 0) {
+			std::cout << "Missing values: " << invalidCount << " points excluded, "
+					<< gappedCount << " points with gaps" << std::endl;
+		}
+	}
+}
+
+void computeValidityMask(const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		float minValidFraction) {
+	validityMask.assign(data.nlat(), std::vector<bool>(data.nlon(), false));
+
+	size_t invalidCount = 0;
+	size_t gappedCount = 0;
+	markValidPoints(data, 0, minValidFraction, validityMask, invalidCount, gappedCount);
+	reportMissingValues(invalidCount, gappedCount);
+}
+
+void computeValidityMask(VCGL::DataBandReader& bands,
+		std::vector< std::vector<bool> >& validityMask,
+		float minValidFraction) {
+	validityMask.assign(bands.nlat(), std::vector<bool>(bands.nlon(), false));
+
+	size_t invalidCount = 0;
+	size_t gappedCount = 0;
+	VCGL::TimeSeriesField band;
+	size_t b = 0;
+	bands.rewind();
+	while (bands.next(band, &b)) {
+		markValidPoints(band, bands.latBegin(b), minValidFraction, validityMask, invalidCount, gappedCount);
+	}
+	reportMissingValues(invalidCount, gappedCount);
+}
+
+namespace {
+	/// Autocorrelations of the points of data, stored from pointOffset on
+	void autocorrelationsOfPoints(const VCGL::TimeSeriesField& data,
+			size_t pointOffset,
+			const std::vector< std::vector<bool> >& validityMask,
+			VCGL::ThreadPool& pool,
+			ProgressReporter& progress,
+			std::vector<float>& autocorrelations) {
+		const size_t nlon = data.nlon();
+		const size_t npoints = data.pointCount();
+		const size_t chunkCount = (npoints + AUTOCORRELATION_CHUNK - 1) / AUTOCORRELATION_CHUNK;
+
+		pool.parallelFor(chunkCount, [&](size_t chunk) {
+			const size_t begin = chunk*AUTOCORRELATION_CHUNK;
+			const size_t end = std::min(npoints, begin+AUTOCORRELATION_CHUNK);
+			for (size_t x = begin; x<end; x++) {
+				const size_t pt = pointOffset + x;
+				if (validityMask[pt / nlon][pt % nlon]) {
+					autocorrelations[pt] = lag1Autocorrelation(data.series(x));
+				}
+			}
+			progress.advance(end-begin);
+		});
+	}
+
+	void reportAutocorrelationRange(const std::vector<float>& autocorrelations,
+			const std::vector< std::vector<bool> >& validityMask,
+			size_t nlon) {
+		float minval = 1.0;
+		float maxval = -1.0;
+		for (size_t x = 0; x<autocorrelations.size(); x++) {
+			if (validityMask[x / nlon][x % nlon]) {
+				minval = std::min(minval, autocorrelations[x]);
+				maxval = std::max(maxval, autocorrelations[x]);
+			}
+		}
+		std::cout << "min=" << minval << ", max=" << maxval << std::endl;
+	}
+}
+
+void computeAutocorrelations(const VCGL::TimeSeriesField& data,
 				std::vector<float> & autocorrelations,
-				std::vector< std::vector<bool> >& validityMask) {
-
-	const int nlat = data.size();
-	const int nlon = data[0].size();
-	const int ntime = data[0][0].size();
-
-   //compute the correlation matrix
-   const int npoints = nlat * nlon;
-
-   const int totalNumIterations = npoints;
-   progress_bar(0, totalNumIterations);
-
-   std::vector<float> averages(npoints, 0.0f);
-
-   autocorrelations.clear();
-   autocorrelations.resize(npoints, 0.0f);
-
-   //compute averages
-   for (int pt = 0; pt<npoints; pt++) {
-	   int ptLat = pt / nlon;
-	   int ptLon = pt % nlon;
-	   float sum = 0.0f;
-	   if (validityMask[ptLat][ptLon]) {
-		   for (int t=0; t<ntime; t++) {
-			   sum += data[ptLat][ptLon][t];
-		   }
-		   averages[pt] = sum / ntime;
-	   }
-   }
-
-   float minval = 1.0;
-   float maxval = -1.0;
-
-   int currIteration = 0;
-   for (int x = 0; x<npoints; x++) {
-	   int xLat = x / nlon;
-	   int xLon = x % nlon;
-
-	   if (validityMask[xLat][xLon]) {
-		   //x starts with timestep 0, y starts with timestep 1, length ntime-1
-
-		   //adjust averages
-		   float avX = (averages[x] * ntime - data[xLat][xLon][ntime-1]) / (ntime-1);
-		   float avY = (averages[x] * ntime - data[xLat][xLon][0]) / (ntime-1);
-
-		   float nom = 0.0f;
-		   float denomX = 0.0f;
-		   float denomY = 0.0f;
-
-		   for (int t=0; t<ntime-1; t++) {
-			   float dx = data[xLat][xLon][t]-avX;
-			   float dy = data[xLat][xLon][t+1]-avY;
-			   nom += dx*dy;
-			   denomX += dx*dx;
-			   denomY += dy*dy;
-		   }
-
-		   float corrValue = nom / sqrt(denomX*denomY);
-		   autocorrelations[x] = corrValue;
-
-		   if (minval > corrValue) {
-			   minval = corrValue;
-		   }
-		   if (maxval < corrValue) {
-			   maxval = corrValue;
-		   }
-	   }
-	   currIteration++;
-	   progress_bar(currIteration, totalNumIterations);
-  }
-   std::cout << std::endl; // for the progress bar
-   std::cout << "min=" << minval << ", max=" << maxval << std::endl;
+				std::vector< std::vector<bool> >& validityMask,
+				unsigned threadCount) {
+
+	const size_t npoints = data.pointCount();
+
+	autocorrelations.clear();
+	autocorrelations.resize(npoints, 0.0f);
+
+	ProgressReporter progress(npoints);
+	VCGL::ThreadPool pool(threadCount);
+	autocorrelationsOfPoints(data, 0, validityMask, pool, progress, autocorrelations);
+	progress.finish();
+
+	reportAutocorrelationRange(autocorrelations, validityMask, data.nlon());
+}
+
+void computeAutocorrelations(VCGL::DataBandReader& bands,
+				std::vector<float> & autocorrelations,
+				std::vector< std::vector<bool> >& validityMask,
+				unsigned threadCount) {
+
+	autocorrelations.clear();
+	autocorrelations.resize(bands.pointCount(), 0.0f);
+
+	ProgressReporter progress(bands.pointCount());
+	VCGL::ThreadPool pool(threadCount);
+	VCGL::TimeSeriesField band;
+	size_t b = 0;
+	bands.rewind();
+	while (bands.next(band, &b)) {
+		autocorrelationsOfPoints(band, bands.pointBegin(b), validityMask, pool, progress, autocorrelations);
+	}
+	progress.finish();
+
+	reportAutocorrelationRange(autocorrelations, validityMask, bands.nlon());
 }
 
 void
-projectCorrelationMatrix(const std::vector< std::vector<float> >& correlations,
-		int nx, int ny, std::vector<VCGL::ProjectedPointInfo>& output) {
+projectCorrelationMatrix(const VCGL::SymmetricMatrix<float>& correlations,
+		int nx, int ny, std::vector<VCGL::ProjectedPointInfo>& output,
+		LSP::SammonObserver* pObserver, int firstIteration, unsigned threadCount,
+		LSP::SammonController* pController) {
 	VCGL::DistanceMatrix* pdmat = 0;
 	VCGL::DistanceMatrix::fromCorrelationMatrixArray(correlations, nx, ny, "correlation", &pdmat);
 
 	std::vector<VCGL::strType> ptNames;
 	pdmat->getObjectIDs(ptNames);
 
-	projectDMAT(ptNames, *pdmat, output);
-
+	//the projection keeps a copy of the distances, the matrix is not needed any more
+	LSP::ParallelSammon sammon(ptNames, *pdmat, threadCount);
 	delete pdmat;
 	pdmat = 0;
+
+	projectPoints(ptNames, sammon, output, pObserver, firstIteration, pController);
 }
 
 void
 projectDMAT(
 		const std::vector<VCGL::strType>& ids,
 		const VCGL::DistanceMatrix& dmat,
-		std::vector<VCGL::ProjectedPointInfo>& output) {
+		std::vector<VCGL::ProjectedPointInfo>& output,
+		LSP::SammonObserver* pObserver, int firstIteration, unsigned threadCount,
+		LSP::SammonController* pController) {
+	LSP::ParallelSammon sammon(ids, dmat, threadCount);
+	projectPoints(ids, sammon, output, pObserver, firstIteration, pController);
+}
+
+void
+projectPoints(
+		const std::vector<VCGL::strType>& ids,
+		LSP::ParallelSammon& sammon,
+		std::vector<VCGL::ProjectedPointInfo>& output,
+		LSP::SammonObserver* pObserver, int firstIteration, LSP::SammonController* pController) {
+	//the projection to continue from
+	QVector<LSP::TSPoint> projectedPoints;
+	if (firstIteration > 0 && output.size() == ids.size()) {
+		for (size_t i = 0; i<output.size(); i++) {
+			projectedPoints.push_back(output[i].pt);
+		}
+	}
 	output.clear();
 
 	const uint fieldsCount = ids.size();
@@ -215,8 +815,11 @@ projectDMAT(
 
 
 	//project all fields
-	QVector<LSP::TSPoint> projectedPoints;
-	LSP::Sammon::performSammonDMAT(ids, dmat, projectedPoints);
+	sammon.perform(projectedPoints, pObserver, firstIteration, pController);
+	if (pController && pController->converged()) {
+		std::cout << "Sammon's mapping converged after " << pController->iterations() << " iterations" << std::endl;
+	}
+	std::cout << "Sammon's stress: " << sammon.stress(projectedPoints) << std::endl;
 
 	const ulong outSize = output.size();
 	const ulong projSize = projectedPoints.size();
@@ -226,3 +829,215 @@ projectDMAT(
 		output[i].pt = projectedPoints[i];
 	}
 }
+
+std::size_t remapProjection(const std::vector<VCGL::ProjectedPointInfo>& previous,
+		const VCGL::GridSubsetRecord& previousSubset, std::size_t previousNlon,
+		const VCGL::GridSubsetRecord& subset, std::size_t nlat, std::size_t nlon, std::size_t fileNlon,
+		std::vector<VCGL::ProjectedPointInfo>& output) {
+	output.clear();
+	if (previousNlon == 0 || fileNlon == 0) {
+		return 0;
+	}
+
+	//the earlier points by their latitude and longitude in the data file
+	std::unordered_map<std::uint64_t, std::size_t> previousPoints;
+	const std::size_t previousNlat = previous.size() / previousNlon;
+	for (std::size_t lat = 0; lat<previousNlat; lat++) {
+		for (std::size_t lon = 0; lon<previousNlon; lon++) {
+			const std::uint64_t fileLat = previousSubset.latStart + lat*previousSubset.latStride;
+			const std::uint64_t fileLon = (previousSubset.lonStart + lon*previousSubset.lonStride) % fileNlon;
+			previousPoints[fileLat*fileNlon + fileLon] = lat*previousNlon + lon;
+		}
+	}
+
+	const std::size_t npoints = nlat*nlon;
+	std::vector<bool> placed(npoints, false);
+	std::vector<std::size_t> queue;
+	output.resize(npoints);
+	for (std::size_t j = 0; j<npoints; j++) {
+		const std::uint64_t fileLat = subset.latStart + (j / nlon)*subset.latStride;
+		const std::uint64_t fileLon = (subset.lonStart + (j % nlon)*subset.lonStride) % fileNlon;
+		const auto found = previousPoints.find(fileLat*fileNlon + fileLon);
+		if (found != previousPoints.end()) {
+			output[j].pt = previous[found->second].pt;
+			placed[j] = true;
+			queue.push_back(j);
+		}
+	}
+	const std::size_t matched = queue.size();
+	if (matched == 0) {
+		output.clear();
+		return 0;
+	}
+
+	//the other points from their neighbours, breadth first in the order of the grid
+	for (std::size_t next = 0; next<queue.size(); next++) {
+		const std::size_t j = queue[next];
+		const std::size_t lat = j / nlon;
+		const std::size_t lon = j % nlon;
+		const std::size_t neighbours[4] = {
+				lat > 0 ? j - nlon : j,
+				lon > 0 ? j - 1 : j,
+				lon+1 < nlon ? j + 1 : j,
+				lat+1 < nlat ? j + nlon : j };
+		for (std::size_t neighbour: neighbours) {
+			if (!placed[neighbour]) {
+				output[neighbour].pt = output[j].pt;
+				placed[neighbour] = true;
+				queue.push_back(neighbour);
+			}
+		}
+	}
+	return matched;
+}
+
+namespace {
+	/// Distances of the points of a correlation matrix
+	class CorrelationMatrixSource: public LSP::DistanceSource {
+	public:
+		explicit CorrelationMatrixSource(const VCGL::SymmetricMatrix<float>& correlations): correlations(correlations) {}
+
+		virtual size_t pointCount() const override { return correlations.size(); }
+
+		virtual void distances(size_t pt, size_t begin, size_t end, float* out) const override {
+			for (size_t q = begin; q<end; q++) {
+				out[q-begin] = VCGL::DistanceMatrix::distanceFromCorrelation(correlations(pt, q));
+			}
+		}
+
+	private:
+		const VCGL::SymmetricMatrix<float>& correlations;
+	};
+
+	/// Distances of the points from the correlations of their standardized series, as in computeCorrelations
+	class SeriesDistanceSource: public LSP::DistanceSource {
+	public:
+		explicit SeriesDistanceSource(const VCGL::StandardizedSeries& series)
+		: series(series), kernel(VCGL::CorrelationEngine::selectKernel()) {}
+
+		virtual size_t pointCount() const override { return series.pointCount(); }
+
+		virtual void distances(size_t pt, size_t begin, size_t end, float* out) const override {
+			const float* row = series.row(pt);
+			for (size_t q = begin; q<end; q++) {
+				float correlation = kernel.dot(row, series.row(q), series.stride());
+				if (series.hasGaps(pt) || series.hasGaps(q)) {
+					correlation = series.pairwiseComplete(pt, q, correlation);
+				}
+				out[q-begin] = VCGL::DistanceMatrix::distanceFromCorrelation(correlation);
+			}
+		}
+
+	private:
+		const VCGL::StandardizedSeries& series;
+		const VCGL::CorrelationKernel& kernel;
+	};
+
+	/// Sammon's stress of the projection of the points over all pairs, with distance(x, y) for y < x
+	template<typename Distance>
+	double projectionStress(const QVector<LSP::TSPoint>& points, Distance distance) {
+		double sum = 0.0;
+		double distances = 0.0;
+		for (size_t x = 0; x<static_cast<size_t>(points.size()); x++) {
+			for (size_t y = 0; y<x; y++) {
+				const double d = distance(x, y);
+				if (d <= 0.0) {
+					continue;
+				}
+				const double dx = points[x].getX() - points[y].getX();
+				const double dy = points[x].getY() - points[y].getY();
+				const double D = std::sqrt(dx*dx + dy*dy);
+				sum += (d - D)*(d - D) / d;
+				distances += d;
+			}
+		}
+		return distances > 0.0 ? sum / distances : 0.0;
+	}
+
+	/// projectionStress of the points of a correlation matrix
+	double correlationStress(const VCGL::SymmetricMatrix<float>& correlations, const QVector<LSP::TSPoint>& points) {
+		const VCGL::SymmetricMatrixView<float> view = correlations.view();
+		return projectionStress(points, [&view](size_t x, size_t y) {
+			return VCGL::DistanceMatrix::distanceFromCorrelation(view.triangleRow(x)[y]);
+		});
+	}
+
+	/// The projection as the points of the output, named by names
+	void storeProjection(const std::vector<VCGL::strType>& names, const QVector<LSP::TSPoint>& projectedPoints,
+			std::vector<VCGL::ProjectedPointInfo>& output) {
+		assert(names.size() == static_cast<size_t>(projectedPoints.size()));
+		output.clear();
+		output.resize(names.size());
+		for (size_t i = 0; i<output.size(); i++) {
+			output[i].name = names[i];
+			output[i].pt = projectedPoints[i];
+		}
+	}
+
+	/// Projection through the landmarks, named as the points of the grid
+	QVector<LSP::TSPoint> projectThroughLandmarks(const LSP::DistanceSource& source, int nx, int ny,
+			size_t landmarkCount, std::vector<VCGL::ProjectedPointInfo>& output, unsigned threadCount) {
+		std::vector<VCGL::strType> ptNames;
+		VCGL::DistanceMatrix::gridObjectIDs(nx, ny, ptNames);
+		assert(ptNames.size() == source.pointCount());
+
+		std::cout << ptNames.size() << " points to project through " << std::min(landmarkCount, ptNames.size())
+				<< " landmarks..." << std::endl;
+		LSP::LandmarkProjection projection(source, landmarkCount, threadCount);
+		QVector<LSP::TSPoint> projectedPoints;
+		projection.perform(projectedPoints);
+		std::cout << "Sammon's stress over the pairs with a landmark: " << projection.landmarkStress(projectedPoints) << std::endl;
+
+		storeProjection(ptNames, projectedPoints, output);
+		return projectedPoints;
+	}
+}
+
+void projectCorrelationMatrixMDS(const VCGL::SymmetricMatrix<float>& correlations,
+		int nx, int ny, std::vector<VCGL::ProjectedPointInfo>& output, unsigned threadCount) {
+	std::vector<VCGL::strType> ptNames;
+	VCGL::DistanceMatrix::gridObjectIDs(nx, ny, ptNames);
+	std::cout << ptNames.size() << " points to project with classical MDS..." << std::endl;
+
+	LSP::ClassicalMDS mds(correlations.view(), LSP::ClassicalMDS::CORRELATIONS, threadCount);
+	QVector<LSP::TSPoint> projectedPoints;
+	mds.perform(projectedPoints);
+	std::cout << "Sammon's stress: " << correlationStress(correlations, projectedPoints) << std::endl;
+
+	storeProjection(ptNames, projectedPoints, output);
+}
+
+void projectDMATMDS(const VCGL::DistanceMatrix& dmat, std::vector<VCGL::ProjectedPointInfo>& output,
+		unsigned threadCount) {
+	std::vector<VCGL::strType> ids;
+	dmat.getObjectIDs(ids);
+	std::cout << ids.size() << " points to project with classical MDS..." << std::endl;
+
+	const VCGL::SymmetricMatrixView<float> distances = dmat.distanceView();
+	LSP::ClassicalMDS mds(distances, LSP::ClassicalMDS::DISTANCES, threadCount);
+	QVector<LSP::TSPoint> projectedPoints;
+	mds.perform(projectedPoints);
+	std::cout << "Sammon's stress: " << projectionStress(projectedPoints, [&distances](size_t x, size_t y) {
+		return distances.triangleRow(x)[y];
+	}) << std::endl;
+
+	storeProjection(ids, projectedPoints, output);
+}
+
+void projectLandmarks(const VCGL::SymmetricMatrix<float>& correlations,
+		int nx, int ny, size_t landmarkCount, std::vector<VCGL::ProjectedPointInfo>& output,
+		unsigned threadCount) {
+	const CorrelationMatrixSource source(correlations);
+	const QVector<LSP::TSPoint> projectedPoints = projectThroughLandmarks(source, nx, ny, landmarkCount, output, threadCount);
+	std::cout << "Sammon's stress: " << correlationStress(correlations, projectedPoints) << std::endl;
+}
+
+void projectLandmarks(const VCGL::TimeSeriesField& data,
+		const std::vector< std::vector<bool> >& validityMask,
+		size_t landmarkCount, std::vector<VCGL::ProjectedPointInfo>& output,
+		unsigned threadCount) {
+	VCGL::StandardizedSeries series;
+	series.assign(data, validityMask);
+	const SeriesDistanceSource source(series);
+	projectThroughLandmarks(source, data.nlon(), data.nlat(), landmarkCount, output, threadCount);
+}
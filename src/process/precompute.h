@@ -9,37 +9,368 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 
 #include "typedefs.h"
+#include "symmetricmatrix.h"
+#include "timeseriesfield.h"
 #include "projection/projectedpointinfo.h"
 
+namespace LSP {
+	struct SammonObserver;
+	class SammonController;
+	class ParallelSammon;
+}
+
 namespace VCGL {
 	struct ProjectedPointInfo;
+	struct GridSubsetRecord;
 	class DistanceMatrix;
+	class DataBandReader;
+	struct SparseCorrelationRows;
+
+	/// Parameters of a precompute run (given on the command line)
+	struct PrecomputeOptions {
+		unsigned threadCount;	///< number of threads for the parallel stages (0 - one per hardware thread)
+		std::size_t memoryBudget;	///< bytes; 0 - keep the whole correlation matrix in memory, otherwise stream it to disk
+		bool teleconnectivityOnly;	///< compute only teleconnectivity and autocorrelations, store no correlations
+		std::size_t lowestCount;	///< keep only this many lowest correlations per point (0 - store all correlations)
+		std::size_t highestCount;	///< with lowestCount, keep also this many highest correlations per point
+		bool update;	///< read only the time steps added since the last run, using the stored statistics
+		int maxLag;	///< also compute the lagged correlations over lags -maxLag..maxLag (0 - no lagged correlations)
+		std::size_t cacheBudget;	///< bytes of the cache of precomputed files (0 - do not use the cache, the default)
+		unsigned checkpointInterval;	///< seconds between two saves of the progress (0 - no checkpoints)
+		bool resume;	///< continue from the checkpoint of an interrupted run of the same precompute
+		unsigned shardIndex;	///< with shardCount, the part of the correlations this run computes
+		unsigned shardCount;	///< compute only shard shardIndex of this many parts of the correlations (0 - all)
+		bool merge;	///< read the correlations from the shards computed before instead of computing them
+		bool compress;	///< store the correlations compressed (CompressedCorrelationStore) instead of as a triangle
+		std::uint32_t dtype;	///< type the values of the triangle are stored as (CorrelationDataType, 1 - float32)
+		std::size_t landmarkCount;	///< project through this many landmarks (LSP::LandmarkProjection, 0 - Sammon's mapping of all pairs)
+		bool classicalMDS;	///< project with classical MDS (LSP::ClassicalMDS) instead of Sammon's mapping
+		double sammonTolerance;	///< stop Sammon's mapping below this relative improvement of the stress (LSP::SammonController, 0 - all iterations)
+		std::string warmStart;	///< projection file of an earlier precompute to refine instead of a random start (empty - none)
+
+		PrecomputeOptions(): threadCount(1), memoryBudget(0), teleconnectivityOnly(false),
+				lowestCount(0), highestCount(0), update(false), maxLag(0),
+				cacheBudget(0), checkpointInterval(600), resume(false),
+				shardIndex(0), shardCount(0), merge(false), compress(false), dtype(1), landmarkCount(0),
+				classicalMDS(false), sammonTolerance(0.0) {}
+	};
+
+	/// Receives the lower triangle of the correlation matrix in consecutive blocks of rows
+	struct CorrelationRowConsumer {
+		virtual ~CorrelationRowConsumer() {}
+
+		/*! @brief Process rows [rowBegin, rowEnd) of the lower triangle
+		 *
+		 * @param values Packed rows: row x holds the x correlations with points 0..x-1
+		 * 				and starts at values + triangleOffset(x) - triangleOffset(rowBegin)
+		 */
+		virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) = 0;
+	};
+
+	/*! @brief Most negative correlation of every point, collected from streamed rows or single values.
+	 *
+	 * Ties are resolved towards the smaller point index, and a point with no
+	 * correlation below 1 is its own partner, as in ExplorationModelImpl::computeTeleconnectivity.
+	 * The result does not depend on the order in which the values are offered.
+	 */
+	class TeleconnectivityMinima: public CorrelationRowConsumer {
+	public:
+		explicit TeleconnectivityMinima(std::size_t npoints);
+
+		virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) override;
+
+		/// Minimal correlation of each point with any other point
+		const std::vector<float>& minima() const { return minCorrelations; }
+		/// Index of the point with which the minimal correlation is reached
+		const std::vector<int>& partners() const { return partnerIndices; }
+
+		/// Write the collected minima, e.g. to a checkpoint
+		void saveState(std::ostream& out) const;
+		/// Continue from minima written by saveState, false if they do not fit the number of points
+		bool restoreState(std::istream& in);
+
+		/// Take into account correlation value of point pt with point other
+		void offer(std::size_t pt, std::size_t other, float value) {
+			const int otherIndex = static_cast<int>(other);
+			if (value < minCorrelations[pt] ||
+					(value == minCorrelations[pt] && otherIndex < partnerIndices[pt] && partnerIndices[pt] != static_cast<int>(pt))) {
+				minCorrelations[pt] = value;
+				partnerIndices[pt] = otherIndex;
+			}
+		}
+
+	private:
+
+		std::vector<float> minCorrelations;
+		std::vector<int> partnerIndices;
+	};
+
+	/*! @brief The k lowest (most negative) and optionally the k highest correlations of every point
+	 *
+	 * Ties are resolved towards the smaller point index, so the lowest kept
+	 * correlation of a point is its teleconnectivity partner, as in TeleconnectivityMinima.
+	 * Memory is proportional to the number of points times k.
+	 */
+	class TopCorrelations: public CorrelationRowConsumer {
+	public:
+		TopCorrelations(std::size_t npoints, std::size_t lowestCount, std::size_t highestCount = 0);
+
+		virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) override;
+
+		/// Kept correlations as sparse rows; a pair kept by either of its points is in both rows
+		void collect(SparseCorrelationRows& rows) const;
+
+		/// Write the kept correlations, e.g. to a checkpoint
+		void saveState(std::ostream& out) const;
+		/// Continue from correlations written by saveState, false if they do not fit the counts
+		bool restoreState(std::istream& in);
+
+	private:
+		struct Candidate {
+			float value;
+			std::uint32_t index;
+		};
+
+		void offer(std::size_t pt, std::size_t other, float value);
+
+		std::size_t npoints;
+		std::size_t nLowest;
+		std::size_t nHighest;
+		std::vector<Candidate> lowest;	///< nLowest per point, heap with the highest value on top
+		std::vector<Candidate> highest;	///< nHighest per point, heap with the lowest value on top
+		std::vector<std::uint32_t> lowestSize;
+		std::vector<std::uint32_t> highestSize;
+	};
+
+	/// Fills the distances of a DistanceMatrix (the Sammon input) from streamed rows
+	class DistanceMatrixFiller: public CorrelationRowConsumer {
+	public:
+		/// @param dmat Matrix with one object per point, e.g. created with DistanceMatrix::forGrid
+		explicit DistanceMatrixFiller(DistanceMatrix& dmat): dmat(dmat) {}
+
+		virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) override;
+
+	private:
+		DistanceMatrix& dmat;
+	};
+
+	/// Passes every block of rows on to several consumers, in the order they were added
+	class CorrelationRowFanOut: public CorrelationRowConsumer {
+	public:
+		void add(CorrelationRowConsumer& consumer) { consumers.push_back(&consumer); }
+
+		virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) override;
+
+	private:
+		std::vector<CorrelationRowConsumer*> consumers;
+	};
 }
 
 
 /** @brief Compute correlation matrix of all pairs of time series
+ *
+ * The result does not depend on the number of threads.
  *
  * @param data 3D data array, indices LAT, LON, TIME
- * @param correlationMatrix output - symmetric square matrix with correlations
+ * @param correlationMatrix output - symmetric matrix with correlations
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param threadCount number of threads (0 - one per hardware thread)
  */
 void computeCorrelations(
-		const std::vector< std::vector< std::vector<float> > >& data,
-		std::vector< std::vector<float> >& correlationMatrix,
-		std::vector< std::vector<bool> >& validityMask);
+		const VCGL::TimeSeriesField& data,
+		VCGL::SymmetricMatrix<float>& correlationMatrix,
+		std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount = 1);
+
+/** @brief Compute the correlation matrix block by block, without holding it in memory
+ *
+ * Rows of the lower triangle are computed in blocks sized to the memory budget and
+ * passed to the consumer in order. Values are identical to computeCorrelations.
+ *
+ * @param data 3D data array, indices LAT, LON, TIME
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param memoryBudget bytes available for the standardized series and one block of rows
+ * @param threadCount number of threads (0 - one per hardware thread)
+ * @param consumer receiver of the row blocks
+ * @param firstRow first row to compute, e.g. to continue from a checkpoint
+ * @param lastRow row after the last row to compute, e.g. for a shard (at most the number of points)
+ */
+void computeCorrelationsStreaming(
+		const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		std::size_t memoryBudget,
+		unsigned threadCount,
+		VCGL::CorrelationRowConsumer& consumer,
+		std::size_t firstRow = 0,
+		std::size_t lastRow = std::size_t(-1));
+
+/** @brief Compute the teleconnectivity of every point without keeping any correlations
+ *
+ * Correlations are computed tile by tile as in computeCorrelations and reduced
+ * to row and column minima right away. The result does not depend on the number of threads.
+ *
+ * @param data 3D data array, indices LAT, LON, TIME
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param threadCount number of threads (0 - one per hardware thread)
+ * @param minima output - most negative correlation and its partner for each point
+ */
+void computeTeleconnectivityMinima(
+		const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount,
+		VCGL::TeleconnectivityMinima& minima);
+
+/** @brief Compute the teleconnectivity of every point, reading the data band by band
+ *
+ * Every pair of bands is read and standardized together: two bands, their
+ * concatenation and its standardized copy, about four bands, are in memory
+ * at a time, and band i is read nbands-i+1 times.
+ * The result is the same as that of computeTeleconnectivityMinima on the whole data.
+ *
+ * @param bands reader of the data
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param threadCount number of threads (0 - one per hardware thread)
+ * @param minima output - most negative correlation and its partner for each point
+ */
+void computeTeleconnectivityMinima(
+		VCGL::DataBandReader& bands,
+		std::vector< std::vector<bool> >& validityMask,
+		unsigned threadCount,
+		VCGL::TeleconnectivityMinima& minima);
+
+/** @brief Mark the points which have enough valid (not NaN) time steps
+ *
+ * Missing values (see NCFileDataStorage) are stored as NaN. Points with gaps
+ * that stay valid get pairwise-complete correlations (see VCGL::StandardizedSeries).
+ *
+ * @param data 3D data array, indices LAT, LON, TIME
+ * @param validityMask output - flags for the points to be used, indices LAT, LON
+ * @param minValidFraction smallest fraction of valid time steps of a point to be used
+ */
+void computeValidityMask(const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<bool> >& validityMask,
+		float minValidFraction = 0.5f);
 
-void computeAutocorrelations(const std::vector< std::vector< std::vector<float> > >& data,
+/// computeValidityMask reading the data band by band
+void computeValidityMask(VCGL::DataBandReader& bands,
+		std::vector< std::vector<bool> >& validityMask,
+		float minValidFraction = 0.5f);
+
+/** @brief Compute lag-1 autocorrelation of every time series
+ *
+ * Series with missing values use the pairs of consecutive steps which are both valid.
+ *
+ * @param data 3D data array, indices LAT, LON, TIME
+ * @param autocorrelations output - autocorrelation for each point id = iLat*nlon + iLon
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ * @param threadCount number of threads (0 - one per hardware thread)
+ */
+void computeAutocorrelations(const VCGL::TimeSeriesField& data,
+				std::vector<float> & autocorrelations,
+				std::vector< std::vector<bool> >& validityMask,
+				unsigned threadCount = 1);
+
+/// computeAutocorrelations reading the data band by band
+void computeAutocorrelations(VCGL::DataBandReader& bands,
 				std::vector<float> & autocorrelations,
-				std::vector< std::vector<bool> >& validityMask);
+				std::vector< std::vector<bool> >& validityMask,
+				unsigned threadCount = 1);
 
+/*! @brief Project the points with Sammon's mapping of their correlation distances
+ *
+ * The mapping is LSP::ParallelSammon, its result does not depend on the number of threads.
+ *
+ * @param output Projected points; with firstIteration > 0 also the projection to continue from
+ * @param pObserver Receiver of the projection after every iteration (optional)
+ * @param firstIteration Iteration to continue from, see LSP::Sammon::performSammonDMAT
+ * @param threadCount number of threads (0 - one per hardware thread)
+ * @param pController Schedule, progress and cancellation of the iterations (optional)
+ */
 void
-projectCorrelationMatrix(const std::vector< std::vector<float> >& correlations,
-		int nx, int ny, std::vector<VCGL::ProjectedPointInfo>& output);
+projectCorrelationMatrix(const VCGL::SymmetricMatrix<float>& correlations,
+		int nx, int ny, std::vector<VCGL::ProjectedPointInfo>& output,
+		LSP::SammonObserver* pObserver = 0, int firstIteration = 0, unsigned threadCount = 1,
+		LSP::SammonController* pController = 0);
 
+/// projectCorrelationMatrix for a distance matrix
 void projectDMAT(
 		const std::vector<VCGL::strType>& ids,
 		const VCGL::DistanceMatrix& dmat,
+		std::vector<VCGL::ProjectedPointInfo>& output,
+		LSP::SammonObserver* pObserver = 0, int firstIteration = 0, unsigned threadCount = 1,
+		LSP::SammonController* pController = 0);
+
+/// projectDMAT with the mapping set up for the objects ids
+void projectPoints(
+		const std::vector<VCGL::strType>& ids,
+		LSP::ParallelSammon& sammon,
+		std::vector<VCGL::ProjectedPointInfo>& output,
+		LSP::SammonObserver* pObserver = 0, int firstIteration = 0, LSP::SammonController* pController = 0);
+
+/*! @brief Projection of a grid remapped from the projection of another part of the same data file
+ *
+ * Starting layout of Sammon's mapping (LSP::SammonController::warmStartIteration). The points
+ * are matched by their latitude and longitude in the data file. Every other point starts at
+ * the position of the nearest matched point, the first one reached over neighbouring points
+ * of the grid.
+ *
+ * @param previous Earlier projection, latitude by latitude
+ * @param previousSubset Part of the data file of the earlier projection
+ * @param previousNlon Number of its longitudes
+ * @param subset Part of the data file of the projection to start
+ * @param nlat Number of its latitudes
+ * @param nlon Number of its longitudes
+ * @param fileNlon Number of longitudes of the data file, after which they wrap around
+ * @param output (output) Starting projection of the nlat*nlon points, empty if no point matched
+ * @return Number of matched points
+ */
+std::size_t remapProjection(const std::vector<VCGL::ProjectedPointInfo>& previous,
+		const VCGL::GridSubsetRecord& previousSubset, std::size_t previousNlon,
+		const VCGL::GridSubsetRecord& subset, std::size_t nlat, std::size_t nlon, std::size_t fileNlon,
 		std::vector<VCGL::ProjectedPointInfo>& output);
 
+/*! @brief Project the points with classical MDS (LSP::ClassicalMDS) of their correlation distances
+ *
+ * Reports Sammon's stress of the projection, comparable to that of projectCorrelationMatrix.
+ *
+ * @param output Projected points
+ * @param threadCount number of threads (0 - one per hardware thread)
+ */
+void projectCorrelationMatrixMDS(const VCGL::SymmetricMatrix<float>& correlations,
+		int nx, int ny, std::vector<VCGL::ProjectedPointInfo>& output, unsigned threadCount = 1);
+
+/// projectCorrelationMatrixMDS for a distance matrix
+void projectDMATMDS(const VCGL::DistanceMatrix& dmat, std::vector<VCGL::ProjectedPointInfo>& output,
+		unsigned threadCount = 1);
+
+/*! @brief Project the points through landmarks (LSP::LandmarkProjection) of their correlation distances
+ *
+ * Reports the stress over all pairs as well, comparable to that of projectCorrelationMatrix.
+ *
+ * @param landmarkCount number of landmarks
+ * @param output Projected points
+ * @param threadCount number of threads (0 - one per hardware thread)
+ */
+void projectLandmarks(const VCGL::SymmetricMatrix<float>& correlations,
+		int nx, int ny, std::size_t landmarkCount, std::vector<VCGL::ProjectedPointInfo>& output,
+		unsigned threadCount = 1);
+
+/*! @brief projectLandmarks with the correlations to the landmarks computed from the data
+ *
+ * Needs 4*N*k bytes for N points and k landmarks besides the data, and no correlation matrix.
+ * Only the stress over the pairs with a landmark is reported.
+ *
+ * @param data 3D data array, indices LAT, LON, TIME
+ * @param validityMask flags for the points to be used, indices LAT, LON
+ */
+void projectLandmarks(const VCGL::TimeSeriesField& data,
+		const std::vector< std::vector<bool> >& validityMask,
+		std::size_t landmarkCount, std::vector<VCGL::ProjectedPointInfo>& output,
+		unsigned threadCount = 1);
+
 #endif // PRECOMPUTE_H_
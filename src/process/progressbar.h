@@ -10,10 +10,11 @@
 
 #include <iostream>
 #include <iomanip>
+#include <mutex>
 
 inline void progress_bar(unsigned int x, unsigned int n, unsigned int w = 50)
 {
-    if ( (x != n) && (x % (n/100) != 0) ) return;
+    if ( (x != n) && (n >= 100) && (x % (n/100) != 0) ) return;
 
     float ratio  =  x/(float)n;
     unsigned   c      =  ratio * w;
@@ -25,5 +26,48 @@ inline void progress_bar(unsigned int x, unsigned int n, unsigned int w = 50)
     std::cout << "]" << std::flush;
 }
 
+/*! @brief Progress reporting for work done in chunks of varying size
+ *
+ * progress_bar() redraws only on exact percent boundaries,
+ * which chunked counters rarely hit; this class redraws whenever
+ * the completed percentage changes. It can be shared between threads.
+ */
+class ProgressReporter {
+public:
+	explicit ProgressReporter(unsigned long long total)
+	: total(total), done(0), lastPercent(-1) {
+		draw();
+	}
+
+	/// Account for another completed chunk of work
+	void advance(unsigned long long amount) {
+		std::lock_guard<std::mutex> lock(m);
+		done += amount;
+		draw();
+	}
+
+	/// Finish the progress bar line
+	void finish() {
+		std::lock_guard<std::mutex> lock(m);
+		done = total;
+		draw();
+		std::cout << std::endl;
+	}
+
+private:
+	void draw() {
+		const int percent = (total > 0) ? static_cast<int>(done*100/total) : 100;
+		if (percent != lastPercent) {
+			lastPercent = percent;
+			progress_bar(percent, 100);
+		}
+	}
+
+	std::mutex m;
+	unsigned long long total;
+	unsigned long long done;
+	int lastPercent;
+};
+
 
 #endif // PROGRESSBAR_H_
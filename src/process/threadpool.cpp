@@ -0,0 +1,136 @@
+/*!	@file threadpool.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Work-stealing thread pool for the precompute stages
+ */
+
+#include "threadpool.h"
+
+#include <algorithm>
+
+namespace VCGL {
+
+ThreadPool::ThreadPool(unsigned threadCount)
+: nthreads(threadCount ? threadCount : hardwareThreads()),
+  queues(nthreads),
+  generation(0),
+  busyWorkers(0),
+  bStopping(false),
+  pTask(0) {
+	for (unsigned id = 1; id<nthreads; id++) {
+		threads.push_back(std::thread(&ThreadPool::workerLoop, this, id));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m);
+		bStopping = true;
+	}
+	cvStart.notify_all();
+	for (unsigned j=0; j<threads.size(); j++) {
+		threads[j].join();
+	}
+}
+
+unsigned ThreadPool::hardwareThreads() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task) {
+	if (taskCount == 0) {
+		return;
+	}
+
+	// deal out round robin, so that expensive tasks at the front are spread over all workers
+	for (unsigned id = 0; id<nthreads; id++) {
+		std::lock_guard<std::mutex> lock(queues[id].m);
+		queues[id].indices.clear();
+		for (std::size_t i = id; i<taskCount; i+=nthreads) {
+			queues[id].indices.push_front(i); // back of the deque is taken first
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m);
+		pTask = &task;
+		firstError = std::exception_ptr();
+		busyWorkers = nthreads-1;
+		generation++;
+	}
+	cvStart.notify_all();
+
+	runTasks(0);
+
+	std::unique_lock<std::mutex> lock(m);
+	cvDone.wait(lock, [this]{ return busyWorkers == 0; });
+	pTask = 0;
+
+	if (firstError) {
+		std::exception_ptr error = firstError;
+		firstError = std::exception_ptr();
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::workerLoop(unsigned id) {
+	unsigned long seenGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m);
+			cvStart.wait(lock, [&]{ return bStopping || generation != seenGeneration; });
+			if (bStopping) {
+				return;
+			}
+			seenGeneration = generation;
+		}
+
+		runTasks(id);
+
+		{
+			std::lock_guard<std::mutex> lock(m);
+			busyWorkers--;
+		}
+		cvDone.notify_one();
+	}
+}
+
+void ThreadPool::runTasks(unsigned id) {
+	std::size_t index = 0;
+	while (takeTask(id, &index)) {
+		try {
+			(*pTask)(index);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(m);
+			if (!firstError) {
+				firstError = std::current_exception();
+			}
+		}
+	}
+}
+
+bool ThreadPool::takeTask(unsigned id, std::size_t* pIndex) {
+	{
+		WorkQueue& own = queues[id];
+		std::lock_guard<std::mutex> lock(own.m);
+		if (!own.indices.empty()) {
+			*pIndex = own.indices.back();
+			own.indices.pop_back();
+			return true;
+		}
+	}
+	// steal from the other workers, starting with the next one
+	for (unsigned k = 1; k<nthreads; k++) {
+		WorkQueue& victim = queues[(id+k) % nthreads];
+		std::lock_guard<std::mutex> lock(victim.m);
+		if (!victim.indices.empty()) {
+			*pIndex = victim.indices.front();
+			victim.indices.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace VCGL
@@ -0,0 +1,83 @@
+/*!	@file threadpool.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Work-stealing thread pool for the precompute stages
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <exception>
+
+namespace VCGL {
+
+/*! @brief Fixed set of worker threads executing indexed tasks.
+ *
+ * Each worker owns a deque of task indices, takes work from its back
+ * and, when empty, steals from the front of the other workers' deques.
+ * The calling thread takes part as worker 0, so a pool of one thread
+ * runs everything inline.
+ */
+class ThreadPool {
+public:
+	/*! @brief Constructor
+	 *
+	 * @param threadCount Number of threads including the calling one (0 - one per hardware thread)
+	 */
+	explicit ThreadPool(unsigned threadCount = 1);
+	~ThreadPool();
+
+	/// Number of threads taking part in parallelFor (including the calling thread)
+	unsigned threadCount() const { return nthreads; }
+
+	/*! @brief Run task(i) for every i in [0, taskCount) and wait for completion
+	 *
+	 * Tasks are dealt out round robin and each worker runs its share in
+	 * index order, so ordering tasks from the most to the least expensive
+	 * gives the best balance.
+	 * The first exception thrown by a task is rethrown here after all
+	 * workers have stopped.
+	 */
+	void parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+	/// Number of hardware threads (at least 1)
+	static unsigned hardwareThreads();
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	struct WorkQueue {
+		std::mutex m;
+		std::deque<std::size_t> indices;
+	};
+
+	void workerLoop(unsigned id);
+	void runTasks(unsigned id);
+	bool takeTask(unsigned id, std::size_t* pIndex);
+
+	unsigned nthreads;
+	std::vector<std::thread> threads;
+	std::vector<WorkQueue> queues;
+
+	std::mutex m;
+	std::condition_variable cvStart;
+	std::condition_variable cvDone;
+	unsigned long generation;	///< incremented for each parallelFor call
+	unsigned busyWorkers;		///< background workers still running the current call
+	bool bStopping;
+
+	const std::function<void(std::size_t)>* pTask;
+	std::exception_ptr firstError;
+};
+
+} // namespace VCGL
+
+#endif // THREADPOOL_H_
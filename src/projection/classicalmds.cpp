@@ -0,0 +1,259 @@
+/*!	@file classicalmds.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Classical multidimensional scaling with a randomized eigensolver
+ */
+
+#include "classicalmds.h"
+
+#include "process/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace LSP {
+
+namespace {
+	const std::size_t P = ClassicalMDS::SUBSPACE_SIZE;
+
+	/// Subtract the mean of every column of an N x P matrix stored row by row
+	void centerColumns(std::vector<double>& m) {
+		const std::size_t n = m.size() / P;
+		double mean[P] = {};
+		for (std::size_t i = 0; i<n; i++) {
+			for (std::size_t c = 0; c<P; c++) {
+				mean[c] += m[i*P + c];
+			}
+		}
+		for (std::size_t c = 0; c<P; c++) {
+			mean[c] /= n;
+		}
+		for (std::size_t i = 0; i<n; i++) {
+			for (std::size_t c = 0; c<P; c++) {
+				m[i*P + c] -= mean[c];
+			}
+		}
+	}
+
+	/// Orthonormalize the columns of an N x P matrix (modified Gram-Schmidt, twice for accuracy)
+	void orthonormalize(std::vector<double>& m) {
+		const std::size_t n = m.size() / P;
+		for (int pass = 0; pass<2; pass++) {
+			for (std::size_t c = 0; c<P; c++) {
+				for (std::size_t prev = 0; prev<c; prev++) {
+					double dot = 0.0;
+					for (std::size_t i = 0; i<n; i++) {
+						dot += m[i*P + c] * m[i*P + prev];
+					}
+					for (std::size_t i = 0; i<n; i++) {
+						m[i*P + c] -= dot * m[i*P + prev];
+					}
+				}
+				double norm = 0.0;
+				for (std::size_t i = 0; i<n; i++) {
+					norm += m[i*P + c] * m[i*P + c];
+				}
+				norm = std::sqrt(norm);
+				for (std::size_t i = 0; i<n; i++) {
+					m[i*P + c] = norm > 0.0 ? m[i*P + c] / norm : 0.0;
+				}
+			}
+		}
+	}
+
+	/*! @brief Eigenvalues and eigenvectors of a symmetric P x P matrix (cyclic Jacobi)
+	 *
+	 * @param a The matrix, row by row (destroyed)
+	 * @param values Receives the eigenvalues
+	 * @param vectors Receives the eigenvectors as columns, row by row
+	 */
+	void symmetricEigen(std::vector<double>& a, std::vector<double>& values, std::vector<double>& vectors) {
+		vectors.assign(P*P, 0.0);
+		for (std::size_t c = 0; c<P; c++) {
+			vectors[c*P + c] = 1.0;
+		}
+		for (int sweep = 0; sweep<100; sweep++) {
+			double offDiagonal = 0.0;
+			for (std::size_t p = 0; p<P; p++) {
+				for (std::size_t q = p+1; q<P; q++) {
+					offDiagonal += a[p*P + q] * a[p*P + q];
+				}
+			}
+			if (offDiagonal < 1e-30) {
+				break;
+			}
+			for (std::size_t p = 0; p<P; p++) {
+				for (std::size_t q = p+1; q<P; q++) {
+					if (a[p*P + q] == 0.0) {
+						continue;
+					}
+					const double theta = (a[q*P + q] - a[p*P + p]) / (2.0 * a[p*P + q]);
+					const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta*theta + 1.0));
+					const double cs = 1.0 / std::sqrt(t*t + 1.0);
+					const double sn = t * cs;
+					for (std::size_t k = 0; k<P; k++) {
+						const double akp = a[k*P + p];
+						const double akq = a[k*P + q];
+						a[k*P + p] = cs*akp - sn*akq;
+						a[k*P + q] = sn*akp + cs*akq;
+					}
+					for (std::size_t k = 0; k<P; k++) {
+						const double apk = a[p*P + k];
+						const double aqk = a[q*P + k];
+						a[p*P + k] = cs*apk - sn*aqk;
+						a[q*P + k] = sn*apk + cs*aqk;
+					}
+					for (std::size_t k = 0; k<P; k++) {
+						const double vkp = vectors[k*P + p];
+						const double vkq = vectors[k*P + q];
+						vectors[k*P + p] = cs*vkp - sn*vkq;
+						vectors[k*P + q] = sn*vkp + cs*vkq;
+					}
+				}
+			}
+		}
+		values.resize(P);
+		for (std::size_t c = 0; c<P; c++) {
+			values[c] = a[c*P + c];
+		}
+	}
+}
+
+ClassicalMDS::ClassicalMDS(const VCGL::SymmetricMatrixView<float>& matrix, Values values, unsigned threadCount)
+: matrix(matrix), offset(values == CORRELATIONS ? 0.5 : 0.0), scale(values == CORRELATIONS ? -0.5 : 1.0),
+  threadCount(threadCount) {}
+
+void ClassicalMDS::multiply(const std::vector<double>& in, std::vector<double>& out, VCGL::ThreadPool& pool) const {
+	const std::size_t n = matrix.size();
+
+	// B * in = -1/2 J D2 J in
+	std::vector<double> centered = in;
+	centerColumns(centered);
+
+	out.assign(n*P, 0.0);
+	pool.parallelFor((n + ROWS_PER_TASK - 1) / ROWS_PER_TASK, [&](std::size_t task) {
+		const std::size_t begin = task*ROWS_PER_TASK;
+		const std::size_t end = std::min(n, begin + ROWS_PER_TASK);
+		// local sums, which the compiler keeps apart from the input
+		std::vector<double> sums((end - begin)*P, 0.0);
+		// every row sums over the columns in increasing order: first its stored part...
+		for (std::size_t i = begin; i<end; i++) {
+			const float* row = matrix.triangleRow(i);
+			double acc[P] = {};
+			for (std::size_t j = 0; j<i; j++) {
+				const double d2 = squaredDistance(row[j]);
+				const double* x = &centered[j*P];
+				for (std::size_t c = 0; c<P; c++) {
+					acc[c] += d2 * x[c];
+				}
+			}
+			std::copy(acc, acc + P, &sums[(i-begin)*P]);
+		}
+		// ...then the columns after it, stored in the rows below
+		for (std::size_t j = begin+1; j<n; j++) {
+			const float* row = matrix.triangleRow(j);
+			double x[P];
+			std::copy(&centered[j*P], &centered[j*P] + P, x);
+			const std::size_t iEnd = std::min(end, j);
+			for (std::size_t i = begin; i<iEnd; i++) {
+				const double d2 = squaredDistance(row[i]);
+				double* acc = &sums[(i-begin)*P];
+				for (std::size_t c = 0; c<P; c++) {
+					acc[c] += d2 * x[c];
+				}
+			}
+		}
+		std::copy(sums.begin(), sums.end(), &out[begin*P]);
+	});
+
+	centerColumns(out);
+	for (std::size_t k = 0; k<out.size(); k++) {
+		out[k] *= -0.5;
+	}
+}
+
+void ClassicalMDS::perform(QVector<TSPoint>& outPointsProjection) {
+	const std::size_t n = matrix.size();
+	outPointsProjection.clear();
+	leading.assign(2, 0.0);
+	if (n < 2) {
+		outPointsProjection.resize(static_cast<int>(n));
+		return;
+	}
+
+	VCGL::ThreadPool pool(threadCount);
+
+	// random start, the same on every platform
+	std::mt19937 rng(1);
+	std::vector<double> q(n*P);
+	for (std::size_t k = 0; k<q.size(); k++) {
+		q[k] = rng() / 4294967296.0 - 0.5;
+	}
+	orthonormalize(q);
+
+	std::vector<double> bq;
+	for (int it = 0; it<POWER_ITERATIONS; it++) {
+		multiply(q, bq, pool);
+		q.swap(bq);
+		orthonormalize(q);
+	}
+
+	// Rayleigh-Ritz: eigenvectors of Q^T B Q
+	multiply(q, bq, pool);
+	std::vector<double> t(P*P, 0.0);
+	for (std::size_t r = 0; r<P; r++) {
+		for (std::size_t c = 0; c<P; c++) {
+			double sum = 0.0;
+			for (std::size_t i = 0; i<n; i++) {
+				sum += q[i*P + r] * bq[i*P + c];
+			}
+			t[r*P + c] = sum;
+		}
+	}
+	for (std::size_t r = 0; r<P; r++) {
+		for (std::size_t c = 0; c<r; c++) {
+			t[r*P + c] = t[c*P + r] = 0.5*(t[r*P + c] + t[c*P + r]);
+		}
+	}
+	std::vector<double> values;
+	std::vector<double> vectors;
+	symmetricEigen(t, values, vectors);
+
+	std::vector<std::size_t> order(P);
+	for (std::size_t c = 0; c<P; c++) {
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return values[a] > values[b]; });
+
+	// coordinates Q v * sqrt(lambda), the largest component of each made positive
+	std::vector<double> coordinates(2*n, 0.0);
+	for (std::size_t axis = 0; axis<2; axis++) {
+		const std::size_t c = order[axis];
+		leading[axis] = values[c];
+		const double length = std::sqrt(std::max(values[c], 0.0));
+		std::size_t largest = 0;
+		for (std::size_t i = 0; i<n; i++) {
+			double sum = 0.0;
+			for (std::size_t r = 0; r<P; r++) {
+				sum += q[i*P + r] * vectors[r*P + c];
+			}
+			coordinates[2*i + axis] = sum * length;
+			if (std::fabs(coordinates[2*i + axis]) > std::fabs(coordinates[2*largest + axis])) {
+				largest = i;
+			}
+		}
+		if (coordinates[2*largest + axis] < 0.0) {
+			for (std::size_t i = 0; i<n; i++) {
+				coordinates[2*i + axis] = -coordinates[2*i + axis];
+			}
+		}
+	}
+
+	outPointsProjection.reserve(static_cast<int>(n));
+	for (std::size_t i = 0; i<n; i++) {
+		outPointsProjection.push_back(TSPoint(coordinates[2*i], coordinates[2*i + 1]));
+	}
+}
+
+} // namespace LSP
@@ -0,0 +1,87 @@
+/*!	@file classicalmds.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Classical multidimensional scaling with a randomized eigensolver
+ */
+
+#ifndef CLASSICALMDS_H_
+#define CLASSICALMDS_H_
+
+#include <QVector>
+#include "tspoint.h"
+
+#include <cstddef>
+#include <vector>
+#include "symmetricmatrix.h"
+
+namespace VCGL {
+	class ThreadPool;
+}
+
+namespace LSP {
+
+/*! @brief Classical (Torgerson) MDS of the objects of a distance matrix
+ *
+ * The coordinates are the two leading eigenvectors of B = -1/2 J D2 J (D2 - the squared
+ * distances, J - the centering matrix), scaled by the square roots of their eigenvalues.
+ * They are found by randomized subspace iteration: a block of SUBSPACE_SIZE random vectors
+ * is multiplied by B and orthonormalized POWER_ITERATIONS times, and the eigenvectors follow
+ * from the small projected matrix. Nothing is to be tuned, and the result may start
+ * Sammon's mapping (ParallelSammon::perform from a later iteration).
+ *
+ * B is never formed: a product reads the packed triangle of the distances twice, in
+ * blocks of rows on several threads. Every value is summed in the same order whichever
+ * thread computes it, so the projection does not depend on the number of threads.
+ */
+class ClassicalMDS {
+public:
+	/// What the values of the matrix are
+	enum Values {
+		DISTANCES,		///< the distances themselves
+		CORRELATIONS	///< correlations r of distance (1-r)/2 (DistanceMatrix::distanceFromCorrelation)
+	};
+
+	/*! @brief Constructor
+	 *
+	 * @param matrix		Distances or correlations of the objects (kept by reference)
+	 * @param values		What the values of matrix are
+	 * @param threadCount	Number of threads (0 - one per hardware thread)
+	 */
+	ClassicalMDS(const VCGL::SymmetricMatrixView<float>& matrix, Values values = DISTANCES, unsigned threadCount = 1);
+
+	/*! @brief Project the objects
+	 *
+	 * @param outPointsProjection (output) coordinates of the objects in the order of the matrix
+	 */
+	void perform(QVector<TSPoint>& outPointsProjection);
+
+	/// Eigenvalues of the two coordinates after perform, the larger first (variance they explain times N)
+	const std::vector<double>& eigenvalues() const { return leading; }
+
+	/// Number of vectors iterated together (2 and the oversampling)
+	static const std::size_t SUBSPACE_SIZE = 12;
+	/// Number of multiplications of the subspace by B
+	static const int POWER_ITERATIONS = 12;
+	/// Number of rows of a task of the product
+	static const std::size_t ROWS_PER_TASK = 64;
+
+private:
+	/// out = B * in for N x SUBSPACE_SIZE matrices stored row by row
+	void multiply(const std::vector<double>& in, std::vector<double>& out, VCGL::ThreadPool& pool) const;
+
+	/// Squared distance of the stored value
+	double squaredDistance(float value) const {
+		const double d = offset + scale*value;
+		return d*d;
+	}
+
+	VCGL::SymmetricMatrixView<float> matrix;
+	double offset;	///< distance = offset + scale*value
+	double scale;
+	unsigned threadCount;
+	std::vector<double> leading;
+};
+
+} // namespace LSP
+
+#endif // CLASSICALMDS_H_
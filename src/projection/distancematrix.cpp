@@ -14,13 +14,8 @@
 namespace VCGL {
 
 DistanceMatrix::DistanceMatrix(const strType& matrixID, const std::vector<strType>& objectIDs)
-: dmatID(matrixID), objIDs(objectIDs) {
+: dmatID(matrixID), objIDs(objectIDs), distances(objectIDs.size(), 0.0f) {
 	objClasses.resize(objIDs.size(), 0.0f);
-	//rows in 1 .. N-1, cols 0 .. (row-1)
-	distances.resize( objIDs.size()-1, std::vector<float>() );
-	for (unsigned j=1; j<objIDs.size(); j++) {
-		distances[j-1].resize(j);
-	}
 }
 
 void DistanceMatrix::findObjectIndices(std::vector<strType> objIDArray, std::vector<unsigned>& outObjIndices) const {
@@ -40,35 +35,27 @@ void DistanceMatrix::findObjectIndices(std::vector<strType> objIDArray, std::vec
 }
 
 float DistanceMatrix::getDistanceByIndices(unsigned objIndex, unsigned otherObjIndex ) const {
-	unsigned id1 = objIndex;
-	unsigned id2 = otherObjIndex;
-	unsigned row = 0;
-	unsigned col = 0;
-	if (id1 > id2) {
-		row = id1 - 1;
-		col = id2;
-	}
-	else {
-		row = id2 - 1;
-		col = id1;
-	}
-	return distances[row][col];
+	return distances(objIndex, otherObjIndex);
+}
+
+void DistanceMatrix::setDistanceByIndices(unsigned objIndex, unsigned otherObjIndex, float distance) {
+	distances.set(objIndex, otherObjIndex, distance);
 }
 
 float
 DistanceMatrix::getDistance(const strType& objID, const strType& otherObjID ) const {
-	unsigned row = 0;
-	unsigned col = 0;
-	findIndices(objID, otherObjID, row,col);
-	return distances[row][col];
+	unsigned index = 0;
+	unsigned otherIndex = 0;
+	findIndices(objID, otherObjID, index, otherIndex);
+	return distances(index, otherIndex);
 }
 
 void
 DistanceMatrix::setDistance(const strType& objID, const strType& otherObjID, float distance) {
-	unsigned row = 0;
-	unsigned col = 0;
-	findIndices(objID, otherObjID, row, col);
-	distances[row][col] = distance;
+	unsigned index = 0;
+	unsigned otherIndex = 0;
+	findIndices(objID, otherObjID, index, otherIndex);
+	distances.set(index, otherIndex, distance);
 }
 
 strType
@@ -104,11 +91,12 @@ DistanceMatrix::printDMAT(std::ostream& output) const {
 		}
 	}
 
-	//the matrix itself
-	for (unsigned row=0; row<distances.size(); row++) {
-		const unsigned ncols =  distances[row].size();
+	//the matrix itself: rows 1..n-1, columns 0..row-1
+	for (unsigned row=1; row<distances.size(); row++) {
+		const unsigned ncols = row;
+		const float* rowDistances = distances.triangleRow(row);
 		for (unsigned col=0; col<ncols; col++) {
-			output << distances[row][col];
+			output << rowDistances[col];
 			if (col<ncols-1) {
 				output << ';';
 			}
@@ -158,9 +146,10 @@ DistanceMatrix::readDMAT(std::istream& input, strType matrixID, DistanceMatrix**
 	}
 
 
-	//the matrix itself
-	for (unsigned row=0; row< dOut->distances.size(); row++) {
-		const unsigned ncols =  dOut->distances[row].size();
+	//the matrix itself: rows 1..n-1, columns 0..row-1
+	for (unsigned row=1; row< dOut->distances.size(); row++) {
+		const unsigned ncols = row;
+		float* rowDistances = dOut->distances.triangleRow(row);
 		for (unsigned col=0; col<ncols; col++) {
 			if (col<ncols-1) {
 				input.getline(buffer, bufSize,';');
@@ -168,29 +157,17 @@ DistanceMatrix::readDMAT(std::istream& input, strType matrixID, DistanceMatrix**
 			else {
 				input.getline(buffer, bufSize);
 			}
-			sscanf(buffer, "%f", &dOut->distances[row][col]);
+			sscanf(buffer, "%f", &rowDistances[col]);
 		}
 	}
 	*ppOutMatrix = dOut;
 }
 
-void DistanceMatrix::fromCorrelationMatrixArray(const std::vector< std::vector<float> >& correlations,
-			int nx,
-			int ny,
-			strType matrixID,
-			DistanceMatrix** ppOutMatrix) {
+void DistanceMatrix::gridObjectIDs(int nx, int ny, std::vector<strType>& outObjIDs) {
+	const unsigned n = nx*ny;
 
-	*ppOutMatrix = 0;
-
-	// first line: number of objects
-	unsigned n = nx*ny;
-
-	assert(correlations.size() == n);
-	assert(correlations[0].size() == n);
-
-	// second line: objects' IDs
-	std::vector<std::string> objIDs;
-	objIDs.resize(n, "");
+	outObjIDs.clear();
+	outObjIDs.resize(n, "");
 
 	const int bufSize = 100;
 	char buffer[bufSize];
@@ -198,24 +175,48 @@ void DistanceMatrix::fromCorrelationMatrixArray(const std::vector< std::vector<f
 		int ptY = j / nx;
 		int ptX = j % nx;
 		sprintf(buffer, "(%d,%d)", ptX, ptY);
-		objIDs[j] = buffer;
+		outObjIDs[j] = buffer;
 	}
+}
+
+void DistanceMatrix::forGrid(int nx, int ny, strType matrixID, DistanceMatrix** ppOutMatrix) {
+	*ppOutMatrix = 0;
+
+	const unsigned n = nx*ny;
+
+	std::vector<std::string> objIDs;
+	gridObjectIDs(nx, ny, objIDs);
 
 	DistanceMatrix* dOut = new DistanceMatrix(matrixID, objIDs);
 
-	//third line: objects' classes
 	for (unsigned j=0; j<n; j++) {
 		dOut->objClasses[j] = 1.0;
 	}
+	*ppOutMatrix = dOut;
+}
 
+void DistanceMatrix::fromCorrelationMatrixArray(const SymmetricMatrix<float>& correlations,
+			int nx,
+			int ny,
+			strType matrixID,
+			DistanceMatrix** ppOutMatrix) {
 
-	//the matrix itself
-	for (unsigned row=0; row< dOut->distances.size(); row++) {
-		const unsigned ncols =  dOut->distances[row].size();
-		for (unsigned col=0; col<ncols; col++) {
-			//dOut->distances[row][col] = 1-fabs(correlations[row][col]); // differentiates only between strong/weak correlation, ignores the sign
-			dOut->distances[row][col] = (1.0-correlations[row][col])/2.0; // puts positively correlated points closer and negatively correlated farther
-		}
+	*ppOutMatrix = 0;
+
+	const unsigned n = nx*ny;
+
+	assert(correlations.size() == n);
+
+	DistanceMatrix* dOut = 0;
+	forGrid(nx, ny, matrixID, &dOut);
+
+	//the matrix itself: both are packed the same way, so convert element by element
+	const float* corr = correlations.data();
+	float* dist = dOut->distances.data();
+	const size_t count = correlations.packedSize();
+	for (size_t k=0; k<count; k++) {
+		//dist[k] = 1-fabs(corr[k]); // differentiates only between strong/weak correlation, ignores the sign
+		dist[k] = distanceFromCorrelation(corr[k]); // puts positively correlated points closer and negatively correlated farther
 	}
 	*ppOutMatrix = dOut;
 
@@ -249,7 +250,7 @@ DistanceMatrix::setObjectClass(const strType& objID, float newClass) {
 }
 
 void
-DistanceMatrix::findIndices(const strType& objID, const strType& otherObjID, unsigned& row, unsigned& col) const {
+DistanceMatrix::findIndices(const strType& objID, const strType& otherObjID, unsigned& index, unsigned& otherIndex) const {
 	int id1 = -1;
 	int id2 = -1;
 	for (unsigned j=0; (id1 < 0 || id2 < 0 ) && j<objIDs.size(); j++ ) {
@@ -260,14 +261,8 @@ DistanceMatrix::findIndices(const strType& objID, const strType& otherObjID, uns
 			id2 = j;
 		}
 	}
-	if (id1 > id2) {
-		row = id1 - 1;
-		col = id2;
-	}
-	else {
-		row = id2 - 1;
-		col = id1;
-	}
+	index = id1;
+	otherIndex = id2;
 }
 
 } // namespace VCGL
@@ -8,6 +8,7 @@
 #define DISTANCEMATRIX_H_
 
 #include "typedefs.h"
+#include "symmetricmatrix.h"
 #include <iostream>
 #include <vector>
 
@@ -28,6 +29,17 @@ public:
 
 	float getDistanceByIndices(unsigned objIndex, unsigned otherObjIndex ) const;
 
+	/// Distances of all objects in the order of getObjectIDs, as a packed triangle
+	SymmetricMatrixView<float> distanceView() const { return distances.view(); }
+
+	/*! @brief Store distance between two objects given by their indices
+	 *
+	 * @param objIndex Index of one object
+	 * @param otherObjIndex Index of other (different) object
+	 * @param distance Distance to be stored
+	 */
+	void setDistanceByIndices(unsigned objIndex, unsigned otherObjIndex, float distance);
+
 	/*! @brief Get stored distance between two given objects
 	 *
 	 * @param objID Identifier of one object
@@ -61,20 +73,42 @@ public:
 	 */
 	static void readDMAT(std::istream& input, strType matrixID, DistanceMatrix** ppOutMatrix);
 
-	/*! @brief Create distance matrix in DMAT format from correlation matrix in two-dimensional array
+	/*! @brief Create distance matrix in DMAT format from correlation matrix
 	 *
-	 * @param correlations Correlation matrix in two-dimensional array (sizes: nx*ny, nx*ny)
+	 * @param correlations Correlation matrix (size: nx*ny)
 	 * @param nx Point count in x
 	 * @param ny Point count in y
 	 * @param matrixID String identifier for the matrix
 	 * @param ppOutMatrix Pointer to pointer which receives the distance matrix
 	 */
-	static void fromCorrelationMatrixArray(const std::vector< std::vector<float> >& correlations,
+	static void fromCorrelationMatrixArray(const SymmetricMatrix<float>& correlations,
 			int nx,
 			int ny,
 			strType matrixID,
 			DistanceMatrix** ppOutMatrix);
 
+	/*! @brief Create distance matrix for the points of a grid, with all distances set to 0
+	 *
+	 * Objects are named "(x,y)" in the order of point id = y*nx + x.
+	 *
+	 * @param nx Point count in x
+	 * @param ny Point count in y
+	 * @param matrixID String identifier for the matrix
+	 * @param ppOutMatrix Pointer to pointer which receives the distance matrix
+	 */
+	static void forGrid(int nx, int ny, strType matrixID, DistanceMatrix** ppOutMatrix);
+
+	/*! @brief Names of the points of a grid, as the objects of forGrid
+	 *
+	 * @param nx Point count in x
+	 * @param ny Point count in y
+	 * @param outObjIDs Vector receiving "(x,y)" in the order of point id = y*nx + x
+	 */
+	static void gridObjectIDs(int nx, int ny, std::vector<strType>& outObjIDs);
+
+	/// Distance between points with the given correlation (positively correlated points are closer)
+	static float distanceFromCorrelation(float correlation) { return (1.0f-correlation)/2.0f; }
+
 	/*! @brief Get object identifiers for which distances are stored in this matrix
 	 *
 	 * @param outObjIDs Vector receiving object identifiers
@@ -100,15 +134,15 @@ private:
 	 *
 	 * @param objID Identifier of one object
 	 * @param otherObjID Identifier of other object
-	 * @param row Reference to unsigned where row index will be stored
-	 * @param col Reference to unsigned where column index will be stored
+	 * @param index Reference to unsigned where index of the first object will be stored
+	 * @param otherIndex Reference to unsigned where index of the other object will be stored
 	 */
-	void findIndices(const strType& objID, const strType& otherObjID, unsigned& row, unsigned& col) const;
+	void findIndices(const strType& objID, const strType& otherObjID, unsigned& index, unsigned& otherIndex) const;
 
 	strType dmatID; ///< String identifier of the matrix
 	std::vector<strType> objIDs; ///< String identifiers of respective objects
 	std::vector<float> objClasses; ///< Float identifiers of object classes
-	std::vector< std::vector<float> > distances; ///< Distances between objects
+	SymmetricMatrix<float> distances; ///< Distances between objects (zero on the diagonal)
 };
 
 } // namespace VCGL
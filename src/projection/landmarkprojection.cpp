@@ -0,0 +1,182 @@
+/*!	@file landmarkprojection.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Projection of all points through a few landmarks, from O(N*k) distances
+ */
+
+#include "landmarkprojection.h"
+
+#include "distancematrix.h"
+#include "parallelsammon.h"
+#include "process/threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <string>
+
+namespace LSP {
+
+DistanceMatrixSource::DistanceMatrixSource(const VCGL::DistanceMatrix& dmat): dmat(dmat), npoints(0) {
+	std::vector<VCGL::strType> ids;
+	dmat.getObjectIDs(ids);
+	npoints = ids.size();
+}
+
+void DistanceMatrixSource::distances(std::size_t pt, std::size_t begin, std::size_t end, float* out) const {
+	const VCGL::SymmetricMatrixView<float> d = dmat.distanceView();
+	for (std::size_t q = begin; q<end; q++) {
+		out[q-begin] = d(pt, q);
+	}
+}
+
+LandmarkProjection::LandmarkProjection(const DistanceSource& source, std::size_t landmarkCount, unsigned threadCount)
+: threadCount(threadCount), npoints(source.pointCount()) {
+	assert(landmarkCount > 0);
+
+	//one random landmark out of every run of npoints/k points, the same on every platform;
+	//in the order of a grid, they cover it evenly
+	const std::size_t k = std::min(landmarkCount, npoints);
+	std::mt19937 rng(1);
+	for (std::size_t j = 0; j<k; j++) {
+		const std::size_t begin = j*npoints/k;
+		const std::size_t end = (j+1)*npoints/k;
+		landmarkPoints.push_back(begin + rng() % (end - begin));
+	}
+
+	landmarkOfPoint.assign(npoints, -1);
+	for (std::size_t j = 0; j<k; j++) {
+		landmarkOfPoint[landmarkPoints[j]] = static_cast<int>(j);
+	}
+
+	//the distances to the landmarks, point by point for the placement
+	toLandmarks.resize(npoints*k);
+	VCGL::ThreadPool pool(threadCount);
+	pool.parallelFor((npoints + POINTS_PER_TASK - 1) / POINTS_PER_TASK, [&](std::size_t task) {
+		const std::size_t begin = task*POINTS_PER_TASK;
+		const std::size_t end = std::min(npoints, begin + POINTS_PER_TASK);
+		std::vector<float> row(end - begin);
+		for (std::size_t j = 0; j<k; j++) {
+			source.distances(landmarkPoints[j], begin, end, row.data());
+			for (std::size_t pt = begin; pt<end; pt++) {
+				toLandmarks[pt*k + j] = row[pt-begin];
+			}
+		}
+	});
+}
+
+void LandmarkProjection::perform(QVector<TSPoint>& outPointsProjection) const {
+	const std::size_t k = landmarkPoints.size();
+
+	//the landmarks with all their distances
+	std::vector<VCGL::strType> ids;
+	for (std::size_t j = 0; j<k; j++) {
+		ids.push_back(std::to_string(landmarkPoints[j]));
+	}
+	VCGL::DistanceMatrix dmat("landmarks", ids);
+	for (std::size_t j = 0; j<k; j++) {
+		for (std::size_t other = 0; other<j; other++) {
+			dmat.setDistanceByIndices(j, other, distance(landmarkPoints[j], other));
+		}
+	}
+	QVector<TSPoint> landmarkProjection;
+	ParallelSammon(ids, dmat, threadCount).perform(landmarkProjection);
+
+	//every other point from the landmarks alone
+	std::vector<TSPoint> points(npoints);
+	VCGL::ThreadPool pool(threadCount);
+	pool.parallelFor((npoints + POINTS_PER_TASK - 1) / POINTS_PER_TASK, [&](std::size_t task) {
+		const std::size_t end = std::min(npoints, (task+1)*POINTS_PER_TASK);
+		for (std::size_t pt = task*POINTS_PER_TASK; pt<end; pt++) {
+			points[pt] = landmarkOfPoint[pt] >= 0 ? landmarkProjection[landmarkOfPoint[pt]] : placePoint(pt, landmarkProjection);
+		}
+	});
+
+	outPointsProjection.clear();
+	outPointsProjection.reserve(static_cast<int>(npoints));
+	for (std::size_t pt = 0; pt<npoints; pt++) {
+		outPointsProjection.push_back(points[pt]);
+	}
+}
+
+TSPoint LandmarkProjection::placePoint(std::size_t pt, const QVector<TSPoint>& landmarkProjection) const {
+	const std::size_t k = landmarkPoints.size();
+
+	//the nearest landmarks, ties in the order of the landmarks
+	std::vector<std::size_t> nearest(k);
+	for (std::size_t j = 0; j<k; j++) {
+		nearest[j] = j;
+	}
+	const std::size_t m = std::min(NEIGHBOUR_COUNT, k);
+	std::partial_sort(nearest.begin(), nearest.begin() + m, nearest.end(), [&](std::size_t a, std::size_t b) {
+		return distance(pt, a) < distance(pt, b) || (distance(pt, a) == distance(pt, b) && a < b);
+	});
+	if (distance(pt, nearest[0]) <= 0.0f) {
+		return landmarkProjection[nearest[0]];
+	}
+
+	double sumX = 0.0;
+	double sumY = 0.0;
+	double sumW = 0.0;
+	for (std::size_t q = 0; q<m; q++) {
+		const double d = distance(pt, nearest[q]);
+		const double w = 1.0 / (d*d);
+		sumX += w * landmarkProjection[nearest[q]].getX();
+		sumY += w * landmarkProjection[nearest[q]].getY();
+		sumW += w;
+	}
+	double x = sumX / sumW;
+	double y = sumY / sumW;
+
+	//Guttman transform of the point alone: each landmark pulls it to distance d from itself
+	for (int it = 0; it<PLACEMENT_ITERATIONS; it++) {
+		double nextX = 0.0;
+		double nextY = 0.0;
+		double weights = 0.0;
+		for (std::size_t j = 0; j<k; j++) {
+			const double d = distance(pt, j);
+			if (d <= 0.0) {
+				continue;
+			}
+			const double lx = landmarkProjection[j].getX();
+			const double ly = landmarkProjection[j].getY();
+			const double dx = x - lx;
+			const double dy = y - ly;
+			const double D = std::sqrt(dx*dx + dy*dy);
+			const double scale = D > 0.0 ? d / D : 0.0;
+			const double w = 1.0 / d;
+			nextX += w * (lx + scale*dx);
+			nextY += w * (ly + scale*dy);
+			weights += w;
+		}
+		x = nextX / weights;
+		y = nextY / weights;
+	}
+	return TSPoint(x, y);
+}
+
+double LandmarkProjection::landmarkStress(const QVector<TSPoint>& points) const {
+	assert(points.size() == static_cast<int>(npoints));
+	double sum = 0.0;
+	double distances = 0.0;
+	for (std::size_t pt = 0; pt<npoints; pt++) {
+		//a pair of two landmarks once
+		const std::size_t k = landmarkOfPoint[pt] >= 0 ? landmarkOfPoint[pt] : landmarkPoints.size();
+		for (std::size_t j = 0; j<k; j++) {
+			const double d = distance(pt, j);
+			if (d <= 0.0) {
+				continue;
+			}
+			const TSPoint& other = points[landmarkPoints[j]];
+			const double dx = points[pt].getX() - other.getX();
+			const double dy = points[pt].getY() - other.getY();
+			const double D = std::sqrt(dx*dx + dy*dy);
+			sum += (d - D)*(d - D) / d;
+			distances += d;
+		}
+	}
+	return distances > 0.0 ? sum / distances : 0.0;
+}
+
+} // namespace LSP
@@ -0,0 +1,116 @@
+/*!	@file landmarkprojection.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Projection of all points through a few landmarks, from O(N*k) distances
+ */
+
+#ifndef LANDMARKPROJECTION_H_
+#define LANDMARKPROJECTION_H_
+
+#include <QVector>
+#include "tspoint.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace VCGL {
+	class DistanceMatrix;
+}
+
+namespace LSP {
+
+/// Distances between the points to be projected, computed on demand
+struct DistanceSource {
+	virtual ~DistanceSource() {}
+
+	/// Number of points
+	virtual std::size_t pointCount() const = 0;
+
+	/*! @brief Distances of one point to a range of points
+	 *
+	 * Called from several threads at once.
+	 *
+	 * @param pt Point the distances are measured from
+	 * @param begin First point of the range
+	 * @param end Point after the range
+	 * @param out Receives the distance to point q at out[q-begin]
+	 */
+	virtual void distances(std::size_t pt, std::size_t begin, std::size_t end, float* out) const = 0;
+};
+
+/// Distances between all objects of a distance matrix, in the order of getObjectIDs
+class DistanceMatrixSource: public DistanceSource {
+public:
+	explicit DistanceMatrixSource(const VCGL::DistanceMatrix& dmat);
+
+	virtual std::size_t pointCount() const override { return npoints; }
+	virtual void distances(std::size_t pt, std::size_t begin, std::size_t end, float* out) const override;
+
+private:
+	const VCGL::DistanceMatrix& dmat;
+	std::size_t npoints;
+};
+
+/*! @brief Projection of many points through landmarks, as the control points of LSP
+ *
+ * The landmarks are a random sample stratified by the order of the points, one out of every
+ * N/k consecutive points, which spreads them over a grid. They are projected with
+ * LSP::ParallelSammon on the distances between them. Every other point is then placed from
+ * its distances to the landmarks alone: it starts at the mean of its NEIGHBOUR_COUNT nearest
+ * landmarks weighted by 1/d^2, and is moved by PLACEMENT_ITERATIONS steps of stress
+ * majorization (SMACOF) against all landmarks, with the 1/d weights of Sammon's stress.
+ * The step of a single point needs no learning rate and never increases its stress.
+ *
+ * Only the distances to the landmarks are computed and kept, 4*N*k bytes for N points and
+ * k landmarks, instead of the 2*N*N bytes of the full Sammon's mapping. The projection
+ * depends neither on the number of threads nor on their timing.
+ */
+class LandmarkProjection {
+public:
+	/*! @brief Constructor: chooses the landmarks and computes the distances to them
+	 *
+	 * @param source		Distances between the points (used only here)
+	 * @param landmarkCount	Number of landmarks, all points if there are fewer
+	 * @param threadCount	Number of threads (0 - one per hardware thread)
+	 */
+	LandmarkProjection(const DistanceSource& source, std::size_t landmarkCount, unsigned threadCount = 1);
+
+	/*! @brief Project all points
+	 *
+	 * @param outPointsProjection (output) mapping of the points in the order of the source
+	 */
+	void perform(QVector<TSPoint>& outPointsProjection) const;
+
+	/*! @brief Sammon's stress over the pairs of a point with a landmark
+	 *
+	 * Sum of (d - D)^2/d over these pairs with distance d > 0 and projected distance D,
+	 * divided by the sum of their distances d (as ParallelSammon::stress over all pairs).
+	 */
+	double landmarkStress(const QVector<TSPoint>& points) const;
+
+	/// The landmarks, in increasing order
+	const std::vector<std::size_t>& landmarks() const { return landmarkPoints; }
+
+	/// Number of the nearest landmarks the placement of a point starts from
+	static const std::size_t NEIGHBOUR_COUNT = 8;
+	/// Number of majorization steps placing a point
+	static const int PLACEMENT_ITERATIONS = 10;
+	/// Number of points placed by one task
+	static const std::size_t POINTS_PER_TASK = 256;
+
+private:
+	TSPoint placePoint(std::size_t pt, const QVector<TSPoint>& landmarkProjection) const;
+
+	/// Distance of point pt to landmark j
+	float distance(std::size_t pt, std::size_t j) const { return toLandmarks[pt*landmarkPoints.size() + j]; }
+
+	unsigned threadCount;
+	std::size_t npoints;
+	std::vector<std::size_t> landmarkPoints;
+	std::vector<int> landmarkOfPoint;	///< index in landmarkPoints, -1 for the other points
+	std::vector<float> toLandmarks;	///< distances of every point to all landmarks, point by point
+};
+
+} // namespace LSP
+
+#endif // LANDMARKPROJECTION_H_
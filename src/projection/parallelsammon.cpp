@@ -0,0 +1,421 @@
+/*!	@file parallelsammon.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Sammon mapping on several threads, with the coordinates and distances in flat arrays
+ */
+
+#include "parallelsammon.h"
+
+#include "sammon.h"
+#include "sammoncontroller.h"
+#include "distancematrix.h"
+#include "process/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TELCON_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace LSP {
+
+namespace {
+	/// The correction of Sammon::performSammonDMAT for one pair, in the same order of operations
+	inline void updatePair(double& xa, double& ya, double& xb, double& yb, double d, double lambda) {
+		const double dx = xa - xb;
+		const double dy = ya - yb;
+		double D = std::sqrt(dx*dx + dy*dy);
+		/* avoid devision with 0 */
+		if (D == 0) {
+			D = 1e-10;
+		}
+		const double c = lambda * (d - D) / D;
+		const double deltaX = dx * c;
+		const double deltaY = dy * c;
+		xa += deltaX;
+		ya += deltaY;
+		xb -= deltaX;
+		yb -= deltaY;
+	}
+
+	void updatePairsScalar(double* xa, double* ya, double* xb, double* yb, const float* distances,
+			std::size_t count, double lambda) {
+		for (std::size_t t = 0; t<count; t++) {
+			updatePair(xa[t], ya[t], xb[t], yb[t], distances[t], lambda);
+		}
+	}
+
+	const SammonKernel scalarKernel = { "scalar", updatePairsScalar };
+
+#ifdef TELCON_X86_KERNELS
+	// no FMA: the products are rounded as in the scalar variant
+	__attribute__((target("avx2")))
+	void updatePairsAVX2(double* xa, double* ya, double* xb, double* yb, const float* distances,
+			std::size_t count, double lambda) {
+		const __m256d l = _mm256_set1_pd(lambda);
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d tiny = _mm256_set1_pd(1e-10);
+		std::size_t t = 0;
+		for (; t+4<=count; t+=4) {
+			const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xa+t), _mm256_loadu_pd(xb+t));
+			const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ya+t), _mm256_loadu_pd(yb+t));
+			__m256d D = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+			D = _mm256_blendv_pd(D, tiny, _mm256_cmp_pd(D, zero, _CMP_EQ_OQ));
+			const __m256d d = _mm256_cvtps_pd(_mm_loadu_ps(distances+t));
+			const __m256d c = _mm256_div_pd(_mm256_mul_pd(l, _mm256_sub_pd(d, D)), D);
+			const __m256d deltaX = _mm256_mul_pd(dx, c);
+			const __m256d deltaY = _mm256_mul_pd(dy, c);
+			_mm256_storeu_pd(xa+t, _mm256_add_pd(_mm256_loadu_pd(xa+t), deltaX));
+			_mm256_storeu_pd(ya+t, _mm256_add_pd(_mm256_loadu_pd(ya+t), deltaY));
+			_mm256_storeu_pd(xb+t, _mm256_sub_pd(_mm256_loadu_pd(xb+t), deltaX));
+			_mm256_storeu_pd(yb+t, _mm256_sub_pd(_mm256_loadu_pd(yb+t), deltaY));
+		}
+		updatePairsScalar(xa+t, ya+t, xb+t, yb+t, distances+t, count-t, lambda);
+	}
+
+	const SammonKernel avx2Kernel = { "avx2", updatePairsAVX2 };
+#endif // TELCON_X86_KERNELS
+
+	/// Shuffle with the generator only, so that the order is the same with every standard library
+	void shuffle(std::vector<std::size_t>& values, std::mt19937& rng) {
+		for (std::size_t j = values.size(); j>1; j--) {
+			std::swap(values[j-1], values[rng() % j]);
+		}
+	}
+
+	bool sameObjects(const std::vector<VCGL::strType>& ids, const VCGL::DistanceMatrix& dmat) {
+		std::vector<VCGL::strType> all;
+		dmat.getObjectIDs(all);
+		return ids == all;
+	}
+}
+
+ParallelSammon::ParallelSammon(const std::vector<VCGL::strType>& ids, const VCGL::DistanceMatrix& dmat, unsigned threadCount)
+: threadCount(threadCount), kernel(selectKernel()), npoints(ids.size()),
+  nblocks((ids.size() + BLOCK_SIZE - 1) / BLOCK_SIZE), pointOfLabel(ids.size()), distances(ids.size(), 0.0f) {
+	std::vector<unsigned> indices;
+	if (sameObjects(ids, dmat)) {
+		indices.resize(npoints);
+		for (std::size_t j = 0; j<npoints; j++) {
+			indices[j] = j;
+		}
+	}
+	else {
+		dmat.findObjectIndices(ids, indices);
+	}
+
+	for (std::size_t j = 0; j<npoints; j++) {
+		pointOfLabel[j] = j;
+	}
+	std::mt19937 rng(1);
+	shuffle(pointOfLabel, rng);
+
+	const VCGL::SymmetricMatrixView<float> source = dmat.distanceView();
+	VCGL::ThreadPool pool(threadCount);
+	pool.parallelFor(npoints, [&](std::size_t task) {
+		const std::size_t label = npoints-1 - task; // longest rows first
+		const unsigned point = indices[pointOfLabel[label]];
+		float* row = distances.triangleRow(label);
+		for (std::size_t other = 0; other<label; other++) {
+			row[other] = source(point, indices[pointOfLabel[other]]);
+		}
+	});
+}
+
+std::size_t ParallelSammon::blockEnd(std::size_t block) const {
+	return std::min(npoints, (block+1)*BLOCK_SIZE);
+}
+
+void ParallelSammon::perform(QVector<TSPoint>& outPointsProjection, SammonObserver* pObserver, int firstIteration,
+		SammonController* pController) {
+	const int inPointsCount = npoints;
+
+	if (firstIteration <= 0 || outPointsProjection.size() != inPointsCount) {
+		firstIteration = 0;
+		outPointsProjection.clear();
+
+		/* initialize the algorithm as Sammon::performSammonDMAT */
+		qsrand(1);
+		for (int i = 0; i < inPointsCount; i++) {
+			double x = qrand() / (double) RAND_MAX;
+			double y = qrand() / (double) RAND_MAX;
+			outPointsProjection.push_back(TSPoint(x, y));
+		}
+	}
+
+	labelX.resize(npoints);
+	labelY.resize(npoints);
+	for (std::size_t label = 0; label<npoints; label++) {
+		labelX[label] = outPointsProjection[pointOfLabel[label]].getX();
+		labelY[label] = outPointsProjection[pointOfLabel[label]].getY();
+	}
+
+	SammonController fixedSchedule;
+	SammonController& schedule = pController ? *pController : fixedSchedule;
+	if (pController) {
+		sampleStressPairs();
+		pController->start(firstIteration, sampledStress());
+	}
+
+	VCGL::ThreadPool pool(threadCount);
+	const int maxIterations = schedule.maxIterations() - 1;
+	for (int iteration = firstIteration; iteration <= maxIterations; ++iteration) {
+		performIteration(iteration, schedule.lambda(iteration), pool);
+		const bool proceed = !pController || pController->iterationDone(iteration + 1, sampledStress());
+
+		if (pObserver || !proceed || iteration == maxIterations) {
+			for (std::size_t label = 0; label<npoints; label++) {
+				outPointsProjection[pointOfLabel[label]] = TSPoint(labelX[label], labelY[label]);
+			}
+		}
+		if (pObserver) {
+			pObserver->iterationDone(iteration + 1, outPointsProjection);
+		}
+		if (!proceed) {
+			break;
+		}
+	}
+}
+
+void ParallelSammon::performIteration(int iteration, double lambda, VCGL::ThreadPool& pool) {
+	// seeded with the iteration only, to be able to continue from any of them
+	std::mt19937 rng(iteration);
+	dealBlocks(rng);
+
+	pool.parallelFor(nblocks, [&](std::size_t block) {
+		updateWithinBlock(block, lambda);
+	});
+
+	if (nblocks > 1) {
+		// round-robin tournament of the blocks (circle method), with a bye when their number is odd
+		const std::size_t teams = nblocks + nblocks % 2;
+		std::vector<std::size_t> blockOfTeam(teams);
+		for (std::size_t j = 0; j<teams; j++) {
+			blockOfTeam[j] = j;
+		}
+		shuffle(blockOfTeam, rng);
+		std::vector<std::size_t> rounds(teams-1);
+		for (std::size_t j = 0; j<rounds.size(); j++) {
+			rounds[j] = j;
+		}
+		shuffle(rounds, rng);
+
+		std::vector< std::pair<std::size_t, std::size_t> > blockPairs;
+		for (std::size_t r: rounds) {
+			blockPairs.clear();
+			for (std::size_t k = 0; k<teams/2; k++) {
+				const std::size_t a = (k == 0) ? teams-1 : (r+k) % (teams-1);
+				const std::size_t b = (r + teams-1 - k) % (teams-1);
+				if (blockOfTeam[a] < nblocks && blockOfTeam[b] < nblocks) {
+					blockPairs.push_back(std::make_pair(blockOfTeam[a], blockOfTeam[b]));
+				}
+			}
+			pool.parallelFor(blockPairs.size(), [&](std::size_t p) {
+				updateBlockPair(blockPairs[p].first, blockPairs[p].second, lambda);
+			});
+		}
+	}
+
+	for (std::size_t slot = 0; slot<npoints; slot++) {
+		labelX[labelOfSlot[slot]] = x[slot];
+		labelY[labelOfSlot[slot]] = y[slot];
+	}
+}
+
+void ParallelSammon::dealBlocks(std::mt19937& rng) {
+	// a shorter last chunk stays last, so that every chunk starts at a multiple of CHUNK_SIZE
+	std::vector<std::size_t> chunks(npoints / CHUNK_SIZE);
+	for (std::size_t j = 0; j<chunks.size(); j++) {
+		chunks[j] = j;
+	}
+	shuffle(chunks, rng);
+	if (npoints % CHUNK_SIZE != 0) {
+		chunks.push_back(npoints / CHUNK_SIZE);
+	}
+
+	labelOfSlot.clear();
+	for (std::size_t chunk: chunks) {
+		const std::size_t end = std::min(npoints, (chunk+1)*CHUNK_SIZE);
+		for (std::size_t label = chunk*CHUNK_SIZE; label<end; label++) {
+			labelOfSlot.push_back(label);
+		}
+	}
+
+	x.resize(npoints);
+	y.resize(npoints);
+	for (std::size_t slot = 0; slot<npoints; slot++) {
+		x[slot] = labelX[labelOfSlot[slot]];
+		y[slot] = labelY[labelOfSlot[slot]];
+	}
+}
+
+void ParallelSammon::updateWithinBlock(std::size_t block, double lambda) {
+	const VCGL::SymmetricMatrixView<float> d = distances.view();
+	const std::size_t begin = blockBegin(block);
+	const std::size_t end = blockEnd(block);
+	for (std::size_t i = begin; i<end; i++) {
+		for (std::size_t j = begin; j<i; j++) {
+			updatePair(x[i], y[i], x[j], y[j], d(labelOfSlot[i], labelOfSlot[j]), lambda);
+		}
+	}
+}
+
+void ParallelSammon::updateBlockPair(std::size_t blockA, std::size_t blockB, double lambda) {
+	// block a is the smaller one (only the last block may be), the diagonals run over its points
+	if (blockEnd(blockA) - blockBegin(blockA) > blockEnd(blockB) - blockBegin(blockB)) {
+		std::swap(blockA, blockB);
+	}
+	const std::size_t a0 = blockBegin(blockA);
+	const std::size_t b0 = blockBegin(blockB);
+	const std::size_t na = blockEnd(blockA) - a0;
+	const std::size_t nb = blockEnd(blockB) - b0;
+
+	// diagonal k pairs point t of block a with point (t+k) % nb of block b
+	std::vector<float> tile(na*nb);
+	std::vector<float> row(nb);
+	for (std::size_t t = 0; t<na; t++) {
+		// the chunks of block b are runs of labels all below or all above the label of t
+		const std::size_t label = labelOfSlot[a0+t];
+		const float* triangleRow = distances.triangleRow(label);
+		for (std::size_t run = 0; run<nb; run += CHUNK_SIZE) {
+			const std::size_t first = labelOfSlot[b0+run];
+			const std::size_t length = std::min(CHUNK_SIZE, nb-run);
+			if (first < label) {
+				std::copy(triangleRow + first, triangleRow + first + length, row.begin() + run);
+			}
+			else {
+				for (std::size_t v = 0; v<length; v++) {
+					row[run+v] = distances.triangleRow(first+v)[label];
+				}
+			}
+		}
+		for (std::size_t s = 0; s<t; s++) {
+			tile[(s + nb - t)*na + t] = row[s];
+		}
+		for (std::size_t s = t; s<nb; s++) {
+			tile[(s - t)*na + t] = row[s];
+		}
+	}
+
+	double* xa = x.data() + a0;
+	double* ya = y.data() + a0;
+	double* xb = x.data() + b0;
+	double* yb = y.data() + b0;
+	for (std::size_t k = 0; k<nb; k++) {
+		const float* diagonal = tile.data() + k*na;
+		// points t < nb-k are paired with t+k, the others wrap around to t+k-nb
+		const std::size_t split = std::min(na, nb-k);
+		kernel.updatePairs(xa, ya, xb+k, yb+k, diagonal, split, lambda);
+		if (split < na) {
+			kernel.updatePairs(xa+split, ya+split, xb, yb, diagonal+split, na-split, lambda);
+		}
+	}
+}
+
+double ParallelSammon::stress(const QVector<TSPoint>& points) const {
+	double sumDistances = 0.0;
+	double sum = 0.0;
+	for (std::size_t label = 0; label<npoints; label++) {
+		const float* row = distances.triangleRow(label);
+		const TSPoint& point = points[pointOfLabel[label]];
+		for (std::size_t other = 0; other<label; other++) {
+			const double d = row[other];
+			if (d > 0) {
+				const double D = point.distance(points[pointOfLabel[other]]);
+				sum += (d - D)*(d - D)/d;
+				sumDistances += d;
+			}
+		}
+	}
+	return sumDistances > 0 ? sum/sumDistances : 0.0;
+}
+
+void ParallelSammon::sampleStressPairs() {
+	sampleA.clear();
+	sampleB.clear();
+	sampleDistances.clear();
+	const std::size_t pairs = npoints*(npoints-1)/2;
+	if (pairs <= STRESS_SAMPLE_SIZE) {
+		for (std::size_t a = 1; a<npoints; a++) {
+			for (std::size_t b = 0; b<a; b++) {
+				sampleA.push_back(a);
+				sampleB.push_back(b);
+			}
+		}
+	}
+	else {
+		// the same pairs on every platform, a pair may be drawn twice
+		std::mt19937 rng(1);
+		for (std::size_t j = 0; j<STRESS_SAMPLE_SIZE; j++) {
+			const std::size_t a = rng() % npoints;
+			std::size_t b = rng() % (npoints-1);
+			if (b >= a) {
+				b++;
+			}
+			sampleA.push_back(std::max(a, b));
+			sampleB.push_back(std::min(a, b));
+		}
+	}
+
+	// only the pairs counted by stress()
+	std::size_t kept = 0;
+	for (std::size_t j = 0; j<sampleA.size(); j++) {
+		const float d = distances.triangleRow(sampleA[j])[sampleB[j]];
+		if (d > 0) {
+			sampleA[kept] = sampleA[j];
+			sampleB[kept] = sampleB[j];
+			sampleDistances.push_back(d);
+			kept++;
+		}
+	}
+	sampleA.resize(kept);
+	sampleB.resize(kept);
+}
+
+double ParallelSammon::sampledStress() const {
+	double sumDistances = 0.0;
+	double sum = 0.0;
+	for (std::size_t j = 0; j<sampleDistances.size(); j++) {
+		const double d = sampleDistances[j];
+		const double dx = labelX[sampleA[j]] - labelX[sampleB[j]];
+		const double dy = labelY[sampleA[j]] - labelY[sampleB[j]];
+		const double D = std::sqrt(dx*dx + dy*dy);
+		sum += (d - D)*(d - D)/d;
+		sumDistances += d;
+	}
+	return sumDistances > 0 ? sum/sumDistances : 0.0;
+}
+
+std::vector<const SammonKernel*> ParallelSammon::availableKernels() {
+	std::vector<const SammonKernel*> kernels;
+	kernels.push_back(&scalarKernel);
+#ifdef TELCON_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		kernels.push_back(&avx2Kernel);
+	}
+#endif
+	return kernels;
+}
+
+const SammonKernel& ParallelSammon::selectKernel() {
+	std::vector<const SammonKernel*> kernels = availableKernels();
+	const SammonKernel* pSelected = kernels.back();
+
+	const char* requested = getenv("TELCON_KERNEL");
+	if (requested) {
+		for (unsigned j=0; j<kernels.size(); j++) {
+			if (0 == strcmp(kernels[j]->name, requested)) {
+				pSelected = kernels[j];
+			}
+		}
+	}
+	return *pSelected;
+}
+
+} // namespace LSP
@@ -0,0 +1,136 @@
+/*!	@file parallelsammon.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Sammon mapping on several threads, with the coordinates and distances in flat arrays
+ */
+
+#ifndef PARALLELSAMMON_H_
+#define PARALLELSAMMON_H_
+
+#include <QVector>
+#include "tspoint.h"
+
+#include <cstddef>
+#include <random>
+#include <vector>
+#include "typedefs.h"
+#include "symmetricmatrix.h"
+
+namespace VCGL {
+	class DistanceMatrix;
+	class ThreadPool;
+}
+
+namespace LSP {
+struct SammonObserver;
+class SammonController;
+
+/*! @brief Update of count pairs of points (a[t], b[t]) that share no point, in a variant per instruction set
+ *
+ * Each pair is moved as in Sammon::performSammonDMAT, towards the distance distances[t].
+ * All variants give exactly the same coordinates.
+ */
+struct SammonKernel {
+	const char* name;
+	void (*updatePairs)(double* xa, double* ya, double* xb, double* yb, const float* distances,
+			std::size_t count, double lambda);
+};
+
+/*! @brief Sammon's mapping of the objects of a distance matrix on several threads
+ *
+ * Same heuristic, initialization and number of iterations as Sammon::performSammonDMAT, with
+ * the pairs reordered so that they can be updated in parallel. Every iteration deals the points
+ * into blocks of BLOCK_SIZE, then updates the pairs within every block, and then the pairs of
+ * two blocks in rounds of a round-robin tournament: in a round every block meets one other
+ * block, so the block pairs of a round share no point and are updated at the same time without
+ * locks. Two blocks are updated diagonal by diagonal, the pairs of a diagonal again sharing no
+ * point, with their distances gathered into a tile in diagonal order.
+ *
+ * The blocks have to be random for the stress to stay as low as with performSammonDMAT, while
+ * the distances should be read in runs. The points are therefore relabeled once in a random
+ * order, with a copy of the distances in that order, and every iteration deals out shuffled
+ * chunks of CHUNK_SIZE consecutive labels. The order of the updates depends neither on the
+ * number of threads nor on the kernel, and a run continued from any iteration gives the same
+ * projection as an uninterrupted one.
+ *
+ * A SammonController may set the step sizes instead, and stop the iterations on the stress
+ * of a fixed random sample of STRESS_SAMPLE_SIZE pairs, computed after every iteration.
+ */
+class ParallelSammon {
+public:
+	/*! @brief Constructor
+	 *
+	 * Copies the distances (4*N*N/2 bytes for N objects), the matrix is not used afterwards.
+	 *
+	 * @param ids		Objects of the matrix to be projected
+	 * @param dmat		Distances of the objects
+	 * @param threadCount Number of threads (0 - one per hardware thread)
+	 */
+	ParallelSammon(const std::vector<VCGL::strType>& ids, const VCGL::DistanceMatrix& dmat, unsigned threadCount = 1);
+
+	/*! @brief Perform the mapping
+	 *
+	 * @param outPointsProjection (output) mapping of the objects; with firstIteration > 0 (input as well)
+	 * 				the projection after firstIteration iterations to continue from
+	 * @param pObserver	Receiver of the state after every iteration (optional)
+	 * @param firstIteration Number of the iteration to start with
+	 * @param pController Schedule of the iterations, which may stop them early (optional,
+	 * 				the fixed schedule of Sammon::performSammonDMAT without)
+	 */
+	void perform(QVector<TSPoint>& outPointsProjection, SammonObserver* pObserver = 0, int firstIteration = 0,
+			SammonController* pController = 0);
+
+	/*! @brief Sammon's stress of a projection of the objects
+	 *
+	 * Sum of (d - D)^2/d over the pairs of objects with distance d > 0 and projected distance D,
+	 * divided by the sum of the distances d.
+	 */
+	double stress(const QVector<TSPoint>& points) const;
+
+	/// Number of points updated together
+	static const std::size_t BLOCK_SIZE = 128;
+	/// Number of consecutive labels dealt out together (distances of a cache line)
+	static const std::size_t CHUNK_SIZE = 16;
+	/// Number of pairs of the stress reported to a SammonController (all pairs if there are fewer)
+	static const std::size_t STRESS_SAMPLE_SIZE = 16384;
+
+	/// All kernels supported by this CPU, from the simplest to the widest
+	static std::vector<const SammonKernel*> availableKernels();
+
+	/*! @brief Widest kernel supported by this CPU
+	 *
+	 * Environment variable TELCON_KERNEL=scalar|avx2 restricts the choice,
+	 * as for the kernels of CorrelationEngine.
+	 */
+	static const SammonKernel& selectKernel();
+
+private:
+	void performIteration(int iteration, double lambda, VCGL::ThreadPool& pool);
+	void dealBlocks(std::mt19937& rng);
+	void updateWithinBlock(std::size_t block, double lambda);
+	void updateBlockPair(std::size_t blockA, std::size_t blockB, double lambda);
+	void sampleStressPairs();
+	double sampledStress() const;
+
+	std::size_t blockBegin(std::size_t block) const { return block*BLOCK_SIZE; }
+	std::size_t blockEnd(std::size_t block) const;
+
+	unsigned threadCount;
+	const SammonKernel& kernel;
+	std::size_t npoints;
+	std::size_t nblocks;
+	std::vector<std::size_t> pointOfLabel;	///< index in ids of the object with the label
+	VCGL::SymmetricMatrix<float> distances;	///< distances between the labels
+	std::vector<double> labelX;	///< coordinates of the labels between the iterations
+	std::vector<double> labelY;
+	std::vector<std::size_t> labelOfSlot;	///< labels in the order of the blocks of the iteration
+	std::vector<double> x;	///< coordinates in the order of the blocks of the iteration
+	std::vector<double> y;
+	std::vector<std::size_t> sampleA;	///< labels of the pairs of the sampled stress
+	std::vector<std::size_t> sampleB;
+	std::vector<float> sampleDistances;	///< their distances, those > 0 only
+};
+
+} // namespace LSP
+
+#endif // PARALLELSAMMON_H_
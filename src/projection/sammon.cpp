@@ -101,33 +101,39 @@ void
 Sammon::performSammonDMAT(
 		const std::vector<VCGL::strType>& ids,
 		const VCGL::DistanceMatrix& dmat,
-		QVector<TSPoint>& outPointsProjection)
+		QVector<TSPoint>& outPointsProjection,
+		SammonObserver* pObserver,
+		int firstIteration)
 {
-	outPointsProjection.clear();
 	std::vector<unsigned> indices;
 	dmat.findObjectIndices(ids, indices);
 
 	const int inPointsCount =indices.size();
 
-	/* initialize the algorithm */
-	for (int i = 0; i < inPointsCount; i++) {
-		double x = qrand() / (double) RAND_MAX;
-		double y = qrand() / (double) RAND_MAX;
-		TSPoint tmp(x, y);
-		outPointsProjection.push_back(tmp);
+	if (firstIteration <= 0 || outPointsProjection.size() != inPointsCount) {
+		firstIteration = 0;
+		outPointsProjection.clear();
+
+		/* initialize the algorithm */
+		qsrand(1);
+		for (int i = 0; i < inPointsCount; i++) {
+			double x = qrand() / (double) RAND_MAX;
+			double y = qrand() / (double) RAND_MAX;
+			TSPoint tmp(x, y);
+			outPointsProjection.push_back(tmp);
+		}
 	}
 
 	TSPoint delta(0.0, 0.0);
-	int maxIterations	= 100;
+	int maxIterations	= ITERATION_COUNT - 1;
 	double lambda		= 1;
 	double d_ij			= 0.0;
 	double D_ij			= 0.0;
 
-	/* initialize the random seed */
-	qsrand(0);
+	for ( int iteration = firstIteration; iteration <= maxIterations; ++iteration ) {
+		/* initialize the random seed, each iteration on its own to be able to continue from any of them */
+		qsrand(iteration);
 
-	for ( int iteration = 0; iteration <= maxIterations; ++iteration ) {
-		//  cout << "Iteration: " << iteration << endl;
 		/* calculate the lambda value for each iteration */
 		double ratio = (double)iteration / (double)maxIterations;
 		lambda = pow(0.01, ratio);
@@ -170,6 +176,9 @@ Sammon::performSammonDMAT(
 			}
 		}
 
+		if (pObserver) {
+			pObserver->iterationDone(iteration + 1, outPointsProjection);
+		}
 	}
 }
 
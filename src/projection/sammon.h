@@ -21,6 +21,18 @@ namespace VCGL {
 namespace LSP {
 struct ILSPData;
 
+/// Receives the state of Sammon's mapping after every iteration, e.g. to continue an interrupted run
+struct SammonObserver {
+	virtual ~SammonObserver() {}
+
+	/*! @brief Called after every iteration
+	 *
+	 * @param iterations Number of completed iterations
+	 * @param points Projection after these iterations
+	 */
+	virtual void iterationDone(int iterations, const QVector<TSPoint>& points) = 0;
+};
+
 /*
  *
  */
@@ -39,7 +51,25 @@ public:
      */
     static void performSammon(const QVector<ILSPData*>& inPoints, QVector<TSPoint>& outPointsProjection);
 
-    static void performSammonDMAT(const std::vector<VCGL::strType>& ids, const VCGL::DistanceMatrix& dmat, QVector<TSPoint>& outPointsProjection);
+    /**
+     * @brief	Sammon's Mapping of the objects of a distance matrix
+     *
+     * Every iteration seeds the random permutations with its number, so a run
+     * continued from the state after some iterations gives the same result as an
+     * uninterrupted one.
+     *
+     * @param ids		Objects of the matrix to be projected
+     * @param dmat		Distances of the objects
+     * @param outPointsProjection (output) mapping of the objects; with firstIteration > 0 (input as well)
+     * 				the projection after firstIteration iterations to continue from
+     * @param pObserver	Receiver of the state after every iteration (optional)
+     * @param firstIteration Number of the iteration to start with
+     */
+    static void performSammonDMAT(const std::vector<VCGL::strType>& ids, const VCGL::DistanceMatrix& dmat, QVector<TSPoint>& outPointsProjection,
+    		SammonObserver* pObserver = 0, int firstIteration = 0);
+
+    /// Number of iterations of performSammonDMAT
+    static const int ITERATION_COUNT = 101;
 
     /**
      * @brief	Return a vector of random permutation of number 0 to size-1
@@ -0,0 +1,60 @@
+/*!	@file sammoncontroller.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Iterations of Sammon's mapping driven by its stress, with progress and cancellation
+ */
+
+#include "sammoncontroller.h"
+
+#include "sammon.h"
+
+#include <cmath>
+
+namespace LSP {
+
+SammonController::SammonController(double tolerance, const ProgressCallback& progress)
+: tolerance(tolerance), progress(progress), cancelRequested(false), bConverged(false), completed(0), lastStress(0.0) {}
+
+double SammonController::lambda(int iteration) const {
+	if (tolerance > 0.0) {
+		return pow(0.01, (double)iteration / (double)DECAY_ITERATIONS);
+	}
+	// as Sammon::performSammonDMAT
+	return pow(0.01, (double)iteration / (double)(Sammon::ITERATION_COUNT - 1));
+}
+
+int SammonController::maxIterations() const {
+	return Sammon::ITERATION_COUNT;
+}
+
+int SammonController::warmStartIteration() const {
+	return tolerance > 0.0 ? DECAY_ITERATIONS : maxIterations() - REFINEMENT_ITERATIONS;
+}
+
+void SammonController::start(int firstIteration, double stress) {
+	bConverged = false;
+	completed = firstIteration;
+	lastStress = stress;
+}
+
+bool SammonController::iterationDone(int iterations, double stress) {
+	const bool bCancelled = cancelRequested;
+	// the stress is compared only once lambda is down to 0.01, before it falls with lambda anyway
+	bConverged = !bCancelled && tolerance > 0.0 && iterations > DECAY_ITERATIONS
+			&& lastStress - stress <= tolerance*lastStress;
+	completed = iterations;
+	lastStress = stress;
+
+	const bool last = bCancelled || bConverged || iterations >= maxIterations();
+	if (progress) {
+		SammonProgress state;
+		state.iterations = iterations;
+		state.maxIterations = maxIterations();
+		state.stress = stress;
+		state.last = last;
+		progress(state);
+	}
+	return !last;
+}
+
+} // namespace LSP
@@ -0,0 +1,95 @@
+/*!	@file sammoncontroller.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Iterations of Sammon's mapping driven by its stress, with progress and cancellation
+ */
+
+#ifndef SAMMONCONTROLLER_H_
+#define SAMMONCONTROLLER_H_
+
+#include <atomic>
+#include <functional>
+
+namespace LSP {
+
+/// State of Sammon's mapping after an iteration
+struct SammonProgress {
+	int iterations;		///< number of completed iterations
+	int maxIterations;	///< number of iterations of the whole schedule
+	double stress;		///< Sammon's stress over a sample of the pairs (see ParallelSammon::STRESS_SAMPLE_SIZE)
+	bool last;			///< no iteration follows: the schedule is complete, the stress converged or the run is cancelled
+};
+
+/*! @brief Step sizes of Sammon's mapping, when to stop it, and its progress
+ *
+ * Without a tolerance, the schedule of Sammon::performSammonDMAT: ITERATION_COUNT iterations
+ * with lambda decaying from 1 to 0.01, the stress falling until the last one only because lambda
+ * does. With a tolerance, lambda reaches 0.01 after DECAY_ITERATIONS and decays further at the
+ * same rate. The layout then settles within a few iterations, and the mapping stops after the
+ * first of them that improves the stress by less than the tolerance (relative), or after
+ * ITERATION_COUNT iterations at most.
+ *
+ * Lambda depends on the number of the iteration only, so a run continued from any iteration
+ * (ParallelSammon::perform with firstIteration > 0) stops where the uninterrupted one does.
+ * A layout that is almost right already, e.g. of slightly different data, is refined by
+ * continuing it from warmStartIteration() instead of running the whole schedule.
+ */
+class SammonController {
+public:
+	typedef std::function<void(const SammonProgress&)> ProgressCallback;
+
+	/*! @brief Constructor
+	 *
+	 * @param tolerance	Smallest relative improvement of the stress to go on (0 - the whole fixed schedule)
+	 * @param progress	Called after every iteration (optional)
+	 */
+	explicit SammonController(double tolerance = 0.0, const ProgressCallback& progress = ProgressCallback());
+
+	/// Step size of the iteration (counted from 0)
+	double lambda(int iteration) const;
+	/// Number of iterations at most
+	int maxIterations() const;
+	/*! @brief Iteration to refine a given layout from (ParallelSammon::perform with it as firstIteration)
+	 *
+	 * The last REFINEMENT_ITERATIONS of the fixed schedule, or with a tolerance the iterations
+	 * after the decay of lambda, until the stress converges.
+	 */
+	int warmStartIteration() const;
+
+	/// Begin a run with iteration firstIteration, from a projection of the given stress
+	void start(int firstIteration, double stress);
+
+	/*! @brief Account for a completed iteration and report the progress
+	 *
+	 * @param iterations Number of completed iterations
+	 * @param stress Stress after them
+	 * @return Whether to go on with the next iteration
+	 */
+	bool iterationDone(int iterations, double stress);
+
+	/// Stop the mapping after the current iteration; may be called from any thread or a signal handler
+	void cancel() { cancelRequested = true; }
+	bool cancelled() const { return cancelRequested; }
+
+	/// Whether the last run stopped because the stress converged
+	bool converged() const { return bConverged; }
+	/// Number of iterations completed by the last run (with those before its first one)
+	int iterations() const { return completed; }
+
+	/// Number of iterations in which lambda decays to 0.01 with a tolerance
+	static const int DECAY_ITERATIONS = 10;
+	/// Number of iterations refining a layout on the fixed schedule
+	static const int REFINEMENT_ITERATIONS = 10;
+
+private:
+	double tolerance;
+	ProgressCallback progress;
+	std::atomic<bool> cancelRequested;
+	bool bConverged;
+	int completed;
+	double lastStress;
+};
+
+} // namespace LSP
+
+#endif // SAMMONCONTROLLER_H_
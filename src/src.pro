@@ -23,6 +23,7 @@ HEADERS += storage/datastorage.h \
     exploration/projection/projectionwidget.h \
     exploration/projection/transformmatrix2d.h \
     exploration/explorationmodelimpl.h \
+    exploration/explorationloader.h \
     exploration/fakeexplorationmodel.h \
     exploration/maps/annotationlink.h \
     exploration/maps/textpainter.h \
@@ -42,6 +43,17 @@ HEADERS += storage/datastorage.h \
     storage/filesystem.h \
     storage/pathresolver.h \
     storage/precomputeddata.h \
+    storage/correlationstore.h \
+    storage/mappedfile.h \
+    storage/sparsecorrelationstore.h \
+    storage/hyperslabunpack.h \
+    storage/databandreader.h \
+    storage/datasubset.h \
+    storage/precomputecache.h \
+    storage/precomputecheckpoint.h \
+    storage/correlationshard.h \
+    storage/compressedcorrelationstore.h \
+    storage/correlationencoding.h \
     colorizer/rgb.h \
     colorizer/transferfunctioneditor.h \
     colorizer/transferfunctionstorage.h \
@@ -50,6 +62,11 @@ HEADERS += storage/datastorage.h \
     preferences/preferencepanelogic.h \
     preferences/preferencepane.h \
     process/precompute.h \
+    process/alignedbuffer.h \
+    process/correlationengine.h \
+    process/threadpool.h \
+    process/correlationstatistics.h \
+    process/laggedcorrelation.h \
     process/progressbar.h \
     storage/read.h \
     colorizer/transferfunctionobject.h \
@@ -61,8 +78,14 @@ HEADERS += storage/datastorage.h \
     projection/ilspdata.h \
     projection/projectedpointinfo.h \
     projection/sammon.h \
+    projection/parallelsammon.h \
+    projection/landmarkprojection.h \
+    projection/classicalmds.h \
+    projection/sammoncontroller.h \
     projection/tspoint.h \
     typedefs.h \
+    symmetricmatrix.h \
+    timeseriesfield.h \
     multiplatform/declareqcloseevent.h \
     multiplatform/declareqmouseevent.h \
     multiplatform/devicepixelratio.h \
@@ -76,6 +99,7 @@ HEADERS += storage/datastorage.h \
 
 SOURCES += storage/ncfiledatastorage.cpp \ 
 	storage/tcstorage.cpp \
+	storage/datastorage.cpp \
     exploration/coordinatetext.cpp \
     exploration/maps/mapgrid.cpp \
     preferences/preferencestorage.cpp \
@@ -85,6 +109,7 @@ SOURCES += storage/ncfiledatastorage.cpp \
     exploration/projection/projectionwidget.cpp \
     exploration/projection/transformmatrix2d.cpp \
     exploration/explorationmodelimpl.cpp \
+    exploration/explorationloader.cpp \
     exploration/fakeexplorationmodel.cpp \
     exploration/maps/equirectangularmapsubview.cpp \
     exploration/maps/polarmapsubview.cpp \
@@ -99,12 +124,27 @@ SOURCES += storage/ncfiledatastorage.cpp \
     storage/filesystem.cpp \
     storage/pathresolver.cpp \
     storage/precomputeddata.cpp \
+    storage/correlationstore.cpp \
+    storage/mappedfile.cpp \
+    storage/sparsecorrelationstore.cpp \
+    storage/hyperslabunpack.cpp \
+    storage/databandreader.cpp \
+    storage/datasubset.cpp \
+    storage/precomputecache.cpp \
+    storage/precomputecheckpoint.cpp \
+    storage/correlationshard.cpp \
+    storage/compressedcorrelationstore.cpp \
+    storage/correlationencoding.cpp \
     preferences/preferences.cpp \
     colorizer/transferfunctioneditor.cpp \
     colorizer/transferfunctionstorage.cpp \
     preferences/preferencepanelogic.cpp \
     preferences/preferencepane.cpp \
     process/precompute.cpp \
+    process/correlationengine.cpp \
+    process/threadpool.cpp \
+    process/correlationstatistics.cpp \
+    process/laggedcorrelation.cpp \
     storage/read.cpp \
     colorizer/transferfunctionobject.cpp \
     colorizer/transferfunctioneditorwidget.cpp \
@@ -112,6 +152,10 @@ SOURCES += storage/ncfiledatastorage.cpp \
     colorizer/icolorizer.cpp \
     projection/distancematrix.cpp \
     projection/sammon.cpp \
+    projection/parallelsammon.cpp \
+    projection/landmarkprojection.cpp \
+    projection/classicalmds.cpp \
+    projection/sammoncontroller.cpp \
     projection/tspoint.cpp \
     exploration/regions/regionsearchexplorer.cpp
 
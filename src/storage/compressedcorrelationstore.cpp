@@ -0,0 +1,385 @@
+/*!	@file compressedcorrelationstore.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Correlations stored as compressed chunks of full rows, decoded on demand
+ */
+
+#include "compressedcorrelationstore.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace VCGL {
+
+const char COMPRESSED_CORRELATION_FILE_MAGIC[8] = { 'T', 'C', 'X', 'C', 'O', 'R', 'Z', '\n' };
+
+static_assert(sizeof(CompressedCorrelationFileHeader) == 64, "header keeps the tables aligned");
+
+namespace {
+	/// Values of full rows per chunk the writer aims at
+	const std::size_t CHUNK_VALUES = std::size_t(1) << 16;
+	/// Slab of full rows put together at once when no budget is given
+	const std::size_t DEFAULT_SLAB_BYTES = std::size_t(64) << 20;
+	/// Correlation 1 is stored as this integer: an error of at most 5e-4, far below a color of the maps
+	const std::uint32_t QUANTIZATION_LEVELS = 1000;
+	/// Number of predictions a row can be encoded with, see predict
+	const unsigned PREDICTION_COUNT = 4;
+
+	std::int32_t quantize(float value, std::uint32_t levels) {
+		if (!(value == value)) {
+			return 0;
+		}
+		const float clamped = std::max(-1.0f, std::min(1.0f, value));
+		return static_cast<std::int32_t>(std::lround(clamped * static_cast<float>(levels)));
+	}
+
+	float dequantize(std::int32_t q, std::uint32_t levels) {
+		return static_cast<float>(q) / static_cast<float>(levels);
+	}
+
+	void putVarint(std::uint32_t value, std::vector<unsigned char>& out) {
+		while (value >= 0x80) {
+			out.push_back(static_cast<unsigned char>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(value));
+	}
+
+	/// Read a varint of at most 32 bits, false at the end of the data
+	bool getVarint(const unsigned char*& p, const unsigned char* end, std::uint32_t& value) {
+		value = 0;
+		for (unsigned shift = 0; shift < 35 && p < end; shift += 7) {
+			const unsigned char byte = *p++;
+			value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::uint32_t zigzag(std::int32_t value) {
+		return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+	}
+
+	std::int32_t unzigzag(std::uint32_t value) {
+		return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+	}
+
+	/*! @brief Prediction of value j of a row
+	 *
+	 * 0 - none, 1 - the left neighbour, 2 - the value above (in the previous row of the chunk),
+	 * 3 - left + above - above-left. Predictions 2 and 3 need the previous row.
+	 */
+	std::int32_t predict(unsigned prediction, const std::int32_t* row, const std::int32_t* above, std::size_t j) {
+		switch (prediction) {
+		case 1:
+			return j > 0 ? row[j-1] : 0;
+		case 2:
+			return above[j];
+		case 3:
+			return j > 0 ? row[j-1] + above[j] - above[j-1] : above[j];
+		default:
+			return 0;
+		}
+	}
+
+	/*! @brief Append a full row with the prediction that gives the fewest bytes
+	 *
+	 * @param above Quantized previous row of the chunk, null for the first row
+	 * @param q Receives the quantized row
+	 * @param best, candidate Buffers for the encodings that are tried
+	 */
+	void encodeRow(const float* values, std::size_t n, std::uint32_t levels, const std::int32_t* above, std::int32_t* q,
+			std::vector<unsigned char>& best, std::vector<unsigned char>& candidate, std::vector<unsigned char>& out) {
+		for (std::size_t j = 0; j<n; j++) {
+			q[j] = quantize(values[j], levels);
+		}
+		const unsigned count = above ? PREDICTION_COUNT : 2;
+		for (unsigned prediction = 0; prediction<count; prediction++) {
+			candidate.clear();
+			candidate.push_back(static_cast<unsigned char>(prediction));
+			for (std::size_t j = 0; j<n; j++) {
+				putVarint(zigzag(q[j] - predict(prediction, q, above, j)), candidate);
+			}
+			if (prediction == 0 || candidate.size() < best.size()) {
+				best.swap(candidate);
+			}
+		}
+		out.insert(out.end(), best.begin(), best.end());
+	}
+
+	/// Minimum of a full row other than the diagonal, ties go to the smaller index (as TeleconnectivityMinima)
+	void fullRowMinimum(const float* values, std::size_t n, std::size_t diagonal, float* pMin, std::uint32_t* pIndex) {
+		float minCorr = 1.0f;
+		std::size_t minIndex = diagonal;
+		for (std::size_t j = 0; j<n; j++) {
+			if (j != diagonal && values[j] < minCorr) {
+				minCorr = values[j];
+				minIndex = j;
+			}
+		}
+		*pMin = minCorr;
+		*pIndex = static_cast<std::uint32_t>(minIndex);
+	}
+
+	bool compressedHeaderValid(const CompressedCorrelationFileHeader& header, std::size_t fileSize, std::string* pReason) {
+		if (header.byteOrder != CORRELATION_BYTE_ORDER) {
+			*pReason = "file was written on a machine with different byte order";
+			return false;
+		}
+		if (header.version != COMPRESSED_CORRELATION_FILE_VERSION) {
+			*pReason = "incomplete file or unsupported file version";
+			return false;
+		}
+		if (header.codec != COMPRESSED_QUANTIZED_DELTA || header.quantizationLevels == 0
+				|| header.quantizationLevels > (1u << 30)) {
+			*pReason = "unsupported encoding";
+			return false;
+		}
+		if (header.headerSize < sizeof(CompressedCorrelationFileHeader) + sizeof(GridSubsetRecord)
+				|| header.headerSize % sizeof(std::uint64_t) != 0) {
+			*pReason = "invalid header size";
+			return false;
+		}
+		if (header.npoints != header.nlat*header.nlon) {
+			*pReason = "point count does not match the grid";
+			return false;
+		}
+		if (header.npoints > fileSize || header.rowsPerChunk == 0
+				|| header.chunkCount != (header.npoints + header.rowsPerChunk - 1) / header.rowsPerChunk
+				|| fileSize < header.headerSize + header.npoints*(sizeof(float) + sizeof(std::uint32_t))
+						+ (header.chunkCount+1)*sizeof(std::uint64_t)) {
+			*pReason = "file size does not match the header";
+			return false;
+		}
+		return true;
+	}
+
+	bool compressedTablesValid(const CompressedCorrelationFileHeader& header, const char* pData, std::size_t fileSize) {
+		const std::uint32_t* partners = reinterpret_cast<const std::uint32_t*>(
+				pData + header.headerSize + header.npoints*sizeof(float));
+		for (std::size_t i = 0; i<header.npoints; i++) {
+			if (partners[i] >= header.npoints) {
+				return false;
+			}
+		}
+		const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(partners + header.npoints);
+		const std::uint64_t dataStart = header.headerSize + header.npoints*(sizeof(float) + sizeof(std::uint32_t))
+				+ (header.chunkCount+1)*sizeof(std::uint64_t);
+		if (offsets[0] != dataStart || offsets[header.chunkCount] != fileSize) {
+			return false;
+		}
+		for (std::size_t c = 0; c<header.chunkCount; c++) {
+			if (offsets[c+1] < offsets[c]) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+CompressedCorrelationStore::CompressedCorrelationStore(MappedFile&& mappedFile,
+		const CompressedCorrelationFileHeader& fileHeader, std::size_t cachedChunks)
+: file(std::move(mappedFile)),
+  header(fileHeader),
+  npoints(fileHeader.npoints),
+  pMinima(reinterpret_cast<const float*>(file.data() + fileHeader.headerSize)),
+  pPartners(reinterpret_cast<const std::uint32_t*>(pMinima + fileHeader.npoints)),
+  pChunkOffsets(reinterpret_cast<const std::uint64_t*>(pPartners + fileHeader.npoints)),
+  useCounter(0),
+  decodedChunks(0),
+  cacheCapacity(std::max<std::size_t>(cachedChunks, 1)) {
+}
+
+float CompressedCorrelationStore::value(std::size_t i, std::size_t j) const {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	const std::vector<float>& rows = chunkRows(i / header.rowsPerChunk);
+	return rows[(i % header.rowsPerChunk)*npoints + j];
+}
+
+void CompressedCorrelationStore::row(std::size_t i, float* out) const {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	const std::vector<float>& rows = chunkRows(i / header.rowsPerChunk);
+	const float* pRow = rows.data() + (i % header.rowsPerChunk)*npoints;
+	std::copy(pRow, pRow + npoints, out);
+}
+
+void CompressedCorrelationStore::rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const {
+	*pMin = pMinima[i];
+	*pIndex = pPartners[i];
+}
+
+std::size_t CompressedCorrelationStore::decodedChunkCount() const {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return decodedChunks;
+}
+
+const std::vector<float>& CompressedCorrelationStore::chunkRows(std::size_t c) const {
+	useCounter++;
+	for (std::size_t k = 0; k<cache.size(); k++) {
+		if (cache[k].chunk == c) {
+			cache[k].lastUse = useCounter;
+			return cache[k].values;
+		}
+	}
+
+	// a new entry while there is room, otherwise the least recently used one is reused
+	std::size_t slot = cache.size();
+	if (cache.size() < cacheCapacity) {
+		cache.push_back(CachedChunk());
+	}
+	else {
+		slot = 0;
+		for (std::size_t k = 1; k<cache.size(); k++) {
+			if (cache[k].lastUse < cache[slot].lastUse) {
+				slot = k;
+			}
+		}
+	}
+	CachedChunk& entry = cache[slot];
+	entry.chunk = c;
+	entry.lastUse = useCounter;
+	decodedChunks++;
+
+	const std::size_t rowBegin = c*header.rowsPerChunk;
+	const std::size_t rowCount = std::min<std::size_t>(header.rowsPerChunk, npoints - rowBegin);
+	entry.values.assign(rowCount*npoints, 0.0f);
+	std::vector<std::int32_t> q(2*npoints);
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(file.data() + pChunkOffsets[c]);
+	const unsigned char* end = reinterpret_cast<const unsigned char*>(file.data() + pChunkOffsets[c+1]);
+	for (std::size_t r = 0; r<rowCount; r++) {
+		float* out = entry.values.data() + r*npoints;
+		std::int32_t* row = &q[(r % 2)*npoints];
+		const std::int32_t* above = (r > 0) ? &q[((r+1) % 2)*npoints] : 0;
+		const unsigned prediction = (p < end) ? *p++ : PREDICTION_COUNT;
+		bool bOk = prediction < (above ? PREDICTION_COUNT : 2);
+		for (std::size_t j = 0; j<npoints && bOk; j++) {
+			std::uint32_t z = 0;
+			bOk = getVarint(p, end, z);
+			row[j] = predict(prediction, row, above, j) + unzigzag(z);
+			out[j] = dequantize(row[j], header.quantizationLevels);
+		}
+		if (!bOk) {
+			// the rest of the chunk reads as uncorrelated
+			std::cerr << "WARNING: chunk " << c << " of the compressed correlations is damaged" << std::endl;
+			std::fill(out, entry.values.data() + entry.values.size(), 0.0f);
+			break;
+		}
+	}
+	return entry.values;
+}
+
+bool storeCorrelationsCompressed(const SymmetricMatrixView<float>& correlations, std::size_t nlat, std::size_t nlon,
+		const std::string& fileName, const GridSubsetRecord& subset, std::size_t memoryBudget) {
+	const std::size_t npoints = correlations.size();
+	assert(npoints == nlat*nlon);
+	const std::size_t rowsPerChunk = std::max<std::size_t>(1, CHUNK_VALUES / std::max<std::size_t>(npoints, 1));
+	const std::size_t chunkCount = (npoints + rowsPerChunk - 1) / rowsPerChunk;
+
+	CompressedCorrelationFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, COMPRESSED_CORRELATION_FILE_MAGIC, sizeof(header.magic));
+	header.codec = COMPRESSED_QUANTIZED_DELTA;
+	header.byteOrder = CORRELATION_BYTE_ORDER;
+	header.headerSize = sizeof(CompressedCorrelationFileHeader) + sizeof(GridSubsetRecord);
+	header.npoints = npoints;
+	header.nlat = nlat;
+	header.nlon = nlon;
+	header.rowsPerChunk = static_cast<std::uint32_t>(rowsPerChunk);
+	header.quantizationLevels = QUANTIZATION_LEVELS;
+	header.chunkCount = chunkCount;
+
+	std::vector<float> minima(npoints);
+	std::vector<std::uint32_t> partners(npoints);
+	std::vector<std::uint64_t> offsets(chunkCount+1);
+
+	// the version is set once the tables are written, a file that was not completed stays invalid
+	std::ofstream fout(fileName, std::ofstream::binary | std::ofstream::trunc);
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(&subset), sizeof(subset));
+	fout.write(reinterpret_cast<const char*>(minima.data()), minima.size()*sizeof(float));
+	fout.write(reinterpret_cast<const char*>(partners.data()), partners.size()*sizeof(std::uint32_t));
+	fout.write(reinterpret_cast<const char*>(offsets.data()), offsets.size()*sizeof(std::uint64_t));
+	std::uint64_t position = header.headerSize + npoints*(sizeof(float) + sizeof(std::uint32_t))
+			+ offsets.size()*sizeof(std::uint64_t);
+
+	// slabs of whole chunks
+	const std::size_t budget = memoryBudget > 0 ? memoryBudget : DEFAULT_SLAB_BYTES;
+	const std::size_t budgetRows = budget / (std::max<std::size_t>(npoints, 1)*sizeof(float));
+	const std::size_t slabRows = std::max(rowsPerChunk, budgetRows - budgetRows % rowsPerChunk);
+	std::vector<float> slab;
+	std::vector<std::int32_t> q(2*npoints);
+	std::vector<unsigned char> encoded, best, candidate;
+	const float* triangle = correlations.data();
+	for (std::size_t slabBegin = 0; slabBegin<npoints && fout; slabBegin += slabRows) {
+		const std::size_t slabEnd = std::min(npoints, slabBegin + slabRows);
+		slab.resize((slabEnd - slabBegin)*npoints);
+		for (std::size_t i = slabBegin; i<slabEnd; i++) {
+			float* full = &slab[(i - slabBegin)*npoints];
+			std::copy(triangle + triangleOffset(i), triangle + triangleOffset(i) + i, full);
+			full[i] = correlations.diagonal();
+		}
+		// the rest of the rows are columns of the later rows of the triangle
+		for (std::size_t j = slabBegin+1; j<npoints; j++) {
+			const float* rowJ = triangle + triangleOffset(j);
+			const std::size_t iEnd = std::min(slabEnd, j);
+			for (std::size_t i = slabBegin; i<iEnd; i++) {
+				slab[(i - slabBegin)*npoints + j] = rowJ[i];
+			}
+		}
+
+		for (std::size_t chunkBegin = slabBegin; chunkBegin<slabEnd; chunkBegin += rowsPerChunk) {
+			const std::size_t chunkEnd = std::min(slabEnd, chunkBegin + rowsPerChunk);
+			encoded.clear();
+			for (std::size_t i = chunkBegin; i<chunkEnd; i++) {
+				const std::size_t r = i - chunkBegin;
+				const float* full = &slab[(i - slabBegin)*npoints];
+				encodeRow(full, npoints, header.quantizationLevels, (r > 0) ? &q[((r+1) % 2)*npoints] : 0, &q[(r % 2)*npoints],
+						best, candidate, encoded);
+				fullRowMinimum(full, npoints, i, &minima[i], &partners[i]);
+			}
+			offsets[chunkBegin / rowsPerChunk] = position;
+			fout.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+			position += encoded.size();
+		}
+	}
+	offsets[chunkCount] = position;
+
+	header.version = COMPRESSED_CORRELATION_FILE_VERSION;
+	fout.seekp(header.headerSize);
+	fout.write(reinterpret_cast<const char*>(minima.data()), minima.size()*sizeof(float));
+	fout.write(reinterpret_cast<const char*>(partners.data()), partners.size()*sizeof(std::uint32_t));
+	fout.write(reinterpret_cast<const char*>(offsets.data()), offsets.size()*sizeof(std::uint64_t));
+	fout.seekp(0);
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.close();
+	return !fout.fail();
+}
+
+bool isCompressedCorrelationFile(const MappedFile& file) {
+	return file.size() >= sizeof(CompressedCorrelationFileHeader)
+			&& memcmp(file.data(), COMPRESSED_CORRELATION_FILE_MAGIC, sizeof(COMPRESSED_CORRELATION_FILE_MAGIC)) == 0;
+}
+
+std::unique_ptr<CorrelationStore> openCompressedCorrelationStore(const std::string& fileName, MappedFile&& file) {
+	CompressedCorrelationFileHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+
+	std::string reason;
+	if (!compressedHeaderValid(header, file.size(), &reason)) {
+		std::cerr << "Cannot use " << fileName << ": " << reason << std::endl;
+		return std::unique_ptr<CorrelationStore>();
+	}
+	if (!compressedTablesValid(header, file.data(), file.size())) {
+		std::cerr << "Cannot use " << fileName << ": corrupted chunk index" << std::endl;
+		return std::unique_ptr<CorrelationStore>();
+	}
+	return std::unique_ptr<CorrelationStore>(new CompressedCorrelationStore(std::move(file), header));
+}
+
+} // namespace VCGL
@@ -0,0 +1,142 @@
+/*!	@file compressedcorrelationstore.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Correlations stored as compressed chunks of full rows, decoded on demand
+ */
+
+#ifndef COMPRESSEDCORRELATIONSTORE_H_
+#define COMPRESSEDCORRELATIONSTORE_H_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+#include "mappedfile.h"
+#include "symmetricmatrix.h"
+#include "storage/correlationstore.h"
+
+namespace VCGL {
+
+/*! @brief Header of the compressed correlation file
+ *
+ * The header is followed by a GridSubsetRecord, the minimum of every row
+ * other than the diagonal (float32, npoints, not quantized) and the point
+ * where it is reached (uint32, npoints), the chunk index (uint64 file
+ * offsets, chunkCount+1) and the chunks.
+ * Chunk c holds the full rows [c*rowsPerChunk, (c+1)*rowsPerChunk) of the
+ * symmetric matrix, the diagonal included, encoded with the codec.
+ * All fields are in the byte order of the writing machine, see byteOrder.
+ */
+struct CompressedCorrelationFileHeader {
+	char magic[8];			///< COMPRESSED_CORRELATION_FILE_MAGIC
+	std::uint32_t version;	///< COMPRESSED_CORRELATION_FILE_VERSION, 0 until the file is complete
+	std::uint32_t codec;	///< encoding of the rows (CompressedCorrelationCodec)
+	std::uint32_t byteOrder;	///< CORRELATION_BYTE_ORDER as written by the producer
+	std::uint32_t headerSize;	///< offset of the row minima from the file start
+	std::uint64_t npoints;
+	std::uint64_t nlat;
+	std::uint64_t nlon;
+	std::uint32_t rowsPerChunk;
+	std::uint32_t quantizationLevels;	///< correlation 1 is stored as this integer
+	std::uint64_t chunkCount;
+};
+
+extern const char COMPRESSED_CORRELATION_FILE_MAGIC[8];
+const std::uint32_t COMPRESSED_CORRELATION_FILE_VERSION = 1;
+
+/*! @brief Encodings of the rows of a compressed correlation file
+ *
+ * QUANTIZED_DELTA: every value is rounded to a multiple of 1/quantizationLevels
+ * (an error of at most 1/(2*quantizationLevels)). A row starts with a byte
+ * choosing how its integers are predicted: not at all, from the left
+ * neighbour, from the previous row of the chunk, or from left + above -
+ * above-left. The differences to the prediction are zigzag encoded and
+ * written as base-128 varints. Correlations change smoothly between
+ * neighbouring grid points and neighbouring rows, and the weak correlations
+ * of distant points are small integers, so most values take one byte.
+ */
+enum CompressedCorrelationCodec {
+	COMPRESSED_QUANTIZED_DELTA = 1
+};
+
+/*! @brief Correlations read from a compressed correlation file
+ *
+ * Only the chunk of a requested row is decoded; the last few decoded chunks
+ * are kept (least recently used are dropped), so browsing reference points
+ * in one region decodes little. Row minima come from the table of the file
+ * without decoding anything. Reading from several threads is safe.
+ */
+class CompressedCorrelationStore: public CorrelationStore {
+public:
+	/// Number of decoded chunks kept by default
+	static const std::size_t DEFAULT_CACHED_CHUNKS = 8;
+
+	/*! @brief Store reading the mapped file, the header must have been validated
+	 *
+	 * @param cachedChunks Number of decoded chunks to keep
+	 */
+	CompressedCorrelationStore(MappedFile&& file, const CompressedCorrelationFileHeader& header,
+			std::size_t cachedChunks = DEFAULT_CACHED_CHUNKS);
+
+	virtual std::size_t pointCount() const override { return npoints; }
+	virtual float value(std::size_t i, std::size_t j) const override;
+	virtual void row(std::size_t i, float* out) const override;
+	virtual void rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const override;
+
+	/// Number of chunks decoded so far (cache misses)
+	std::size_t decodedChunkCount() const;
+
+private:
+	/// Decoded rows of chunk c, from the cache or decoded into it; the cache mutex must be held
+	const std::vector<float>& chunkRows(std::size_t c) const;
+
+	struct CachedChunk {
+		std::size_t chunk;
+		std::uint64_t lastUse;
+		std::vector<float> values;
+	};
+
+	MappedFile file;
+	CompressedCorrelationFileHeader header;
+	std::size_t npoints;
+	const float* pMinima;
+	const std::uint32_t* pPartners;
+	const std::uint64_t* pChunkOffsets;
+
+	mutable std::mutex cacheMutex;
+	mutable std::vector<CachedChunk> cache;
+	mutable std::uint64_t useCounter;
+	mutable std::size_t decodedChunks;
+	std::size_t cacheCapacity;
+};
+
+/*! @brief Store the correlations in the compressed format
+ *
+ * The full rows are put together from the packed triangle in slabs of rows,
+ * reading every row of the triangle once per slab: with a triangle mapped from
+ * a file larger than the memory, a larger budget means fewer passes over it.
+ *
+ * @param correlations The correlations, e.g. in memory or mapped from a triangle file
+ * @param subset Part of the data file the correlations were computed from
+ * @param memoryBudget Bytes for a slab of full rows (0 - a default of 64 MB)
+ * @return false if the file could not be written
+ */
+bool storeCorrelationsCompressed(const SymmetricMatrixView<float>& correlations, std::size_t nlat, std::size_t nlon,
+		const std::string& fileName, const GridSubsetRecord& subset = GridSubsetRecord::whole(),
+		std::size_t memoryBudget = 0);
+
+/// Whether the mapped file starts with the compressed correlation file magic
+bool isCompressedCorrelationFile(const MappedFile& file);
+
+/*! @brief Open a mapped compressed correlation file
+ *
+ * @return The store, or null if the file is not valid (reason reported to stderr)
+ */
+std::unique_ptr<CorrelationStore> openCompressedCorrelationStore(const std::string& fileName, MappedFile&& file);
+
+} // namespace VCGL
+
+#endif // COMPRESSEDCORRELATIONSTORE_H_
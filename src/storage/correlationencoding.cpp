@@ -0,0 +1,322 @@
+/*!	@file correlationencoding.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Correlation values stored in fewer bits: half precision and fixed point
+ */
+
+#include "correlationencoding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TELCON_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace VCGL {
+
+namespace {
+	const float INT16_SCALE = 32767.0f;
+	const float INT8_SCALE = 127.0f;
+	// decoding multiplies by the inverse in every variant, so they agree to the bit
+	const float INT16_STEP = 1.0f / INT16_SCALE;
+	const float INT8_STEP = 1.0f / INT8_SCALE;
+
+	template<typename T>
+	T toFixedPoint(float value, float scale) {
+		if (!(value == value)) {
+			return 0;
+		}
+		return static_cast<T>(std::lround(std::max(-1.0f, std::min(1.0f, value)) * scale));
+	}
+
+	void fromFloat16Scalar(const std::uint16_t* in, std::size_t count, float* out) {
+		for (std::size_t j = 0; j<count; j++) {
+			out[j] = halfToFloat(in[j]);
+		}
+	}
+
+	void fromInt16Scalar(const std::int16_t* in, std::size_t count, float* out) {
+		for (std::size_t j = 0; j<count; j++) {
+			out[j] = static_cast<float>(in[j]) * INT16_STEP;
+		}
+	}
+
+	void fromInt8Scalar(const std::int8_t* in, std::size_t count, float* out) {
+		for (std::size_t j = 0; j<count; j++) {
+			out[j] = static_cast<float>(in[j]) * INT8_STEP;
+		}
+	}
+
+	const CorrelationDecoder scalarDecoder = { "scalar", fromFloat16Scalar, fromInt16Scalar, fromInt8Scalar };
+
+#ifdef TELCON_X86_KERNELS
+
+	// every processor with AVX2 has the F16C conversions as well
+	__attribute__((target("avx2,f16c")))
+	void fromFloat16AVX2(const std::uint16_t* in, std::size_t count, float* out) {
+		std::size_t j = 0;
+		for (; j+8 <= count; j += 8) {
+			const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+j));
+			_mm256_storeu_ps(out+j, _mm256_cvtph_ps(h));
+		}
+		fromFloat16Scalar(in+j, count-j, out+j);
+	}
+
+	__attribute__((target("avx2")))
+	void fromInt16AVX2(const std::int16_t* in, std::size_t count, float* out) {
+		const __m256 step = _mm256_set1_ps(INT16_STEP);
+		std::size_t j = 0;
+		for (; j+8 <= count; j += 8) {
+			const __m256i q = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+j)));
+			_mm256_storeu_ps(out+j, _mm256_mul_ps(_mm256_cvtepi32_ps(q), step));
+		}
+		fromInt16Scalar(in+j, count-j, out+j);
+	}
+
+	__attribute__((target("avx2")))
+	void fromInt8AVX2(const std::int8_t* in, std::size_t count, float* out) {
+		const __m256 step = _mm256_set1_ps(INT8_STEP);
+		std::size_t j = 0;
+		for (; j+8 <= count; j += 8) {
+			const __m256i q = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in+j)));
+			_mm256_storeu_ps(out+j, _mm256_mul_ps(_mm256_cvtepi32_ps(q), step));
+		}
+		fromInt8Scalar(in+j, count-j, out+j);
+	}
+
+	const CorrelationDecoder avx2Decoder = { "avx2", fromFloat16AVX2, fromInt16AVX2, fromInt8AVX2 };
+
+#endif // TELCON_X86_KERNELS
+}
+
+std::size_t correlationValueSize(std::uint32_t dtype) {
+	switch (dtype) {
+	case CORRELATION_FLOAT32:
+		return sizeof(float);
+	case CORRELATION_FLOAT16:
+	case CORRELATION_INT16:
+		return sizeof(std::uint16_t);
+	case CORRELATION_INT8:
+		return sizeof(std::int8_t);
+	default:
+		return 0;
+	}
+}
+
+const char* correlationDataTypeName(CorrelationDataType dtype) {
+	switch (dtype) {
+	case CORRELATION_FLOAT16:
+		return "float16";
+	case CORRELATION_INT16:
+		return "int16";
+	case CORRELATION_INT8:
+		return "int8";
+	default:
+		return "float32";
+	}
+}
+
+bool parseCorrelationDataType(const std::string& name, CorrelationDataType* pType) {
+	const CorrelationDataType types[] = { CORRELATION_FLOAT32, CORRELATION_FLOAT16, CORRELATION_INT16, CORRELATION_INT8 };
+	for (CorrelationDataType dtype: types) {
+		if (name == correlationDataTypeName(dtype)) {
+			*pType = dtype;
+			return true;
+		}
+	}
+	return false;
+}
+
+double correlationEncodingError(CorrelationDataType dtype) {
+	switch (dtype) {
+	case CORRELATION_FLOAT16:
+		// half of the spacing of the half precision values in [0.5, 1]
+		return std::ldexp(1.0, -12);
+	case CORRELATION_INT16:
+		return 0.5 / INT16_SCALE;
+	case CORRELATION_INT8:
+		return 0.5 / INT8_SCALE;
+	default:
+		// half of the spacing of the floats in [0.5, 1]
+		return std::ldexp(1.0, -25);
+	}
+}
+
+double QuantizationError::rms() const {
+	return count > 0 ? std::sqrt(sumSquares / count) : 0.0;
+}
+
+void encodeCorrelations(CorrelationDataType dtype, const float* values, std::size_t count, void* out,
+		QuantizationError* pError) {
+	switch (dtype) {
+	case CORRELATION_FLOAT16:
+		{
+			std::uint16_t* h = static_cast<std::uint16_t*>(out);
+			for (std::size_t j = 0; j<count; j++) {
+				h[j] = floatToHalf(values[j]);
+			}
+		}
+		break;
+	case CORRELATION_INT16:
+		{
+			std::int16_t* q = static_cast<std::int16_t*>(out);
+			for (std::size_t j = 0; j<count; j++) {
+				q[j] = toFixedPoint<std::int16_t>(values[j], INT16_SCALE);
+			}
+		}
+		break;
+	case CORRELATION_INT8:
+		{
+			std::int8_t* q = static_cast<std::int8_t*>(out);
+			for (std::size_t j = 0; j<count; j++) {
+				q[j] = toFixedPoint<std::int8_t>(values[j], INT8_SCALE);
+			}
+		}
+		break;
+	default:
+		memcpy(out, values, count*sizeof(float));
+		break;
+	}
+
+	if (pError) {
+		for (std::size_t j = 0; j<count; j++) {
+			if (values[j] == values[j]) {
+				const double difference = std::fabs(static_cast<double>(decodeCorrelation(dtype, out, j)) - values[j]);
+				pError->maxError = std::max(pError->maxError, difference);
+				pError->sumSquares += difference*difference;
+				pError->count++;
+			}
+		}
+	}
+}
+
+std::vector<const CorrelationDecoder*> availableCorrelationDecoders() {
+	std::vector<const CorrelationDecoder*> decoders;
+	decoders.push_back(&scalarDecoder);
+#ifdef TELCON_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		decoders.push_back(&avx2Decoder);
+	}
+#endif
+	return decoders;
+}
+
+const CorrelationDecoder& selectCorrelationDecoder() {
+	std::vector<const CorrelationDecoder*> decoders = availableCorrelationDecoders();
+	const CorrelationDecoder* pSelected = decoders.back();
+
+	const char* requested = getenv("TELCON_KERNEL");
+	if (requested) {
+		for (unsigned j=0; j<decoders.size(); j++) {
+			if (0 == strcmp(decoders[j]->name, requested)) {
+				pSelected = decoders[j];
+			}
+		}
+	}
+	return *pSelected;
+}
+
+void decodeCorrelations(CorrelationDataType dtype, const void* in, std::size_t count, float* out) {
+	static const CorrelationDecoder& decoder = selectCorrelationDecoder();
+	switch (dtype) {
+	case CORRELATION_FLOAT16:
+		decoder.fromFloat16(static_cast<const std::uint16_t*>(in), count, out);
+		break;
+	case CORRELATION_INT16:
+		decoder.fromInt16(static_cast<const std::int16_t*>(in), count, out);
+		break;
+	case CORRELATION_INT8:
+		decoder.fromInt8(static_cast<const std::int8_t*>(in), count, out);
+		break;
+	default:
+		memcpy(out, in, count*sizeof(float));
+		break;
+	}
+}
+
+float decodeCorrelation(CorrelationDataType dtype, const void* in, std::size_t index) {
+	switch (dtype) {
+	case CORRELATION_FLOAT16:
+		return halfToFloat(static_cast<const std::uint16_t*>(in)[index]);
+	case CORRELATION_INT16:
+		return static_cast<float>(static_cast<const std::int16_t*>(in)[index]) * INT16_STEP;
+	case CORRELATION_INT8:
+		return static_cast<float>(static_cast<const std::int8_t*>(in)[index]) * INT8_STEP;
+	default:
+		return static_cast<const float*>(in)[index];
+	}
+}
+
+std::uint16_t floatToHalf(float value) {
+	std::uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+	const std::uint32_t magnitude = bits & 0x7fffffffu;
+
+	if (magnitude >= 0x7f800000u) {
+		// infinity, or NaN kept quiet
+		return sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u);
+	}
+	if (magnitude >= 0x477ff000u) {
+		// rounds above the largest half (65504)
+		return sign | 0x7c00u;
+	}
+	if (magnitude < 0x38800000u) {
+		// below the smallest normal half: subnormal or zero
+		if (magnitude < 0x33000000u) {
+			return sign;
+		}
+		const std::uint32_t exponent = magnitude >> 23;
+		const std::uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+		const std::uint32_t shift = 126 - exponent;
+		std::uint32_t half = mantissa >> shift;
+		const std::uint32_t rest = mantissa & ((1u << shift) - 1);
+		const std::uint32_t middle = 1u << (shift - 1);
+		if (rest > middle || (rest == middle && (half & 1))) {
+			half++;
+		}
+		return static_cast<std::uint16_t>(sign | half);
+	}
+	// rebias the exponent from 127 to 15, a carry of the rounding goes into the exponent
+	std::uint32_t half = (magnitude - 0x38000000u) >> 13;
+	const std::uint32_t rest = magnitude & 0x1fffu;
+	if (rest > 0x1000u || (rest == 0x1000u && (half & 1))) {
+		half++;
+	}
+	return static_cast<std::uint16_t>(sign | half);
+}
+
+float halfToFloat(std::uint16_t half) {
+	const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+	std::uint32_t exponent = (half >> 10) & 0x1fu;
+	std::uint32_t mantissa = half & 0x3ffu;
+	std::uint32_t bits;
+	if (exponent == 0x1fu) {
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	}
+	else if (exponent != 0) {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0) {
+		bits = sign;
+	}
+	else {
+		// subnormal half, a normal float
+		exponent = 113;
+		while (!(mantissa & 0x400u)) {
+			mantissa <<= 1;
+			exponent--;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+	}
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+} // namespace VCGL
@@ -0,0 +1,89 @@
+/*!	@file correlationencoding.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Correlation values stored in fewer bits: half precision and fixed point
+ */
+
+#ifndef CORRELATIONENCODING_H_
+#define CORRELATIONENCODING_H_
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "storage/correlationstore.h"
+
+namespace VCGL {
+
+/// Bytes of one value of the type, 0 for an unknown type
+std::size_t correlationValueSize(std::uint32_t dtype);
+
+/// Name of the type as given on the command line: float32, float16, int16 or int8
+const char* correlationDataTypeName(CorrelationDataType dtype);
+
+/// Type with the given name, false if there is none
+bool parseCorrelationDataType(const std::string& name, CorrelationDataType* pType);
+
+/// Largest difference between a correlation in [-1,1] and its value stored as the type
+double correlationEncodingError(CorrelationDataType dtype);
+
+/// Differences between the correlations and their stored values, collected while encoding
+struct QuantizationError {
+	double maxError;	///< largest absolute difference
+	double sumSquares;	///< sum of the squared differences
+	unsigned long long count;	///< number of values (NaN not counted)
+
+	QuantizationError(): maxError(0.0), sumSquares(0.0), count(0) {}
+
+	/// Root mean square of the differences
+	double rms() const;
+};
+
+/*! @brief Encode correlations as the type
+ *
+ * Values are rounded to the nearest value of the type. The fixed-point types
+ * store round(value*scale) with value clamped to [-1,1] (scale 32767 for int16,
+ * 127 for int8) and NaN as 0; float16 keeps NaN.
+ *
+ * @param out Receives count values of correlationValueSize(dtype) bytes
+ * @param pError If given, the differences of the stored values are added to it
+ */
+void encodeCorrelations(CorrelationDataType dtype, const float* values, std::size_t count, void* out,
+		QuantizationError* pError = 0);
+
+/*! @brief Conversion of stored values to floats, in a variant per instruction set
+ *
+ * All variants give exactly the same floats.
+ */
+struct CorrelationDecoder {
+	const char* name;
+	void (*fromFloat16)(const std::uint16_t* in, std::size_t count, float* out);
+	void (*fromInt16)(const std::int16_t* in, std::size_t count, float* out);
+	void (*fromInt8)(const std::int8_t* in, std::size_t count, float* out);
+};
+
+/// All decoders supported by this CPU, from the simplest to the widest
+std::vector<const CorrelationDecoder*> availableCorrelationDecoders();
+
+/*! @brief Widest decoder supported by this CPU
+ *
+ * Environment variable TELCON_KERNEL=scalar|avx2 restricts the choice,
+ * as for the kernels of CorrelationEngine.
+ */
+const CorrelationDecoder& selectCorrelationDecoder();
+
+/// Decode count values of the type with the selected decoder
+void decodeCorrelations(CorrelationDataType dtype, const void* in, std::size_t count, float* out);
+
+/// Decode value index of the values of the type
+float decodeCorrelation(CorrelationDataType dtype, const void* in, std::size_t index);
+
+/// Half precision bits of the value, rounded to nearest even
+std::uint16_t floatToHalf(float value);
+/// Value of the half precision bits
+float halfToFloat(std::uint16_t bits);
+
+} // namespace VCGL
+
+#endif // CORRELATIONENCODING_H_
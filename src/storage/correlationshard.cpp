@@ -0,0 +1,195 @@
+/*!	@file correlationshard.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Parts of the correlation triangle computed by independent processes, and their merge
+ */
+
+#include "correlationshard.h"
+
+#include "symmetricmatrix.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace VCGL {
+
+const char CORRELATION_SHARD_MAGIC[8] = { 'T', 'C', 'S', 'H', 'A', 'R', 'D', '\0' };
+
+namespace {
+	/// Values read at once when replaying, about 64 MB
+	const std::size_t REPLAY_BLOCK_VALUES = std::size_t(1) << 24;
+
+	/// Smallest row r with triangleOffset(r) >= pairs
+	std::size_t rowOfPairs(std::uint64_t pairs) {
+		std::size_t row = static_cast<std::size_t>((1.0 + std::sqrt(1.0 + 8.0*static_cast<double>(pairs))) / 2.0);
+		while (triangleOffset(row) < pairs) {
+			row++;
+		}
+		while (row > 0 && triangleOffset(row-1) >= pairs) {
+			row--;
+		}
+		return row;
+	}
+
+	bool sameSubset(const GridSubsetRecord& a, const GridSubsetRecord& b) {
+		return memcmp(&a, &b, sizeof(a)) == 0;
+	}
+}
+
+void shardRowRange(std::size_t npoints, unsigned shardCount, unsigned shardIndex,
+		std::size_t* pRowBegin, std::size_t* pRowEnd) {
+	assert(shardIndex < shardCount);
+	const std::uint64_t total = triangleOffset(npoints);
+	*pRowBegin = std::min(npoints, rowOfPairs(total * shardIndex / shardCount));
+	*pRowEnd = (shardIndex+1 == shardCount) ? npoints : std::min(npoints, rowOfPairs(total * (shardIndex+1) / shardCount));
+}
+
+std::string correlationShardFileName(const std::string& prefix, unsigned shardIndex) {
+	return prefix + std::to_string(shardIndex) + ".bin";
+}
+
+CorrelationShardWriter::CorrelationShardWriter(const std::string& fileName, std::size_t nlat, std::size_t nlon,
+		const GridSubsetRecord& subset, const std::string& key, unsigned shardIndex, unsigned shardCount)
+: fout(fileName, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary), subset(subset), nextRow(0) {
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CORRELATION_SHARD_MAGIC, sizeof(header.magic));
+	header.version = CORRELATION_SHARD_VERSION;
+	header.byteOrder = CORRELATION_BYTE_ORDER;
+	header.shardIndex = shardIndex;
+	header.shardCount = shardCount;
+	header.npoints = nlat*nlon;
+	header.nlat = nlat;
+	header.nlon = nlon;
+	memcpy(header.key, key.data(), std::min(key.size(), sizeof(header.key)));
+	std::size_t rowBegin = 0, rowEnd = 0;
+	shardRowRange(header.npoints, shardCount, shardIndex, &rowBegin, &rowEnd);
+	header.rowBegin = rowBegin;
+	header.rowEnd = rowEnd;
+	nextRow = rowBegin;
+
+	// rewritten with the checksum on close, a shard that was not completed stays invalid
+	CorrelationShardHeader placeholder = header;
+	placeholder.version = 0;
+	fout.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+	fout.write(reinterpret_cast<const char*>(&subset), sizeof(subset));
+}
+
+void CorrelationShardWriter::consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) {
+	assert(rowBegin == nextRow && rowEnd <= header.rowEnd);
+	const std::size_t count = triangleOffset(rowEnd) - triangleOffset(rowBegin);
+	fout.write(reinterpret_cast<const char*>(values), count*sizeof(float));
+	checksum.add(values, count);
+	nextRow = rowEnd;
+}
+
+bool CorrelationShardWriter::close() {
+	const bool complete = (nextRow == header.rowEnd);
+	if (complete) {
+		header.checksum = checksum.value();
+		fout.seekp(0);
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+	fout.close();
+	return !fout.fail() && complete;
+}
+
+CorrelationShardSet::CorrelationShardSet() {
+}
+
+bool CorrelationShardSet::open(const std::string& prefix, std::size_t nlat, std::size_t nlon,
+		const GridSubsetRecord& subset, const std::string& key) {
+	fileNames.clear();
+	headers.clear();
+	const std::size_t npoints = nlat*nlon;
+	std::size_t count = 1;
+	for (std::size_t i = 0; i<count; i++) {
+		const std::string fileName = correlationShardFileName(prefix, static_cast<unsigned>(i));
+		std::ifstream in(fileName.c_str(), std::ios::binary | std::ios::ate);
+		if (!in) {
+			std::cerr << "ERROR: shard " << i << " is missing: " << fileName << std::endl;
+			return false;
+		}
+		const std::uint64_t fileSize = static_cast<std::uint64_t>(in.tellg());
+		in.seekg(0);
+		CorrelationShardHeader header;
+		GridSubsetRecord written;
+		in.read(reinterpret_cast<char*>(&header), sizeof(header));
+		in.read(reinterpret_cast<char*>(&written), sizeof(written));
+		if (!in || memcmp(header.magic, CORRELATION_SHARD_MAGIC, sizeof(header.magic)) != 0
+				|| header.byteOrder != CORRELATION_BYTE_ORDER) {
+			std::cerr << "ERROR: " << fileName << " is not a shard of this machine's byte order" << std::endl;
+			return false;
+		}
+		if (header.version != CORRELATION_SHARD_VERSION) {
+			std::cerr << "ERROR: shard " << fileName << " is incomplete or of an unknown version" << std::endl;
+			return false;
+		}
+		if (i == 0) {
+			count = header.shardCount;
+		}
+		if (header.shardIndex != i || header.shardCount != count || header.npoints != npoints
+				|| header.nlat != nlat || header.nlon != nlon || !sameSubset(written, subset)
+				|| std::string(header.key, sizeof(header.key)) != key.substr(0, sizeof(header.key))) {
+			std::cerr << "ERROR: shard " << fileName << " is of other data or another number of shards" << std::endl;
+			return false;
+		}
+		const std::size_t expectedBegin = headers.empty() ? 0 : headers.back().rowEnd;
+		if (header.rowBegin != expectedBegin || header.rowEnd < header.rowBegin || header.rowEnd > npoints
+				|| (i+1 == count && header.rowEnd != npoints)) {
+			std::cerr << "ERROR: shard " << fileName << " holds rows " << header.rowBegin << ".." << header.rowEnd
+					<< ", the shards do not cover rows 0.." << npoints << " exactly once" << std::endl;
+			return false;
+		}
+		const std::uint64_t valueCount = triangleOffset(header.rowEnd) - triangleOffset(header.rowBegin);
+		if (fileSize != sizeof(header) + sizeof(written) + valueCount*sizeof(float)) {
+			std::cerr << "ERROR: shard " << fileName << " has a wrong size" << std::endl;
+			return false;
+		}
+		fileNames.push_back(fileName);
+		headers.push_back(header);
+	}
+	return count > 0;
+}
+
+bool CorrelationShardSet::replay(std::size_t firstRow, CorrelationRowConsumer& consumer) const {
+	std::vector<float> block;
+	for (std::size_t i = 0; i<fileNames.size(); i++) {
+		const CorrelationShardHeader& header = headers[i];
+		if (header.rowEnd <= firstRow) {
+			continue;
+		}
+		std::ifstream in(fileNames[i].c_str(), std::ios::binary);
+		in.seekg(sizeof(header) + sizeof(GridSubsetRecord));
+
+		CorrelationChecksum checksum;
+		std::size_t row = header.rowBegin;
+		while (row < header.rowEnd && in) {
+			// blocks end at firstRow, so the rows before it are only checksummed
+			const std::size_t limit = (row < firstRow) ? firstRow : header.rowEnd;
+			std::size_t rowEnd = row + 1;
+			while (rowEnd < limit && triangleOffset(rowEnd+1) - triangleOffset(row) <= REPLAY_BLOCK_VALUES) {
+				rowEnd++;
+			}
+			block.resize(triangleOffset(rowEnd) - triangleOffset(row));
+			in.read(reinterpret_cast<char*>(block.data()), block.size()*sizeof(float));
+			if (!in) {
+				break;
+			}
+			checksum.add(block.data(), block.size());
+			if (row >= firstRow) {
+				consumer.consumeRows(row, rowEnd, block.data());
+			}
+			row = rowEnd;
+		}
+		if (row != header.rowEnd || checksum.value() != header.checksum) {
+			std::cerr << "ERROR: shard " << fileNames[i] << " cannot be read or is damaged" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace VCGL
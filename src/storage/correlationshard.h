@@ -0,0 +1,131 @@
+/*!	@file correlationshard.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Parts of the correlation triangle computed by independent processes, and their merge
+ */
+
+#ifndef CORRELATIONSHARD_H_
+#define CORRELATIONSHARD_H_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+#include "process/precompute.h"
+#include "storage/correlationstore.h"
+
+namespace VCGL {
+
+/*! @brief Header of a shard file
+ *
+ * The header is followed by a GridSubsetRecord and the rows [rowBegin, rowEnd)
+ * of the packed strictly lower triangle (row x holds the x correlations with
+ * points 0..x-1). All fields are in the byte order of the writing machine,
+ * see byteOrder.
+ */
+struct CorrelationShardHeader {
+	char magic[8];			///< CORRELATION_SHARD_MAGIC
+	std::uint32_t version;	///< CORRELATION_SHARD_VERSION, 0 until the shard is complete
+	std::uint32_t byteOrder;	///< CORRELATION_BYTE_ORDER as written by the producer
+	std::uint32_t shardIndex;
+	std::uint32_t shardCount;
+	std::uint64_t npoints;
+	std::uint64_t nlat;
+	std::uint64_t nlon;
+	std::uint64_t rowBegin;
+	std::uint64_t rowEnd;
+	std::uint64_t checksum;	///< CorrelationChecksum of the rows
+	char key[32];			///< hash of the data the rows are computed from (see PrecomputeCacheKey::hash)
+	std::uint64_t reserved[2];	///< zero, pads the header to two cache lines
+};
+
+extern const char CORRELATION_SHARD_MAGIC[8];
+const std::uint32_t CORRELATION_SHARD_VERSION = 1;
+
+/*! @brief Rows of the triangle computed by one of shardCount shards
+ *
+ * The shards take consecutive ranges of rows with about the same number of pairs each.
+ */
+void shardRowRange(std::size_t npoints, unsigned shardCount, unsigned shardIndex,
+		std::size_t* pRowBegin, std::size_t* pRowEnd);
+
+/// File of shard shardIndex: the prefix followed by the index
+std::string correlationShardFileName(const std::string& prefix, unsigned shardIndex);
+
+/// Writes the rows of one shard as they are computed
+class CorrelationShardWriter: public CorrelationRowConsumer {
+public:
+	/*! @brief Create the file and reserve space for its header
+	 *
+	 * @param fileName Name of the shard file
+	 * @param nlat Number of latitudes of the grid
+	 * @param nlon Number of longitudes of the grid
+	 * @param subset Part of the data file the correlations are computed from
+	 * @param key Hash of the data (and its selection), checked by the merge
+	 * @param shardIndex Index of this shard, less than shardCount
+	 * @param shardCount Number of shards
+	 */
+	CorrelationShardWriter(const std::string& fileName, std::size_t nlat, std::size_t nlon,
+			const GridSubsetRecord& subset, const std::string& key, unsigned shardIndex, unsigned shardCount);
+
+	/// First row of the shard
+	std::size_t rowBegin() const { return header.rowBegin; }
+	/// Row after the last row of the shard
+	std::size_t rowEnd() const { return header.rowEnd; }
+
+	/// Append rows [rowBegin, rowEnd) within the rows of the shard; rowBegin must follow the previously written rows
+	virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) override;
+
+	/// Write the header with the checksum and close the file, true if all rows of the shard were written successfully
+	bool close();
+
+private:
+	std::ofstream fout;
+	CorrelationShardHeader header;
+	GridSubsetRecord subset;
+	CorrelationChecksum checksum;
+	std::size_t nextRow;
+};
+
+/*! @brief All shards of a triangle, read back in the order of the rows
+ *
+ * Opening checks that the shards are complete, were computed from the same data
+ * and together cover every row exactly once; the problems are reported to std::cerr.
+ */
+class CorrelationShardSet {
+public:
+	CorrelationShardSet();
+
+	/*! @brief Open the shards prefix0, prefix1, ... (their count is taken from the first one)
+	 *
+	 * @param prefix File name of the shards without the index
+	 * @param nlat Number of latitudes the shards must have
+	 * @param nlon Number of longitudes the shards must have
+	 * @param subset Part of the data file the shards must be computed from
+	 * @param key Hash of the data the shards must be computed from
+	 * @return false if a shard is missing, incomplete or does not fit the others
+	 */
+	bool open(const std::string& prefix, std::size_t nlat, std::size_t nlon,
+			const GridSubsetRecord& subset, const std::string& key);
+
+	/// Number of opened shards
+	std::size_t shardCount() const { return fileNames.size(); }
+
+	/*! @brief Pass the rows from firstRow on to the consumer, in blocks of consecutive rows
+	 *
+	 * Every shard is read whole to verify its checksum; the consumer may have received
+	 * rows of a damaged shard before it is found out.
+	 * @return false if a shard cannot be read or its values do not match the checksum
+	 */
+	bool replay(std::size_t firstRow, CorrelationRowConsumer& consumer) const;
+
+private:
+	std::vector<std::string> fileNames;
+	std::vector<CorrelationShardHeader> headers;
+};
+
+} // namespace VCGL
+
+#endif // CORRELATIONSHARD_H_
@@ -0,0 +1,335 @@
+/*!	@file correlationstore.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Read access to precomputed correlations and their versioned file format
+ */
+
+#include "correlationstore.h"
+#include "sparsecorrelationstore.h"
+#include "compressedcorrelationstore.h"
+#include "correlationencoding.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+
+namespace VCGL {
+
+const char CORRELATION_FILE_MAGIC[8] = { 'T', 'C', 'X', 'C', 'O', 'R', 'R', '\n' };
+
+static_assert(sizeof(CorrelationFileHeader) == 64, "header keeps the values aligned to a cache line");
+static_assert(sizeof(GridSubsetRecord) == 64, "subset record keeps the values aligned to a cache line");
+
+void CorrelationStore::row(std::size_t i, float* out) const {
+	const std::size_t npoints = pointCount();
+	for (std::size_t j = 0; j<npoints; j++) {
+		out[j] = value(i, j);
+	}
+}
+
+void CorrelationStore::rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const {
+	std::vector<float> values(pointCount());
+	row(i, values.data());
+
+	float minCorr = 1.0f;
+	std::size_t minIndex = i;
+	for (std::size_t j = 0; j<values.size(); j++) {
+		if (values[j] < minCorr) {
+			minCorr = values[j];
+			minIndex = j;
+		}
+	}
+	*pMin = minCorr;
+	*pIndex = minIndex;
+}
+
+void CorrelationChecksum::add(const float* values, std::size_t count) {
+	const std::uint64_t prime = 1099511628211ull;
+	std::uint64_t h = state;
+	for (std::size_t j = 0; j<count; j++) {
+		std::uint32_t word;
+		memcpy(&word, values+j, sizeof(word));
+		h = (h ^ word) * prime;
+	}
+	state = h;
+}
+
+void CorrelationChecksum::addBytes(const void* data, std::size_t bytes) {
+	const std::uint64_t prime = 1099511628211ull;
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	std::uint64_t h = state;
+	for (std::size_t j = 0; j<bytes; j++) {
+		h = (h ^ p[j]) * prime;
+	}
+	state = h;
+}
+
+CorrelationTriangleStore::CorrelationTriangleStore(SymmetricMatrix<float>&& matrix)
+: ownValues(std::move(matrix)), storedChecksum(0), triangle(ownValues.view()) {
+}
+
+CorrelationTriangleStore::CorrelationTriangleStore(MappedFile&& mappedFile, std::size_t offset,
+		const CorrelationFileHeader& header)
+: file(std::move(mappedFile)), storedChecksum(header.checksum),
+  triangle(reinterpret_cast<const float*>(file.data() + offset), header.npoints, 1.0f) {
+	assert(offset + triangle.packedSize()*sizeof(float) <= file.size());
+}
+
+float CorrelationTriangleStore::value(std::size_t i, std::size_t j) const {
+	return triangle(i, j);
+}
+
+void CorrelationTriangleStore::row(std::size_t i, float* out) const {
+	const SymmetricMatrixView<float>::RowView r = triangle.row(i);
+	std::copy(r.begin(), r.end(), out);
+}
+
+void CorrelationTriangleStore::rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const {
+	float minCorr = 1.0f;
+	std::size_t minIndex = i;
+	const SymmetricMatrixView<float>::RowView r = triangle.row(i);
+	for (SymmetricMatrixView<float>::RowIterator it = r.begin(); it != r.end(); ++it) {
+		if (*it < minCorr) {
+			minCorr = *it;
+			minIndex = it.column();
+		}
+	}
+	*pMin = minCorr;
+	*pIndex = minIndex;
+}
+
+bool CorrelationTriangleStore::checksumMatches() const {
+	if (!isMapped()) {
+		return true;
+	}
+	CorrelationChecksum checksum;
+	checksum.add(triangle.data(), triangle.packedSize());
+	return checksum.value() == storedChecksum;
+}
+
+QuantizedTriangleStore::QuantizedTriangleStore(const SymmetricMatrixView<float>& matrix, CorrelationDataType dtype)
+: ownValues(matrix.packedSize()*correlationValueSize(dtype)), storedChecksum(0), dtype(dtype),
+  valueSize(correlationValueSize(dtype)), npoints(matrix.size()), values(ownValues.data()) {
+	encodeCorrelations(dtype, matrix.data(), matrix.packedSize(), ownValues.data());
+}
+
+QuantizedTriangleStore::QuantizedTriangleStore(MappedFile&& mappedFile, std::size_t offset,
+		const CorrelationFileHeader& header)
+: file(std::move(mappedFile)), storedChecksum(header.checksum), dtype(static_cast<CorrelationDataType>(header.dtype)),
+  valueSize(correlationValueSize(header.dtype)), npoints(header.npoints),
+  values(reinterpret_cast<const unsigned char*>(file.data()) + offset) {
+	assert(offset + triangleOffset(npoints)*valueSize <= file.size());
+}
+
+float QuantizedTriangleStore::value(std::size_t i, std::size_t j) const {
+	if (i == j) {
+		return 1.0f;
+	}
+	return decodeCorrelation(dtype, values, i > j ? triangleOffset(i) + j : triangleOffset(j) + i);
+}
+
+void QuantizedTriangleStore::row(std::size_t i, float* out) const {
+	// the row of the triangle at once, the rest of the row one value per later row
+	decodeCorrelations(dtype, values + triangleOffset(i)*valueSize, i, out);
+	out[i] = 1.0f;
+	for (std::size_t j = i+1; j<npoints; j++) {
+		out[j] = decodeCorrelation(dtype, values, triangleOffset(j) + i);
+	}
+}
+
+void QuantizedTriangleStore::triangleRow(std::size_t i, float* out) const {
+	decodeCorrelations(dtype, values + triangleOffset(i)*valueSize, i, out);
+}
+
+void QuantizedTriangleStore::rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const {
+	std::vector<float> decoded(npoints);
+	row(i, decoded.data());
+
+	float minCorr = 1.0f;
+	std::size_t minIndex = i;
+	for (std::size_t j = 0; j<npoints; j++) {
+		if (j != i && decoded[j] < minCorr) {
+			minCorr = decoded[j];
+			minIndex = j;
+		}
+	}
+	*pMin = minCorr;
+	*pIndex = minIndex;
+}
+
+bool QuantizedTriangleStore::checksumMatches() const {
+	if (!isMapped()) {
+		return true;
+	}
+	CorrelationChecksum checksum;
+	checksum.addBytes(values, triangleOffset(npoints)*valueSize);
+	return checksum.value() == storedChecksum;
+}
+
+bool correlationHeaderValid(const CorrelationFileHeader& header, std::string* pReason) {
+	if (memcmp(header.magic, CORRELATION_FILE_MAGIC, sizeof(header.magic)) != 0) {
+		*pReason = "not a versioned correlation file";
+		return false;
+	}
+	if (header.byteOrder != CORRELATION_BYTE_ORDER) {
+		*pReason = "file was written on a machine with different byte order";
+		return false;
+	}
+	if (header.version < CORRELATION_FILE_MIN_VERSION || header.version > CORRELATION_FILE_VERSION) {
+		*pReason = "unsupported file version";
+		return false;
+	}
+	if (correlationValueSize(header.dtype) == 0) {
+		*pReason = "unsupported value type";
+		return false;
+	}
+	const std::size_t minHeaderSize = sizeof(CorrelationFileHeader) + (header.version >= 2 ? sizeof(GridSubsetRecord) : 0);
+	if (header.headerSize < minHeaderSize || header.headerSize % sizeof(float) != 0) {
+		*pReason = "invalid header size";
+		return false;
+	}
+	if (header.npoints != header.nlat*header.nlon) {
+		*pReason = "point count does not match the grid";
+		return false;
+	}
+	return true;
+}
+
+namespace {
+	std::unique_ptr<CorrelationStore> openMapped(const std::string& fileName, MappedFile&& file) {
+		CorrelationFileHeader header;
+		memcpy(&header, file.data(), sizeof(header));
+
+		std::string reason;
+		if (!correlationHeaderValid(header, &reason)) {
+			std::cerr << "Cannot use " << fileName << ": " << reason << std::endl;
+			return std::unique_ptr<CorrelationStore>();
+		}
+		if (file.size() < header.headerSize + triangleOffset(header.npoints)*correlationValueSize(header.dtype)) {
+			std::cerr << "Cannot use " << fileName << ": file is truncated" << std::endl;
+			return std::unique_ptr<CorrelationStore>();
+		}
+		const std::size_t offset = header.headerSize;
+		bool bChecksumMatches = false;
+		std::unique_ptr<CorrelationStore> store;
+		if (header.dtype != CORRELATION_FLOAT32) {
+			QuantizedTriangleStore* pQuantized = new QuantizedTriangleStore(std::move(file), offset, header);
+			store.reset(pQuantized);
+			bChecksumMatches = pQuantized->checksumMatches();
+		}
+		else {
+			CorrelationTriangleStore* pTriangle = new CorrelationTriangleStore(std::move(file), offset, header);
+			store.reset(pTriangle);
+			bChecksumMatches = pTriangle->checksumMatches();
+		}
+		if (!bChecksumMatches) {
+			std::cerr << "Cannot use " << fileName << ": values do not match the checksum" << std::endl;
+			return std::unique_ptr<CorrelationStore>();
+		}
+		return store;
+	}
+
+	std::unique_ptr<CorrelationStore> openLegacy(const std::string& fileName, std::size_t fileSize) {
+		std::ifstream fin(fileName, std::ifstream::binary);
+		std::size_t npoints = 0;
+		fin.read(reinterpret_cast<char*>(&npoints), sizeof(std::size_t));
+		if (!fin || npoints > fileSize || sizeof(std::size_t) + triangleOffset(npoints)*sizeof(float) != fileSize) {
+			std::cerr << "Cannot use " << fileName << ": not a correlation file" << std::endl;
+			return std::unique_ptr<CorrelationStore>();
+		}
+
+		SymmetricMatrix<float> matrix(npoints, 1.0f);
+		fin.read(reinterpret_cast<char*>(matrix.data()), matrix.packedSize()*sizeof(float));
+		if (!fin) {
+			std::cerr << "Cannot use " << fileName << ": file is truncated" << std::endl;
+			return std::unique_ptr<CorrelationStore>();
+		}
+		return std::unique_ptr<CorrelationStore>(new CorrelationTriangleStore(std::move(matrix)));
+	}
+}
+
+std::unique_ptr<CorrelationStore> openCorrelationStore(const std::string& fileName) {
+	MappedFile file;
+	if (!file.map(fileName)) {
+		return std::unique_ptr<CorrelationStore>();
+	}
+	if (file.size() >= sizeof(CorrelationFileHeader)
+			&& memcmp(file.data(), CORRELATION_FILE_MAGIC, sizeof(CORRELATION_FILE_MAGIC)) == 0) {
+		return openMapped(fileName, std::move(file));
+	}
+	if (isSparseCorrelationFile(file)) {
+		return openSparseCorrelationStore(fileName, std::move(file));
+	}
+	if (isCompressedCorrelationFile(file)) {
+		return openCompressedCorrelationStore(fileName, std::move(file));
+	}
+	const std::size_t fileSize = file.size();
+	file.unmap();
+	return openLegacy(fileName, fileSize);
+}
+
+bool readGridSubset(const std::string& fileName, GridSubsetRecord& subset, std::size_t* pnlat, std::size_t* pnlon) {
+	subset = GridSubsetRecord::whole();
+	std::ifstream fin(fileName, std::ifstream::binary);
+	char magic[8];
+	if (!fin.read(magic, sizeof(magic))) {
+		return false;
+	}
+	fin.seekg(0);
+
+	std::uint32_t version = 0;
+	std::uint64_t nlat = 0;
+	std::uint64_t nlon = 0;
+	std::string reason;
+	if (memcmp(magic, CORRELATION_FILE_MAGIC, sizeof(magic)) == 0) {
+		CorrelationFileHeader header;
+		if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header)) || !correlationHeaderValid(header, &reason)) {
+			return false;
+		}
+		version = header.version;
+		nlat = header.nlat;
+		nlon = header.nlon;
+	}
+	else if (memcmp(magic, SPARSE_CORRELATION_FILE_MAGIC, sizeof(magic)) == 0) {
+		SparseCorrelationFileHeader header;
+		if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header))
+				|| header.version < SPARSE_CORRELATION_FILE_MIN_VERSION || header.version > SPARSE_CORRELATION_FILE_VERSION) {
+			return false;
+		}
+		version = header.version;
+		nlat = header.nlat;
+		nlon = header.nlon;
+	}
+	else if (memcmp(magic, COMPRESSED_CORRELATION_FILE_MAGIC, sizeof(magic)) == 0) {
+		CompressedCorrelationFileHeader header;
+		if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header))
+				|| header.version != COMPRESSED_CORRELATION_FILE_VERSION) {
+			return false;
+		}
+		// all compressed files have the record
+		version = 2;
+		nlat = header.nlat;
+		nlon = header.nlon;
+	}
+	else {
+		return false;
+	}
+
+	// the record follows the header of any kind, all are 64 bytes
+	if (version >= 2 && !fin.read(reinterpret_cast<char*>(&subset), sizeof(subset))) {
+		subset = GridSubsetRecord::whole();
+		return false;
+	}
+	if (pnlat) {
+		*pnlat = static_cast<std::size_t>(nlat);
+	}
+	if (pnlon) {
+		*pnlon = static_cast<std::size_t>(nlon);
+	}
+	return true;
+}
+
+} // namespace VCGL
@@ -0,0 +1,225 @@
+/*!	@file correlationstore.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Read access to precomputed correlations and their versioned file format
+ */
+
+#ifndef CORRELATIONSTORE_H_
+#define CORRELATIONSTORE_H_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "mappedfile.h"
+#include "symmetricmatrix.h"
+
+namespace VCGL {
+
+/*! @brief Read-only access to the correlations of all pairs of grid points
+ *
+ * Points are identified by id = iLat*nlon + iLon; the correlation of a point
+ * with itself is 1.
+ */
+class CorrelationStore {
+public:
+	virtual ~CorrelationStore() {}
+
+	/// Number of points
+	virtual std::size_t pointCount() const = 0;
+
+	/// Correlation of points i and j
+	virtual float value(std::size_t i, std::size_t j) const = 0;
+
+	/// Correlations of point i with all points, out must hold pointCount() values
+	virtual void row(std::size_t i, float* out) const;
+
+	/*! @brief Most negative correlation of point i with any other point
+	 *
+	 * @param i Point index
+	 * @param pMin Receives the minimal correlation (1 if there is none below 1)
+	 * @param pIndex Receives the first point where the minimum is reached (i if there is none)
+	 */
+	virtual void rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const;
+};
+
+/*! @brief Header of the versioned correlation triangle file
+ *
+ * The header is followed by the packed strictly lower triangle:
+ * row x holds the x correlations with points 0..x-1.
+ * All fields are in the byte order of the writing machine, see byteOrder.
+ */
+struct CorrelationFileHeader {
+	char magic[8];			///< CORRELATION_FILE_MAGIC
+	std::uint32_t version;	///< CORRELATION_FILE_VERSION
+	std::uint32_t dtype;	///< value type of the triangle (CorrelationDataType)
+	std::uint32_t byteOrder;	///< CORRELATION_BYTE_ORDER as written by the producer
+	std::uint32_t headerSize;	///< offset of the triangle from the file start
+	std::uint64_t npoints;
+	std::uint64_t nlat;
+	std::uint64_t nlon;
+	std::uint64_t checksum;	///< CorrelationChecksum of the triangle
+	std::uint64_t reserved;	///< zero, pads the header to a cache line
+};
+
+/*! @brief Part of the data file the values were computed from
+ *
+ * Follows the header in files of version 2 (correlation and sparse correlation
+ * files). Indices and strides refer to the grid of the data file, see
+ * GridSelection; the numbers of latitudes and longitudes are nlat and nlon of
+ * the header. timeCount 0 stands for all time steps from timeStart.
+ */
+struct GridSubsetRecord {
+	std::uint64_t latStart;
+	std::uint64_t latStride;
+	std::uint64_t lonStart;
+	std::uint64_t lonStride;
+	std::uint64_t timeStart;
+	std::uint64_t timeCount;
+	std::uint64_t timeStride;
+	std::uint64_t reserved;	///< zero, pads the record to a cache line
+
+	/// Record of the whole data file
+	static GridSubsetRecord whole() {
+		const GridSubsetRecord record = { 0, 1, 0, 1, 0, 0, 1, 0 };
+		return record;
+	}
+};
+
+extern const char CORRELATION_FILE_MAGIC[8];
+const std::uint32_t CORRELATION_FILE_VERSION = 2;	///< version written, with a GridSubsetRecord
+const std::uint32_t CORRELATION_FILE_MIN_VERSION = 1;	///< oldest version read (no GridSubsetRecord)
+const std::uint32_t CORRELATION_BYTE_ORDER = 0x01020304;
+
+/// Value types of the triangle, see correlationencoding.h for the conversions
+enum CorrelationDataType {
+	CORRELATION_FLOAT32 = 1,
+	CORRELATION_FLOAT16 = 2,	///< IEEE half precision
+	CORRELATION_INT16 = 3,	///< fixed point, the value times 32767
+	CORRELATION_INT8 = 4	///< fixed point, the value times 127
+};
+
+/*! @brief Checksum of the triangle values, computed incrementally
+ *
+ * 64-bit FNV-1a over 32-bit words for float values, over bytes for the encoded types.
+ */
+class CorrelationChecksum {
+public:
+	CorrelationChecksum(): state(14695981039346656037ull) {}
+
+	void add(const float* values, std::size_t count);
+	void addBytes(const void* data, std::size_t bytes);
+	std::uint64_t value() const { return state; }
+
+private:
+	std::uint64_t state;
+};
+
+/*! @brief Correlations kept as a packed lower triangle, either in memory or mapped from a file
+ *
+ * A row of the triangle is contiguous, the rest of a full row is read column-wise.
+ */
+class CorrelationTriangleStore: public CorrelationStore {
+public:
+	/// Store owning the matrix
+	explicit CorrelationTriangleStore(SymmetricMatrix<float>&& matrix);
+	/// Store reading the triangle straight from the mapped file, starting at the given byte offset
+	CorrelationTriangleStore(MappedFile&& file, std::size_t offset, const CorrelationFileHeader& header);
+
+	virtual std::size_t pointCount() const override { return triangle.size(); }
+	virtual float value(std::size_t i, std::size_t j) const override;
+	virtual void row(std::size_t i, float* out) const override;
+	virtual void rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const override;
+
+	/// The correlations as a symmetric matrix
+	const SymmetricMatrixView<float>& matrix() const { return triangle; }
+
+	/// Whether the values are mapped from a file (as opposed to loaded into memory)
+	bool isMapped() const { return file.isMapped(); }
+
+	/*! @brief Compare the checksum of the values with the one stored in the file header
+	 *
+	 * Reads the whole triangle; openCorrelationStore rejects files that do not match.
+	 * In-memory stores have no stored checksum and always match.
+	 */
+	bool checksumMatches() const;
+
+private:
+	SymmetricMatrix<float> ownValues;
+	MappedFile file;
+	std::uint64_t storedChecksum;
+	SymmetricMatrixView<float> triangle;
+};
+
+/*! @brief Correlations kept as a packed lower triangle of encoded values (see CorrelationDataType)
+ *
+ * The values are either mapped from a file or encoded in memory, and decoded
+ * as they are read; whole rows with the widest decoder of the CPU.
+ */
+class QuantizedTriangleStore: public CorrelationStore {
+public:
+	/// Store encoding the matrix in memory
+	QuantizedTriangleStore(const SymmetricMatrixView<float>& matrix, CorrelationDataType dtype);
+	/// Store reading the values straight from the mapped file, starting at the given byte offset
+	QuantizedTriangleStore(MappedFile&& file, std::size_t offset, const CorrelationFileHeader& header);
+
+	virtual std::size_t pointCount() const override { return npoints; }
+	virtual float value(std::size_t i, std::size_t j) const override;
+	virtual void row(std::size_t i, float* out) const override;
+	virtual void rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const override;
+
+	/// Row i of the triangle (correlations with points 0..i-1), decoded into out; sequential in the file
+	void triangleRow(std::size_t i, float* out) const;
+
+	/// Type of the stored values
+	CorrelationDataType dataType() const { return dtype; }
+
+	/// Whether the values are mapped from a file (as opposed to encoded in memory)
+	bool isMapped() const { return file.isMapped(); }
+
+	/// @copydoc CorrelationTriangleStore::checksumMatches
+	bool checksumMatches() const;
+
+private:
+	std::vector<unsigned char> ownValues;
+	MappedFile file;
+	std::uint64_t storedChecksum;
+	CorrelationDataType dtype;
+	std::size_t valueSize;
+	std::size_t npoints;
+	const unsigned char* values;
+};
+
+/*! @brief Open a correlation file for reading
+ *
+ * Files in the versioned format are mapped into memory, so the pages are shared
+ * between processes; opening reads the triangle once to compare it with the checksum
+ * of the header. Triangles of encoded values are read by a QuantizedTriangleStore. Sparse files (see
+ * SparseCorrelationStore) and compressed files (see CompressedCorrelationStore)
+ * are mapped as well. Files in the legacy binary
+ * format (no header) are read into a packed triangle in memory.
+ *
+ * @param fileName File written by CorrelationTriangleWriter, storeCorrelationsTriangle, storeSparseCorrelations
+ *	or storeCorrelationsCompressed
+ * @return The store, or null if the file cannot be used (reason reported to stderr)
+ */
+std::unique_ptr<CorrelationStore> openCorrelationStore(const std::string& fileName);
+
+/// Check whether the header belongs to a file this version can map
+bool correlationHeaderValid(const CorrelationFileHeader& header, std::string* pReason);
+
+/*! @brief Read the part of the data file a correlation file was computed from
+ *
+ * @param fileName Versioned, sparse or compressed correlation file
+ * @param[out] subset The record, GridSubsetRecord::whole() for files of version 1
+ * @param[out] pnlat, pnlon Numbers of latitudes and longitudes of the file (optional)
+ * @return false if the file is not a valid versioned, sparse or compressed correlation file
+ */
+bool readGridSubset(const std::string& fileName, GridSubsetRecord& subset,
+		std::size_t* pnlat = 0, std::size_t* pnlon = 0);
+
+} // namespace VCGL
+
+#endif // CORRELATIONSTORE_H_
@@ -0,0 +1,47 @@
+/*!	@file databandreader.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Reading the variable data in bands of latitudes
+ */
+
+#include "databandreader.h"
+
+#include <algorithm>
+
+namespace VCGL {
+
+DataBandReader::DataBandReader(DataStorage* pDataStorage, const GridSelection& selection, std::size_t bandLatCount)
+: pDataStorage(pDataStorage),
+  selection(selection),
+  bandLatCount(std::max<std::size_t>(1, bandLatCount)),
+  nextBand(0) {
+}
+
+std::size_t DataBandReader::bandLatsForBudget(std::size_t nlon, std::size_t ntime, std::size_t memoryBudget) {
+	const std::size_t stride = (ntime + TimeSeriesField::ROW_ALIGNMENT - 1)
+			/ TimeSeriesField::ROW_ALIGNMENT * TimeSeriesField::ROW_ALIGNMENT;
+	const std::size_t latBytes = std::max<std::size_t>(1, nlon*stride*sizeof(float));
+	return std::max<std::size_t>(1, memoryBudget / latBytes);
+}
+
+TimeSeriesField DataBandReader::readBand(std::size_t b) {
+	if (!pDataStorage || b >= bandCount()) {
+		return TimeSeriesField();
+	}
+	GridSelection band = selection;
+	band.latStart = selection.lat(latBegin(b));
+	band.latCount = latEnd(b) - latBegin(b);
+	return pDataStorage->loadData(band);
+}
+
+bool DataBandReader::next(TimeSeriesField& band, std::size_t* pIndex) {
+	if (nextBand >= bandCount()) {
+		band.clear();
+		return false;
+	}
+	*pIndex = nextBand;
+	band = readBand(nextBand++);
+	return true;
+}
+
+} // namespace VCGL
@@ -0,0 +1,80 @@
+/*!	@file databandreader.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Reading the variable data in bands of latitudes
+ */
+
+#ifndef DATABANDREADER_H_
+#define DATABANDREADER_H_
+
+#include <cstddef>
+#include <algorithm>
+
+#include "datastorage.h"
+#include "timeseriesfield.h"
+
+namespace VCGL {
+
+/*! @brief Iterates over the selected data in bands of a fixed number of latitudes
+ *
+ * Only the band being read is in memory, so a field larger than the memory can
+ * be processed band by band. Bands can be read in sequence with next() or
+ * directly with readBand(), e.g. to visit pairs of bands.
+ * Latitudes and point ids are counted within the selection, so the points
+ * of band b are [pointBegin(b), pointEnd(b)) of the whole field.
+ * The reader does not own the storage.
+ */
+class DataBandReader {
+public:
+	/*! @brief Constructor
+	 *
+	 * @param pDataStorage Storage of the variable
+	 * @param selection Part of the variable to be read
+	 * @param bandLatCount Number of selected latitudes per band (the last band may be shorter)
+	 */
+	DataBandReader(DataStorage* pDataStorage, const GridSelection& selection, std::size_t bandLatCount);
+
+	/// Number of latitudes per band fitting the memory budget (at least 1)
+	static std::size_t bandLatsForBudget(std::size_t nlon, std::size_t ntime, std::size_t memoryBudget);
+
+	std::size_t nlat() const { return selection.latCount; }
+	std::size_t nlon() const { return selection.lonCount; }
+	std::size_t timeCount() const { return selection.timeCount; }
+	std::size_t pointCount() const { return nlat()*nlon(); }
+
+	/// Number of latitudes per band
+	std::size_t bandLats() const { return bandLatCount; }
+	std::size_t bandCount() const { return (nlat() + bandLatCount - 1) / bandLatCount; }
+	/// First latitude of band b
+	std::size_t latBegin(std::size_t b) const { return b*bandLatCount; }
+	/// Latitude after the last one of band b
+	std::size_t latEnd(std::size_t b) const { return std::min(nlat(), (b+1)*bandLatCount); }
+	/// First point of band b
+	std::size_t pointBegin(std::size_t b) const { return latBegin(b)*nlon(); }
+	/// Point after the last one of band b
+	std::size_t pointEnd(std::size_t b) const { return latEnd(b)*nlon(); }
+
+	/// Time series of the points of band b
+	TimeSeriesField readBand(std::size_t b);
+
+	/*! @brief Read the next band of the sequence
+	 *
+	 * @param[out] band Time series of the points of the band
+	 * @param[out] pIndex Receives the index of the band
+	 * @return false after the last band
+	 */
+	bool next(TimeSeriesField& band, std::size_t* pIndex);
+
+	/// Start the sequence of next() again from band 0
+	void rewind() { nextBand = 0; }
+
+private:
+	DataStorage* pDataStorage;
+	GridSelection selection;
+	std::size_t bandLatCount;
+	std::size_t nextBand;
+};
+
+} // namespace VCGL
+
+#endif // DATABANDREADER_H_
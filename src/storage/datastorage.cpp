@@ -0,0 +1,43 @@
+/*! @file datastorage.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Default implementations of the data storage functions
+ */
+
+#include "datastorage.h"
+
+namespace VCGL {
+
+TimeSeriesField DataStorage::loadData(const GridSelection& selection) {
+	const std::size_t nlon = getNLon();
+	const bool allLons = (selection.lonStart == 0 && selection.lonCount == nlon && selection.lonStride == 1);
+	if (allLons && selection.latStride == 1 && selection.timeStride == 1) {
+		return loadData(selection.latStart, selection.latCount, selection.timeStart, selection.timeCount);
+	}
+
+	TimeSeriesField data;
+	if (selection.latCount == 0 || selection.lonCount == 0 || selection.timeCount == 0) {
+		return data;
+	}
+	const std::size_t latSpan = selection.lat(selection.latCount-1) - selection.latStart + 1;
+	const std::size_t timeSpan = selection.time(selection.timeCount-1) - selection.timeStart + 1;
+	const TimeSeriesField covered = loadData(selection.latStart, latSpan, selection.timeStart, timeSpan);
+	if (covered.nlat() != latSpan || covered.timeCount() != timeSpan) {
+		return data;
+	}
+
+	data.resize(selection.latCount, selection.lonCount, selection.timeCount);
+	for (std::size_t lat = 0; lat<selection.latCount; lat++) {
+		for (std::size_t lon = 0; lon<selection.lonCount; lon++) {
+			SeriesSpan<const float> from = covered.series(lat*selection.latStride, selection.lon(lon, nlon));
+			SeriesSpan<float> to = data.series(lat, lon);
+			for (std::size_t t = 0; t<selection.timeCount; t++) {
+				to[t] = from[t*selection.timeStride];
+			}
+		}
+	}
+	return data;
+}
+
+} // namespace VCGL
@@ -9,9 +9,43 @@
 #define DATASTORAGE_H_
 
 #include "typedefs.h"
+#include "timeseriesfield.h"
+
+#include <cstddef>
 
 namespace VCGL {
 
+/*! @brief Part of the variable to be read: a range with a stride in each of LAT, LON and TIME
+ *
+ * Indices refer to the grid of the data file. The longitudes
+ * lonStart + k*lonStride wrap around the last longitude of the file,
+ * so that a region crossing the seam of the grid is one selection.
+ */
+struct GridSelection {
+	std::size_t latStart, latCount, latStride;
+	std::size_t lonStart, lonCount, lonStride;
+	std::size_t timeStart, timeCount, timeStride;
+
+	GridSelection()
+	: latStart(0), latCount(0), latStride(1),
+	  lonStart(0), lonCount(0), lonStride(1),
+	  timeStart(0), timeCount(0), timeStride(1) {}
+
+	/// Latitudes [latStart, latStart+latCount) at all nlon longitudes, time steps [timeStart, timeStart+timeCount)
+	GridSelection(std::size_t latStart, std::size_t latCount, std::size_t nlon,
+			std::size_t timeStart, std::size_t timeCount)
+	: latStart(latStart), latCount(latCount), latStride(1),
+	  lonStart(0), lonCount(nlon), lonStride(1),
+	  timeStart(timeStart), timeCount(timeCount), timeStride(1) {}
+
+	/// File index of the k-th selected latitude
+	std::size_t lat(std::size_t k) const { return latStart + k*latStride; }
+	/// File index of the k-th selected longitude, for a file with nlon longitudes
+	std::size_t lon(std::size_t k, std::size_t nlon) const { return (lonStart + k*lonStride) % nlon; }
+	/// File index of the k-th selected time step
+	std::size_t time(std::size_t k) const { return timeStart + k*timeStride; }
+};
+
 struct DataStorage {
 	virtual std::size_t getNTime() = 0;
 	virtual std::size_t getNLon() = 0;
@@ -20,9 +54,24 @@ struct DataStorage {
 	virtual std::vector<float> loadLats() = 0;
 
 	/*! Read variable data
-	 * @return  Data array with indices (LAT, LON, TIME).
+	 * @return  Time series of the points of latitudes [latStart, latStart+latCount).
+	 */
+	virtual TimeSeriesField loadData(std::size_t latStart, std::size_t latCount) = 0;
+
+	/*! Read variable data of the time steps [timeStart, timeStart+timeCount)
+	 * @return  Time series of the points of latitudes [latStart, latStart+latCount).
+	 */
+	virtual TimeSeriesField loadData(std::size_t latStart, std::size_t latCount,
+			std::size_t timeStart, std::size_t timeCount) = 0;
+
+	/*! Read the selected part of the variable data
+	 *
+	 * The default implementation reads the covered ranges of latitudes and
+	 * time steps and picks the selected values; storages which can skip
+	 * the other values while reading override it.
+	 * @return  Time series of the selected points, over the selected time steps.
 	 */
-	virtual vectorFloat3D loadData(std::size_t latStart, std::size_t latCount) = 0;
+	virtual TimeSeriesField loadData(const GridSelection& selection);
 
 	virtual ~DataStorage() {};
 };
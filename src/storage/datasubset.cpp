@@ -0,0 +1,192 @@
+/*!	@file datasubset.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Region, time range and grid stride of the data to be used
+ */
+
+#include "datasubset.h"
+
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+
+namespace VCGL {
+
+namespace {
+	/// Distance from lonFirst going east, in [0, 360)
+	float eastOf(float lonFirst, float lon) {
+		float d = fmod(lon - lonFirst, 360.0f);
+		return (d < 0.0f) ? d + 360.0f : d;
+	}
+
+	/// Coordinate for file names: no minus sign, which separates the ranges
+	std::string coordinateTag(float value) {
+		std::ostringstream str;
+		if (value < 0.0f) {
+			str << 'm';
+		}
+		str << fabs(value);
+		return str.str();
+	}
+
+	bool parseCount(const std::string& text, std::size_t* pValue) {
+		char* end = 0;
+		long long value = strtoll(text.c_str(), &end, 10);
+		if (text.empty() || *end != '\0' || value < 0) {
+			return false;
+		}
+		*pValue = static_cast<std::size_t>(value);
+		return true;
+	}
+}
+
+DataSubset::DataSubset()
+: hasBox(false),
+  lonFirst(0.0f),
+  lonLast(0.0f),
+  latFirst(0.0f),
+  latLast(0.0f),
+  timeStart(0),
+  timeEnd(0),
+  timeStride(1),
+  gridStride(1) {
+}
+
+bool DataSubset::isWhole() const {
+	return !hasBox && timeStart == 0 && timeEnd == 0 && timeStride == 1 && gridStride == 1;
+}
+
+std::string DataSubset::fileNameTag() const {
+	std::ostringstream str;
+	if (hasBox) {
+		str << "_box" << coordinateTag(lonFirst) << '-' << coordinateTag(lonLast)
+				<< '_' << coordinateTag(latFirst) << '-' << coordinateTag(latLast);
+	}
+	if (timeStart != 0 || timeEnd != 0 || timeStride != 1) {
+		str << "_t" << timeStart << '-';
+		if (timeEnd != 0) {
+			str << timeEnd;
+		}
+		if (timeStride != 1) {
+			str << 's' << timeStride;
+		}
+	}
+	if (gridStride != 1) {
+		str << "_g" << gridStride;
+	}
+	return str.str();
+}
+
+bool DataSubset::parseBox(const char* text) {
+	float values[4];
+	std::istringstream str(text);
+	for (int i = 0; i<4; i++) {
+		if (i > 0 && str.get() != ',') {
+			return false;
+		}
+		if (!(str >> values[i])) {
+			return false;
+		}
+	}
+	if (str.peek() != std::char_traits<char>::eof() || values[2] > values[3]
+			|| values[2] < -90.0f || values[3] > 90.0f) {
+		return false;
+	}
+	hasBox = true;
+	lonFirst = values[0];
+	lonLast = values[1];
+	latFirst = values[2];
+	latLast = values[3];
+	return true;
+}
+
+bool DataSubset::parseTime(const char* text) {
+	std::vector<std::string> parts(1);
+	for (const char* p = text; *p; p++) {
+		if (*p == ':') {
+			parts.push_back(std::string());
+		}
+		else {
+			parts.back() += *p;
+		}
+	}
+	if (parts.size() > 3) {
+		return false;
+	}
+	std::size_t start = 0, end = 0, stride = 1;
+	if (!parseCount(parts[0], &start)) {
+		return false;
+	}
+	if (parts.size() > 1 && !parts[1].empty() && (!parseCount(parts[1], &end) || end <= start)) {
+		return false;
+	}
+	if (parts.size() > 2 && (!parseCount(parts[2], &stride) || stride == 0)) {
+		return false;
+	}
+	timeStart = start;
+	timeEnd = end;
+	timeStride = stride;
+	return true;
+}
+
+bool DataSubset::parseGridStride(const char* text) {
+	std::size_t stride = 0;
+	if (!parseCount(text, &stride) || stride == 0) {
+		return false;
+	}
+	gridStride = stride;
+	return true;
+}
+
+bool DataSubset::select(const std::vector<float>& lons, const std::vector<float>& lats, std::size_t ntime,
+		bool northOnly, GridSelection& selection) const {
+	selection = GridSelection();
+
+	//latitudes: one contiguous range of a monotonous grid
+	const auto latSelected = [&](float lat) {
+		return (!northOnly || lat >= 0.0f) && (!hasBox || (lat >= latFirst && lat <= latLast));
+	};
+	std::size_t latStart = 0;
+	while (latStart < lats.size() && !latSelected(lats[latStart])) {
+		latStart++;
+	}
+	std::size_t latEnd = latStart;
+	while (latEnd < lats.size() && latSelected(lats[latEnd])) {
+		latEnd++;
+	}
+	selection.latStart = latStart;
+	selection.latStride = gridStride;
+	selection.latCount = (latEnd - latStart + gridStride - 1) / gridStride;
+
+	//longitudes: one range, which may continue from the last longitude of the file to the first one
+	const std::size_t nlon = lons.size();
+	// a box of 360 degrees or more is all longitudes, e.g. 0,360 or -180,180
+	const bool bAllLons = !hasBox || lonLast - lonFirst >= 360.0f;
+	const float boxWidth = eastOf(lonFirst, lonLast);
+	const auto lonSelected = [&](std::size_t i) {
+		return bAllLons || eastOf(lonFirst, lons[i]) <= boxWidth;
+	};
+	std::size_t lonStart = 0;
+	std::size_t lonCount = 0;
+	for (std::size_t i = 0; i<nlon; i++) {
+		if (lonSelected(i) && !lonSelected((i + nlon - 1) % nlon)) {
+			lonStart = i;
+			break;
+		}
+	}
+	while (lonCount < nlon && lonSelected((lonStart + lonCount) % nlon)) {
+		lonCount++;
+	}
+	selection.lonStart = lonStart;
+	selection.lonStride = gridStride;
+	selection.lonCount = (lonCount + gridStride - 1) / gridStride;
+
+	const std::size_t timeLast = (timeEnd == 0) ? ntime : std::min(timeEnd, ntime);
+	selection.timeStart = timeStart;
+	selection.timeStride = timeStride;
+	selection.timeCount = (timeLast > timeStart) ? (timeLast - timeStart + timeStride - 1) / timeStride : 0;
+
+	return selection.latCount >= 2 && selection.lonCount >= 2 && selection.timeCount > 0;
+}
+
+} // namespace VCGL
@@ -0,0 +1,65 @@
+/*!	@file datasubset.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Region, time range and grid stride of the data to be used
+ */
+
+#ifndef DATASUBSET_H_
+#define DATASUBSET_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "datastorage.h"
+
+namespace VCGL {
+
+/*! @brief Part of the data file to be used (given on the command line)
+ *
+ * The box is given in coordinates and turned into index ranges of the file
+ * grid by select(). Longitudes go east from lonFirst to lonLast, so a box
+ * with lonFirst > lonLast crosses the seam of the grid (e.g. 340,20).
+ */
+struct DataSubset {
+	bool hasBox;		///< restrict the points to the box
+	float lonFirst;		///< western border of the box
+	float lonLast;		///< eastern border of the box
+	float latFirst;		///< southern border of the box
+	float latLast;		///< northern border of the box
+	std::size_t timeStart;	///< first time step
+	std::size_t timeEnd;	///< time step after the last one (0 - up to the last one of the file)
+	std::size_t timeStride;	///< use every timeStride-th time step
+	std::size_t gridStride;	///< use every gridStride-th latitude and longitude
+
+	DataSubset();
+
+	/// Whether all data are used
+	bool isWhole() const;
+
+	/// Part of the precomputed file names identifying the subset, empty for the whole data
+	std::string fileNameTag() const;
+
+	/// Set the box from "lon0,lon1,lat0,lat1", false if the text is not valid
+	bool parseBox(const char* text);
+	/// Set the time range from "start:end:stride" (end and stride may be left out), false if not valid
+	bool parseTime(const char* text);
+	/// Set the grid stride from a positive integer, false if not valid
+	bool parseGridStride(const char* text);
+
+	/*! @brief Indices of the subset in a grid
+	 *
+	 * @param lons Longitudes of the file grid (increasing)
+	 * @param lats Latitudes of the file grid (monotonous)
+	 * @param ntime Number of time steps of the file
+	 * @param northOnly Restrict the latitudes to the northern hemisphere as well
+	 * @param[out] selection The selected ranges
+	 * @return false if fewer than two latitudes or longitudes, or no time step are selected
+	 */
+	bool select(const std::vector<float>& lons, const std::vector<float>& lats, std::size_t ntime,
+			bool northOnly, GridSelection& selection) const;
+};
+
+} // namespace VCGL
+
+#endif // DATASUBSET_H_
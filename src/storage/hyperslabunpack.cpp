@@ -0,0 +1,88 @@
+/*!	@file hyperslabunpack.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Unpacking of (time, point) hyperslabs into time series rows
+ */
+
+#include "hyperslabunpack.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace VCGL {
+
+namespace {
+	/// Time steps and points of a tile: 64x64 floats stay in L1 together with the flags
+	const std::size_t TILE_TIMES = 64;
+	const std::size_t TILE_POINTS = 64;
+}
+
+UnpackStatistics::UnpackStatistics()
+: dataMin(HUGE_VALF), dataMax(-HUGE_VALF), missingCount(0) {
+}
+
+void UnpackStatistics::merge(const UnpackStatistics& other) {
+	dataMin = std::min(dataMin, other.dataMin);
+	dataMax = std::max(dataMax, other.dataMax);
+	missingCount += other.missingCount;
+}
+
+void unpackHyperslab(const float* raw,
+		std::size_t timeCount,
+		std::size_t pointCount,
+		float scaleFactor,
+		float addOffset,
+		const std::vector<float>& missingValues,
+		float* rows,
+		std::size_t stride,
+		UnpackStatistics& statistics) {
+	float tile[TILE_TIMES][TILE_POINTS];
+	int missing[TILE_POINTS];
+
+	float dataMin = statistics.dataMin;
+	float dataMax = statistics.dataMax;
+	std::size_t missingCount = 0;
+
+	for (std::size_t p0 = 0; p0<pointCount; p0 += TILE_POINTS) {
+		const std::size_t np = std::min(TILE_POINTS, pointCount - p0);
+		for (std::size_t t0 = 0; t0<timeCount; t0 += TILE_TIMES) {
+			const std::size_t nt = std::min(TILE_TIMES, timeCount - t0);
+
+			// unpack along the contiguous points of each time step; the loops are branch free
+			for (std::size_t t = 0; t<nt; t++) {
+				const float* src = raw + (t0+t)*pointCount + p0;
+				float* dst = tile[t];
+				for (std::size_t p = 0; p<np; p++) {
+					missing[p] = (src[p] != src[p]);
+				}
+				for (float mv: missingValues) {
+					for (std::size_t p = 0; p<np; p++) {
+						missing[p] |= (src[p] == mv);
+					}
+				}
+				for (std::size_t p = 0; p<np; p++) {
+					const float value = missing[p] ? NAN : src[p]*scaleFactor + addOffset;
+					// comparisons with NaN are false, so the missing values are skipped
+					dataMin = (value < dataMin) ? value : dataMin;
+					dataMax = (value > dataMax) ? value : dataMax;
+					missingCount += missing[p];
+					dst[p] = value;
+				}
+			}
+
+			// write the tile transposed, contiguous along the time of each point
+			for (std::size_t p = 0; p<np; p++) {
+				float* row = rows + (p0+p)*stride + t0;
+				for (std::size_t t = 0; t<nt; t++) {
+					row[t] = tile[t][p];
+				}
+			}
+		}
+	}
+
+	statistics.dataMin = dataMin;
+	statistics.dataMax = dataMax;
+	statistics.missingCount += missingCount;
+}
+
+} // namespace VCGL
@@ -0,0 +1,55 @@
+/*!	@file hyperslabunpack.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Unpacking of (time, point) hyperslabs into time series rows
+ */
+
+#ifndef HYPERSLABUNPACK_H_
+#define HYPERSLABUNPACK_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace VCGL {
+
+/// Diagnostics of the unpacked values, for user eyes only
+struct UnpackStatistics {
+	float dataMin;
+	float dataMax;
+	std::size_t missingCount;
+
+	UnpackStatistics();
+
+	/// Combine with the statistics of another part of the data
+	void merge(const UnpackStatistics& other);
+};
+
+/*! @brief Unpack a hyperslab stored as (time, point) into rows of series stored as (point, time)
+ *
+ * value = raw*scaleFactor + addOffset; NaN and the missing values become NaN.
+ * Unpacking, transposing and the min/max are done in one pass over tiles of
+ * the hyperslab small enough for the source and the destination to stay in cache.
+ *
+ * @param raw			Values with the index t*pointCount + p
+ * @param timeCount		Number of time steps
+ * @param pointCount	Number of points
+ * @param scaleFactor	Scaling factor (in case of packed data, otherwise 1.0)
+ * @param addOffset		Offset (in case of packed data, otherwise 0.0)
+ * @param missingValues	Raw values marking missing data
+ * @param[out] rows		Output with the index p*stride + t
+ * @param stride		Distance between rows, at least timeCount
+ * @param[in,out] statistics Statistics merged with those of the hyperslab
+ */
+void unpackHyperslab(const float* raw,
+		std::size_t timeCount,
+		std::size_t pointCount,
+		float scaleFactor,
+		float addOffset,
+		const std::vector<float>& missingValues,
+		float* rows,
+		std::size_t stride,
+		UnpackStatistics& statistics);
+
+} // namespace VCGL
+
+#endif // HYPERSLABUNPACK_H_
@@ -0,0 +1,72 @@
+/*!	@file mappedfile.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Read-only memory mapping of a whole file
+ */
+
+#include "mappedfile.h"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace VCGL {
+
+MappedFile::MappedFile(MappedFile&& other): pData(other.pData), length(other.length) {
+	other.pData = 0;
+	other.length = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+	if (this != &other) {
+		unmap();
+		pData = other.pData;
+		length = other.length;
+		other.pData = 0;
+		other.length = 0;
+	}
+	return *this;
+}
+
+bool MappedFile::map(const std::string& fileName) {
+	unmap();
+
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "Cannot open " << fileName << ": " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		std::cerr << "Cannot map empty or unreadable file " << fileName << std::endl;
+		close(fd);
+		return false;
+	}
+
+	void* p = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // the mapping keeps its own reference to the file
+	if (p == MAP_FAILED) {
+		std::cerr << "Cannot map " << fileName << ": " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	pData = static_cast<const char*>(p);
+	length = st.st_size;
+	return true;
+}
+
+void MappedFile::unmap() {
+	if (pData) {
+		munmap(const_cast<char*>(pData), length);
+		pData = 0;
+		length = 0;
+	}
+}
+
+} // namespace VCGL
@@ -0,0 +1,50 @@
+/*!	@file mappedfile.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Read-only memory mapping of a whole file
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+
+namespace VCGL {
+
+/*! @brief Read-only shared mapping of a file.
+ *
+ * Pages are loaded on first access and shared through the page cache
+ * between all processes mapping the same file. Move-only.
+ */
+class MappedFile {
+public:
+	MappedFile(): pData(0), length(0) {}
+	~MappedFile() { unmap(); }
+
+	MappedFile(MappedFile&& other);
+	MappedFile& operator=(MappedFile&& other);
+
+	/*! @brief Map the given file, replacing the current mapping
+	 *
+	 * @return true on success; on failure the reason is reported to stderr
+	 */
+	bool map(const std::string& fileName);
+	/// Release the mapping
+	void unmap();
+
+	bool isMapped() const { return pData != 0; }
+	const char* data() const { return pData; }
+	std::size_t size() const { return length; }
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const char* pData;
+	std::size_t length;
+};
+
+} // namespace VCGL
+
+#endif // MAPPEDFILE_H_
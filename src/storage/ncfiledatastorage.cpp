@@ -6,6 +6,8 @@
  */
 
 #include "ncfiledatastorage.h"
+#include "hyperslabunpack.h"
+#include "process/threadpool.h"
 
 #include <iostream>
 #include "typedefs.h"
@@ -13,6 +15,8 @@
 #include <string.h>
 #include <math.h>
 #include <cassert>
+#include <algorithm>
+#include <mutex>
 
 namespace {
 	int nc_retval = 0;
@@ -21,6 +25,9 @@ namespace {
 	const char* LEV_NAME = "lev";
 	const char* LEV_NAME_2 = "level";
 	const char* TIME_NAME = "time";
+
+	/// Target size of the raw buffer of one latitude band read
+	const std::size_t BAND_BYTES = 64*1024*1024;
 }
 
 namespace VCGL {
@@ -65,6 +72,65 @@ struct NCFileHelper {
 		}
 	}
 
+	/*! get the raw values which mark missing data (_FillValue and missing_value attributes)
+	 *
+	 * Without a _FillValue attribute, the NetCDF default fill value of the variable type is used.
+	 * Values are converted to float the same way nc_get_vara_float converts the data.
+	 *
+	 * @param ncid	Open NetCDF file descriptor
+	 * @param varID	ID of the variable for which to get attributes
+	 * @return The values marking missing data
+	 */
+	static std::vector<float> getMissingValues(int ncid, int varID) {
+		std::vector<float> missingValues;
+
+		std::vector<double> fillValues;
+		if (getAttributeValues(ncid, varID, "_FillValue", fillValues)) {
+			missingValues.insert(missingValues.end(), fillValues.begin(), fillValues.end());
+		}
+		else {
+			nc_type varType = 0;
+			if (NC_NOERR == nc_inq_vartype(ncid, varID, &varType)) {
+				switch (varType) {
+				case NC_BYTE: missingValues.push_back(NC_FILL_BYTE); break;
+				case NC_SHORT: missingValues.push_back(NC_FILL_SHORT); break;
+				case NC_INT: missingValues.push_back(static_cast<float>(NC_FILL_INT)); break;
+				case NC_FLOAT: missingValues.push_back(NC_FILL_FLOAT); break;
+				case NC_DOUBLE: missingValues.push_back(static_cast<float>(NC_FILL_DOUBLE)); break;
+				default: break;
+				}
+			}
+		}
+
+		std::vector<double> missingAttribute;
+		if (getAttributeValues(ncid, varID, "missing_value", missingAttribute)) {
+			missingValues.insert(missingValues.end(), missingAttribute.begin(), missingAttribute.end());
+		}
+		return missingValues;
+	}
+
+	/*! read all values of a numeric attribute
+	 *
+	 * @param ncid	Open NetCDF file descriptor
+	 * @param varID	ID of the variable the attribute belongs to
+	 * @param name	Name of the attribute
+	 * @param[out] values	The values of the attribute
+	 * @return false if there is no such attribute
+	 */
+	static bool getAttributeValues(int ncid, int varID, const char* name, std::vector<double>& values) {
+		values.clear();
+		size_t len = 0;
+		if (NC_NOERR != nc_inq_attlen(ncid, varID, name, &len) || len == 0) {
+			return false;
+		}
+		values.resize(len);
+		if (NC_NOERR != nc_get_att_double(ncid, varID, name, &values[0])) {
+			values.clear();
+			return false;
+		}
+		return true;
+	}
+
 	/*! get length of a dimension
 	 *
 	 * @param ncid	Open NetCDF file descriptor
@@ -179,59 +245,6 @@ struct NCFileHelper {
 		}
 		return OK;
 	}
-
-	/*! Rearrange the data from (time, (level), lat, lon) to (lat, lon, time)
-	 *
-	 * @param var_in	The data array with the (time, (level), lat, lon) indices
-	 * @param ntime		Length of the time dimension for var_in array
-	 * @param nlat		Length of the latitude dimension for var_in array
-	 * @param nlon		Length of the longitude dimension for var_in array
-	 * @param scale_factor	Scaling factor (in case of packed data, otherwise 1.0)
-	 * @param add_offset	Offset (in case of packed data, otherwise 0.0)
-	 * @param[out] data			Output 3D vector with the (lat, lon, time) indices
-	 */
-	static void rearrangeData(const std::vector<float>& var_in,
-				size_t ntime,
-				size_t nlat,
-				size_t nlon,
-				float scale_factor,
-				float add_offset,
-				vectorFloat3D& data) {
-
-			data.clear();
-			const std::vector<float> ts_init(ntime, 0);
-			const std::vector< std::vector<float> > par_init(nlon, ts_init);
-			data.resize(nlat, par_init);
-
-
-			//diagnostic variables - for user eyes only
-			float dataMin;
-		   float dataMax;
-		   dataMin = data[0][0][0];
-		   dataMax = data[0][0][0];
-
-		   for (size_t itime = 0; itime < ntime; itime++) {
-			   for (size_t ilat = 0; ilat < nlat; ilat++) {
-				   for (size_t ilon = 0; ilon < nlon; ilon++) {
-					   size_t index = itime*nlat*nlon + ilat*nlon + ilon;
-
-					   float dataValue = var_in[index] * scale_factor + add_offset;
-					   data[ilat][ilon][itime] = dataValue;
-
-					   if (dataMin > dataValue) {
-						   dataMin = dataValue;
-					   }
-					   if (dataMax < dataValue) {
-						   dataMax = dataValue;
-					   }
-				   }
-			   }
-		   }
-
-		   std::cerr << " dataMin = " << dataMin
-				    << ", dataMax = " << dataMax << std::endl;
-
-		}
 };
 
 NCFileDataStorage::NCFileDataStorage(const char* filename)
@@ -243,7 +256,8 @@ NCFileDataStorage::NCFileDataStorage(const char* filename)
   var_numdim(0),
   iLev(0),
   lat_varid(-1),
-  lon_varid(-1)
+  lon_varid(-1),
+  threadCount(0)
 {
 
 	bool OK = true;
@@ -304,6 +318,10 @@ void NCFileDataStorage::releaseVariable() {
 	iLev = 0;
 }
 
+void NCFileDataStorage::setThreadCount(unsigned threadCount) {
+	this->threadCount = threadCount;
+}
+
 std::size_t NCFileDataStorage::getNTime() {
 	return ntime;
 }
@@ -323,79 +341,167 @@ std::vector<float> NCFileDataStorage::loadLats() {
 	return NCFileHelper::loadArray(ncid, lat_varid, nlat);
 
 }
-vectorFloat3D NCFileDataStorage::loadData(std::size_t latStart, std::size_t latCount) {
-	nc_retval = 0;
-	bool OK = true;
-	std::vector<float> var_in(ntime*nlat*nlon);
+TimeSeriesField NCFileDataStorage::loadData(std::size_t latStart, std::size_t latCount) {
+	return loadData(latStart, latCount, 0, ntime);
+}
 
-	//numdim = 4
-	if (OK && var_numdim == 4) {
-		OK = read4DVar(var_in, latStart, latCount);
-	}
-	//numdim = 3
-	if (OK && var_numdim == 3) {
-		OK = read3DVar(var_in, latStart, latCount);
+/*! Number of file latitudes of the bands read by loadData
+ *
+ * A multiple of the latitude chunk size of NetCDF-4 chunked variables,
+ * so that each chunk is decompressed by one read only.
+ */
+std::size_t NCFileDataStorage::bandLatCount(std::size_t timeCount, std::size_t lonCount) const {
+	std::size_t chunkLats = 1;
+	int storage = NC_CONTIGUOUS;
+	size_t chunkSizes[NC_MAX_VAR_DIMS];
+	if (NC_NOERR == nc_inq_var_chunking(ncid, varID, &storage, chunkSizes) && storage == NC_CHUNKED) {
+		chunkLats = std::max<size_t>(1, chunkSizes[var_numdim - 2]);
 	}
+	const std::size_t rowBytes = std::max<std::size_t>(1, timeCount*lonCount*sizeof(float));
+	const std::size_t chunksPerBand = std::max<std::size_t>(1, BAND_BYTES / rowBytes / chunkLats);
+	return chunksPerBand*chunkLats;
+}
 
-	//at this point we have 3D data = an array of 2D maps for each timestep
-
-	vectorFloat3D data;
+TimeSeriesField NCFileDataStorage::loadData(std::size_t latStart, std::size_t latCount,
+		std::size_t timeStart, std::size_t timeCount) {
+	return loadData(GridSelection(latStart, latCount, nlon, timeStart, timeCount));
+}
 
-	if (OK) {
-		float scaleFactor = 1.0f;
-		float addOffset = 0.0f;
-		NCFileHelper::getPackedDataAttributes(ncid, varID, &scaleFactor, &addOffset);
+TimeSeriesField NCFileDataStorage::loadData(const GridSelection& selection) {
+	nc_retval = 0;
+	TimeSeriesField data;
+	const GridSelection& sel = selection;
+	if (sel.latCount == 0 || sel.lonCount == 0 || sel.timeCount == 0
+			|| sel.latStride == 0 || sel.lonStride == 0 || sel.timeStride == 0
+			|| sel.lat(sel.latCount-1) >= nlat || sel.time(sel.timeCount-1) >= ntime
+			|| sel.lonStart >= nlon || (sel.lonCount-1)*sel.lonStride >= nlon
+			|| (var_numdim != 3 && var_numdim != 4)) {
+		return data;
+	}
 
-		//rearrange data from (time, lat, lon) to (lat, lon, time)
-		NCFileHelper::rearrangeData(var_in, ntime, latCount, nlon, scaleFactor, addOffset, data);
+	float scaleFactor = 1.0f;
+	float addOffset = 0.0f;
+	NCFileHelper::getPackedDataAttributes(ncid, varID, &scaleFactor, &addOffset);
+	const std::vector<float> missingValues = NCFileHelper::getMissingValues(ncid, varID);
+
+	//longitudes up to the seam of the grid are read first, the ones after it wrap to the start
+	const std::size_t lonCountFirst = std::min(sel.lonCount, (nlon - sel.lonStart + sel.lonStride - 1) / sel.lonStride);
+	const std::size_t lonCountSecond = sel.lonCount - lonCountFirst;
+
+	//band boundaries where the file latitude crosses a multiple of the band height
+	const std::size_t bandLats = bandLatCount(sel.timeCount, sel.lonCount);
+	std::vector<std::size_t> bandStarts(1, 0);
+	for (std::size_t k = 1; k < sel.latCount; k++) {
+		if (sel.lat(k) / bandLats != sel.lat(k-1) / bandLats) {
+			bandStarts.push_back(k);
+		}
 	}
-	return data;
-}
+	bandStarts.push_back(sel.latCount);
 
-bool NCFileDataStorage::read4DVar(std::vector<float>& var_in, std::size_t latStart, std::size_t latCount) {
-	//read variable: (0,iLev,0,0) -> (ntime, iLev+1, nLat, nLon)
-	size_t start[4], count[4];
+	data.resize(sel.latCount, sel.lonCount, sel.timeCount);
+
+	//the NetCDF library is not thread safe: reads are serialized, unpacking overlaps them
+	std::mutex ncMutex;
+	bool OK = true;
+	UnpackStatistics statistics;
+	const std::size_t bandTotal = bandStarts.size() - 1;
+	const unsigned threads = threadCount ? threadCount : ThreadPool::hardwareThreads();
+	ThreadPool pool(static_cast<unsigned>(std::min<std::size_t>(threads, bandTotal)));
+	pool.parallelFor(bandTotal, [&](std::size_t band) {
+		const std::size_t bandStart = bandStarts[band];
+		const std::size_t bandCount = bandStarts[band+1] - bandStart;
+		const std::size_t valueCount = sel.timeCount*bandCount;
+		std::vector<float> var_in(valueCount*sel.lonCount);
+		std::vector<float> wrapped(valueCount*lonCountSecond);
+		{
+			std::lock_guard<std::mutex> lock(ncMutex);
+			if (!OK) {
+				return;
+			}
+			OK = readVar(&var_in[0], sel.lat(bandStart), bandCount, sel.lonStart, lonCountFirst, sel);
+			if (OK && lonCountSecond > 0) {
+				OK = readVar(&wrapped[0], sel.lat(bandStart), bandCount, sel.lon(lonCountFirst, nlon), lonCountSecond, sel);
+			}
+			if (!OK) {
+				return;
+			}
+		}
 
-	start[0] = 0;
-	start[1] = iLev;
-	start[2] = latStart;
-	start[3] = 0;
+		if (lonCountSecond > 0) {
+			//join the rows of both parts, from the last one so that the first part is moved in place
+			for (std::size_t row = valueCount; row-- > 0; ) {
+				std::copy_backward(&var_in[row*lonCountFirst], &var_in[row*lonCountFirst] + lonCountFirst,
+						&var_in[row*sel.lonCount] + lonCountFirst);
+				std::copy(&wrapped[row*lonCountSecond], &wrapped[row*lonCountSecond] + lonCountSecond,
+						&var_in[row*sel.lonCount] + lonCountFirst);
+			}
+		}
 
-	count[0] = ntime;
-	count[1] = 1;
-	count[2] = latCount;
-	count[3] = nlon;
+		//(time, lat, lon) to (lat, lon, time), missing values become NaN
+		UnpackStatistics bandStatistics;
+		unpackHyperslab(var_in.data(), sel.timeCount, bandCount*sel.lonCount, scaleFactor, addOffset, missingValues,
+				data.series(bandStart, 0).data(), data.stride(), bandStatistics);
 
-	std::cout << "reading 4D var, start=("
-		   << start[0] << ',' << start[1] << ',' << start[2] << ',' << start[3] <<
-		   "), count=("
-		   << count[0] << ',' << count[1] << ',' << count[2] << ',' << count[3] << ")" << std::endl;
-	bool OK = true;
+		std::lock_guard<std::mutex> lock(ncMutex);
+		statistics.merge(bandStatistics);
+	});
 
-	if ((nc_retval = nc_get_vara_float(ncid, varID, start, count, &var_in[0]))) { OK = false; }
+	if (!OK) {
+		data.clear();
+		return data;
+	}
 
-	return OK;
+	std::cerr << " dataMin = " << statistics.dataMin
+			<< ", dataMax = " << statistics.dataMax;
+	if (statistics.missingCount > 0) {
+		std::cerr << ", missing values: " << statistics.missingCount;
+	}
+	std::cerr << std::endl;
+	return data;
 }
 
-bool NCFileDataStorage::read3DVar(std::vector<float>& var_in, std::size_t latStart, std::size_t latCount) {
-	//read variable: (0,0,0) -> (ntime,nlat,nlon)
-	size_t start[3], count[3];
+bool NCFileDataStorage::readVar(float* var_in, std::size_t latStart, std::size_t latCount,
+		std::size_t lonStart, std::size_t lonCount, const GridSelection& selection) {
+	//read variable: (timeStart,(iLev),latStart,lonStart) -> (timeCount,(1),latCount,lonCount), strided
+	size_t start[4], count[4];
+	ptrdiff_t stride[4];
+	int d = 0;
+
+	start[d] = selection.timeStart;
+	count[d] = selection.timeCount;
+	stride[d++] = selection.timeStride;
+
+	if (var_numdim == 4) {
+		start[d] = iLev;
+		count[d] = 1;
+		stride[d++] = 1;
+	}
 
-	start[0] = 0;
-	start[1] = latStart;
-	start[2] = 0;
+	start[d] = latStart;
+	count[d] = latCount;
+	stride[d++] = selection.latStride;
 
-	count[0] = ntime;
-	count[1] = latCount;
-	count[2] = nlon;
+	start[d] = lonStart;
+	count[d] = lonCount;
+	stride[d++] = selection.lonStride;
 
-	std::cerr << "reading 3D var, start=("
-			   << start[0] << ',' << start[1] << ',' << start[2] <<  "), count=("
-			   << count[0] << ',' << count[1] << ',' << count[2] <<  ")" << std::endl;
+	std::cerr << "reading " << var_numdim << "D var, start=(";
+	for (int i = 0; i<d; i++) {
+		std::cerr << (i ? "," : "") << start[i];
+	}
+	std::cerr << "), count=(";
+	for (int i = 0; i<d; i++) {
+		std::cerr << (i ? "," : "") << count[i];
+	}
+	std::cerr << "), stride=(";
+	for (int i = 0; i<d; i++) {
+		std::cerr << (i ? "," : "") << stride[i];
+	}
+	std::cerr << ")" << std::endl;
 
 	bool OK = true;
 
-	if ((nc_retval = nc_get_vara_float(ncid, varID, start, count, &var_in[0]))) { OK = false; }
+	if ((nc_retval = nc_get_vars_float(ncid, varID, start, count, stride, var_in))) { OK = false; }
 
 	return OK;
 }
@@ -22,16 +22,27 @@ public:
 			int level);
 	void releaseVariable();
 
+	/*! @brief Set the number of threads unpacking the latitude bands in loadData
+	 *
+	 * @param threadCount Number of threads (0 - one per hardware thread)
+	 */
+	void setThreadCount(unsigned threadCount);
+
 	virtual std::size_t getNTime() override;
 	virtual std::size_t getNLon() override;
 	virtual std::size_t getNLat() override;
 	virtual std::vector<float> loadLons() override;
 	virtual std::vector<float> loadLats() override;
-	virtual vectorFloat3D loadData(std::size_t latStart, std::size_t latCount) override;
+	virtual TimeSeriesField loadData(std::size_t latStart, std::size_t latCount) override;
+	virtual TimeSeriesField loadData(std::size_t latStart, std::size_t latCount,
+			std::size_t timeStart, std::size_t timeCount) override;
+	/// Reads only the selected values (strided hyperslabs, two of them when the longitudes wrap)
+	virtual TimeSeriesField loadData(const GridSelection& selection) override;
 
 private:
-	bool read4DVar(std::vector<float>& var_in, std::size_t latStart, std::size_t latCount);
-	bool read3DVar(std::vector<float>& var_in, std::size_t latStart, std::size_t latCount);
+	std::size_t bandLatCount(std::size_t timeCount, std::size_t lonCount) const;
+	bool readVar(float* var_in, std::size_t latStart, std::size_t latCount,
+			std::size_t lonStart, std::size_t lonCount, const GridSelection& selection);
 
 	int ncid;
 
@@ -45,6 +56,8 @@ private:
 
 	int lat_varid;
 	int lon_varid;
+
+	unsigned threadCount;
 };
 
 } /* namespace VCGL */
@@ -14,6 +14,7 @@
 #include <libgen.h>
 #include <limits.h>
 #include <cstring>
+#include <cstdlib>
 
 
 
@@ -134,6 +135,18 @@ bool PathResolver::checkDir(const std::string& dirName, const std::string& inFil
 	return bExists;
 }
 
+std::string PathResolver::getCacheDir() const {
+	const char* cacheDir = getenv("TELCON_CACHE_DIR");
+	if (cacheDir && *cacheDir) {
+		return cacheDir;
+	}
+	const char* xdgCacheHome = getenv("XDG_CACHE_HOME");
+	if (xdgCacheHome && *xdgCacheHome && !isRelativePath(xdgCacheHome)) {
+		return std::string(xdgCacheHome) + "/telcon-explorer";
+	}
+	return fs.getHomeDir() + "/.cache/telcon-explorer";
+}
+
 std::string PathResolver::getGlobalDataDir() const {
 #ifdef DATADIR
 	// return data dir if it exists
@@ -20,6 +20,12 @@ public:
 	bool find(const std::string& inFileName, std::string& outPath);
 	bool findDependency(const std::string& dependencyName, const std::string& givenFileName, std::string& outPath);
 	static void setAppDir(const std::string& dirName);
+	/*! @brief Directory of the precompute cache
+	 *
+	 * $TELCON_CACHE_DIR if set (e.g. a directory shared by a group of users),
+	 * otherwise $XDG_CACHE_HOME/telcon-explorer or $HOME/.cache/telcon-explorer
+	 */
+	std::string getCacheDir() const;
 private:
 	bool checkDir(const std::string& dirName, const std::string& inFileName,
 			std::string& testPath);
@@ -0,0 +1,327 @@
+/*!	@file precomputecache.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Cache of precomputed files keyed on the input data and the parameters
+ */
+
+#include "precomputecache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <utility>
+#include <cerrno>
+#include <cstdio>
+
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+namespace VCGL {
+
+namespace {
+	const char* KEY_FILE = "key.txt";
+	const char* FILES_FILE = "files.txt";
+
+	/// FNV-1a
+	std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL) {
+		for (std::size_t i = 0; i<size; i++) {
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	std::string hex(std::uint64_t value) {
+		std::ostringstream str;
+		str << std::hex << std::setw(16) << std::setfill('0') << value;
+		return str.str();
+	}
+
+	bool fileStatus(const std::string& path, std::uint64_t* pSize, std::time_t* pTime) {
+		struct stat buffer;
+		if (stat(path.c_str(), &buffer) != 0 || !S_ISREG(buffer.st_mode)) {
+			return false;
+		}
+		*pSize = static_cast<std::uint64_t>(buffer.st_size);
+		*pTime = buffer.st_mtime;
+		return true;
+	}
+
+	/// mkdir -p
+	bool makeDirs(const std::string& dirName) {
+		for (std::size_t pos = 1; pos <= dirName.size(); pos++) {
+			if (pos == dirName.size() || dirName[pos] == '/') {
+				const std::string part = dirName.substr(0, pos);
+				if (mkdir(part.c_str(), 0777) != 0 && errno != EEXIST) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/// Entries being written are hidden until they are complete
+	bool isTemporary(const std::string& entryName) {
+		return entryName[0] == '.';
+	}
+
+	/// Regular files (or subdirectories) of a directory, without . and ..
+	std::vector<std::string> listDir(const std::string& dirName, bool directories) {
+		std::vector<std::string> names;
+		DIR* pDir = opendir(dirName.c_str());
+		if (!pDir) {
+			return names;
+		}
+		while (struct dirent* pEntry = readdir(pDir)) {
+			const std::string name = pEntry->d_name;
+			if (name == "." || name == "..") {
+				continue;
+			}
+			struct stat buffer;
+			const std::string path = dirName + '/' + name;
+			if (stat(path.c_str(), &buffer) == 0 && (directories ? S_ISDIR(buffer.st_mode) : S_ISREG(buffer.st_mode))) {
+				names.push_back(name);
+			}
+		}
+		closedir(pDir);
+		return names;
+	}
+
+	void removeDir(const std::string& dirName) {
+		for (const std::string& name: listDir(dirName, false)) {
+			unlink((dirName + '/' + name).c_str());
+		}
+		rmdir(dirName.c_str());
+	}
+
+	/// Copy through a temporary file renamed into place, so the target is never partially written
+	bool copyFile(const std::string& from, const std::string& to) {
+		const std::string partName = to + ".part";
+		{
+			std::ifstream in(from.c_str(), std::ios::binary);
+			std::ofstream out(partName.c_str(), std::ios::binary | std::ios::trunc);
+			if (!in || !out) {
+				return false;
+			}
+			out << in.rdbuf();
+			out.flush();
+			if (!out) {
+				out.close();
+				unlink(partName.c_str());
+				return false;
+			}
+		}
+		if (rename(partName.c_str(), to.c_str()) != 0) {
+			unlink(partName.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool readText(const std::string& fileName, std::string& text) {
+		std::ifstream in(fileName.c_str(), std::ios::binary);
+		if (!in) {
+			return false;
+		}
+		std::ostringstream str;
+		str << in.rdbuf();
+		text = str.str();
+		return true;
+	}
+
+	/// Roles and sizes of the files of an entry
+	bool readFileList(const std::string& fileName, std::vector< std::pair<std::string, std::uint64_t> >& roles) {
+		std::ifstream in(fileName.c_str());
+		std::string role;
+		std::uint64_t size = 0;
+		roles.clear();
+		while (in >> role >> size) {
+			roles.push_back(std::make_pair(role, size));
+		}
+		return in.eof() && !roles.empty();
+	}
+}
+
+void PrecomputeCacheKey::add(const std::string& name, const std::string& value) {
+	text += name + '=' + value + '\n';
+}
+
+void PrecomputeCacheKey::add(const std::string& name, std::uint64_t value) {
+	add(name, std::to_string(value));
+}
+
+bool PrecomputeCacheKey::addDataFile(const std::string& fileName) {
+	std::uint64_t size = 0;
+	std::time_t modified = 0;
+	if (!fileStatus(fileName, &size, &modified)) {
+		return false;
+	}
+	std::ifstream in(fileName.c_str(), std::ios::binary);
+	std::vector<char> header(HEADER_BYTES);
+	in.read(header.data(), header.size());
+	if (in.bad()) {
+		return false;
+	}
+	add("data.size", size);
+	add("data.mtime", static_cast<std::uint64_t>(modified));
+	add("data.header", hex(hashBytes(header.data(), static_cast<std::size_t>(in.gcount()))));
+	return true;
+}
+
+std::string PrecomputeCacheKey::hash() const {
+	//two passes with different bases for a 128-bit name
+	return hex(hashBytes(text.data(), text.size()))
+			+ hex(hashBytes(text.data(), text.size(), 0x6c62272e07bb0142ULL));
+}
+
+PrecomputeCache::PrecomputeCache(const std::string& dirName, std::uint64_t sizeBudget)
+: dirName(dirName),
+  sizeBudget(sizeBudget) {
+}
+
+std::string PrecomputeCache::entryDir(const std::string& entryName) const {
+	return dirName + '/' + entryName;
+}
+
+bool PrecomputeCache::restore(const PrecomputeCacheKey& key, const std::vector<CachedFile>& files) {
+	const std::string dir = entryDir(key.hash());
+	std::string description;
+	std::vector< std::pair<std::string, std::uint64_t> > roles;
+	if (!readText(dir + '/' + KEY_FILE, description) || description != key.description()
+			|| !readFileList(dir + '/' + FILES_FILE, roles)) {
+		return false;
+	}
+
+	//check the whole entry before copying anything
+	std::vector< std::pair<std::string, std::string> > copies;
+	for (const auto& role: roles) {
+		const auto it = std::find_if(files.begin(), files.end(),
+				[&](const CachedFile& file) { return file.role == role.first; });
+		std::uint64_t size = 0;
+		std::time_t modified = 0;
+		if (it == files.end() || !fileStatus(dir + '/' + role.first, &size, &modified) || size != role.second) {
+			return false;
+		}
+		copies.push_back(std::make_pair(dir + '/' + role.first, it->path));
+	}
+	for (const auto& copy: copies) {
+		if (!copyFile(copy.first, copy.second)) {
+			std::cerr << "ERROR: failed to copy " << copy.first << " to " << copy.second << std::endl;
+			return false;
+		}
+	}
+
+	//recently used
+	utime((dir + '/' + FILES_FILE).c_str(), 0);
+	return true;
+}
+
+std::size_t PrecomputeCache::store(const PrecomputeCacheKey& key, const std::vector<CachedFile>& files,
+		std::time_t notBefore) {
+	const std::string entryName = key.hash();
+	const std::string tmpDir = entryDir("." + entryName + '-' + std::to_string(getpid()));
+	if (!makeDirs(tmpDir)) {
+		std::cerr << "WARNING: cannot create cache directory " << tmpDir << std::endl;
+		return 0;
+	}
+
+	std::ostringstream fileList;
+	std::size_t count = 0;
+	bool bOk = true;
+	for (const CachedFile& file: files) {
+		std::uint64_t size = 0;
+		std::time_t modified = 0;
+		if (!fileStatus(file.path, &size, &modified) || modified < notBefore) {
+			continue;
+		}
+		bOk = bOk && copyFile(file.path, tmpDir + '/' + file.role);
+		fileList << file.role << ' ' << size << '\n';
+		count++;
+	}
+	std::ofstream keyOut((tmpDir + '/' + KEY_FILE).c_str(), std::ios::binary);
+	keyOut << key.description();
+	keyOut.close();
+	std::ofstream listOut((tmpDir + '/' + FILES_FILE).c_str());
+	listOut << fileList.str();
+	listOut.close();
+
+	//replace an older entry of the same key
+	if (bOk && count > 0 && keyOut && listOut) {
+		removeDir(entryDir(entryName));
+		bOk = (rename(tmpDir.c_str(), entryDir(entryName).c_str()) == 0);
+	}
+	else {
+		bOk = false;
+	}
+	if (!bOk) {
+		removeDir(tmpDir);
+		return 0;
+	}
+
+	evict(entryName);
+	return count;
+}
+
+void PrecomputeCache::evict(const std::string& keep) {
+	if (sizeBudget == 0) {
+		return;
+	}
+	struct Entry {
+		std::string name;
+		std::time_t used;
+		std::uint64_t size;
+	};
+	std::vector<Entry> entries;
+	std::uint64_t total = 0;
+	for (const std::string& name: listDir(dirName, true)) {
+		if (isTemporary(name)) {
+			continue;
+		}
+		Entry entry = { name, 0, 0 };
+		std::uint64_t size = 0;
+		if (!fileStatus(entryDir(name) + '/' + FILES_FILE, &size, &entry.used)) {
+			continue; //not an entry
+		}
+		for (const std::string& fileName: listDir(entryDir(name), false)) {
+			std::time_t modified = 0;
+			if (fileStatus(entryDir(name) + '/' + fileName, &size, &modified)) {
+				entry.size += size;
+			}
+		}
+		total += entry.size;
+		entries.push_back(entry);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.used < b.used || (a.used == b.used && a.name < b.name);
+	});
+	for (std::size_t i = 0; i<entries.size() && total > sizeBudget; i++) {
+		if (entries[i].name != keep) {
+			removeDir(entryDir(entries[i].name));
+			total -= entries[i].size;
+		}
+	}
+}
+
+std::uint64_t PrecomputeCache::totalSize() const {
+	std::uint64_t total = 0;
+	for (const std::string& name: listDir(dirName, true)) {
+		if (isTemporary(name)) {
+			continue;
+		}
+		for (const std::string& fileName: listDir(entryDir(name), false)) {
+			std::uint64_t size = 0;
+			std::time_t modified = 0;
+			if (fileStatus(entryDir(name) + '/' + fileName, &size, &modified)) {
+				total += size;
+			}
+		}
+	}
+	return total;
+}
+
+} // namespace VCGL
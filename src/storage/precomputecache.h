@@ -0,0 +1,98 @@
+/*!	@file precomputecache.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Cache of precomputed files keyed on the input data and the parameters
+ */
+
+#ifndef PRECOMPUTECACHE_H_
+#define PRECOMPUTECACHE_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+
+namespace VCGL {
+
+/*! @brief Identity of a precompute: fingerprint of the data file and all parameters affecting the results
+ *
+ * The data file enters through its size, modification time and first bytes
+ * (the NetCDF header), not through its name, so a moved or renamed file is
+ * still recognized. The whole description is kept as text next to the cached
+ * files, so two keys are equal only if their descriptions are equal.
+ */
+class PrecomputeCacheKey {
+public:
+	/// Number of bytes at the start of the data file entering the fingerprint
+	static const std::size_t HEADER_BYTES = 64*1024;
+
+	/// Add a named parameter
+	void add(const std::string& name, const std::string& value);
+	void add(const std::string& name, std::uint64_t value);
+
+	/// Add the fingerprint of a data file, false if it cannot be read
+	bool addDataFile(const std::string& fileName);
+
+	/// Text of all added parameters, one per line
+	const std::string& description() const { return text; }
+	/// Hash of the description in hex, used as the name of the cache entry
+	std::string hash() const;
+
+private:
+	std::string text;
+};
+
+/// Precomputed file: its role in the cache entry (e.g. "correlation") and its path
+struct CachedFile {
+	std::string role;
+	std::string path;
+
+	CachedFile(const std::string& role, const std::string& path): role(role), path(path) {}
+};
+
+/*! @brief Directory of cache entries, one subdirectory per key, evicted least recently used first
+ *
+ * Entries are written to a temporary directory and renamed into place, so
+ * concurrent runs (of different users sharing the directory as well) never
+ * see half written entries.
+ */
+class PrecomputeCache {
+public:
+	/*! @param dirName Cache directory, created when the first entry is stored
+	 *	@param sizeBudget Bytes the entries may take in total (0 - no limit)
+	 */
+	PrecomputeCache(const std::string& dirName, std::uint64_t sizeBudget);
+
+	const std::string& directory() const { return dirName; }
+
+	/*! @brief Copy the files of the entry of the key to their paths
+	 *
+	 * @param files Paths for the roles; every role stored in the entry must be among them
+	 * @return false if there is no complete entry for the key (nothing is copied then)
+	 */
+	bool restore(const PrecomputeCacheKey& key, const std::vector<CachedFile>& files);
+
+	/*! @brief Store copies of the files as the entry of the key and evict old entries
+	 *
+	 * Only the files modified at notBefore or later are stored, so outputs of
+	 * earlier runs which the current one did not produce are left out.
+	 * @return number of stored files
+	 */
+	std::size_t store(const PrecomputeCacheKey& key, const std::vector<CachedFile>& files, std::time_t notBefore);
+
+	/// Remove the least recently used entries (except keep) until the budget is met
+	void evict(const std::string& keep = std::string());
+
+	/// Total size of the stored entries in bytes
+	std::uint64_t totalSize() const;
+
+private:
+	std::string entryDir(const std::string& entryName) const;
+
+	std::string dirName;
+	std::uint64_t sizeBudget;
+};
+
+} // namespace VCGL
+
+#endif // PRECOMPUTECACHE_H_
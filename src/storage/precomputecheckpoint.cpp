@@ -0,0 +1,125 @@
+/*!	@file precomputecheckpoint.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Progress of a precompute kept on disk to continue an interrupted run
+ */
+
+#include "precomputecheckpoint.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+
+namespace VCGL {
+
+namespace {
+	const char CHECKPOINT_MAGIC[8] = { 'T', 'C', 'C', 'H', 'E', 'C', 'K', 'P' };
+	const std::uint32_t CHECKPOINT_VERSION = 1;
+
+	template<typename T>
+	void writeValue(std::ostream& out, const T& value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	template<typename T>
+	bool readValue(std::istream& in, T& value) {
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return static_cast<bool>(in);
+	}
+
+	template<typename T>
+	void writeArray(std::ostream& out, const T* values, std::uint64_t count) {
+		writeValue(out, count);
+		out.write(reinterpret_cast<const char*>(values), count*sizeof(T));
+	}
+
+	/// Read an array written by writeArray, at most maxCount values
+	template<typename C>
+	bool readArray(std::istream& in, C& values, std::uint64_t maxCount) {
+		std::uint64_t count = 0;
+		if (!readValue(in, count) || count > maxCount) {
+			return false;
+		}
+		values.resize(count);
+		if (count > 0) {
+			in.read(reinterpret_cast<char*>(&values[0]), count*sizeof(values[0]));
+		}
+		return static_cast<bool>(in);
+	}
+}
+
+PrecomputeCheckpoint::PrecomputeCheckpoint()
+: startTime(0),
+  completedStages(0),
+  correlationRows(0),
+  projectionIteration(0) {
+}
+
+bool PrecomputeCheckpoint::save(const std::string& fileName) const {
+	const std::string partName = fileName + ".part";
+	std::ofstream out(partName.c_str(), std::ios::binary | std::ios::trunc);
+	out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	writeValue(out, CHECKPOINT_VERSION);
+	writeArray(out, key.data(), key.size());
+	writeValue(out, startTime);
+	writeValue(out, completedStages);
+	writeValue(out, correlationRows);
+	writeArray(out, correlationState.data(), correlationState.size());
+	writeValue(out, projectionIteration);
+	writeArray(out, projection.data(), projection.size());
+	out.close();
+	if (!out || rename(partName.c_str(), fileName.c_str()) != 0) {
+		std::cerr << "WARNING: failed to write the checkpoint " << fileName << std::endl;
+		std::remove(partName.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool PrecomputeCheckpoint::load(const std::string& fileName) {
+	std::ifstream in(fileName.c_str(), std::ios::binary | std::ios::ate);
+	// sizes are bounded by the file to fail on damaged files instead of allocating them
+	const std::uint64_t maxBytes = in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+	in.seekg(0);
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	std::uint32_t version = 0;
+	in.read(magic, sizeof(magic));
+	if (!in || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0
+			|| !readValue(in, version) || version != CHECKPOINT_VERSION) {
+		return false;
+	}
+	PrecomputeCheckpoint loaded;
+	if (!readArray(in, loaded.key, maxBytes) || !readValue(in, loaded.startTime)
+			|| !readValue(in, loaded.completedStages) || !readValue(in, loaded.correlationRows)
+			|| !readArray(in, loaded.correlationState, maxBytes) || !readValue(in, loaded.projectionIteration)
+			|| !readArray(in, loaded.projection, maxBytes)) {
+		return false;
+	}
+	*this = loaded;
+	return true;
+}
+
+CheckpointSaver::CheckpointSaver(const std::string& fileName, unsigned intervalSeconds, PrecomputeCheckpoint& checkpoint)
+: checkpoint(checkpoint),
+  checkpointFileName(fileName),
+  interval(intervalSeconds),
+  lastSave(std::time(0)) {
+}
+
+bool CheckpointSaver::due() const {
+	return enabled() && std::difftime(std::time(0), lastSave) >= interval;
+}
+
+void CheckpointSaver::save() {
+	if (enabled()) {
+		checkpoint.save(checkpointFileName);
+		lastSave = std::time(0);
+	}
+}
+
+void CheckpointSaver::remove() {
+	std::remove(checkpointFileName.c_str());
+}
+
+} // namespace VCGL
@@ -0,0 +1,81 @@
+/*!	@file precomputecheckpoint.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Progress of a precompute kept on disk to continue an interrupted run
+ */
+
+#ifndef PRECOMPUTECHECKPOINT_H_
+#define PRECOMPUTECHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+
+namespace VCGL {
+
+/*! @brief Consistent state of a precompute, written to disk while it runs
+ *
+ * The finished stages have their files written completely. Of the streamed
+ * correlations, the first correlationRows rows are in the correlation file and
+ * correlationState holds the minima (and the kept correlations of a sparse
+ * file) collected from them. Of the projection, the points after
+ * projectionIteration iterations are kept.
+ */
+struct PrecomputeCheckpoint {
+	/// Stages of the precompute, flags of completedStages
+	enum Stage {
+		CORRELATIONS = 0x01,	///< correlation file (or teleconnectivity with -T)
+		AUTOCORRELATIONS = 0x02,
+		LAGGED_CORRELATIONS = 0x04,
+		PROJECTION = 0x08
+	};
+
+	std::string key;	///< identity of the precompute, see PrecomputeCacheKey::hash
+	std::int64_t startTime;	///< when the first run of the precompute started
+	std::uint32_t completedStages;	///< Stage flags
+	std::uint64_t correlationRows;	///< rows of the streamed correlations written so far
+	std::string correlationState;	///< state of the collectors of the streamed rows
+	std::uint32_t projectionIteration;	///< Sammon iterations done
+	std::vector<double> projection;	///< x and y of every point after projectionIteration iterations
+
+	PrecomputeCheckpoint();
+
+	bool isCompleted(Stage stage) const { return (completedStages & stage) != 0; }
+	void complete(Stage stage) { completedStages |= stage; }
+
+	/// Write to a temporary file renamed into place, so an interrupted save keeps the previous checkpoint
+	bool save(const std::string& fileName) const;
+	/// Read a checkpoint written by save, false if there is none or it is damaged
+	bool load(const std::string& fileName);
+};
+
+/// Saves a checkpoint at most once per interval
+class CheckpointSaver {
+public:
+	/*! @param fileName File of the checkpoint
+	 *	@param intervalSeconds Smallest time between two saves (0 - never save)
+	 *	@param checkpoint The state to save
+	 */
+	CheckpointSaver(const std::string& fileName, unsigned intervalSeconds, PrecomputeCheckpoint& checkpoint);
+
+	bool enabled() const { return interval > 0; }
+	/// Whether the interval since the last save has passed
+	bool due() const;
+	/// Save now (when enabled)
+	void save();
+	/// Remove the checkpoint file once the precompute is complete
+	void remove();
+
+	PrecomputeCheckpoint& checkpoint;
+	const std::string& fileName() const { return checkpointFileName; }
+
+private:
+	std::string checkpointFileName;
+	unsigned interval;
+	std::time_t lastSave;
+};
+
+} // namespace VCGL
+
+#endif // PRECOMPUTECHECKPOINT_H_
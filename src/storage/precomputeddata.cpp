@@ -10,10 +10,12 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <cstring>
+#include <cstdint>
 
 #include "projection/projectedpointinfo.h"
 
-void storeCorrelationsTriangle(const std::vector< std::vector<float> >& correlationMatrix, const std::string& corrFileNameOUT, bool binary) {
+void storeCorrelationsTriangle(const VCGL::SymmetricMatrix<float>& correlationMatrix, const std::string& corrFileNameOUT, bool binary) {
 	const size_t npoints = correlationMatrix.size();
 	std::ios_base::openmode mode = std::ofstream::trunc;
 	std::ofstream fout;
@@ -22,8 +24,9 @@ void storeCorrelationsTriangle(const std::vector< std::vector<float> >& correlat
 		fout << npoints << std::endl;
 
 		for (size_t x = 0; x<npoints; x++) {
+			const float* row = correlationMatrix.triangleRow(x);
 			for (size_t y = 0; y<x; y++) {
-				fout << correlationMatrix[x][y] << ' ';
+				fout << row[y] << ' ';
 			}
 			fout << std::endl;
 		}
@@ -31,51 +34,71 @@ void storeCorrelationsTriangle(const std::vector< std::vector<float> >& correlat
 	else {
 		fout.open(corrFileNameOUT, mode | std::ofstream::binary);
 		fout.write(reinterpret_cast<const char*>(&npoints), sizeof(size_t));
-
-		for (size_t x = 0; x<npoints; x++) {
-			fout.write(reinterpret_cast<const char*>(correlationMatrix[x].data()), x*sizeof(float));
-		}
+		// the packed triangle is exactly the file layout
+		fout.write(reinterpret_cast<const char*>(correlationMatrix.data()), correlationMatrix.packedSize()*sizeof(float));
 	}
 	fout.close();
 }
 
-void readCorrelationTriangle(const std::string& fileName, std::vector< std::vector<float> > & correlationMatrix, bool binary) {
+void readCorrelationTriangle(const std::string& fileName, VCGL::SymmetricMatrix<float>& correlationMatrix, bool binary) {
 		size_t npoints = 0;
 		std::ifstream fin;
 	if (!binary) {
 		fin.open(fileName);
 		fin >> npoints;
 
-		correlationMatrix.clear();
-		correlationMatrix.resize(npoints, std::vector<float>(npoints) );
+		correlationMatrix = VCGL::SymmetricMatrix<float>(npoints, 1.0f);
 
 		for (size_t x = 0; x<npoints; x++) {
+			float* row = correlationMatrix.triangleRow(x);
 			for (size_t y = 0; y<x; y++) {
-				fin >> correlationMatrix[x][y];
-				correlationMatrix[y][x] = correlationMatrix[x][y];
+				fin >> row[y];
 			}
-			correlationMatrix[x][x] = 1.0;
 		}
 	}
 	else {
 		fin.open(fileName, std::ofstream::binary);
-		fin.read(reinterpret_cast<char*>(&npoints), sizeof(size_t));
-
-		correlationMatrix.clear();
-		correlationMatrix.resize(npoints, std::vector<float>(npoints) );
+		VCGL::CorrelationFileHeader header;
+		fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+		std::string reason;
+		VCGL::CorrelationDataType dtype = VCGL::CORRELATION_FLOAT32;
+		if (fin && VCGL::correlationHeaderValid(header, &reason)) {
+			npoints = header.npoints;
+			dtype = static_cast<VCGL::CorrelationDataType>(header.dtype);
+			fin.seekg(header.headerSize);
+		}
+		else {
+			// legacy format: the point count, then the triangle
+			fin.clear();
+			fin.seekg(0);
+			fin.read(reinterpret_cast<char*>(&npoints), sizeof(size_t));
+		}
 
-		for (size_t x = 0; x<npoints; x++) {
-			fin.read(reinterpret_cast<char*>(correlationMatrix[x].data()), x*sizeof(float));
-			for (size_t y = 0; y<x; y++) {
-				correlationMatrix[y][x] = correlationMatrix[x][y];
-			}
-			correlationMatrix[x][x] = 1.0;
+		correlationMatrix = VCGL::SymmetricMatrix<float>(npoints, 1.0f);
+		if (dtype == VCGL::CORRELATION_FLOAT32) {
+			fin.read(reinterpret_cast<char*>(correlationMatrix.data()), correlationMatrix.packedSize()*sizeof(float));
+		}
+		else {
+			std::vector<unsigned char> encoded(correlationMatrix.packedSize()*VCGL::correlationValueSize(dtype));
+			fin.read(reinterpret_cast<char*>(encoded.data()), encoded.size());
+			VCGL::decodeCorrelations(dtype, encoded.data(), correlationMatrix.packedSize(), correlationMatrix.data());
 		}
 	}
 	fin.close();
 }
 
-void storeAutocorrelations(const std::vector<float>& autocorrelations, const std::string& autocorrFileNameOUT, bool binary) {
+bool storeCorrelationsVersioned(const VCGL::SymmetricMatrix<float>& correlationMatrix, size_t nlat, size_t nlon, const std::string& fileName,
+		const VCGL::GridSubsetRecord& subset, VCGL::CorrelationDataType dtype, VCGL::QuantizationError* pError) {
+	assert(correlationMatrix.size() == nlat*nlon);
+	VCGL::CorrelationTriangleWriter writer(fileName, nlat, nlon, subset, dtype);
+	writer.consumeRows(0, correlationMatrix.size(), correlationMatrix.data());
+	if (pError) {
+		*pError = writer.quantizationError();
+	}
+	return writer.close();
+}
+
+bool storeAutocorrelations(const std::vector<float>& autocorrelations, const std::string& autocorrFileNameOUT, bool binary) {
 	const size_t npoints = autocorrelations.size();
 	std::ios_base::openmode mode = std::ofstream::trunc;
 	std::ofstream fout;
@@ -92,6 +115,7 @@ void storeAutocorrelations(const std::vector<float>& autocorrelations, const std
 		fout.write(reinterpret_cast<const char*>(autocorrelations.data()), sizeof(float)*npoints);
 	}
 	fout.close();
+	return !fout.fail();
 }
 
 void readAutocorrelations(const std::string& fileName, std::vector<float>& autocorrelations, bool binary) {
@@ -121,6 +145,156 @@ void readAutocorrelations(const std::string& fileName, std::vector<float>& autoc
 	fin.close();
 }
 
+bool storeTeleconnectivity(const std::vector<float>& minima, const std::vector<int>& partners, const std::string& fileName) {
+	assert(minima.size() == partners.size());
+	const size_t npoints = minima.size();
+	std::ofstream fout(fileName, std::ofstream::trunc | std::ofstream::binary);
+	fout.write(reinterpret_cast<const char*>(&npoints), sizeof(size_t));
+	fout.write(reinterpret_cast<const char*>(minima.data()), sizeof(float)*npoints);
+	fout.write(reinterpret_cast<const char*>(partners.data()), sizeof(int)*npoints);
+	fout.close();
+	return !fout.fail();
+}
+
+void readTeleconnectivity(const std::string& fileName, std::vector<float>& minima, std::vector<int>& partners) {
+	size_t npoints = 0;
+	std::ifstream fin(fileName, std::ifstream::binary);
+	fin.read(reinterpret_cast<char*>(&npoints), sizeof(size_t));
+
+	minima.clear();
+	minima.resize(npoints);
+	partners.clear();
+	partners.resize(npoints);
+
+	fin.read(reinterpret_cast<char*>(minima.data()), sizeof(float)*npoints);
+	fin.read(reinterpret_cast<char*>(partners.data()), sizeof(int)*npoints);
+	fin.close();
+}
+
+bool storeLags(const std::vector<int16_t>& lags, size_t npoints, int maxLag, const std::string& fileName) {
+	assert(lags.size() == VCGL::triangleOffset(npoints));
+	const int32_t maxLag32 = maxLag;
+	std::ofstream fout(fileName, std::ofstream::binary | std::ofstream::trunc);
+	fout.write(reinterpret_cast<const char*>(&npoints), sizeof(size_t));
+	fout.write(reinterpret_cast<const char*>(&maxLag32), sizeof(maxLag32));
+	fout.write(reinterpret_cast<const char*>(lags.data()), lags.size()*sizeof(int16_t));
+	fout.close();
+	return !fout.fail();
+}
+
+bool readLags(const std::string& fileName, std::vector<int16_t>& lags, size_t* pnpoints, int* pMaxLag) {
+	std::ifstream fin(fileName, std::ifstream::binary);
+	size_t npoints = 0;
+	int32_t maxLag32 = 0;
+	fin.read(reinterpret_cast<char*>(&npoints), sizeof(size_t));
+	fin.read(reinterpret_cast<char*>(&maxLag32), sizeof(maxLag32));
+	if (!fin) {
+		return false;
+	}
+
+	// check the size before allocating anything
+	const std::streamoff dataStart = fin.tellg();
+	fin.seekg(0, std::ifstream::end);
+	const uint64_t dataSize = static_cast<uint64_t>(fin.tellg() - dataStart);
+	if (npoints > dataSize || dataSize != VCGL::triangleOffset(npoints)*sizeof(int16_t)) {
+		return false;
+	}
+	fin.seekg(dataStart);
+
+	lags.resize(VCGL::triangleOffset(npoints));
+	fin.read(reinterpret_cast<char*>(lags.data()), lags.size()*sizeof(int16_t));
+	if (!fin) {
+		return false;
+	}
+	*pnpoints = npoints;
+	*pMaxLag = maxLag32;
+	return true;
+}
+
+namespace {
+	/// Header of the correlation statistics file, followed by the point statistics,
+	/// the validity flags (padded to 8 bytes) and the packed triangle of pair sums
+	struct StatisticsFileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrder;
+		uint64_t npoints;
+		uint64_t nlat;
+		uint64_t nlon;
+		uint64_t samples;
+		uint64_t reserved[2];
+	};
+	static_assert(sizeof(StatisticsFileHeader) == 64, "header keeps the sums aligned");
+
+	const char STATISTICS_FILE_MAGIC[8] = { 'T', 'C', 'X', 'S', 'T', 'A', 'T', '\n' };
+	const uint32_t STATISTICS_FILE_VERSION = 1;
+
+	size_t paddedTo8(size_t bytes) {
+		return (bytes + 7) / 8 * 8;
+	}
+}
+
+bool storeCorrelationStatistics(const VCGL::CorrelationStatistics& statistics, const std::string& fileName) {
+	StatisticsFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, STATISTICS_FILE_MAGIC, sizeof(header.magic));
+	header.version = STATISTICS_FILE_VERSION;
+	header.byteOrder = VCGL::CORRELATION_BYTE_ORDER;
+	header.npoints = statistics.pointCount();
+	header.nlat = statistics.nlat();
+	header.nlon = statistics.nlon();
+	header.samples = statistics.sampleCount();
+
+	std::vector<uint8_t> validity(statistics.validity());
+	validity.resize(paddedTo8(validity.size()), 0);
+
+	std::ofstream fout(fileName, std::ofstream::binary | std::ofstream::trunc);
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(statistics.pointStatistics().data()),
+			statistics.pointCount()*sizeof(VCGL::PointStatistics));
+	fout.write(reinterpret_cast<const char*>(validity.data()), validity.size());
+	fout.write(reinterpret_cast<const char*>(statistics.pairSums().data()),
+			statistics.pairSums().packedSize()*sizeof(double));
+	fout.close();
+	return !fout.fail();
+}
+
+bool readCorrelationStatistics(const std::string& fileName, VCGL::CorrelationStatistics& statistics) {
+	std::ifstream fin(fileName, std::ifstream::binary);
+	StatisticsFileHeader header;
+	fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!fin || memcmp(header.magic, STATISTICS_FILE_MAGIC, sizeof(header.magic)) != 0
+			|| header.version != STATISTICS_FILE_VERSION
+			|| header.byteOrder != VCGL::CORRELATION_BYTE_ORDER
+			|| header.npoints != header.nlat*header.nlon) {
+		return false;
+	}
+
+	// check the size before allocating anything
+	fin.seekg(0, std::ifstream::end);
+	const uint64_t fileSize = fin.tellg();
+	const uint64_t npoints = header.npoints;
+	if (npoints > fileSize || fileSize != sizeof(header) + npoints*sizeof(VCGL::PointStatistics)
+			+ paddedTo8(npoints) + VCGL::triangleOffset(npoints)*sizeof(double)) {
+		return false;
+	}
+	fin.seekg(sizeof(header));
+
+	std::vector<VCGL::PointStatistics> points(npoints);
+	std::vector<uint8_t> validity(paddedTo8(npoints));
+	VCGL::SymmetricMatrix<double> pairSums(npoints, 0.0);
+	fin.read(reinterpret_cast<char*>(points.data()), npoints*sizeof(VCGL::PointStatistics));
+	fin.read(reinterpret_cast<char*>(validity.data()), validity.size());
+	fin.read(reinterpret_cast<char*>(pairSums.data()), pairSums.packedSize()*sizeof(double));
+	if (!fin) {
+		return false;
+	}
+	validity.resize(npoints);
+	statistics.assign(header.nlat, header.nlon, header.samples,
+			std::move(points), std::move(validity), std::move(pairSums));
+	return true;
+}
+
 void storeProjectionResults(const std::string& fileName, std::vector<VCGL::ProjectedPointInfo>& results, bool binary) {
 	const size_t numPoints = results.size();
 	std::ios_base::openmode mode = std::ofstream::trunc;
@@ -191,3 +365,139 @@ void loadProjectionLonLat(const std::string& fnProjection, int nlon, int nlat, s
 	}
 	fin.close();
 }
+
+bool readProjectionResults(const std::string& fnProjection, std::vector<VCGL::ProjectedPointInfo>& projection) {
+	projection.clear();
+	std::ifstream fin(fnProjection, std::ifstream::binary | std::ifstream::ate);
+	if (!fin) {
+		return false;
+	}
+	const std::streamoff fileSize = fin.tellg();
+	fin.seekg(0);
+	size_t numPoints = 0;
+	if (!fin.read(reinterpret_cast<char*>(&numPoints), sizeof(size_t))
+			|| static_cast<std::streamoff>(sizeof(size_t) + 2*sizeof(double)*numPoints) != fileSize) {
+		return false;
+	}
+
+	std::vector<double> data(2*numPoints);
+	if (!fin.read(reinterpret_cast<char*>(data.data()), sizeof(double)*data.size())) {
+		return false;
+	}
+	projection.resize(numPoints);
+	for (size_t j=0; j<numPoints; j++) {
+		projection[j].pt = LSP::TSPoint(data[2*j], data[2*j+1]);
+	}
+	return true;
+}
+
+namespace VCGL {
+
+CorrelationTriangleWriter::CorrelationTriangleWriter(const std::string& fileName, size_t nlat, size_t nlon,
+		const GridSubsetRecord& subset, CorrelationDataType dtype)
+: fout(fileName, std::fstream::out | std::fstream::trunc | std::fstream::binary), subset(subset), nextRow(0) {
+	initHeader(nlat, nlon, dtype);
+	// rewritten with the checksum on close, a file that was not completed stays invalid
+	CorrelationFileHeader placeholder = header;
+	placeholder.version = 0;
+	fout.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+	fout.write(reinterpret_cast<const char*>(&this->subset), sizeof(this->subset));
+}
+
+CorrelationTriangleWriter::CorrelationTriangleWriter(const std::string& fileName, size_t nlat, size_t nlon,
+		const GridSubsetRecord& subset, size_t resumeRows, CorrelationRowConsumer* pReplay, CorrelationDataType dtype)
+: fout(fileName, std::fstream::in | std::fstream::out | std::fstream::binary), subset(subset), nextRow(0) {
+	initHeader(nlat, nlon, dtype);
+	CorrelationFileHeader placeholder;
+	GridSubsetRecord written;
+	fout.read(reinterpret_cast<char*>(&placeholder), sizeof(placeholder));
+	fout.read(reinterpret_cast<char*>(&written), sizeof(written));
+	if (!fout || memcmp(placeholder.magic, header.magic, sizeof(header.magic)) != 0 || placeholder.version != 0
+			|| placeholder.npoints != header.npoints || placeholder.dtype != header.dtype
+			|| memcmp(&written, &subset, sizeof(written)) != 0 || resumeRows > header.npoints) {
+		fout.setstate(std::ios::failbit);
+		return;
+	}
+
+	// read back the rows in blocks of about 64 MB of floats
+	const size_t blockValues = size_t(1) << 24;
+	const size_t valueSize = correlationValueSize(dtype);
+	std::vector<float> block;
+	while (nextRow < resumeRows && fout) {
+		size_t rowEnd = nextRow + 1;
+		while (rowEnd < resumeRows && triangleOffset(rowEnd+1) - triangleOffset(nextRow) <= blockValues) {
+			rowEnd++;
+		}
+		block.resize(triangleOffset(rowEnd) - triangleOffset(nextRow));
+		if (dtype == CORRELATION_FLOAT32) {
+			if (!fout.read(reinterpret_cast<char*>(block.data()), block.size()*sizeof(float))) {
+				break;
+			}
+			checksum.add(block.data(), block.size());
+		}
+		else {
+			encoded.resize(block.size()*valueSize);
+			if (!fout.read(reinterpret_cast<char*>(encoded.data()), encoded.size())) {
+				break;
+			}
+			checksum.addBytes(encoded.data(), encoded.size());
+			decodeCorrelations(dtype, encoded.data(), block.size(), block.data());
+		}
+		if (pReplay) {
+			pReplay->consumeRows(nextRow, rowEnd, block.data());
+		}
+		nextRow = rowEnd;
+	}
+	if (nextRow != resumeRows) {
+		fout.setstate(std::ios::failbit);
+		return;
+	}
+	fout.seekp(sizeof(header) + sizeof(subset) + triangleOffset(resumeRows)*valueSize);
+}
+
+void CorrelationTriangleWriter::initHeader(size_t nlat, size_t nlon, CorrelationDataType dtype) {
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CORRELATION_FILE_MAGIC, sizeof(header.magic));
+	header.version = CORRELATION_FILE_VERSION;
+	header.dtype = dtype;
+	header.byteOrder = CORRELATION_BYTE_ORDER;
+	header.headerSize = sizeof(header) + sizeof(subset);
+	header.npoints = nlat*nlon;
+	header.nlat = nlat;
+	header.nlon = nlon;
+}
+
+void CorrelationTriangleWriter::consumeRows(size_t rowBegin, size_t rowEnd, const float* values) {
+	assert(rowBegin == nextRow && rowEnd <= header.npoints);
+	const size_t count = triangleOffset(rowEnd) - triangleOffset(rowBegin);
+	if (header.dtype == CORRELATION_FLOAT32) {
+		fout.write(reinterpret_cast<const char*>(values), count*sizeof(float));
+		checksum.add(values, count);
+	}
+	else {
+		const CorrelationDataType dtype = static_cast<CorrelationDataType>(header.dtype);
+		encoded.resize(count*correlationValueSize(dtype));
+		encodeCorrelations(dtype, values, count, encoded.data(), &error);
+		fout.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+		checksum.addBytes(encoded.data(), encoded.size());
+	}
+	nextRow = rowEnd;
+}
+
+bool CorrelationTriangleWriter::flush() {
+	fout.flush();
+	return good();
+}
+
+bool CorrelationTriangleWriter::close() {
+	const bool complete = (nextRow == header.npoints);
+	if (complete) {
+		header.checksum = checksum.value();
+		fout.seekp(0);
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+	fout.close();
+	return !fout.fail() && complete;
+}
+
+} // namespace VCGL
@@ -9,22 +9,123 @@
 
 #include <vector>
 #include <string>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
 
 #include "typedefs.h"
+#include "symmetricmatrix.h"
 #include "projection/projectedpointinfo.h"
+#include "process/precompute.h"
+#include "process/correlationstatistics.h"
+#include "storage/correlationstore.h"
+#include "storage/correlationencoding.h"
 
 namespace VCGL {
 	struct ProjectedPointInfo;
 	class DistanceMatrix;
+
+	/*! @brief Writes a correlation triangle file in the versioned format (see CorrelationFileHeader)
+	 * from blocks of rows as they are computed.
+	 */
+	class CorrelationTriangleWriter: public CorrelationRowConsumer {
+	public:
+		/*! @brief Create the file and reserve space for its header
+		 *
+		 * @param fileName Name of the triangle file
+		 * @param nlat Number of latitudes of the grid
+		 * @param nlon Number of longitudes of the grid (the file holds nlat*nlon rows)
+		 * @param subset Part of the data file the correlations are computed from
+		 * @param dtype Type the values are stored as (see encodeCorrelations)
+		 */
+		CorrelationTriangleWriter(const std::string& fileName, std::size_t nlat, std::size_t nlon,
+				const GridSubsetRecord& subset = GridSubsetRecord::whole(), CorrelationDataType dtype = CORRELATION_FLOAT32);
+
+		/*! @brief Continue a file which was not closed, e.g. after an interrupted precompute
+		 *
+		 * The first resumeRows rows are read back (to the checksum and to pReplay if given,
+		 * decoded) and anything after them is overwritten. The file must be of the type dtype.
+		 * Check good() for the success.
+		 */
+		CorrelationTriangleWriter(const std::string& fileName, std::size_t nlat, std::size_t nlon,
+				const GridSubsetRecord& subset, std::size_t resumeRows, CorrelationRowConsumer* pReplay = 0,
+				CorrelationDataType dtype = CORRELATION_FLOAT32);
+
+		/// Append rows [rowBegin, rowEnd); rowBegin must follow the previously written rows
+		virtual void consumeRows(std::size_t rowBegin, std::size_t rowEnd, const float* values) override;
+
+		/// Pass the written rows on to the file system, true if all of them were written successfully
+		bool flush();
+
+		/// Write the header with the checksum and close the file, true if all rows were written successfully
+		bool close();
+
+		/// Whether the file is open and all writes so far succeeded
+		bool good() const { return fout.is_open() && !fout.fail(); }
+		/// Number of rows written so far
+		std::size_t rowCount() const { return nextRow; }
+
+		/// Differences of the stored values to the given ones, of the rows written since the writer was created
+		const QuantizationError& quantizationError() const { return error; }
+
+	private:
+		void initHeader(std::size_t nlat, std::size_t nlon, CorrelationDataType dtype);
+
+		std::fstream fout;
+		CorrelationFileHeader header;
+		GridSubsetRecord subset;
+		CorrelationChecksum checksum;
+		std::size_t nextRow;
+		std::vector<unsigned char> encoded;
+		QuantizationError error;
+	};
 }
 
-void storeCorrelationsTriangle(const std::vector< std::vector<float> >& correlationMatrix, const std::string& corrFileNameOUT, bool binary = true);
-void readCorrelationTriangle(const std::string& fileName, std::vector< std::vector<float> > & correlationMatrix, bool binary = true);
+void storeCorrelationsTriangle(const VCGL::SymmetricMatrix<float>& correlationMatrix, const std::string& corrFileNameOUT, bool binary = true);
+void readCorrelationTriangle(const std::string& fileName, VCGL::SymmetricMatrix<float>& correlationMatrix, bool binary = true);
+/*! @brief Store the correlation matrix in the versioned format (see VCGL::openCorrelationStore for reading)
+ *
+ * @param dtype Type the values are stored as
+ * @param pError If given, receives the differences of the stored values to the matrix
+ */
+bool storeCorrelationsVersioned(const VCGL::SymmetricMatrix<float>& correlationMatrix, std::size_t nlat, std::size_t nlon, const std::string& fileName,
+		const VCGL::GridSubsetRecord& subset = VCGL::GridSubsetRecord::whole(),
+		VCGL::CorrelationDataType dtype = VCGL::CORRELATION_FLOAT32, VCGL::QuantizationError* pError = 0);
 
-void storeAutocorrelations(const std::vector<float>& autocorrelations, const std::string& autocorrFileNameOUT, bool binary=true);
+/// Store the autocorrelation of every point, false if the file could not be written
+bool storeAutocorrelations(const std::vector<float>& autocorrelations, const std::string& autocorrFileNameOUT, bool binary=true);
 void readAutocorrelations(const std::string& fileName, std::vector<float>& autocorrelations, bool binary=true);
 
+/*! @brief Store the teleconnectivity of every point
+ *
+ * @param minima Minimal (most negative) correlation of each point
+ * @param partners Index of the point with which the minimum is reached
+ * @return false if the file could not be written
+ */
+bool storeTeleconnectivity(const std::vector<float>& minima, const std::vector<int>& partners, const std::string& fileName);
+void readTeleconnectivity(const std::string& fileName, std::vector<float>& minima, std::vector<int>& partners);
+
+/*! @brief Store the lags of the lagged correlation minima (see VCGL::LaggedCorrelations)
+ *
+ * Format: the point count (size_t), the maximal lag (int32), then the packed triangle of int16 lags.
+ * The minima themselves go to a correlation file (storeCorrelationsVersioned).
+ * @return false if the file could not be written
+ */
+bool storeLags(const std::vector<int16_t>& lags, std::size_t npoints, int maxLag, const std::string& fileName);
+/// Read lags written by storeLags, false if the file is missing or not valid
+bool readLags(const std::string& fileName, std::vector<int16_t>& lags, std::size_t* pnpoints, int* pMaxLag);
+
+/*! @brief Store the sufficient statistics of the correlations (for the --update mode)
+ *
+ * @return false if the file could not be written
+ */
+bool storeCorrelationStatistics(const VCGL::CorrelationStatistics& statistics, const std::string& fileName);
+/// Read statistics written by storeCorrelationStatistics, false if the file is missing or not valid
+bool readCorrelationStatistics(const std::string& fileName, VCGL::CorrelationStatistics& statistics);
+
 void storeProjectionResults(const std::string& fileName, std::vector<VCGL::ProjectedPointInfo>& results, bool binary=true);
 void loadProjectionLonLat(const std::string& fnProjection, int nlon, int nlat, std::vector<VCGL::ProjectedPointInfo>& projection, bool binary=true);
+/// Read a binary projection of any number of points (no names), false if the file is missing or not complete
+bool readProjectionResults(const std::string& fnProjection, std::vector<VCGL::ProjectedPointInfo>& projection);
 
 #endif // PRECOMPUTEDDATA_H_
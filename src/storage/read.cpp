@@ -15,6 +15,8 @@
 #include <cassert>
 
 #include "typedefs.h"
+#include "precomputeddata.h"
+#include "correlationstore.h"
 
 #include <QPointF>
 
@@ -170,7 +172,7 @@ loadData(const char* dataFileNameIN, std::vector< std::vector< std::vector<float
 
 
 
-void readCorrelationWithLags(
+bool readCorrelationWithLags(
 		const char* corrFileName,
 		const char* lagsFileName,
 		int* pnlat,
@@ -178,31 +180,48 @@ void readCorrelationWithLags(
 		std::vector< std::vector<float> > & minCorrelations,
 		std::vector< std::vector<int> > & lags ) {
 
-	const int NPOINTS = NLAT * NLON;
-
-	*pnlat = NLAT;
-	*pnlon = NLON;
 	minCorrelations.clear();
-	minCorrelations.resize(NPOINTS, std::vector<float>(NPOINTS) );
 	lags.clear();
-	lags.resize(NPOINTS, std::vector<int>(NPOINTS, -1));
 
-	std::ifstream fin(corrFileName);
-	for (int x = 0; x<NPOINTS; x++) {
-	   for (int y = 0; y<NPOINTS; y++) {
-		   fin >> minCorrelations[x][y];
-	  }
+	// grid size from the header of the lagged correlation file (see computeLaggedCorrelations)
+	VCGL::CorrelationFileHeader header;
+	std::string reason("file cannot be read");
+	std::ifstream fin(corrFileName, std::ios::binary);
+	if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| !VCGL::correlationHeaderValid(header, &reason)) {
+		std::cerr << "Cannot read lagged correlations from " << corrFileName << ": " << reason << std::endl;
+		return false;
 	}
 	fin.close();
 
-	std::ifstream lfin(lagsFileName);
-		for (int x = 0; x<NPOINTS; x++) {
-		   for (int y = 0; y<NPOINTS; y++) {
-			   lfin >> lags[x][y];
-		  }
-		}
-	lfin.close();
+	std::vector<int16_t> packedLags;
+	size_t npoints = 0;
+	int maxLag = 0;
+	if (!readLags(lagsFileName, packedLags, &npoints, &maxLag) || npoints != header.npoints) {
+		std::cerr << "Lags in " << lagsFileName << " do not match " << corrFileName << std::endl;
+		return false;
+	}
+
+	VCGL::SymmetricMatrix<float> correlations;
+	readCorrelationTriangle(corrFileName, correlations);
+	if (correlations.size() != npoints) {
+		return false;
+	}
 
+	*pnlat = header.nlat;
+	*pnlon = header.nlon;
+	minCorrelations.resize(npoints, std::vector<float>(npoints));
+	lags.resize(npoints, std::vector<int>(npoints, 0));
+	for (size_t x = 0; x<npoints; x++) {
+		for (size_t y = 0; y<npoints; y++) {
+			minCorrelations[x][y] = correlations(x, y);
+		}
+		for (size_t y = 0; y<x; y++) {
+			lags[x][y] = packedLags[VCGL::triangleOffset(x) + y];
+			lags[y][x] = -lags[x][y];
+		}
+	}
+	return true;
 }
 
 void readContours(const char* contoursFileName, std::vector< std::vector<QPointF> >& contours) {
@@ -13,7 +13,14 @@ int fileStat(const char* dataFileName);
 
 int loadData(const char* dataFileNameIN, std::vector< std::vector< std::vector<float> > >& data, int* pnlon, int* pnlat);
 
-void readCorrelationWithLags(
+/*! @brief Read the lagged correlations and their lags into full matrices
+ *
+ * @param corrFileName Lagged correlation file (versioned correlation format)
+ * @param lagsFileName Lags file written by storeLags
+ * @param lags Receives lags[x][y]: positive if y follows x
+ * @return false if the files are missing or do not match
+ */
+bool readCorrelationWithLags(
 		const char* corrFileName,
 		const char* lagsFileName,
 		int* pnlat,
@@ -0,0 +1,178 @@
+/*!	@file sparsecorrelationstore.cpp
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Correlations reduced to the strongest partners of every point, in CSR form
+ */
+
+#include "sparsecorrelationstore.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+namespace VCGL {
+
+const char SPARSE_CORRELATION_FILE_MAGIC[8] = { 'T', 'C', 'X', 'S', 'P', 'R', 'S', '\n' };
+
+static_assert(sizeof(SparseCorrelationFileHeader) == 64, "header keeps the arrays aligned to a cache line");
+
+SparseCorrelationStore::SparseCorrelationStore(SparseCorrelationRows&& rows)
+: ownRows(std::move(rows)), npoints(ownRows.pointCount()),
+  pOffsets(ownRows.offsets.data()), pColumns(ownRows.columns.data()), pValues(ownRows.values.data()) {
+}
+
+SparseCorrelationStore::SparseCorrelationStore(MappedFile&& mappedFile, const SparseCorrelationFileHeader& header)
+: file(std::move(mappedFile)), npoints(header.npoints) {
+	const char* p = file.data() + header.headerSize;
+	pOffsets = reinterpret_cast<const std::uint64_t*>(p);
+	p += (npoints+1)*sizeof(std::uint64_t);
+	pColumns = reinterpret_cast<const std::uint32_t*>(p);
+	p += header.nnz*sizeof(std::uint32_t);
+	pValues = reinterpret_cast<const float*>(p);
+}
+
+float SparseCorrelationStore::value(std::size_t i, std::size_t j) const {
+	assert(i < npoints && j < npoints);
+	if (i == j) {
+		return 1.0f;
+	}
+	const std::uint32_t* begin = pColumns + pOffsets[i];
+	const std::uint32_t* end = pColumns + pOffsets[i+1];
+	const std::uint32_t* it = std::lower_bound(begin, end, static_cast<std::uint32_t>(j));
+	return (it != end && *it == j) ? pValues[it - pColumns] : 0.0f;
+}
+
+void SparseCorrelationStore::row(std::size_t i, float* out) const {
+	std::fill(out, out + npoints, 0.0f);
+	out[i] = 1.0f;
+	for (std::uint64_t k = pOffsets[i]; k<pOffsets[i+1]; k++) {
+		out[pColumns[k]] = pValues[k];
+	}
+}
+
+void SparseCorrelationStore::rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const {
+	float minCorr = 1.0f;
+	std::size_t minIndex = i;
+	for (std::uint64_t k = pOffsets[i]; k<pOffsets[i+1]; k++) {
+		if (pValues[k] < minCorr) {
+			minCorr = pValues[k];
+			minIndex = pColumns[k];
+		}
+	}
+	*pMin = minCorr;
+	*pIndex = minIndex;
+}
+
+bool storeSparseCorrelations(const SparseCorrelationRows& rows, std::size_t nlat, std::size_t nlon,
+		std::size_t lowestCount, std::size_t highestCount, const std::string& fileName,
+		const GridSubsetRecord& subset) {
+	assert(rows.pointCount() == nlat*nlon);
+	assert(rows.columns.size() == rows.values.size());
+	assert(lowestCount >= 1);
+
+	SparseCorrelationFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SPARSE_CORRELATION_FILE_MAGIC, sizeof(header.magic));
+	header.version = SPARSE_CORRELATION_FILE_VERSION;
+	header.dtype = CORRELATION_FLOAT32;
+	header.byteOrder = CORRELATION_BYTE_ORDER;
+	header.headerSize = sizeof(SparseCorrelationFileHeader) + sizeof(GridSubsetRecord);
+	header.npoints = rows.pointCount();
+	header.nlat = nlat;
+	header.nlon = nlon;
+	header.nnz = rows.values.size();
+	header.lowestCount = static_cast<std::uint32_t>(lowestCount);
+	header.highestCount = static_cast<std::uint32_t>(highestCount);
+
+	std::ofstream fout(fileName, std::ofstream::binary | std::ofstream::trunc);
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(&subset), sizeof(subset));
+	fout.write(reinterpret_cast<const char*>(rows.offsets.data()), rows.offsets.size()*sizeof(std::uint64_t));
+	fout.write(reinterpret_cast<const char*>(rows.columns.data()), rows.columns.size()*sizeof(std::uint32_t));
+	fout.write(reinterpret_cast<const char*>(rows.values.data()), rows.values.size()*sizeof(float));
+	fout.close();
+	return !fout.fail();
+}
+
+bool isSparseCorrelationFile(const MappedFile& file) {
+	return file.size() >= sizeof(SparseCorrelationFileHeader)
+			&& memcmp(file.data(), SPARSE_CORRELATION_FILE_MAGIC, sizeof(SPARSE_CORRELATION_FILE_MAGIC)) == 0;
+}
+
+namespace {
+	bool sparseHeaderValid(const SparseCorrelationFileHeader& header, std::size_t fileSize, std::string* pReason) {
+		if (header.byteOrder != CORRELATION_BYTE_ORDER) {
+			*pReason = "file was written on a machine with different byte order";
+			return false;
+		}
+		if (header.version < SPARSE_CORRELATION_FILE_MIN_VERSION || header.version > SPARSE_CORRELATION_FILE_VERSION) {
+			*pReason = "unsupported file version";
+			return false;
+		}
+		if (header.dtype != CORRELATION_FLOAT32) {
+			*pReason = "unsupported value type";
+			return false;
+		}
+		const std::size_t minHeaderSize = sizeof(SparseCorrelationFileHeader)
+				+ (header.version >= 2 ? sizeof(GridSubsetRecord) : 0);
+		if (header.headerSize < minHeaderSize || header.headerSize % sizeof(std::uint64_t) != 0) {
+			*pReason = "invalid header size";
+			return false;
+		}
+		if (header.npoints != header.nlat*header.nlon) {
+			*pReason = "point count does not match the grid";
+			return false;
+		}
+		if (header.lowestCount == 0) {
+			*pReason = "no lowest correlations kept";
+			return false;
+		}
+		if (header.npoints > fileSize || header.nnz > fileSize
+				|| fileSize != header.headerSize + (header.npoints+1)*sizeof(std::uint64_t)
+						+ header.nnz*(sizeof(std::uint32_t) + sizeof(float))) {
+			*pReason = "file size does not match the header";
+			return false;
+		}
+		return true;
+	}
+
+	bool sparseRowsValid(const SparseCorrelationFileHeader& header, const char* pData) {
+		const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(pData + header.headerSize);
+		const std::uint32_t* columns = reinterpret_cast<const std::uint32_t*>(offsets + header.npoints + 1);
+		if (offsets[0] != 0 || offsets[header.npoints] != header.nnz) {
+			return false;
+		}
+		for (std::uint64_t i = 0; i<header.npoints; i++) {
+			if (offsets[i+1] < offsets[i] || offsets[i+1] > header.nnz) {
+				return false;
+			}
+			// value() searches the columns of a row, so they must increase; no point is its own partner
+			for (std::uint64_t k = offsets[i]; k<offsets[i+1]; k++) {
+				if (columns[k] >= header.npoints || columns[k] == i || (k > offsets[i] && columns[k] <= columns[k-1])) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+std::unique_ptr<CorrelationStore> openSparseCorrelationStore(const std::string& fileName, MappedFile&& file) {
+	SparseCorrelationFileHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+
+	std::string reason;
+	if (!sparseHeaderValid(header, file.size(), &reason)) {
+		std::cerr << "Cannot use " << fileName << ": " << reason << std::endl;
+		return std::unique_ptr<CorrelationStore>();
+	}
+	if (!sparseRowsValid(header, file.data())) {
+		std::cerr << "Cannot use " << fileName << ": corrupted row index" << std::endl;
+		return std::unique_ptr<CorrelationStore>();
+	}
+	return std::unique_ptr<CorrelationStore>(new SparseCorrelationStore(std::move(file), header));
+}
+
+} // namespace VCGL
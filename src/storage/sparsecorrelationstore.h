@@ -0,0 +1,113 @@
+/*!	@file sparsecorrelationstore.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Correlations reduced to the strongest partners of every point, in CSR form
+ */
+
+#ifndef SPARSECORRELATIONSTORE_H_
+#define SPARSECORRELATIONSTORE_H_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "correlationstore.h"
+#include "mappedfile.h"
+
+namespace VCGL {
+
+/*! @brief Symmetric sparse correlation rows (compressed sparse rows)
+ *
+ * Row i holds the entries [offsets[i], offsets[i+1]) of columns and values,
+ * with increasing columns. A pair is present in both of its rows.
+ */
+struct SparseCorrelationRows {
+	std::vector<std::uint64_t> offsets;	///< pointCount()+1 entries
+	std::vector<std::uint32_t> columns;
+	std::vector<float> values;
+
+	std::size_t pointCount() const { return offsets.empty() ? 0 : offsets.size()-1; }
+};
+
+/*! @brief Header of the sparse correlation file
+ *
+ * The header is followed by the offsets (uint64, npoints+1), the columns (uint32, nnz)
+ * and the values (float32, nnz) of SparseCorrelationRows.
+ * All fields are in the byte order of the writing machine, see byteOrder.
+ */
+struct SparseCorrelationFileHeader {
+	char magic[8];			///< SPARSE_CORRELATION_FILE_MAGIC
+	std::uint32_t version;	///< SPARSE_CORRELATION_FILE_VERSION
+	std::uint32_t dtype;	///< value type (CorrelationDataType)
+	std::uint32_t byteOrder;	///< CORRELATION_BYTE_ORDER as written by the producer
+	std::uint32_t headerSize;	///< offset of the offsets array from the file start
+	std::uint64_t npoints;
+	std::uint64_t nlat;
+	std::uint64_t nlon;
+	std::uint64_t nnz;		///< number of stored entries (each pair counts twice)
+	std::uint32_t lowestCount;	///< number of lowest correlations kept per point, at least 1 (the teleconnectivity partner)
+	std::uint32_t highestCount;	///< number of highest correlations kept per point
+};
+
+extern const char SPARSE_CORRELATION_FILE_MAGIC[8];
+const std::uint32_t SPARSE_CORRELATION_FILE_VERSION = 2;	///< version written, with a GridSubsetRecord
+const std::uint32_t SPARSE_CORRELATION_FILE_MIN_VERSION = 1;	///< oldest version read (no GridSubsetRecord)
+
+/*! @brief Correlations of the strongest partners of every point
+ *
+ * Pairs that were not kept read as 0 (uncorrelated). The minimum of every row
+ * is kept, so rowMinimum and the teleconnectivity are the same as with the full matrix.
+ */
+class SparseCorrelationStore: public CorrelationStore {
+public:
+	/// Store owning the rows
+	explicit SparseCorrelationStore(SparseCorrelationRows&& rows);
+	/// Store reading the rows straight from the mapped file, the header must have been validated
+	SparseCorrelationStore(MappedFile&& file, const SparseCorrelationFileHeader& header);
+
+	virtual std::size_t pointCount() const override { return npoints; }
+	virtual float value(std::size_t i, std::size_t j) const override;
+	virtual void row(std::size_t i, float* out) const override;
+	virtual void rowMinimum(std::size_t i, float* pMin, std::size_t* pIndex) const override;
+
+	/// Number of stored entries
+	std::size_t entryCount() const { return npoints ? pOffsets[npoints] : 0; }
+
+	/// Whether the values are mapped from a file (as opposed to held in memory)
+	bool isMapped() const { return file.isMapped(); }
+
+private:
+	SparseCorrelationRows ownRows;
+	MappedFile file;
+	std::size_t npoints;
+	const std::uint64_t* pOffsets;
+	const std::uint32_t* pColumns;
+	const float* pValues;
+};
+
+/*! @brief Store sparse correlation rows in the sparse file format
+ *
+ * @param lowestCount, highestCount How many lowest/highest correlations per point were kept (informational);
+ *	lowestCount is at least 1, files without the minima of the rows are rejected when opened
+ * @param subset Part of the data file the correlations were computed from
+ * @return false if the file could not be written
+ */
+bool storeSparseCorrelations(const SparseCorrelationRows& rows, std::size_t nlat, std::size_t nlon,
+		std::size_t lowestCount, std::size_t highestCount, const std::string& fileName,
+		const GridSubsetRecord& subset = GridSubsetRecord::whole());
+
+/// Whether the mapped file starts with the sparse correlation file magic
+bool isSparseCorrelationFile(const MappedFile& file);
+
+/*! @brief Open a mapped sparse correlation file
+ *
+ * The columns of every row have to increase (see SparseCorrelationRows).
+ * @return The store, or null if the file is not valid (reason reported to stderr)
+ */
+std::unique_ptr<CorrelationStore> openSparseCorrelationStore(const std::string& fileName, MappedFile&& file);
+
+} // namespace VCGL
+
+#endif // SPARSECORRELATIONSTORE_H_
@@ -10,6 +10,8 @@
 
 #include <vector>
 #include "datastorage.h"
+#include "databandreader.h"
+#include "datasubset.h"
 
 namespace VCGL {
 
@@ -17,9 +19,11 @@ namespace VCGL {
 
 class TCStorage {
 public:
-	TCStorage(DataStorage* pDataStorage, bool bNorthHemisphereOnly = false) {
+	TCStorage(DataStorage* pDataStorage, bool bNorthHemisphereOnly = false,
+			const DataSubset& subset = DataSubset()) {
 		this->pDataStorage = pDataStorage;
 		this->bNorthHemisphere = bNorthHemisphereOnly;
+		this->subset = subset;
 	}
 	~TCStorage() {
 		if (pDataStorage != 0) {
@@ -35,50 +39,92 @@ public:
 		return result;
 	}
 
+	/// Number of longitudes of the data file, after which the used ones wrap around
+	size_t getNLon() {
+		return pDataStorage ? pDataStorage->getNLon() : 0;
+	}
+
+	/*! @brief Coordinates of the used grid points
+	 *
+	 * When the used longitudes cross the seam of the grid, the ones after
+	 * the seam are continued past 360 degrees, so that they keep increasing.
+	 */
 	void loadGrid(std::vector<float>& lons, std::vector<float>& lats) {
 		lons.clear();
 		lats.clear();
 
 		if (pDataStorage) {
-			lons = pDataStorage->loadLons();
+			const std::vector<float> fileLons = pDataStorage->loadLons();
+			const std::vector<float> fileLats = pDataStorage->loadLats();
+			GridSelection sel;
+			select(fileLons, fileLats, sel);
 
-			if (!bNorthHemisphere) {
-				lats = pDataStorage->loadLats();
+			for (std::size_t k = 0; k<sel.latCount; k++) {
+				lats.push_back(fileLats[sel.lat(k)]);
 			}
-			else {
-				for (auto lat: pDataStorage->loadLats()) {
-					if (lat >= 0.0) {
-						lats.push_back(lat);
-					}
+			for (std::size_t k = 0; k<sel.lonCount; k++) {
+				float lon = fileLons[sel.lon(k, fileLons.size())];
+				if (k > 0 && lon < lons.back()) {
+					lon += 360.0f;
 				}
+				lons.push_back(lon);
 			}
 		}
 	}
 
-	void loadData(vectorFloat3D& data) {
+	/// Indices of the used part of the data, false if it is too small to be used
+	bool selection(GridSelection& sel) {
+		if (!pDataStorage) {
+			sel = GridSelection();
+			return false;
+		}
+		return select(pDataStorage->loadLons(), pDataStorage->loadLats(), sel);
+	}
+
+	void loadData(TimeSeriesField& data) {
 		data.clear();
 		if (pDataStorage) {
-			std::size_t start = 0;
-			std::size_t count = pDataStorage->getNLat();
-
-			if (bNorthHemisphere) {
-				std::vector<float> lats = pDataStorage->loadLats();
-				start = 0;
-				while (start<lats.size() && lats[start] < 0) {
-					start++;
-				}
-				std::size_t end = start;
-				while (end<lats.size() && lats[end] >= 0) {
-					end++;
-				}
-				count = end-start;
-			}
-			data = pDataStorage->loadData(start, count);
+			GridSelection sel;
+			selection(sel);
+			data = pDataStorage->loadData(sel);
 		}
 	}
+
+	/// Load the time steps [timeStart, timeStart+timeCount) only (the time range of the subset is not applied)
+	void loadData(TimeSeriesField& data, std::size_t timeStart, std::size_t timeCount) {
+		data.clear();
+		if (pDataStorage) {
+			GridSelection sel;
+			selection(sel);
+			sel.timeStart = timeStart;
+			sel.timeCount = timeCount;
+			sel.timeStride = 1;
+			data = pDataStorage->loadData(sel);
+		}
+	}
+
+	/*! @brief Reader of the data in bands of latitudes, each fitting the memory budget
+	 *
+	 * @param memoryBudget Bytes for the time series of one band
+	 */
+	DataBandReader readBands(std::size_t memoryBudget) {
+		GridSelection sel;
+		selection(sel);
+		return DataBandReader(pDataStorage, sel,
+				DataBandReader::bandLatsForBudget(sel.lonCount, sel.timeCount, memoryBudget));
+	}
+
+	/// The used part of the data file
+	const DataSubset& dataSubset() const { return subset; }
+
 private:
+	bool select(const std::vector<float>& lons, const std::vector<float>& lats, GridSelection& sel) {
+		return subset.select(lons, lats, pDataStorage->getNTime(), bNorthHemisphere, sel);
+	}
+
 	DataStorage* pDataStorage;
 	bool bNorthHemisphere;
+	DataSubset subset;
 
 };
 
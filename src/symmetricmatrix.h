@@ -0,0 +1,190 @@
+/*!	@file symmetricmatrix.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Symmetric matrix stored as a packed strictly lower triangle
+ */
+
+#ifndef SYMMETRICMATRIX_H_
+#define SYMMETRICMATRIX_H_
+
+#include <cstddef>
+#include <vector>
+#include <iterator>
+#include <cassert>
+
+namespace VCGL {
+
+/// Number of entries in rows 0..row-1 of a packed strictly lower triangle (= offset of the row)
+inline std::size_t triangleOffset(std::size_t row) {
+	return (row % 2 == 0) ? (row/2)*(row-1) : row*((row-1)/2);
+}
+
+/*! @brief Read-only view of a symmetric n x n matrix given by its packed strictly lower triangle
+ *
+ * Row i of the triangle holds the i values (i,0)..(i,i-1) and starts at triangleOffset(i).
+ * All diagonal elements have the same value, which is not stored.
+ * The view does not own the values (they may be e.g. mapped from a file).
+ */
+template<typename T>
+class SymmetricMatrixView {
+public:
+	/// Iterator over a full row of the matrix (columns 0..n-1)
+	class RowIterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef T reference;
+
+		RowIterator(const T* values, std::size_t i, std::size_t j, T diagonal)
+		: values(values), i(i), j(j), p(0), diagonalValue(diagonal) {
+			p = (j > i) ? values + triangleOffset(j) + i : values + triangleOffset(i) + j;
+		}
+
+		T operator*() const { return (j == i) ? diagonalValue : *p; }
+
+		RowIterator& operator++() {
+			j++;
+			if (j < i) {
+				p++;
+			}
+			else if (j == i+1) {
+				p = values + triangleOffset(j) + i;
+			}
+			else if (j > i+1) {
+				p += j-1; // triangleOffset(j) - triangleOffset(j-1)
+			}
+			return *this;
+		}
+		RowIterator operator++(int) { RowIterator old(*this); ++(*this); return old; }
+
+		bool operator==(const RowIterator& other) const { return j == other.j; }
+		bool operator!=(const RowIterator& other) const { return j != other.j; }
+
+		/// Column of the current element
+		std::size_t column() const { return j; }
+
+	private:
+		const T* values;
+		std::size_t i;
+		std::size_t j;
+		const T* p;
+		T diagonalValue;
+	};
+
+	/// Full row i of the matrix, usable in range-based for loops
+	class RowView {
+	public:
+		RowView(const T* values, std::size_t n, std::size_t i, T diagonal)
+		: values(values), n(n), i(i), diagonalValue(diagonal) {}
+		RowIterator begin() const { return RowIterator(values, i, 0, diagonalValue); }
+		RowIterator end() const { return RowIterator(values, i, n, diagonalValue); }
+		std::size_t size() const { return n; }
+	private:
+		const T* values;
+		std::size_t n;
+		std::size_t i;
+		T diagonalValue;
+	};
+
+	SymmetricMatrixView(): values(0), n(0), diagonalValue() {}
+	SymmetricMatrixView(const T* packedValues, std::size_t n, T diagonal)
+	: values(packedValues), n(n), diagonalValue(diagonal) {}
+
+	/// Number of rows (and columns)
+	std::size_t size() const { return n; }
+	/// Value of all diagonal elements
+	T diagonal() const { return diagonalValue; }
+
+	T operator()(std::size_t i, std::size_t j) const {
+		assert(i < n && j < n);
+		if (i == j) {
+			return diagonalValue;
+		}
+		return (i > j) ? values[triangleOffset(i) + j] : values[triangleOffset(j) + i];
+	}
+
+	/// Stored part of row i: the i values of columns 0..i-1
+	const T* triangleRow(std::size_t i) const { return values + triangleOffset(i); }
+	/// Full row i
+	RowView row(std::size_t i) const { return RowView(values, n, i, diagonalValue); }
+
+	/// Packed triangle
+	const T* data() const { return values; }
+	/// Number of stored values
+	std::size_t packedSize() const { return triangleOffset(n); }
+
+private:
+	const T* values;
+	std::size_t n;
+	T diagonalValue;
+};
+
+/*! @brief Symmetric n x n matrix owning its packed strictly lower triangle
+ *
+ * Takes half the memory of a square matrix in one contiguous block;
+ * the diagonal is implicit (see SymmetricMatrixView).
+ */
+template<typename T>
+class SymmetricMatrix {
+public:
+	typedef typename SymmetricMatrixView<T>::RowView RowView;
+
+	/// Empty matrix with the given diagonal value
+	explicit SymmetricMatrix(T diagonal = T(1)): n(0), diagonalValue(diagonal) {}
+	/// Matrix of size n x n with all off-diagonal elements set to fill
+	SymmetricMatrix(std::size_t n, T diagonal, T fill = T())
+	: values(triangleOffset(n), fill), n(n), diagonalValue(diagonal) {}
+
+	/// Change the size, the existing rows are kept
+	void resize(std::size_t newSize, T fill = T()) {
+		values.resize(triangleOffset(newSize), fill);
+		n = newSize;
+	}
+
+	std::size_t size() const { return n; }
+	T diagonal() const { return diagonalValue; }
+
+	T operator()(std::size_t i, std::size_t j) const { return view()(i, j); }
+
+	/// Set the element (i,j) and (j,i); i and j must differ
+	void set(std::size_t i, std::size_t j, T value) {
+		assert(i != j && i < n && j < n);
+		if (i > j) {
+			values[triangleOffset(i) + j] = value;
+		}
+		else {
+			values[triangleOffset(j) + i] = value;
+		}
+	}
+
+	/// Stored part of row i: the i values of columns 0..i-1
+	T* triangleRow(std::size_t i) { return values.data() + triangleOffset(i); }
+	const T* triangleRow(std::size_t i) const { return values.data() + triangleOffset(i); }
+
+	/// Full row i; the matrix must not be resized while the row is in use
+	RowView row(std::size_t i) const { return view().row(i); }
+
+	/// Packed triangle
+	T* data() { return values.data(); }
+	const T* data() const { return values.data(); }
+	std::size_t packedSize() const { return values.size(); }
+
+	/// Non-owning view of this matrix
+	SymmetricMatrixView<T> view() const { return SymmetricMatrixView<T>(values.data(), n, diagonalValue); }
+
+	bool operator==(const SymmetricMatrix& other) const {
+		return n == other.n && diagonalValue == other.diagonalValue && values == other.values;
+	}
+	bool operator!=(const SymmetricMatrix& other) const { return !(*this == other); }
+
+private:
+	std::vector<T> values;
+	std::size_t n;
+	T diagonalValue;
+};
+
+} // namespace VCGL
+
+#endif // SYMMETRICMATRIX_H_
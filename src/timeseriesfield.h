@@ -0,0 +1,148 @@
+/*!	@file timeseriesfield.h
+ *	@author anantonov
+ *	@date	Oct 17, 2026 (created)
+ *	@brief	Time series of all grid points in one contiguous buffer
+ */
+
+#ifndef TIMESERIESFIELD_H_
+#define TIMESERIESFIELD_H_
+
+#include <cstddef>
+#include <algorithm>
+#include <cassert>
+
+#include "typedefs.h"
+#include "process/alignedbuffer.h"
+
+namespace VCGL {
+
+/// Contiguous run of values of one time series, usable in range-based for loops
+template<typename T>
+class SeriesSpan {
+public:
+	SeriesSpan(T* first, std::size_t count): first(first), count(count) {}
+	/// Read-only span from a writable one
+	template<typename U>
+	SeriesSpan(const SeriesSpan<U>& other): first(other.data()), count(other.size()) {}
+
+	T* begin() const { return first; }
+	T* end() const { return first + count; }
+	T* data() const { return first; }
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T& operator[](std::size_t t) const { assert(t < count); return first[t]; }
+
+private:
+	T* first;
+	std::size_t count;
+};
+
+/*! @brief Time series of a variable at all points of a latitude/longitude grid
+ *
+ * One aligned buffer in (point, time) layout, point id = iLat*nlon + iLon.
+ * Rows are padded with zeros to a multiple of ROW_ALIGNMENT values and start
+ * on a cache line boundary, so that vector kernels can run over whole rows.
+ * Missing values are NaN. The field can be moved but not copied (see clone).
+ */
+class TimeSeriesField {
+public:
+	static const std::size_t ROW_ALIGNMENT = 16; ///< row length granularity, in floats (one AVX-512 register)
+
+	TimeSeriesField(): latCount(0), lonCount(0), ntime(0), rowStride(0) {}
+
+	/// Field of the given size with all values 0
+	TimeSeriesField(std::size_t nlat, std::size_t nlon, std::size_t ntime)
+	: latCount(0), lonCount(0), ntime(0), rowStride(0) {
+		resize(nlat, nlon, ntime);
+	}
+
+	/// Copy of data with indices (LAT, LON, TIME)
+	explicit TimeSeriesField(const vectorFloat3D& nested)
+	: latCount(0), lonCount(0), ntime(0), rowStride(0) {
+		const std::size_t nlat = nested.size();
+		const std::size_t nlon = nlat ? nested[0].size() : 0;
+		resize(nlat, nlon, nlon ? nested[0][0].size() : 0);
+		for (std::size_t lat = 0; lat<nlat; lat++) {
+			for (std::size_t lon = 0; lon<nlon; lon++) {
+				assert(nested[lat][lon].size() == ntime);
+				std::copy(nested[lat][lon].begin(), nested[lat][lon].end(), series(lat, lon).begin());
+			}
+		}
+	}
+
+	TimeSeriesField(TimeSeriesField&& other) = default;
+	TimeSeriesField& operator=(TimeSeriesField&& other) = default;
+
+	/// Reallocate for the given size, all values 0
+	void resize(std::size_t nlat, std::size_t nlon, std::size_t timeCount) {
+		latCount = nlat;
+		lonCount = nlon;
+		ntime = timeCount;
+		rowStride = (ntime + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+		values.resize(latCount*lonCount*rowStride);
+	}
+
+	/// Release the buffer
+	void clear() { resize(0, 0, 0); }
+
+	/// Deep copy
+	TimeSeriesField clone() const {
+		TimeSeriesField result(latCount, lonCount, ntime);
+		std::copy(values.data(), values.data() + values.size(), result.values.data());
+		return result;
+	}
+
+	std::size_t nlat() const { return latCount; }
+	std::size_t nlon() const { return lonCount; }
+	/// Number of grid points (rows)
+	std::size_t pointCount() const { return latCount*lonCount; }
+	/// Number of time steps in each series
+	std::size_t timeCount() const { return ntime; }
+	/// Distance between consecutive rows, in floats (multiple of ROW_ALIGNMENT)
+	std::size_t stride() const { return rowStride; }
+	bool empty() const { return pointCount() == 0 || ntime == 0; }
+
+	/// Time series of the point with id = iLat*nlon + iLon
+	SeriesSpan<float> series(std::size_t pt) {
+		assert(pt < pointCount());
+		return SeriesSpan<float>(values.data() + pt*rowStride, ntime);
+	}
+	SeriesSpan<const float> series(std::size_t pt) const {
+		assert(pt < pointCount());
+		return SeriesSpan<const float>(values.data() + pt*rowStride, ntime);
+	}
+	SeriesSpan<float> series(std::size_t lat, std::size_t lon) { return series(lat*lonCount + lon); }
+	SeriesSpan<const float> series(std::size_t lat, std::size_t lon) const { return series(lat*lonCount + lon); }
+
+	float& operator()(std::size_t lat, std::size_t lon, std::size_t t) { return series(lat, lon)[t]; }
+	float operator()(std::size_t lat, std::size_t lon, std::size_t t) const { return series(lat, lon)[t]; }
+
+	/// All rows, including the padding
+	float* data() { return values.data(); }
+	const float* data() const { return values.data(); }
+
+	/// Same size and values (NaN never equals)
+	bool operator==(const TimeSeriesField& other) const {
+		if (latCount != other.latCount || lonCount != other.lonCount || ntime != other.ntime) {
+			return false;
+		}
+		for (std::size_t pt = 0; pt<pointCount(); pt++) {
+			if (!std::equal(series(pt).begin(), series(pt).end(), other.series(pt).begin())) {
+				return false;
+			}
+		}
+		return true;
+	}
+	bool operator!=(const TimeSeriesField& other) const { return !(*this == other); }
+
+private:
+	std::size_t latCount;
+	std::size_t lonCount;
+	std::size_t ntime;
+	std::size_t rowStride;
+	AlignedBuffer<float> values;
+};
+
+} // namespace VCGL
+
+#endif // TIMESERIESFIELD_H_
@@ -11,9 +11,16 @@
 #include <CppUnitLite/SimpleString.h>
 #include <QPoint>
 
+#include "symmetricmatrix.h"
+#include "timeseriesfield.h"
+#include "projection/distancematrix.h"
+#include "projection/sammon.h"
+
 #include <vector>
 #include <sstream>
 #include <string>
+#include <cmath>
+#include <memory>
 
 SimpleString StringFrom (const QPoint& value);
 
@@ -89,4 +96,154 @@ SimpleString StringFrom(const std::vector< std::vector<std::vector<T> > >& vec)
 	return StringFrom(oss.str().c_str());
 }
 
+/// output of symmetric matrix (all rows in full)
+template<typename T>
+SimpleString StringFrom(const VCGL::SymmetricMatrix<T>& matrix) {
+	std::ostringstream oss;
+	oss << '[' << std::endl;
+	for (size_t i=0; i<matrix.size(); i++) {
+		oss << '[';
+		for (size_t j=0; j<matrix.size(); j++) {
+			oss << matrix(i, j);
+			if (j<matrix.size()-1) {
+				oss << ", ";
+			}
+		}
+		oss << ']' << std::endl;
+	}
+	oss << ']';
+	return StringFrom(oss.str().c_str());
+}
+
+/// output of a time series field (one line per latitude, series separated by ';')
+inline SimpleString StringFrom(const VCGL::TimeSeriesField& field) {
+	std::ostringstream oss;
+	oss << '[' << std::endl;
+	for (size_t lat=0; lat<field.nlat(); lat++) {
+		oss << '[';
+		for (size_t lon=0; lon<field.nlon(); lon++) {
+			oss << '[';
+			for (size_t t=0; t<field.timeCount(); t++) {
+				oss << field(lat, lon, t);
+				if (t<field.timeCount()-1) {
+					oss << ", ";
+				}
+			}
+			oss << ']';
+			if (lon<field.nlon()-1) {
+				oss << "; ";
+			}
+		}
+		oss << ']' << std::endl;
+	}
+	oss << ']';
+	return StringFrom(oss.str().c_str());
+}
+
+/// symmetric matrix with the lower triangle and the diagonal of the given square matrix
+template<typename T>
+VCGL::SymmetricMatrix<T> symmetricFromSquare(const std::vector< std::vector<T> >& square) {
+	VCGL::SymmetricMatrix<T> result(square.size(), square.empty() ? T(1) : square[0][0]);
+	for (size_t i=0; i<square.size(); i++) {
+		for (size_t j=0; j<i; j++) {
+			result.set(i, j, square[i][j]);
+		}
+	}
+	return result;
+}
+
+/// Correlations of six points (a 2 x 3 grid) as a square matrix: positive, negative and zero ones, one tie (-0.6)
+inline std::vector< std::vector<float> > sixPointCorrelations() {
+	return { {1.0, 0.3, 0.7, 0.1, -0.4, 0.2},
+			 {0.3, 1.0, 0.6, -0.2, 0.0, -0.6},
+			 {0.7, 0.6, 1.0, -0.5, 0.3, -0.6},
+			 {0.1, -0.2, -0.5, 1.0, 0.9, 0.4},
+			 {-0.4, 0.0, 0.3, 0.9, 1.0, -0.1},
+			 {0.2, -0.6, -0.6, 0.4, -0.1, 1.0} };
+}
+
+/*! @brief Deterministic time series: a common wave of alternating sign at neighbouring points, plus noise
+ *
+ * data(lat, lon, t) = offset + sign*(lon+1)*sin(frequency*(t - lag*(lat+lon))) + noise, the sign
+ * alternating with lat+lon and the noise in [-0.5, 0.5) from a linear congruential generator started
+ * at seed. Neighbouring points are thus anti-correlated, and with lag each point follows its
+ * neighbours before it by lag time steps.
+ */
+inline VCGL::TimeSeriesField makeWaveData(int nlat, int nlon, int ntime,
+		unsigned seed, float offset, double frequency, int lag = 0) {
+	unsigned state = seed;
+	VCGL::TimeSeriesField data(nlat, nlon, ntime);
+	for (int t=0; t<ntime; t++) {
+		for (int lat=0; lat<nlat; lat++) {
+			for (int lon=0; lon<nlon; lon++) {
+				state = state*1103515245u + 12345u;
+				const float noise = ((state >> 8) % 1000) / 1000.0f - 0.5f;
+				const float sign = ((lat+lon) % 2) ? -1.0f : 1.0f;
+				const float wave = std::sin(frequency*(t - lag*(lat+lon)));
+				data(lat, lon, t) = offset + sign*wave*(lon+1) + noise;
+			}
+		}
+	}
+	return data;
+}
+
+/// Keeps the projection after one of the iterations of Sammon's mapping
+struct IterationRecorder: public LSP::SammonObserver {
+	int iteration;
+	int calls;
+	QVector<LSP::TSPoint> points;
+
+	explicit IterationRecorder(int iteration): iteration(iteration), calls(0) {}
+
+	virtual void iterationDone(int iterations, const QVector<LSP::TSPoint>& current) override {
+		calls++;
+		if (iterations == iteration) {
+			points = current;
+		}
+	}
+};
+
+/// Correlation distances of a nx x ny grid, with waves of positive and negative correlations
+inline std::unique_ptr<VCGL::DistanceMatrix> waveDistances(int nx, int ny, double xFrequency = 0.3) {
+	VCGL::DistanceMatrix* pdmat = 0;
+	VCGL::DistanceMatrix::forGrid(nx, ny, "grid", &pdmat);
+	for (int i = 0; i < nx*ny; i++) {
+		for (int j = 0; j < i; j++) {
+			const double correlation = std::cos(xFrequency*(i%nx - j%nx)) * std::cos(0.2*(i/nx - j/nx));
+			pdmat->setDistanceByIndices(i, j, VCGL::DistanceMatrix::distanceFromCorrelation(correlation));
+		}
+	}
+	return std::unique_ptr<VCGL::DistanceMatrix>(pdmat);
+}
+
+/*! @brief Correlations of a nlat x nlon grid: cosine of the distance of the points in grid steps
+ *
+ * @param frequency Radians per grid step; above pi/(largest distance) the far points are anticorrelated
+ * @param drift Added per row, so that rows of equal distances differ
+ */
+inline VCGL::SymmetricMatrix<float> gridCorrelations(size_t nlat, size_t nlon, double frequency, double drift = 0.0) {
+	VCGL::SymmetricMatrix<float> matrix(nlat*nlon, 1.0f);
+	for (size_t x = 0; x<matrix.size(); x++) {
+		for (size_t y = 0; y<x; y++) {
+			const double dLat = double(x / nlon) - double(y / nlon);
+			const double dLon = double(x % nlon) - double(y % nlon);
+			matrix.data()[VCGL::triangleOffset(x) + y] = static_cast<float>(std::cos(frequency*std::sqrt(dLat*dLat + dLon*dLon) + drift*x));
+		}
+	}
+	return matrix;
+}
+
+/// Whether two projections have exactly the same points
+inline bool samePoints(const QVector<LSP::TSPoint>& a, const QVector<LSP::TSPoint>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (int i = 0; i < a.size(); i++) {
+		if (a[i].getX() != b[i].getX() || a[i].getY() != b[i].getY()) {
+			return false;
+		}
+	}
+	return true;
+}
+
 #endif /* CPPUNITEXTRAS_H_ */
@@ -0,0 +1,362 @@
+/*! @file explorationmodelimpltest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for ExplorationModelImpl filled stage by stage, and by ExplorationLoader from files
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "exploration/explorationmodelimpl.h"
+#include "exploration/explorationloader.h"
+#include "storage/correlationstore.h"
+#include "storage/precomputeddata.h"
+
+#include <QCoreApplication>
+
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace Testing {
+
+namespace {
+
+const unsigned NLAT = 4;
+const unsigned NLON = 5;
+
+/// Model with a grid of NLAT x NLON points and nothing else loaded
+class GridModel: public VCGL::ExplorationModelImpl {
+public:
+	GridModel() {
+		for (unsigned i=0; i<NLAT; i++) {
+			grid.lats.push_back(60.0f - 10.0f*i);
+		}
+		for (unsigned j=0; j<NLON; j++) {
+			grid.lons.push_back(10.0f*j);
+		}
+		_ntime = 200;
+	}
+};
+
+/// Correlations between the points, strongly negative between the far ones
+VCGL::SymmetricMatrix<float> waveMatrix() {
+	return gridCorrelations(NLAT, NLON, 0.9);
+}
+
+std::unique_ptr<VCGL::CorrelationStore> waveStore() {
+	return std::unique_ptr<VCGL::CorrelationStore>(new VCGL::CorrelationTriangleStore(waveMatrix()));
+}
+
+/// Store answering through another one value by value, so that the teleconnectivity is searched row by row
+class ValueStore: public VCGL::CorrelationStore {
+public:
+	explicit ValueStore(const VCGL::CorrelationStore& store): store(store) {}
+	virtual std::size_t pointCount() const override { return store.pointCount(); }
+	virtual float value(std::size_t i, std::size_t j) const override { return store.value(i, j); }
+private:
+	const VCGL::CorrelationStore& store;
+};
+
+/// Whether the teleconnectivity derived from the store is that found row by row
+bool sameTeleconnectivityByRows(const VCGL::CorrelationStore& store) {
+	VCGL::ExplorationModelImpl::TeleconnectivityMaps maps;
+	VCGL::ExplorationModelImpl::TeleconnectivityMaps byRows;
+	return VCGL::ExplorationModelImpl::computeTeleconnectivity(store, NLAT, NLON, maps)
+			&& VCGL::ExplorationModelImpl::computeTeleconnectivity(ValueStore(store), NLAT, NLON, byRows)
+			&& maps.tc == byRows.tc && maps.tcindices == byRows.tcindices;
+}
+
+std::vector<float> autocorrelations() {
+	return std::vector<float>(NLAT*NLON, 0.2f);
+}
+
+VCGL::ExplorationModelImpl::TeleconnectivityMaps teleconnectivity() {
+	VCGL::ExplorationModelImpl::TeleconnectivityMaps maps;
+	VCGL::ExplorationModelImpl::computeTeleconnectivity(*waveStore(), NLAT, NLON, maps);
+	return maps;
+}
+
+/// Everything the views show of the model
+struct Shown {
+	std::vector< std::vector<float> > correlationColors;
+	std::vector< std::vector<float> > teleconnectivityColors;
+	std::vector< std::vector<bool> > significance;
+	std::vector<VCGL::AnnotationLinkF> chain;
+	std::vector<VCGL::LinkF> links;
+	QPointF reference;
+
+	explicit Shown(const VCGL::ExplorationModel& model) {
+		model.getCorrelationMapColors(correlationColors);
+		model.getTeleconnectivityMapColors(teleconnectivityColors);
+		model.getStatisticalSignificanceMask(significance);
+		model.getCorrelationMapChainLinks(chain);
+		model.getTeleconnectivityLinks(links);
+		reference = model.getReferencePoint();
+	}
+
+	bool operator==(const Shown& other) const {
+		if (chain.size() != other.chain.size() || links.size() != other.links.size()) {
+			return false;
+		}
+		for (unsigned j=0; j<links.size(); j++) {
+			if (links[j].ptA != other.links[j].ptA || links[j].ptB != other.links[j].ptB || links[j].w != other.links[j].w) {
+				return false;
+			}
+		}
+		return correlationColors == other.correlationColors && teleconnectivityColors == other.teleconnectivityColors
+				&& significance == other.significance && reference == other.reference;
+	}
+};
+
+/*! @brief Store the files of the wave correlations, named after prefix
+ *
+ * With bTeleconnectivity, a teleconnectivity file of half the actual teleconnectivity is stored
+ * as well, so that it can be told from the teleconnectivity derived from the correlations.
+ */
+VCGL::ExplorationFiles storeWaveFiles(const std::string& prefix, bool bTeleconnectivity) {
+	VCGL::ExplorationFiles files;
+	files.correlations = prefix + "-corr.bin";
+	files.autocorrelations = prefix + "-autocorr.bin";
+	storeCorrelationsVersioned(waveMatrix(), NLAT, NLON, files.correlations);
+	storeAutocorrelations(autocorrelations(), files.autocorrelations);
+	if (bTeleconnectivity) {
+		files.teleconnectivity = prefix + "-teleconn.bin";
+		const VCGL::ExplorationModelImpl::TeleconnectivityMaps maps = teleconnectivity();
+		std::vector<float> minima;
+		std::vector<int> partners;
+		for (unsigned i=0; i<NLAT*NLON; i++) {
+			minima.push_back(-0.5f*maps.tc[i / NLON][i % NLON]);
+			const QPoint partner = maps.tcindices[i / NLON][i % NLON];
+			partners.push_back(partner.y()*NLON + partner.x());
+		}
+		storeTeleconnectivity(minima, partners, files.teleconnectivity);
+	}
+	return files;
+}
+
+/// The application whose event loop hands the stages of the loader to the model, created once
+void ensureApplication() {
+	static int argc = 1;
+	static char name[] = "telcon-tests";
+	static char* argv[] = { name, 0 };
+	if (!QCoreApplication::instance()) {
+		static QCoreApplication application(argc, argv);
+	}
+}
+
+/*! @brief Load the files into the model with ExplorationLoader, running the event loop until it is complete
+ *
+ * @return false if the loader was not complete after a minute
+ */
+bool loadWithLoader(VCGL::ExplorationModelImpl& model, const VCGL::ExplorationFiles& files) {
+	ensureApplication();
+	VCGL::ExplorationLoader loader(&model, files);
+	loader.start();
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+	while (!loader.isComplete()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			return false;
+		}
+		QCoreApplication::processEvents();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return loader.pendingStages().isEmpty();
+}
+
+/// What a model filled directly with the wave correlations, the autocorrelations and the given teleconnectivity shows
+Shown shownWhenAdopted(const VCGL::ExplorationModelImpl::TeleconnectivityMaps& maps) {
+	GridModel model;
+	model.computeStatisticalSignificanceMask(0.99f);
+	model.setThreshold(0.5f);
+	model.adoptCorrelations(waveStore());
+	model.adoptTeleconnectivity(VCGL::ExplorationModelImpl::TeleconnectivityMaps(maps));
+	model.adoptAutocorrelations(autocorrelations());
+	return Shown(model);
+}
+
+/// Whether the model shows the wave correlations
+bool hasWaveCorrelations(const VCGL::ExplorationModelImpl& model) {
+	const VCGL::SymmetricMatrix<float> matrix = waveMatrix();
+	for (unsigned i=0; i<NLAT*NLON; i++) {
+		for (unsigned j=0; j<i; j++) {
+			if (model.getCorrelationValue(QPoint(i % NLON, i / NLON), QPoint(j % NLON, j / NLON)) != matrix(i, j)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// Whether the model shows the teleconnectivity of the maps at every point
+bool hasTeleconnectivity(const VCGL::ExplorationModelImpl& model, const VCGL::ExplorationModelImpl::TeleconnectivityMaps& maps) {
+	for (unsigned lat=0; lat<NLAT; lat++) {
+		for (unsigned lon=0; lon<NLON; lon++) {
+			float value = 0.0f;
+			if (!model.getClosestPointTeleconnectivityValue(QPointF(10.0f*lon, 60.0f - 10.0f*lat), &value)
+					|| value != maps.tc[lat][lon]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+TEST(EmptyUntilLoaded, ExplorationModelImpl)
+{
+	GridModel model;
+	model.computeStatisticalSignificanceMask(0.99f);
+	model.setThreshold(0.5f);
+	model.selectReferencePoint(QPointF(20.0f, 40.0f));
+	model.selectRegionAtPoint(QPointF(20.0f, 40.0f), true);
+
+	const Shown shown(model);
+	CHECK(shown.correlationColors.empty());
+	CHECK(shown.teleconnectivityColors.empty());
+	CHECK(shown.significance.empty());
+	CHECK(shown.chain.empty());
+	CHECK(shown.links.empty());
+
+	float value = 0.0f;
+	CHECK(!model.getClosestPointCorrelationValue(QPointF(0.0f, 60.0f), &value));
+	CHECK(!model.getClosestPointTeleconnectivityValue(QPointF(0.0f, 60.0f), &value));
+	std::vector<QPointF> chainProjection;
+	model.getCorrelationChainProjection(chainProjection);
+	CHECK(chainProjection.empty());
+	CHECK(model.getReferencePointProjection() == QPointF(0.0f, 0.0f));
+
+	// the correlations alone show the correlation map
+	model.adoptCorrelations(waveStore());
+	std::vector< std::vector<float> > colors;
+	model.getCorrelationMapColors(colors);
+	LONGS_EQUAL(NLAT, colors.size());
+	CHECK(model.getClosestPointCorrelationValue(QPointF(0.0f, 60.0f), &value));
+}
+
+TEST(SameInAnyOrder, ExplorationModelImpl)
+{
+	// as loaded one after another; the chain follows the threshold set when the reference point is chosen
+	GridModel loaded;
+	loaded.computeStatisticalSignificanceMask(0.99f);
+	loaded.setThreshold(0.5f);
+	loaded.adoptCorrelations(waveStore());
+	loaded.adoptTeleconnectivity(teleconnectivity());
+	loaded.adoptAutocorrelations(autocorrelations());
+	const Shown expected(loaded);
+	CHECK(!expected.significance.empty());
+	CHECK(!expected.chain.empty());
+
+	// the stages arriving in other orders
+	GridModel teleconnectivityFirst;
+	teleconnectivityFirst.computeStatisticalSignificanceMask(0.99f);
+	teleconnectivityFirst.setThreshold(0.5f);
+	teleconnectivityFirst.adoptTeleconnectivity(teleconnectivity());
+	teleconnectivityFirst.adoptAutocorrelations(autocorrelations());
+	teleconnectivityFirst.adoptCorrelations(waveStore());
+	CHECK(Shown(teleconnectivityFirst) == expected);
+
+	GridModel autocorrelationsFirst;
+	autocorrelationsFirst.computeStatisticalSignificanceMask(0.99f);
+	autocorrelationsFirst.setThreshold(0.5f);
+	autocorrelationsFirst.adoptAutocorrelations(autocorrelations());
+	autocorrelationsFirst.adoptCorrelations(waveStore());
+	autocorrelationsFirst.adoptTeleconnectivity(teleconnectivity());
+	CHECK(Shown(autocorrelationsFirst) == expected);
+}
+
+TEST(ChosenPointKeptWhenTeleconnectivityArrives, ExplorationModelImpl)
+{
+	// without a choice, the point with the highest teleconnectivity
+	GridModel highest;
+	highest.adoptCorrelations(waveStore());
+	highest.adoptTeleconnectivity(teleconnectivity());
+
+	// a point chosen before the teleconnectivity arrived stays
+	GridModel chosen;
+	chosen.adoptCorrelations(waveStore());
+	const QPointF chosenPoint = highest.getReferencePoint() == QPointF(0.0f, 60.0f)
+			? QPointF(10.0f, 50.0f) : QPointF(0.0f, 60.0f);
+	chosen.selectReferencePoint(chosenPoint);
+	chosen.adoptTeleconnectivity(teleconnectivity());
+	CHECK(chosen.getReferencePoint() == chosenPoint);
+}
+
+TEST(ComputeTeleconnectivityCancels, ExplorationModelImpl)
+{
+	VCGL::ExplorationModelImpl::TeleconnectivityMaps maps;
+	std::atomic<bool> bCancelled(true);
+	CHECK(!VCGL::ExplorationModelImpl::computeTeleconnectivity(*waveStore(), NLAT, NLON, maps, &bCancelled));
+
+	bCancelled = false;
+	CHECK(VCGL::ExplorationModelImpl::computeTeleconnectivity(*waveStore(), NLAT, NLON, maps, &bCancelled));
+	LONGS_EQUAL(NLAT, maps.tc.size());
+	LONGS_EQUAL(NLON, maps.tcindices[0].size());
+	// the partner of every point is the one with the most negative correlation
+	const VCGL::SymmetricMatrix<float> matrix = waveMatrix();
+	for (unsigned i=0; i<NLAT*NLON; i++) {
+		const QPoint partner = maps.tcindices[i / NLON][i % NLON];
+		DOUBLES_EQUAL(-matrix(i, partner.y()*NLON + partner.x()), maps.tc[i / NLON][i % NLON], 1e-6);
+	}
+}
+
+TEST(TeleconnectivityInOnePass, ExplorationModelImpl)
+{
+	// the packed triangles are read once along the file, with the same minima and partners
+	CHECK(sameTeleconnectivityByRows(*waveStore()));
+	CHECK(sameTeleconnectivityByRows(VCGL::QuantizedTriangleStore(waveMatrix().view(), VCGL::CORRELATION_INT8)));
+	CHECK(sameTeleconnectivityByRows(VCGL::QuantizedTriangleStore(waveMatrix().view(), VCGL::CORRELATION_FLOAT16)));
+}
+
+TEST(MissingCorrelationsLeaveMapsEmpty, ExplorationModelImpl)
+{
+	GridModel model;
+	model.loadCorrelations("no-such-correlations.bin");
+	const Shown shown(model);
+	CHECK(shown.correlationColors.empty());
+	CHECK(shown.teleconnectivityColors.empty());
+}
+
+TEST(LoaderDerivesTeleconnectivity, ExplorationModelImpl)
+{
+	const VCGL::ExplorationFiles files = storeWaveFiles("test-loader-derived", false);
+	GridModel model;
+	model.computeStatisticalSignificanceMask(0.99f);
+	model.setThreshold(0.5f);
+	CHECK(loadWithLoader(model, files));
+
+	// the teleconnectivity is derived from the correlations after they are handed over
+	CHECK(hasWaveCorrelations(model));
+	CHECK(hasTeleconnectivity(model, teleconnectivity()));
+	// the autocorrelations, without which there is no significance
+	const Shown shown(model);
+	CHECK(!shown.significance.empty());
+	CHECK(shown == shownWhenAdopted(teleconnectivity()));
+}
+
+TEST(LoaderReadsTeleconnectivity, ExplorationModelImpl)
+{
+	const VCGL::ExplorationFiles files = storeWaveFiles("test-loader-read", true);
+	VCGL::ExplorationModelImpl::TeleconnectivityMaps maps;
+	CHECK(VCGL::ExplorationModelImpl::readTeleconnectivity(files.teleconnectivity, NLAT, NLON, maps));
+	DOUBLES_EQUAL(0.5f*teleconnectivity().tc[0][0], maps.tc[0][0], 1e-6);
+
+	GridModel model;
+	model.computeStatisticalSignificanceMask(0.99f);
+	model.setThreshold(0.5f);
+	CHECK(loadWithLoader(model, files));
+
+	// the teleconnectivity of the file, which may arrive before the correlations or after them
+	CHECK(hasWaveCorrelations(model));
+	CHECK(hasTeleconnectivity(model, maps));
+	const Shown shown(model);
+	CHECK(!shown.significance.empty());
+	CHECK(shown == shownWhenAdopted(maps));
+}
+
+} // namespace Testing
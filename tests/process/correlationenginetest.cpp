@@ -0,0 +1,625 @@
+/*! @file correlationenginetest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the blocked correlation computation
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "process/correlationengine.h"
+#include "process/precompute.h"
+#include "storage/correlationstore.h"
+#include "storage/databandreader.h"
+#include "storage/sparsecorrelationstore.h"
+#include "storage/correlationshard.h"
+#include "typedefs.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace Testing {
+
+namespace {
+
+/// Deterministic test data with some correlated and anti-correlated series
+VCGL::TimeSeriesField makeTestData(int nlat, int nlon, int ntime) {
+	return makeWaveData(nlat, nlon, ntime, 12345, 100.0f, 0.3);
+}
+
+/// The straightforward correlation loop (computeCorrelations before the blocked engine)
+void referenceCorrelations(const VCGL::TimeSeriesField& data,
+		std::vector< std::vector<float> >& correlationMatrix,
+		const std::vector< std::vector<bool> >& validityMask) {
+	const int nlat = data.nlat();
+	const int nlon = data.nlon();
+	const int ntime = data.timeCount();
+	const int npoints = nlat * nlon;
+
+	std::vector<float> averages(npoints, 0.0f);
+	correlationMatrix.clear();
+	correlationMatrix.resize(npoints, std::vector<float>(npoints, 0.0f));
+
+	for (int pt = 0; pt<npoints; pt++) {
+		float sum = 0.0f;
+		if (validityMask[pt / nlon][pt % nlon]) {
+			for (int t=0; t<ntime; t++) {
+				sum += data.series(pt)[t];
+			}
+			averages[pt] = sum / ntime;
+		}
+	}
+
+	for (int x = 0; x<npoints; x++) {
+		correlationMatrix[x][x] = 1.0;
+		for (int y = 0; y<x; y++) {
+			VCGL::SeriesSpan<const float> tx = data.series(x);
+			VCGL::SeriesSpan<const float> ty = data.series(y);
+			if (validityMask[x / nlon][x % nlon] && validityMask[y / nlon][y % nlon]) {
+				float nom = 0.0f;
+				float denomX = 0.0f;
+				float denomY = 0.0f;
+				for (int t=0; t<ntime; t++) {
+					float dx = tx[t]-averages[x];
+					float dy = ty[t]-averages[y];
+					nom += dx*dy;
+					denomX += dx*dx;
+					denomY += dy*dy;
+				}
+				correlationMatrix[x][y] = correlationMatrix[y][x] = nom / sqrt(denomX*denomY);
+			}
+		}
+	}
+}
+
+/// Pearson coefficient over the time steps valid (not NaN) in both series, in double
+template<typename Series>
+double pairwiseCompleteReference(const Series& a, const Series& b) {
+	double n = 0.0, sa = 0.0, sb = 0.0, saa = 0.0, sbb = 0.0, sab = 0.0;
+	for (size_t t=0; t<a.size(); t++) {
+		if (std::isnan(a[t]) || std::isnan(b[t])) {
+			continue;
+		}
+		n += 1.0;
+		sa += a[t];
+		sb += b[t];
+		saa += (double)a[t]*a[t];
+		sbb += (double)b[t]*b[t];
+		sab += (double)a[t]*b[t];
+	}
+	return (n*sab - sa*sb) / sqrt((n*saa - sa*sa)*(n*sbb - sb*sb));
+}
+
+double maxDifference(const std::vector< std::vector<float> >& a, const VCGL::SymmetricMatrix<float>& b) {
+	double result = 0.0;
+	for (size_t i=0; i<a.size(); i++) {
+		for (size_t j=0; j<a[i].size(); j++) {
+			result = std::max(result, (double)fabs(a[i][j] - b(i, j)));
+		}
+	}
+	return result;
+}
+
+/// Collects streamed rows into a symmetric matrix
+struct MatrixCollector: public VCGL::CorrelationRowConsumer {
+	VCGL::SymmetricMatrix<float> matrix;
+	std::vector<size_t> blockStarts;
+
+	explicit MatrixCollector(size_t npoints): matrix(npoints, 1.0f) {}
+
+	virtual void consumeRows(size_t rowBegin, size_t rowEnd, const float* values) override {
+		blockStarts.push_back(rowBegin);
+		const size_t count = VCGL::triangleOffset(rowEnd) - VCGL::triangleOffset(rowBegin);
+		std::copy(values, values + count, matrix.triangleRow(rowBegin));
+	}
+};
+
+} // namespace
+
+TEST(StandardizedRowsHaveUnitNorm, CorrelationEngine)
+{
+	VCGL::TimeSeriesField data = makeTestData(2, 3, 21);
+	std::vector< std::vector<bool> > validityMask(2, std::vector<bool>(3, true));
+	validityMask[1][2] = false;
+
+	VCGL::StandardizedSeries series;
+	series.assign(data, validityMask);
+
+	LONGS_EQUAL(6, series.pointCount());
+	LONGS_EQUAL(21, series.timeCount());
+	CHECK(series.stride() % VCGL::StandardizedSeries::ROW_ALIGNMENT == 0);
+
+	for (size_t pt=0; pt<5; pt++) {
+		double norm = 0.0;
+		double sum = 0.0;
+		for (size_t t=0; t<series.stride(); t++) {
+			norm += series.row(pt)[t]*series.row(pt)[t];
+			sum += series.row(pt)[t];
+		}
+		DOUBLES_EQUAL(1.0, norm, 1e-5);
+		DOUBLES_EQUAL(0.0, sum, 1e-5);
+	}
+	for (size_t t=0; t<series.stride(); t++) {
+		DOUBLES_EQUAL(0.0, series.row(5)[t], 0.0);
+	}
+}
+
+TEST(AllKernelsMatchReference, CorrelationEngine)
+{
+	const int nlat = 5, nlon = 7, ntime = 37;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	std::vector< std::vector<float> > expected;
+	referenceCorrelations(data, expected, validityMask);
+
+	VCGL::StandardizedSeries series;
+	series.assign(data, validityMask);
+	const size_t npoints = series.pointCount();
+
+	std::vector<const VCGL::CorrelationKernel*> kernels = VCGL::CorrelationEngine::availableKernels();
+	for (size_t k=0; k<kernels.size(); k++) {
+		VCGL::CorrelationEngine engine(series);
+		engine.useKernel(*kernels[k]);
+
+		// odd tile boundaries on purpose
+		std::vector<float> out(npoints*npoints, 0.0f);
+		const size_t split = 13;
+		engine.computeTile(0, split, 0, split, out.data(), npoints);
+		engine.computeTile(split, npoints, 0, split, out.data()+split*npoints, npoints);
+		engine.computeTile(split, npoints, split, npoints, out.data()+split*npoints+split, npoints);
+
+		for (size_t x=0; x<npoints; x++) {
+			for (size_t y=0; y<x; y++) {
+				DOUBLES_EQUAL(expected[x][y], out[x*npoints+y], 1e-4);
+			}
+		}
+	}
+}
+
+TEST(ComputeCorrelationsMatchesReference, CorrelationEngine)
+{
+	const int nlat = 4, nlon = 9, ntime = 50;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+	validityMask[2][3] = false;
+
+	std::vector< std::vector<float> > expected;
+	referenceCorrelations(data, expected, validityMask);
+
+	VCGL::SymmetricMatrix<float> actual;
+	computeCorrelations(data, actual, validityMask);
+
+	LONGS_EQUAL(expected.size(), actual.size());
+	CHECK(maxDifference(expected, actual) < 1e-4);
+}
+
+TEST(TriangleTilesCoverLowerTriangle, CorrelationEngine)
+{
+	const size_t npoints = 23;
+	std::vector<VCGL::TriangleTile> tiles = VCGL::makeTriangleTiles(npoints, 5);
+
+	std::vector<int> covered(npoints*npoints, 0);
+	unsigned long long pairs = 0;
+	for (size_t t=0; t<tiles.size(); t++) {
+		if (t > 0) {
+			CHECK(tiles[t-1].pairCount() >= tiles[t].pairCount() || tiles[t].colBegin == tiles[t].rowBegin);
+		}
+		pairs += tiles[t].pairCount();
+		for (size_t x=tiles[t].rowBegin; x<tiles[t].rowEnd; x++) {
+			for (size_t y=tiles[t].colBegin; y<std::min(tiles[t].colEnd, x); y++) {
+				covered[x*npoints+y]++;
+			}
+		}
+	}
+	LONGS_EQUAL(npoints*(npoints-1)/2, pairs);
+	for (size_t x=0; x<npoints; x++) {
+		for (size_t y=0; y<x; y++) {
+			LONGS_EQUAL(1, covered[x*npoints+y]);
+		}
+	}
+}
+
+TEST(ResultIndependentOfThreadCount, CorrelationEngine)
+{
+	const int nlat = 12, nlon = 15, ntime = 40;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	VCGL::SymmetricMatrix<float> single;
+	computeCorrelations(data, single, validityMask, 1);
+	VCGL::SymmetricMatrix<float> multi;
+	computeCorrelations(data, multi, validityMask, 4);
+	CHECK(single == multi);
+
+	std::vector<float> autoSingle;
+	computeAutocorrelations(data, autoSingle, validityMask, 1);
+	std::vector<float> autoMulti;
+	computeAutocorrelations(data, autoMulti, validityMask, 3);
+	CHECK(autoSingle == autoMulti);
+}
+
+TEST(TriangleOffsetDoesNotOverflow, CorrelationEngine)
+{
+	LONGS_EQUAL(0, VCGL::triangleOffset(0));
+	LONGS_EQUAL(0, VCGL::triangleOffset(1));
+	LONGS_EQUAL(3, VCGL::triangleOffset(3));
+	LONGS_EQUAL(6, VCGL::triangleOffset(4));
+	// 1 degree global grid: more pairs than fit into 32 bits
+	const size_t npoints = 360*181;
+	CHECK(VCGL::triangleOffset(npoints) == static_cast<size_t>(npoints)*(npoints-1)/2);
+}
+
+TEST(StreamingMatchesInMemory, CorrelationEngine)
+{
+	const int nlat = 10, nlon = 13, ntime = 30;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+	validityMask[3][4] = false;
+
+	VCGL::SymmetricMatrix<float> expected;
+	computeCorrelations(data, expected, validityMask, 2);
+
+	// budget for the series and a few rows only, to get several blocks
+	MatrixCollector collector(nlat*nlon);
+	VCGL::TeleconnectivityMinima minima(nlat*nlon);
+	VCGL::CorrelationRowFanOut consumers;
+	consumers.add(collector);
+	consumers.add(minima);
+	computeCorrelationsStreaming(data, validityMask, 1, 3, consumers);
+
+	CHECK(collector.blockStarts.size() > 1);
+	CHECK(expected == collector.matrix);
+
+	// same rule as ExplorationModelImpl::computeTeleconnectivity
+	for (size_t i=0; i<expected.size(); i++) {
+		float minCorr = 1.0f;
+		int minIndex = i;
+		for (size_t j=0; j<expected.size(); j++) {
+			if (expected(i, j) < minCorr) {
+				minCorr = expected(i, j);
+				minIndex = j;
+			}
+		}
+		DOUBLES_EQUAL(minCorr, minima.minima()[i], 0.0);
+		LONGS_EQUAL(minIndex, minima.partners()[i]);
+	}
+}
+
+namespace {
+
+/// Keeps the state of the collectors after the first block of rows, as a checkpoint would
+struct FirstBlockState: public VCGL::CorrelationRowConsumer {
+	const VCGL::TeleconnectivityMinima& minima;
+	const VCGL::TopCorrelations& top;
+	size_t rowEnd;
+	std::string state;
+
+	FirstBlockState(const VCGL::TeleconnectivityMinima& minima, const VCGL::TopCorrelations& top)
+	: minima(minima), top(top), rowEnd(0) {}
+
+	virtual void consumeRows(size_t /*rowBegin*/, size_t end, const float* /*values*/) override {
+		if (rowEnd == 0) {
+			std::ostringstream out;
+			minima.saveState(out);
+			top.saveState(out);
+			state = out.str();
+			rowEnd = end;
+		}
+	}
+};
+
+} // namespace
+
+TEST(StreamingContinuesFromSavedState, CorrelationEngine)
+{
+	const int nlat = 10, nlon = 13, ntime = 30;
+	const size_t npoints = nlat*nlon;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	VCGL::TeleconnectivityMinima minima(npoints);
+	VCGL::TopCorrelations top(npoints, 3, 2);
+	FirstBlockState firstBlock(minima, top);
+	VCGL::CorrelationRowFanOut consumers;
+	consumers.add(minima);
+	consumers.add(top);
+	consumers.add(firstBlock);
+	computeCorrelationsStreaming(data, validityMask, 1, 2, consumers);
+	CHECK(firstBlock.rowEnd > 0 && firstBlock.rowEnd < npoints);
+
+	// the continued run sees only the rows after the first block
+	VCGL::TeleconnectivityMinima continuedMinima(npoints);
+	VCGL::TopCorrelations continuedTop(npoints, 3, 2);
+	std::istringstream in(firstBlock.state);
+	CHECK(continuedMinima.restoreState(in));
+	CHECK(continuedTop.restoreState(in));
+	MatrixCollector collector(npoints);
+	VCGL::CorrelationRowFanOut continued;
+	continued.add(continuedMinima);
+	continued.add(continuedTop);
+	continued.add(collector);
+	computeCorrelationsStreaming(data, validityMask, 1, 3, continued, firstBlock.rowEnd);
+	LONGS_EQUAL(firstBlock.rowEnd, collector.blockStarts.front());
+
+	CHECK(minima.minima() == continuedMinima.minima());
+	CHECK(minima.partners() == continuedMinima.partners());
+	VCGL::SparseCorrelationRows expected, actual;
+	top.collect(expected);
+	continuedTop.collect(actual);
+	CHECK(expected.offsets == actual.offsets);
+	CHECK(expected.columns == actual.columns);
+	CHECK(expected.values == actual.values);
+
+	// state of a different number of points is refused
+	VCGL::TeleconnectivityMinima other(npoints+1);
+	std::istringstream again(firstBlock.state);
+	CHECK(!other.restoreState(again));
+}
+
+TEST(StreamingRowRangesMatchWholeRun, CorrelationEngine)
+{
+	const int nlat = 9, nlon = 11, ntime = 25;
+	const size_t npoints = nlat*nlon;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	VCGL::SymmetricMatrix<float> expected;
+	computeCorrelations(data, expected, validityMask, 1);
+
+	// the shards of independent runs put together
+	const unsigned shardCount = 5;
+	MatrixCollector collector(npoints);
+	for (unsigned i = 0; i<shardCount; i++) {
+		size_t rowBegin = 0, rowEnd = 0;
+		VCGL::shardRowRange(npoints, shardCount, i, &rowBegin, &rowEnd);
+		const size_t blocksBefore = collector.blockStarts.size();
+		computeCorrelationsStreaming(data, validityMask, 1, 1+i%3, collector, rowBegin, rowEnd);
+		if (rowEnd > rowBegin) {
+			LONGS_EQUAL(rowBegin, collector.blockStarts[blocksBefore]);
+		}
+	}
+	CHECK(expected == collector.matrix);
+}
+
+TEST(TeleconnectivityOnlyMatchesFullMatrix, CorrelationEngine)
+{
+	const int nlat = 9, nlon = 11, ntime = 25;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	// identical series give ties, which must go to the smaller index
+	std::copy(data.series(0, 5).begin(), data.series(0, 5).end(), data.series(7, 2).begin());
+	std::copy(data.series(0, 5).begin(), data.series(0, 5).end(), data.series(8, 10).begin());
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	VCGL::SymmetricMatrix<float> expected;
+	computeCorrelations(data, expected, validityMask, 1);
+
+	VCGL::TeleconnectivityMinima single(0);
+	computeTeleconnectivityMinima(data, validityMask, 1, single);
+	VCGL::TeleconnectivityMinima multi(0);
+	computeTeleconnectivityMinima(data, validityMask, 4, multi);
+	CHECK(single.minima() == multi.minima());
+	CHECK(single.partners() == multi.partners());
+
+	// same rule as ExplorationModelImpl::computeTeleconnectivity
+	LONGS_EQUAL(expected.size(), multi.minima().size());
+	for (size_t i=0; i<expected.size(); i++) {
+		float minCorr = 1.0f;
+		int minIndex = i;
+		for (size_t j=0; j<expected.size(); j++) {
+			if (expected(i, j) < minCorr) {
+				minCorr = expected(i, j);
+				minIndex = j;
+			}
+		}
+		DOUBLES_EQUAL(minCorr, multi.minima()[i], 0.0);
+		LONGS_EQUAL(minIndex, multi.partners()[i]);
+	}
+}
+
+namespace {
+
+/// Storage serving bands of a field held in memory, counting the reads
+class FieldDataStorage: public VCGL::DataStorage {
+public:
+	explicit FieldDataStorage(const VCGL::TimeSeriesField& field): field(field), readCount(0) {}
+
+	virtual std::size_t getNTime() override { return field.timeCount(); }
+	virtual std::size_t getNLon() override { return field.nlon(); }
+	virtual std::size_t getNLat() override { return field.nlat(); }
+	virtual std::vector<float> loadLons() override { return std::vector<float>(field.nlon(), 0.0f); }
+	virtual std::vector<float> loadLats() override { return std::vector<float>(field.nlat(), 0.0f); }
+	virtual VCGL::TimeSeriesField loadData(std::size_t latStart, std::size_t latCount) override {
+		return loadData(latStart, latCount, 0, field.timeCount());
+	}
+	virtual VCGL::TimeSeriesField loadData(std::size_t latStart, std::size_t latCount,
+			std::size_t timeStart, std::size_t timeCount) override {
+		readCount++;
+		VCGL::TimeSeriesField band(latCount, field.nlon(), timeCount);
+		for (size_t lat=0; lat<latCount; lat++) {
+			for (size_t lon=0; lon<field.nlon(); lon++) {
+				for (size_t t=0; t<timeCount; t++) {
+					band(lat, lon, t) = field(latStart+lat, lon, timeStart+t);
+				}
+			}
+		}
+		return band;
+	}
+
+	const VCGL::TimeSeriesField& field;
+	size_t readCount;
+};
+
+} // namespace
+
+TEST(BandedMatchesWholeData, CorrelationEngine)
+{
+	const int nlat = 10, nlon = 7, ntime = 30;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	// ties across bands, a gap and a point without enough values
+	std::copy(data.series(1, 3).begin(), data.series(1, 3).end(), data.series(6, 2).begin());
+	std::copy(data.series(1, 3).begin(), data.series(1, 3).end(), data.series(9, 0).begin());
+	data(4, 4, 10) = NAN;
+	std::fill(data.series(8, 1).begin(), data.series(8, 1).end(), NAN);
+
+	std::vector< std::vector<bool> > expectedMask;
+	computeValidityMask(data, expectedMask);
+	VCGL::TeleconnectivityMinima expected(0);
+	computeTeleconnectivityMinima(data, expectedMask, 1, expected);
+	std::vector<float> expectedAuto;
+	computeAutocorrelations(data, expectedAuto, expectedMask, 1);
+
+	FieldDataStorage storage(data);
+	// 3 latitudes per band: bands of 3, 3, 3 and 1 latitudes
+	VCGL::DataBandReader bands(&storage, VCGL::GridSelection(0, nlat, nlon, 0, ntime),
+			VCGL::DataBandReader::bandLatsForBudget(nlon, ntime, 3*nlon*32*sizeof(float)));
+	LONGS_EQUAL(3, bands.bandLats());
+	LONGS_EQUAL(4, bands.bandCount());
+	LONGS_EQUAL(nlat*nlon, bands.pointEnd(3));
+
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(bands, validityMask);
+	CHECK(expectedMask == validityMask);
+	CHECK(!validityMask[8][1]);
+
+	VCGL::TeleconnectivityMinima minima(0);
+	storage.readCount = 0;
+	computeTeleconnectivityMinima(bands, validityMask, 3, minima);
+	LONGS_EQUAL(4 + 3+2+1, storage.readCount);
+	CHECK(expected.minima() == minima.minima());
+	CHECK(expected.partners() == minima.partners());
+
+	std::vector<float> autocorrelations;
+	computeAutocorrelations(bands, autocorrelations, validityMask, 2);
+	CHECK(expectedAuto == autocorrelations);
+}
+
+TEST(MissingValuesArePairwiseComplete, CorrelationEngine)
+{
+	const int nlat = 4, nlon = 6, ntime = 45;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	// sparse gaps in some points, a mostly missing point and an all-missing one
+	for (int t=3; t<ntime; t+=11) {
+		data(0, 1, t) = NAN;
+		data(2, 3, t+1) = NAN;
+	}
+	data(0, 1, 4) = NAN;
+	data(1, 5, 4) = NAN;
+	for (int t=0; t<ntime; t++) {
+		if (t % 3) {
+			data(3, 0, t) = NAN;
+		}
+		data(3, 2, t) = NAN;
+	}
+
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(data, validityMask);
+	CHECK(validityMask[0][1] && validityMask[2][3] && validityMask[1][5]);
+	CHECK(!validityMask[3][0] && !validityMask[3][2]);
+	validityMask[3][0] = true; // still usable with a lower threshold
+
+	VCGL::SymmetricMatrix<float> single, multi;
+	computeCorrelations(data, single, validityMask, 1);
+	computeCorrelations(data, multi, validityMask, 3);
+	CHECK(single == multi);
+
+	const size_t npoints = nlat*nlon;
+	for (size_t x=0; x<npoints; x++) {
+		for (size_t y=0; y<x; y++) {
+			const bool valid = validityMask[x / nlon][x % nlon] && validityMask[y / nlon][y % nlon];
+			const double expected = valid ?
+					pairwiseCompleteReference(data.series(x), data.series(y)) : 0.0;
+			DOUBLES_EQUAL(expected, multi(x, y), 1e-4);
+		}
+	}
+
+	std::vector<float> autocorrelations;
+	computeAutocorrelations(data, autocorrelations, validityMask, 2);
+	for (size_t pt=0; pt<npoints; pt++) {
+		CHECK(!std::isnan(autocorrelations[pt]));
+	}
+	// consecutive pairs with both steps valid
+	VCGL::SeriesSpan<const float> ts = data.series(0, 1);
+	std::vector<float> a, b;
+	for (int t=0; t+1<ntime; t++) {
+		if (!std::isnan(ts[t]) && !std::isnan(ts[t+1])) {
+			a.push_back(ts[t]);
+			b.push_back(ts[t+1]);
+		}
+	}
+	DOUBLES_EQUAL(pairwiseCompleteReference(a, b), autocorrelations[1], 1e-5);
+}
+
+TEST(LandmarkProjectionFromDataMatchesMatrix, CorrelationEngine)
+{
+	const int nlat = 6, nlon = 10, ntime = 60;
+	VCGL::TimeSeriesField data = makeTestData(nlat, nlon, ntime);
+	for (int t=2; t<ntime; t+=7) {
+		data(0, 1, t) = NAN;
+		data(4, 6, t+1) = NAN;
+	}
+	std::vector< std::vector<bool> > validityMask;
+	computeValidityMask(data, validityMask);
+
+	VCGL::SymmetricMatrix<float> correlations;
+	computeCorrelations(data, correlations, validityMask, 1);
+	std::vector<VCGL::ProjectedPointInfo> fromMatrix;
+	projectLandmarks(correlations, nlon, nlat, 12, fromMatrix, 1);
+	// the correlations with the landmarks computed again give the same projection
+	std::vector<VCGL::ProjectedPointInfo> fromData;
+	projectLandmarks(data, validityMask, 12, fromData, 2);
+
+	LONGS_EQUAL(nlat*nlon, fromMatrix.size());
+	CHECK(fromMatrix == fromData);
+	CHECK(fromMatrix[nlon+3].name == "(3,1)");
+}
+
+TEST(RemapProjectionByDataFileGrid, CorrelationEngine)
+{
+	// 3x4 points from latitude 2 and longitude 10 of a file of 12 longitudes, wrapping around
+	std::vector<VCGL::ProjectedPointInfo> previous(12);
+	for (int j=0; j<12; j++) {
+		previous[j].pt = LSP::TSPoint(j, -j);
+	}
+	VCGL::GridSubsetRecord previousSubset = VCGL::GridSubsetRecord::whole();
+	previousSubset.latStart = 2;
+	previousSubset.lonStart = 10;
+	// shifted by one latitude and one longitude: the last latitude and longitude are new
+	VCGL::GridSubsetRecord subset = previousSubset;
+	subset.latStart = 3;
+	subset.lonStart = 11;
+
+	std::vector<VCGL::ProjectedPointInfo> output;
+	LONGS_EQUAL(6, remapProjection(previous, previousSubset, 4, subset, 3, 4, 12, output));
+	const int expected[12] = { 5, 6, 7, 7, 9, 10, 11, 11, 9, 10, 11, 11 };
+	LONGS_EQUAL(12, output.size());
+	for (int j=0; j<12; j++) {
+		DOUBLES_EQUAL(expected[j], output[j].pt.getX(), 0.0);
+		DOUBLES_EQUAL(-expected[j], output[j].pt.getY(), 0.0);
+	}
+
+	// the same grid is kept as it is
+	LONGS_EQUAL(12, remapProjection(previous, previousSubset, 4, previousSubset, 3, 4, 12, output));
+	for (int j=0; j<12; j++) {
+		DOUBLES_EQUAL(j, output[j].pt.getX(), 0.0);
+	}
+
+	// every other latitude and longitude of the earlier grid
+	subset = previousSubset;
+	subset.latStride = 2;
+	subset.lonStride = 2;
+	LONGS_EQUAL(4, remapProjection(previous, previousSubset, 4, subset, 2, 2, 12, output));
+	DOUBLES_EQUAL(2, output[1].pt.getX(), 0.0);
+	DOUBLES_EQUAL(10, output[3].pt.getX(), 0.0);
+
+	// nothing in common
+	subset.latStart = 20;
+	LONGS_EQUAL(0, remapProjection(previous, previousSubset, 4, subset, 2, 2, 12, output));
+	CHECK(output.empty());
+}
+
+} // namespace Testing
@@ -0,0 +1,131 @@
+/*! @file correlationstatisticstest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the incremental correlation statistics
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+#include "typedefs.h"
+
+#include "process/correlationstatistics.h"
+#include "process/precompute.h"
+#include "storage/precomputeddata.h"
+
+#include <cmath>
+
+namespace Testing {
+
+namespace {
+
+/// Series far from zero, as geopotential heights are
+VCGL::TimeSeriesField makeSeries(int nlat, int nlon, int ntime) {
+	return makeWaveData(nlat, nlon, ntime, 4321, 5000.0f, 0.4);
+}
+
+/// Time steps [begin, end) of the data
+VCGL::TimeSeriesField timeSlice(const VCGL::TimeSeriesField& data, int begin, int end) {
+	VCGL::TimeSeriesField slice(data.nlat(), data.nlon(), end-begin);
+	for (size_t pt=0; pt<data.pointCount(); pt++) {
+		std::copy(data.series(pt).begin()+begin, data.series(pt).begin()+end, slice.series(pt).begin());
+	}
+	return slice;
+}
+
+struct TriangleCollector: public VCGL::CorrelationRowConsumer {
+	VCGL::SymmetricMatrix<float> matrix;
+	explicit TriangleCollector(size_t npoints): matrix(npoints, 1.0f) {}
+	virtual void consumeRows(size_t rowBegin, size_t rowEnd, const float* values) override {
+		const size_t count = VCGL::triangleOffset(rowEnd) - VCGL::triangleOffset(rowBegin);
+		std::copy(values, values + count, matrix.triangleRow(rowBegin));
+	}
+};
+
+} // namespace
+
+TEST(UpdateMatchesFullComputation, CorrelationStatistics)
+{
+	const int nlat = 4, nlon = 5, ntime = 40;
+	VCGL::TimeSeriesField data = makeSeries(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+	validityMask[2][3] = false;
+
+	VCGL::SymmetricMatrix<float> expected;
+	computeCorrelations(data, expected, validityMask, 1);
+	std::vector<float> expectedAuto;
+	computeAutocorrelations(data, expectedAuto, validityMask, 1);
+
+	// the history first, then two appended slices
+	VCGL::CorrelationStatistics statistics;
+	statistics.accumulate(timeSlice(data, 0, 25), validityMask, 2);
+	statistics.accumulate(timeSlice(data, 25, 26), validityMask, 2);
+	statistics.accumulate(timeSlice(data, 26, ntime), validityMask, 3);
+	LONGS_EQUAL(ntime, statistics.sampleCount());
+
+	TriangleCollector collector(nlat*nlon);
+	statistics.emitCorrelations(7, 2, collector);
+	for (size_t i=0; i<expected.size(); i++) {
+		for (size_t j=0; j<i; j++) {
+			DOUBLES_EQUAL(expected(i, j), collector.matrix(i, j), 1e-5);
+			DOUBLES_EQUAL(expected(i, j), statistics.correlation(i, j), 1e-5);
+		}
+	}
+
+	std::vector<float> autocorrelations;
+	statistics.autocorrelations(autocorrelations);
+	for (size_t i=0; i<expectedAuto.size(); i++) {
+		DOUBLES_EQUAL(expectedAuto[i], autocorrelations[i], 1e-4);
+	}
+}
+
+TEST(StoredStatisticsCanBeUpdated, CorrelationStatistics)
+{
+	const int nlat = 3, nlon = 4, ntime = 30;
+	VCGL::TimeSeriesField data = makeSeries(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	VCGL::CorrelationStatistics full;
+	full.accumulate(data, validityMask, 1);
+
+	const std::string statsFileName = "test-stats.bin";
+	{
+		VCGL::CorrelationStatistics history;
+		history.accumulate(timeSlice(data, 0, 20), validityMask, 1);
+		CHECK(storeCorrelationStatistics(history, statsFileName));
+	}
+	VCGL::CorrelationStatistics restored;
+	CHECK(readCorrelationStatistics(statsFileName, restored));
+	LONGS_EQUAL(20, restored.sampleCount());
+	LONGS_EQUAL(nlat, restored.nlat());
+	LONGS_EQUAL(nlon, restored.nlon());
+
+	restored.accumulate(timeSlice(data, 20, ntime), validityMask, 1);
+	for (size_t i=0; i<restored.pointCount(); i++) {
+		for (size_t j=0; j<i; j++) {
+			DOUBLES_EQUAL(full.correlation(i, j), restored.correlation(i, j), 1e-6);
+		}
+	}
+
+	CHECK(!readCorrelationStatistics("no-such-stats.bin", restored));
+}
+
+TEST(ConstantSeriesAreUncorrelated, CorrelationStatistics)
+{
+	const int nlat = 2, nlon = 3, ntime = 40;
+	VCGL::TimeSeriesField data = makeSeries(nlat, nlon, ntime);
+	std::fill(data.series(4).begin(), data.series(4).end(), 2.0f);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+
+	VCGL::CorrelationStatistics statistics;
+	statistics.accumulate(data, validityMask, 1);
+	CHECK(statistics.correlation(4, 1) == 0.0f);
+
+	// no variance, neither in the first nor in the last steps
+	std::vector<float> autocorrelations;
+	statistics.autocorrelations(autocorrelations);
+	CHECK(autocorrelations[4] == 0.0f);
+	CHECK(std::isfinite(autocorrelations[3]) && autocorrelations[3] != 0.0f);
+}
+
+} // namespace Testing
@@ -0,0 +1,128 @@
+/*! @file laggedcorrelationtest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the FFT lagged correlation engine
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+#include "typedefs.h"
+
+#include "process/laggedcorrelation.h"
+#include "process/precompute.h"
+#include "storage/precomputeddata.h"
+
+#include <cmath>
+
+namespace Testing {
+
+namespace {
+
+/// Points further away follow the first one, by a time step per latitude and longitude
+VCGL::TimeSeriesField makeLaggedData(int nlat, int nlon, int ntime) {
+	return makeWaveData(nlat, nlon, ntime, 777, 20.0f, 0.5, 1);
+}
+
+/// Brute-force minimum over the lags of sum a[t]*b[t+L] of the standardized series
+void referenceLagged(const VCGL::TimeSeriesField& data, int maxLag, size_t x, size_t y, float* pMin, int* pLag) {
+	std::vector<double> a(data.series(x).begin(), data.series(x).end());
+	std::vector<double> b(data.series(y).begin(), data.series(y).end());
+	for (std::vector<double>* s: { &a, &b }) {
+		double mean = 0.0, norm = 0.0;
+		for (double v: *s) { mean += v; }
+		mean /= s->size();
+		for (double& v: *s) { v -= mean; norm += v*v; }
+		for (double& v: *s) { v /= sqrt(norm); }
+	}
+	const int ntime = a.size();
+	*pMin = 2.0f;
+	for (int k = 0; k<=2*maxLag; k++) {
+		// 0, -1, 1, -2, 2, ...
+		const int l = (k % 2 == 0) ? k/2 : -(k+1)/2;
+		double c = 0.0;
+		for (int t=0; t<ntime; t++) {
+			if (t+l >= 0 && t+l < ntime) {
+				c += a[t]*b[t+l];
+			}
+		}
+		if (c < *pMin) {
+			*pMin = c;
+			*pLag = l;
+		}
+	}
+}
+
+/// Whether the lagged correlations of the data match the brute force ones and do not depend on the threads
+bool matchesBruteForce(const VCGL::TimeSeriesField& data, int maxLag) {
+	std::vector< std::vector<bool> > validityMask(data.nlat(), std::vector<bool>(data.nlon(), true));
+	VCGL::LaggedCorrelations single, multi;
+	VCGL::computeLaggedCorrelations(data, validityMask, maxLag, 1, single);
+	VCGL::computeLaggedCorrelations(data, validityMask, maxLag, 3, multi);
+	if (!(single.minima == multi.minima) || single.lags != multi.lags || multi.maxLag != maxLag) {
+		return false;
+	}
+	for (size_t x=0; x<multi.minima.size(); x++) {
+		for (size_t y=0; y<x; y++) {
+			float expectedMin = 0.0f;
+			int expectedLag = 0;
+			referenceLagged(data, maxLag, x, y, &expectedMin, &expectedLag);
+			if (std::fabs(expectedMin - multi.minima(x, y)) > 1e-5
+					|| multi.lag(x, y) != expectedLag || multi.lag(y, x) != -expectedLag) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+TEST(MatchesBruteForce, LaggedCorrelation)
+{
+	// 37 steps pad to 64 (or 128): up to 5 lags each side are dot products, more go through the FFT
+	VCGL::TimeSeriesField data = makeLaggedData(3, 4, 37);
+	CHECK(matchesBruteForce(data, 5));
+	CHECK(matchesBruteForce(data, 6));
+	CHECK(matchesBruteForce(data, 20));
+	CHECK(matchesBruteForce(data, 36));
+	// more points than a tile of pairs
+	CHECK(matchesBruteForce(makeLaggedData(9, 10, 24), 2));
+	CHECK(matchesBruteForce(makeLaggedData(9, 10, 24), 9));
+}
+
+TEST(ZeroLagIsPearson, LaggedCorrelation)
+{
+	const int nlat = 2, nlon = 5, ntime = 20;
+	VCGL::TimeSeriesField data = makeLaggedData(nlat, nlon, ntime);
+	std::vector< std::vector<bool> > validityMask(nlat, std::vector<bool>(nlon, true));
+	validityMask[1][1] = false;
+
+	VCGL::SymmetricMatrix<float> expected;
+	computeCorrelations(data, expected, validityMask, 1);
+	VCGL::LaggedCorrelations lagged;
+	VCGL::computeLaggedCorrelations(data, validityMask, 0, 2, lagged);
+	for (size_t x=0; x<expected.size(); x++) {
+		for (size_t y=0; y<x; y++) {
+			DOUBLES_EQUAL(expected(x, y), lagged.minima(x, y), 1e-5);
+			LONGS_EQUAL(0, lagged.lag(x, y));
+		}
+	}
+}
+
+TEST(LagsWriteRead, LaggedCorrelation)
+{
+	const std::vector<int16_t> lags = { 1, -2, 0, 3, 3, -1 };
+	const std::string lagsFileName = "test-lags.bin";
+	CHECK(storeLags(lags, 4, 3, lagsFileName));
+
+	std::vector<int16_t> lagsIn;
+	size_t npoints = 0;
+	int maxLag = 0;
+	CHECK(readLags(lagsFileName, lagsIn, &npoints, &maxLag));
+	LONGS_EQUAL(4, npoints);
+	LONGS_EQUAL(3, maxLag);
+	CHECK(lags == lagsIn);
+}
+
+} // namespace Testing
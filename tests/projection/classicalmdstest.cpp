@@ -0,0 +1,122 @@
+/*! @file classicalmdstest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for classical MDS
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "projection/distancematrix.h"
+#include "projection/parallelsammon.h"
+#include "projection/classicalmds.h"
+
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace Testing {
+
+namespace {
+
+/// Correlations of a nx x ny grid, with waves of positive and negative correlations
+VCGL::SymmetricMatrix<float> waveCorrelations(int nx, int ny) {
+	VCGL::SymmetricMatrix<float> correlations(nx*ny, 1.0f);
+	for (int i = 0; i < nx*ny; i++) {
+		for (int j = 0; j < i; j++) {
+			correlations.set(i, j, static_cast<float>(std::cos(0.3*(i%nx - j%nx)) * std::cos(0.2*(i/nx - j/nx))));
+		}
+	}
+	return correlations;
+}
+
+double distance(const LSP::TSPoint& a, const LSP::TSPoint& b) {
+	return std::sqrt((a.getX() - b.getX())*(a.getX() - b.getX()) + (a.getY() - b.getY())*(a.getY() - b.getY()));
+}
+
+} // namespace
+
+TEST(PlanarPointsRecovered, ClassicalMDS)
+{
+	const int count = 200;
+	std::vector<LSP::TSPoint> points;
+	srand(3);
+	for (int i = 0; i < count; i++) {
+		points.push_back(LSP::TSPoint(rand() / (double) RAND_MAX, 0.3 * rand() / (double) RAND_MAX));
+	}
+	VCGL::SymmetricMatrix<float> distances(count, 0.0f);
+	for (int i = 0; i < count; i++) {
+		for (int j = 0; j < i; j++) {
+			distances.set(i, j, static_cast<float>(distance(points[i], points[j])));
+		}
+	}
+
+	LSP::ClassicalMDS mds(distances.view());
+	QVector<LSP::TSPoint> projection;
+	mds.perform(projection);
+	LONGS_EQUAL(count, projection.size());
+	// the same distances, up to the rounding of the stored ones
+	for (int i = 0; i < count; i++) {
+		for (int j = 0; j < i; j++) {
+			DOUBLES_EQUAL(distances(i, j), distance(projection[i], projection[j]), 1e-5);
+		}
+	}
+	CHECK(mds.eigenvalues()[0] >= mds.eigenvalues()[1]);
+	CHECK(mds.eigenvalues()[1] > 0.0);
+}
+
+TEST(SameWithAnyThreadCount, ClassicalMDS)
+{
+	const VCGL::SymmetricMatrix<float> correlations = waveCorrelations(20, 15);
+	QVector<LSP::TSPoint> single;
+	LSP::ClassicalMDS(correlations.view(), LSP::ClassicalMDS::CORRELATIONS, 1).perform(single);
+	QVector<LSP::TSPoint> several;
+	LSP::ClassicalMDS(correlations.view(), LSP::ClassicalMDS::CORRELATIONS, 3).perform(several);
+	LONGS_EQUAL(300, single.size());
+	LONGS_EQUAL(300, several.size());
+	for (int i = 0; i < single.size(); i++) {
+		CHECK(single[i].getX() == several[i].getX() && single[i].getY() == several[i].getY());
+	}
+}
+
+TEST(CorrelationsAsDistances, ClassicalMDS)
+{
+	const VCGL::SymmetricMatrix<float> correlations = waveCorrelations(12, 10);
+	VCGL::DistanceMatrix* pdmat = 0;
+	VCGL::DistanceMatrix::fromCorrelationMatrixArray(correlations, 12, 10, "correlation", &pdmat);
+	std::unique_ptr<VCGL::DistanceMatrix> dmat(pdmat);
+
+	QVector<LSP::TSPoint> fromCorrelations;
+	LSP::ClassicalMDS(correlations.view(), LSP::ClassicalMDS::CORRELATIONS).perform(fromCorrelations);
+	QVector<LSP::TSPoint> fromDistances;
+	LSP::ClassicalMDS(dmat->distanceView()).perform(fromDistances);
+	LONGS_EQUAL(120, fromCorrelations.size());
+	// a symmetric grid leaves the sign of an axis to rounding
+	const double signX = fromDistances[0].getX() * fromCorrelations[0].getX() < 0.0 ? -1.0 : 1.0;
+	const double signY = fromDistances[0].getY() * fromCorrelations[0].getY() < 0.0 ? -1.0 : 1.0;
+	for (int i = 0; i < fromCorrelations.size(); i++) {
+		DOUBLES_EQUAL(fromDistances[i].getX(), signX*fromCorrelations[i].getX(), 1e-5);
+		DOUBLES_EQUAL(fromDistances[i].getY(), signY*fromCorrelations[i].getY(), 1e-5);
+	}
+}
+
+TEST(StressAsSammon, ClassicalMDS)
+{
+	const VCGL::SymmetricMatrix<float> correlations = waveCorrelations(30, 20);
+	VCGL::DistanceMatrix* pdmat = 0;
+	VCGL::DistanceMatrix::fromCorrelationMatrixArray(correlations, 30, 20, "correlation", &pdmat);
+	std::unique_ptr<VCGL::DistanceMatrix> dmat(pdmat);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+
+	LSP::ParallelSammon sammon(ids, *dmat);
+	QVector<LSP::TSPoint> reference;
+	sammon.perform(reference);
+	QVector<LSP::TSPoint> projection;
+	LSP::ClassicalMDS(correlations.view(), LSP::ClassicalMDS::CORRELATIONS, 2).perform(projection);
+	CHECK(sammon.stress(projection) < 1.2*sammon.stress(reference));
+}
+
+} // namespace Testing
@@ -0,0 +1,50 @@
+/*! @file distancematrixtest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the distance matrix
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "projection/distancematrix.h"
+
+#include <sstream>
+#include <memory>
+
+namespace Testing {
+
+TEST(FromCorrelationsAndDMATRoundTrip, DistanceMatrix)
+{
+	const VCGL::SymmetricMatrix<float> correlations = symmetricFromSquare<float>(
+		{ {1.0, 0.5, -1.0, 0.0},
+		  {0.5, 1.0, 0.2, -0.6},
+		  {-1.0, 0.2, 1.0, 0.8},
+		  {0.0, -0.6, 0.8, 1.0} });
+
+	VCGL::DistanceMatrix* pdmat = 0;
+	VCGL::DistanceMatrix::fromCorrelationMatrixArray(correlations, 2, 2, "correlation", &pdmat);
+	std::unique_ptr<VCGL::DistanceMatrix> dmat(pdmat);
+
+	for (unsigned i=0; i<4; i++) {
+		for (unsigned j=0; j<4; j++) {
+			const float expected = (i == j) ? 0.0f : (1.0f - correlations(i, j))/2.0f;
+			DOUBLES_EQUAL(expected, dmat->getDistanceByIndices(i, j), 1e-6);
+		}
+	}
+	DOUBLES_EQUAL(1.0, dmat->getDistance("(0,1)", "(0,0)"), 1e-6);
+
+	std::stringstream dmatText;
+	dmat->printDMAT(dmatText);
+	VCGL::DistanceMatrix* pread = 0;
+	VCGL::DistanceMatrix::readDMAT(dmatText, "read", &pread);
+	std::unique_ptr<VCGL::DistanceMatrix> read(pread);
+	for (unsigned i=0; i<4; i++) {
+		for (unsigned j=0; j<4; j++) {
+			DOUBLES_EQUAL(dmat->getDistanceByIndices(i, j), read->getDistanceByIndices(i, j), 1e-6);
+		}
+	}
+}
+
+} // namespace Testing
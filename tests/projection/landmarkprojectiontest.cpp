@@ -0,0 +1,101 @@
+/*! @file landmarkprojectiontest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the projection through landmarks
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "projection/distancematrix.h"
+#include "projection/parallelsammon.h"
+#include "projection/landmarkprojection.h"
+
+#include <memory>
+#include <cmath>
+#include <vector>
+
+namespace Testing {
+
+namespace {
+
+bool samePoint(const LSP::TSPoint& a, const LSP::TSPoint& b) {
+	return a.getX() == b.getX() && a.getY() == b.getY();
+}
+
+} // namespace
+
+TEST(StressAsSammon, LandmarkProjection)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(30, 20);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+
+	LSP::ParallelSammon sammon(ids, *dmat, 1);
+	QVector<LSP::TSPoint> full;
+	sammon.perform(full);
+
+	const LSP::DistanceMatrixSource source(*dmat);
+	LSP::LandmarkProjection projection(source, 60, 2);
+	LONGS_EQUAL(60, projection.landmarks().size());
+	QVector<LSP::TSPoint> points;
+	projection.perform(points);
+	LONGS_EQUAL(ids.size(), points.size());
+
+	const double fullStress = sammon.stress(full);
+	CHECK(fullStress > 0.0);
+	CHECK(sammon.stress(points) < 1.2*fullStress);
+	CHECK(projection.landmarkStress(points) < 1.2*fullStress);
+}
+
+TEST(SameWithAnyThreadCount, LandmarkProjection)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(20, 15);
+	const LSP::DistanceMatrixSource source(*dmat);
+
+	QVector<LSP::TSPoint> single;
+	LSP::LandmarkProjection(source, 40, 1).perform(single);
+	QVector<LSP::TSPoint> several;
+	LSP::LandmarkProjection(source, 40, 3).perform(several);
+	LONGS_EQUAL(300, single.size());
+	LONGS_EQUAL(300, several.size());
+	for (int i = 0; i < single.size(); i++) {
+		CHECK(samePoint(single[i], several[i]));
+	}
+}
+
+TEST(LandmarksKeepTheirProjection, LandmarkProjection)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(10, 8);
+	const LSP::DistanceMatrixSource source(*dmat);
+	LSP::LandmarkProjection projection(source, 20);
+	QVector<LSP::TSPoint> points;
+	projection.perform(points);
+
+	// the landmarks alone give the same projection of them
+	const std::vector<std::size_t>& landmarks = projection.landmarks();
+	std::vector<VCGL::strType> ids;
+	for (std::size_t j = 0; j < landmarks.size(); j++) {
+		ids.push_back(std::to_string(landmarks[j]));
+	}
+	VCGL::DistanceMatrix landmarkDistances("landmarks", ids);
+	for (std::size_t j = 0; j < landmarks.size(); j++) {
+		for (std::size_t other = 0; other < j; other++) {
+			landmarkDistances.setDistanceByIndices(j, other, dmat->getDistanceByIndices(landmarks[j], landmarks[other]));
+		}
+	}
+	QVector<LSP::TSPoint> landmarkPoints;
+	LSP::ParallelSammon(ids, landmarkDistances).perform(landmarkPoints);
+	for (std::size_t j = 0; j < landmarks.size(); j++) {
+		CHECK(samePoint(points[landmarks[j]], landmarkPoints[j]));
+	}
+
+	// more landmarks than points: all of them
+	LSP::LandmarkProjection all(source, 1000);
+	LONGS_EQUAL(80, all.landmarks().size());
+	all.perform(points);
+	LONGS_EQUAL(80, points.size());
+}
+
+} // namespace Testing
@@ -0,0 +1,109 @@
+/*! @file parallelsammontest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for Sammon's mapping on several threads
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "projection/distancematrix.h"
+#include "projection/sammon.h"
+#include "projection/parallelsammon.h"
+
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace Testing {
+
+TEST(KernelsAgreeWithScalar, ParallelSammon)
+{
+	const std::size_t count = 37;
+	std::vector<double> coordinates(4*count);
+	std::vector<float> distances(count);
+	srand(7);
+	for (std::size_t j = 0; j < coordinates.size(); j++) {
+		coordinates[j] = rand() / (double) RAND_MAX;
+	}
+	for (std::size_t j = 0; j < count; j++) {
+		distances[j] = rand() / (float) RAND_MAX;
+	}
+	// a pair at the same place
+	coordinates[0] = coordinates[2*count];
+	coordinates[count] = coordinates[3*count];
+
+	const std::vector<const LSP::SammonKernel*> kernels = LSP::ParallelSammon::availableKernels();
+	CHECK(!kernels.empty());
+	std::vector<double> expected = coordinates;
+	double* e = expected.data();
+	kernels.front()->updatePairs(e, e+count, e+2*count, e+3*count, distances.data(), count, 0.3);
+	for (const LSP::SammonKernel* pKernel: kernels) {
+		std::vector<double> actual = coordinates;
+		double* a = actual.data();
+		pKernel->updatePairs(a, a+count, a+2*count, a+3*count, distances.data(), count, 0.3);
+		CHECK(expected == actual);
+	}
+}
+
+TEST(SameWithAnyThreadCount, ParallelSammon)
+{
+	// three blocks, one of them shorter
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(30, 10);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+
+	QVector<LSP::TSPoint> single;
+	LSP::ParallelSammon(ids, *dmat, 1).perform(single);
+	QVector<LSP::TSPoint> several;
+	LSP::ParallelSammon(ids, *dmat, 3).perform(several);
+	LONGS_EQUAL(ids.size(), single.size());
+	CHECK(samePoints(single, several));
+}
+
+TEST(ContinuedRunMatchesUninterrupted, ParallelSammon)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(20, 10);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+	LSP::ParallelSammon sammon(ids, *dmat, 2);
+
+	IterationRecorder recorder(40);
+	QVector<LSP::TSPoint> uninterrupted;
+	sammon.perform(uninterrupted, &recorder);
+	LONGS_EQUAL(LSP::Sammon::ITERATION_COUNT, recorder.calls);
+	LONGS_EQUAL(ids.size(), recorder.points.size());
+
+	QVector<LSP::TSPoint> continued = recorder.points;
+	LSP::ParallelSammon(ids, *dmat, 1).perform(continued, 0, recorder.iteration);
+	CHECK(samePoints(uninterrupted, continued));
+}
+
+TEST(StressAsSammon, ParallelSammon)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(20, 12);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+
+	QVector<LSP::TSPoint> reference;
+	LSP::Sammon::performSammonDMAT(ids, *dmat, reference);
+	LSP::ParallelSammon sammon(ids, *dmat, 2);
+	QVector<LSP::TSPoint> parallel;
+	sammon.perform(parallel);
+
+	const double referenceStress = sammon.stress(reference);
+	CHECK(referenceStress > 0.0);
+	CHECK(sammon.stress(parallel) < 1.2*referenceStress);
+
+	// a part of the objects, in another order
+	std::vector<VCGL::strType> part(ids.rbegin(), ids.rbegin() + 100);
+	LSP::ParallelSammon partSammon(part, *dmat, 2);
+	QVector<LSP::TSPoint> partProjection;
+	partSammon.perform(partProjection);
+	LONGS_EQUAL(part.size(), partProjection.size());
+	CHECK(partSammon.stress(partProjection) < 1.2*referenceStress);
+}
+
+} // namespace Testing
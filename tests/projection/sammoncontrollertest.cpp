@@ -0,0 +1,132 @@
+/*! @file sammoncontrollertest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the iterations of Sammon's mapping driven by its stress
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "projection/distancematrix.h"
+#include "projection/sammon.h"
+#include "projection/parallelsammon.h"
+#include "projection/sammoncontroller.h"
+
+#include <memory>
+#include <cmath>
+#include <vector>
+
+namespace Testing {
+
+TEST(FixedScheduleAsWithout, SammonController)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(12, 10);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+	LSP::ParallelSammon sammon(ids, *dmat);
+
+	QVector<LSP::TSPoint> reference;
+	sammon.perform(reference);
+
+	std::vector<LSP::SammonProgress> reports;
+	LSP::SammonController controller(0.0, [&reports](const LSP::SammonProgress& progress) {
+		reports.push_back(progress);
+	});
+	QVector<LSP::TSPoint> controlled;
+	sammon.perform(controlled, 0, 0, &controller);
+
+	CHECK(samePoints(reference, controlled));
+	LONGS_EQUAL(LSP::Sammon::ITERATION_COUNT, reports.size());
+	for (size_t j = 0; j < reports.size(); j++) {
+		LONGS_EQUAL(j+1, reports[j].iterations);
+		LONGS_EQUAL(LSP::Sammon::ITERATION_COUNT, reports[j].maxIterations);
+		CHECK(reports[j].last == (j+1 == reports.size()));
+	}
+	CHECK(!controller.converged());
+	// all 7140 pairs are sampled
+	DOUBLES_EQUAL(sammon.stress(controlled), reports.back().stress, 1e-9);
+}
+
+TEST(StopsOnceConverged, SammonController)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(30, 20);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+	LSP::ParallelSammon sammon(ids, *dmat);
+
+	QVector<LSP::TSPoint> reference;
+	sammon.perform(reference);
+
+	double sampled = 0.0;
+	LSP::SammonController controller(1e-3, [&sampled](const LSP::SammonProgress& progress) {
+		sampled = progress.stress;
+	});
+	QVector<LSP::TSPoint> controlled;
+	sammon.perform(controlled, 0, 0, &controller);
+
+	CHECK(controller.converged());
+	CHECK(controller.iterations() > LSP::SammonController::DECAY_ITERATIONS);
+	CHECK(controller.iterations() < 30);
+	CHECK(sammon.stress(controlled) < 1.05*sammon.stress(reference));
+	// 179700 pairs, of which a sample
+	DOUBLES_EQUAL(sammon.stress(controlled), sampled, 0.1*sampled);
+}
+
+TEST(CancelledAndContinued, SammonController)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> dmat = waveDistances(20, 15);
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+	LSP::ParallelSammon sammon(ids, *dmat, 2);
+
+	LSP::SammonController uninterrupted(1e-3);
+	QVector<LSP::TSPoint> reference;
+	sammon.perform(reference, 0, 0, &uninterrupted);
+
+	// cancelled during the fifth iteration
+	LSP::SammonController cancelled(1e-3, [&cancelled](const LSP::SammonProgress& progress) {
+		if (progress.iterations == 4) {
+			cancelled.cancel();
+		}
+	});
+	QVector<LSP::TSPoint> points;
+	sammon.perform(points, 0, 0, &cancelled);
+	CHECK(cancelled.cancelled());
+	CHECK(!cancelled.converged());
+	LONGS_EQUAL(5, cancelled.iterations());
+
+	LSP::SammonController continued(1e-3);
+	sammon.perform(points, 0, cancelled.iterations(), &continued);
+	LONGS_EQUAL(uninterrupted.iterations(), continued.iterations());
+	CHECK(continued.converged());
+	CHECK(samePoints(reference, points));
+}
+
+TEST(WarmStartRefines, SammonController)
+{
+	std::unique_ptr<VCGL::DistanceMatrix> before = waveDistances(20, 15);
+	std::unique_ptr<VCGL::DistanceMatrix> after = waveDistances(20, 15, 0.32);
+	std::vector<VCGL::strType> ids;
+	after->getObjectIDs(ids);
+
+	QVector<LSP::TSPoint> points;
+	LSP::ParallelSammon(ids, *before).perform(points);
+	LSP::ParallelSammon sammon(ids, *after);
+	QVector<LSP::TSPoint> cold;
+	sammon.perform(cold);
+
+	// the last iterations from the layout of the slightly different distances
+	LSP::SammonController controller;
+	const int first = controller.warmStartIteration();
+	LONGS_EQUAL(LSP::Sammon::ITERATION_COUNT - LSP::SammonController::REFINEMENT_ITERATIONS, first);
+	sammon.perform(points, 0, first, &controller);
+	LONGS_EQUAL(LSP::Sammon::ITERATION_COUNT, controller.iterations());
+	CHECK(sammon.stress(points) < 1.02*sammon.stress(cold));
+
+	// with a tolerance, after the decay of the step
+	LSP::SammonController converging(1e-3);
+	LONGS_EQUAL(LSP::SammonController::DECAY_ITERATIONS, converging.warmStartIteration());
+}
+
+} // namespace Testing
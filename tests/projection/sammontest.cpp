@@ -0,0 +1,48 @@
+/*! @file sammontest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for Sammon's mapping
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "projection/distancematrix.h"
+#include "projection/sammon.h"
+
+#include <memory>
+#include <cstdlib>
+#include <vector>
+
+namespace Testing {
+
+TEST(ContinuedRunMatchesUninterrupted, Sammon)
+{
+	VCGL::DistanceMatrix* pdmat = 0;
+	VCGL::DistanceMatrix::forGrid(4, 3, "grid", &pdmat);
+	std::unique_ptr<VCGL::DistanceMatrix> dmat(pdmat);
+	for (unsigned i = 0; i < 12; i++) {
+		for (unsigned j = 0; j < i; j++) {
+			dmat->setDistanceByIndices(i, j, std::abs(int(i%4) - int(j%4)) + std::abs(int(i/4) - int(j/4)));
+		}
+	}
+	std::vector<VCGL::strType> ids;
+	dmat->getObjectIDs(ids);
+
+	IterationRecorder recorder(40);
+	QVector<LSP::TSPoint> uninterrupted;
+	LSP::Sammon::performSammonDMAT(ids, *dmat, uninterrupted, &recorder);
+	LONGS_EQUAL(LSP::Sammon::ITERATION_COUNT, recorder.calls);
+	LONGS_EQUAL(ids.size(), recorder.points.size());
+
+	QVector<LSP::TSPoint> continued = recorder.points;
+	LSP::Sammon::performSammonDMAT(ids, *dmat, continued, 0, recorder.iteration);
+	LONGS_EQUAL(uninterrupted.size(), continued.size());
+	for (int i = 0; i < uninterrupted.size(); i++) {
+		DOUBLES_EQUAL(uninterrupted[i].getX(), continued[i].getX(), 0.0);
+		DOUBLES_EQUAL(uninterrupted[i].getY(), continued[i].getY(), 0.0);
+	}
+}
+
+} // namespace Testing
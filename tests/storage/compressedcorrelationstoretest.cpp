@@ -0,0 +1,183 @@
+/*! @file compressedcorrelationstoretest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the compressed correlation store
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "storage/compressedcorrelationstore.h"
+#include "storage/correlationstore.h"
+#include "storage/precomputeddata.h"
+#include "symmetricmatrix.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Testing {
+
+namespace {
+
+/// Correlations of a grid that change smoothly with the distance of the points, some of them negative
+VCGL::SymmetricMatrix<float> smoothMatrix(size_t nlat, size_t nlon) {
+	return gridCorrelations(nlat, nlon, 0.15);
+}
+
+long fileSize(const std::string& fileName) {
+	struct stat info;
+	return stat(fileName.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : -1;
+}
+
+} // namespace
+
+TEST(ReadsBackWithinQuantization, CompressedCorrelationStore)
+{
+	const std::string fileName = "test-corr-compressed.bin";
+	const VCGL::SymmetricMatrix<float> matrix = smoothMatrix(9, 11);
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 9, 11, fileName));
+
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(fileName);
+	CHECK(dynamic_cast<const VCGL::CompressedCorrelationStore*>(pStore.get()) != 0);
+	LONGS_EQUAL(99, pStore->pointCount());
+
+	std::vector<float> row(99);
+	for (size_t i = 0; i<99; i++) {
+		pStore->row(i, row.data());
+		for (size_t j = 0; j<99; j++) {
+			DOUBLES_EQUAL(matrix(i, j), row[j], 0.0005 + 1e-6);
+			CHECK(pStore->value(i, j) == row[j]);
+		}
+	}
+
+	// the minima of the table are exact
+	VCGL::CorrelationTriangleStore reference{ VCGL::SymmetricMatrix<float>(matrix) };
+	for (size_t i = 0; i<99; i++) {
+		float expectedMin = 0.0f, actualMin = 0.0f;
+		size_t expectedIndex = 0, actualIndex = 0;
+		reference.rowMinimum(i, &expectedMin, &expectedIndex);
+		pStore->rowMinimum(i, &actualMin, &actualIndex);
+		CHECK(expectedMin == actualMin);
+		LONGS_EQUAL(expectedIndex, actualIndex);
+	}
+	unlink(fileName.c_str());
+}
+
+TEST(KeepsFewDecodedChunks, CompressedCorrelationStore)
+{
+	const std::string fileName = "test-corr-compressed-cache.bin";
+	// 300 points: 218 rows per chunk, two chunks
+	const VCGL::SymmetricMatrix<float> matrix = smoothMatrix(15, 20);
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 15, 20, fileName));
+
+	VCGL::MappedFile file;
+	CHECK(file.map(fileName));
+	VCGL::CompressedCorrelationFileHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	LONGS_EQUAL(2, header.chunkCount);
+	VCGL::CompressedCorrelationStore store(std::move(file), header, 1);
+
+	// minima need no decoding
+	float minCorr = 0.0f;
+	size_t minIndex = 0;
+	store.rowMinimum(299, &minCorr, &minIndex);
+	LONGS_EQUAL(0, store.decodedChunkCount());
+
+	store.value(0, 5);
+	store.value(217, 5);
+	LONGS_EQUAL(1, store.decodedChunkCount());
+	store.value(218, 5);
+	LONGS_EQUAL(2, store.decodedChunkCount());
+	// the first chunk was dropped for the second one
+	store.value(1, 5);
+	LONGS_EQUAL(3, store.decodedChunkCount());
+	DOUBLES_EQUAL(matrix(1, 5), store.value(1, 5), 0.0005 + 1e-6);
+	DOUBLES_EQUAL(matrix(250, 12), store.value(250, 12), 0.0005 + 1e-6);
+	unlink(fileName.c_str());
+}
+
+TEST(SmallerThanTriangle, CompressedCorrelationStore)
+{
+	const std::string triangleName = "test-corr-compressed-triangle.bin";
+	const std::string compressedName = "test-corr-compressed-size.bin";
+	const VCGL::SymmetricMatrix<float> matrix = smoothMatrix(20, 30);
+	CHECK(storeCorrelationsVersioned(matrix, 20, 30, triangleName));
+	// a slab of a few chunks at a time gives the same file
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 20, 30, compressedName, VCGL::GridSubsetRecord::whole(), 256*1024));
+
+	const long triangleBytes = fileSize(triangleName);
+	const long compressedBytes = fileSize(compressedName);
+	CHECK(triangleBytes > 0 && compressedBytes > 0);
+	CHECK(compressedBytes < triangleBytes*6/10);
+
+	const std::string wholeName = "test-corr-compressed-whole.bin";
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 20, 30, wholeName));
+	std::ifstream a(compressedName.c_str(), std::ios::binary), b(wholeName.c_str(), std::ios::binary);
+	const std::string sliced((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+	const std::string whole((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+	CHECK(sliced == whole);
+
+	unlink(triangleName.c_str());
+	unlink(compressedName.c_str());
+	unlink(wholeName.c_str());
+}
+
+TEST(RecordsSubset, CompressedCorrelationStore)
+{
+	const std::string fileName = "test-corr-compressed-subset.bin";
+	VCGL::GridSubsetRecord subset = VCGL::GridSubsetRecord::whole();
+	subset.latStart = 4;
+	subset.lonStride = 3;
+	subset.timeCount = 50;
+	CHECK(VCGL::storeCorrelationsCompressed(smoothMatrix(2, 3).view(), 2, 3, fileName, subset));
+
+	VCGL::GridSubsetRecord read;
+	CHECK(VCGL::readGridSubset(fileName, read));
+	LONGS_EQUAL(4, read.latStart);
+	LONGS_EQUAL(3, read.lonStride);
+	LONGS_EQUAL(50, read.timeCount);
+	unlink(fileName.c_str());
+}
+
+TEST(RejectsDamagedFiles, CompressedCorrelationStore)
+{
+	const std::string fileName = "test-corr-compressed-damaged.bin";
+	const VCGL::SymmetricMatrix<float> matrix = smoothMatrix(4, 5);
+
+	// a file that was not completed
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 4, 5, fileName));
+	{
+		std::fstream file(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(8);
+		const std::uint32_t version = 0;
+		file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	}
+	CHECK(!VCGL::openCorrelationStore(fileName));
+
+	// a truncated file
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 4, 5, fileName));
+	CHECK(truncate(fileName.c_str(), fileSize(fileName) - 1) == 0);
+	CHECK(!VCGL::openCorrelationStore(fileName));
+
+	// a chunk index pointing out of order
+	CHECK(VCGL::storeCorrelationsCompressed(matrix.view(), 4, 5, fileName));
+	{
+		std::fstream file(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(sizeof(VCGL::CompressedCorrelationFileHeader) + sizeof(VCGL::GridSubsetRecord)
+				+ 20*(sizeof(float) + sizeof(std::uint32_t)));
+		const std::uint64_t offset = 1;
+		file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+	}
+	CHECK(!VCGL::openCorrelationStore(fileName));
+	unlink(fileName.c_str());
+}
+
+} // namespace Testing
@@ -0,0 +1,303 @@
+/*! @file correlationencodingtest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the correlations stored as half precision and fixed point
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "storage/correlationencoding.h"
+#include "storage/correlationstore.h"
+#include "storage/precomputeddata.h"
+#include "symmetricmatrix.h"
+
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Testing {
+
+namespace {
+
+const VCGL::CorrelationDataType encodedTypes[] = { VCGL::CORRELATION_FLOAT16, VCGL::CORRELATION_INT16, VCGL::CORRELATION_INT8 };
+
+/// Correlations of a grid falling with the distance of the points to negative values
+VCGL::SymmetricMatrix<float> distanceMatrix(size_t nlat, size_t nlon) {
+	return gridCorrelations(nlat, nlon, 0.37, 0.001);
+}
+
+long fileSize(const std::string& fileName) {
+	struct stat info;
+	return stat(fileName.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : -1;
+}
+
+} // namespace
+
+TEST(RoundTripWithinError, CorrelationEncoding)
+{
+	std::vector<float> values;
+	for (int k = -1000; k<=1000; k++) {
+		values.push_back(k / 1000.0f);
+	}
+	values.push_back(0.99999f);
+	values.push_back(-0.33333f);
+	std::vector<float> decoded(values.size());
+
+	for (VCGL::CorrelationDataType dtype: encodedTypes) {
+		std::vector<unsigned char> encoded(values.size()*VCGL::correlationValueSize(dtype));
+		VCGL::QuantizationError error;
+		VCGL::encodeCorrelations(dtype, values.data(), values.size(), encoded.data(), &error);
+		VCGL::decodeCorrelations(dtype, encoded.data(), values.size(), decoded.data());
+
+		const double bound = VCGL::correlationEncodingError(dtype);
+		double maxError = 0.0;
+		for (size_t j = 0; j<values.size(); j++) {
+			DOUBLES_EQUAL(values[j], decoded[j], bound*1.0001);
+			CHECK(decoded[j] == VCGL::decodeCorrelation(dtype, encoded.data(), j));
+			maxError = std::max(maxError, std::fabs(double(decoded[j]) - values[j]));
+		}
+		DOUBLES_EQUAL(maxError, error.maxError, 1e-12);
+		CHECK(error.count == values.size());
+		CHECK(error.rms() > 0.0 && error.rms() <= error.maxError);
+	}
+
+	// the ends of the range are exact
+	for (VCGL::CorrelationDataType dtype: encodedTypes) {
+		const float ends[] = { -1.0f, 0.0f, 1.0f };
+		unsigned char encoded[3*sizeof(std::uint16_t)];
+		float decoded[3];
+		VCGL::encodeCorrelations(dtype, ends, 3, encoded);
+		VCGL::decodeCorrelations(dtype, encoded, 3, decoded);
+		CHECK(decoded[0] == -1.0f && decoded[1] == 0.0f && decoded[2] == 1.0f);
+	}
+}
+
+TEST(FixedPointClampsAndZeroesNaN, CorrelationEncoding)
+{
+	const float values[] = { 1.5f, -2.0f, std::numeric_limits<float>::quiet_NaN() };
+	std::int16_t q16[3];
+	VCGL::encodeCorrelations(VCGL::CORRELATION_INT16, values, 3, q16);
+	LONGS_EQUAL(32767, q16[0]);
+	LONGS_EQUAL(-32767, q16[1]);
+	LONGS_EQUAL(0, q16[2]);
+
+	std::int8_t q8[3];
+	VCGL::encodeCorrelations(VCGL::CORRELATION_INT8, values, 3, q8);
+	LONGS_EQUAL(127, q8[0]);
+	LONGS_EQUAL(-127, q8[1]);
+	LONGS_EQUAL(0, q8[2]);
+}
+
+TEST(HalfPrecisionSpecialValues, CorrelationEncoding)
+{
+	LONGS_EQUAL(0x0000, VCGL::floatToHalf(0.0f));
+	LONGS_EQUAL(0x8000, VCGL::floatToHalf(-0.0f));
+	LONGS_EQUAL(0x3c00, VCGL::floatToHalf(1.0f));
+	LONGS_EQUAL(0xbc00, VCGL::floatToHalf(-1.0f));
+	LONGS_EQUAL(0x7bff, VCGL::floatToHalf(65504.0f));
+	LONGS_EQUAL(0x7c00, VCGL::floatToHalf(1e6f));
+	LONGS_EQUAL(0xfc00, VCGL::floatToHalf(-std::numeric_limits<float>::infinity()));
+	// smallest subnormal, and half of it rounding to even (zero)
+	LONGS_EQUAL(0x0001, VCGL::floatToHalf(std::ldexp(1.0f, -24)));
+	LONGS_EQUAL(0x0000, VCGL::floatToHalf(std::ldexp(1.0f, -25)));
+	// ties between two halves round to the even one
+	LONGS_EQUAL(0x3c00, VCGL::floatToHalf(1.0f + std::ldexp(1.0f, -11)));
+	LONGS_EQUAL(0x3c02, VCGL::floatToHalf(1.0f + 3*std::ldexp(1.0f, -11)));
+
+	const float nan = VCGL::halfToFloat(VCGL::floatToHalf(std::numeric_limits<float>::quiet_NaN()));
+	CHECK(nan != nan);
+	CHECK(VCGL::halfToFloat(0x7c00) == std::numeric_limits<float>::infinity());
+	CHECK(VCGL::halfToFloat(0x0001) == std::ldexp(1.0f, -24));
+	CHECK(VCGL::halfToFloat(0x03ff) == std::ldexp(1023.0f, -24));
+
+	// every finite half converts back to itself
+	bool allSame = true;
+	for (std::uint32_t bits = 0; bits<0x10000u; bits++) {
+		if ((bits & 0x7c00u) != 0x7c00u) {
+			allSame = allSame && VCGL::floatToHalf(VCGL::halfToFloat(static_cast<std::uint16_t>(bits))) == bits;
+		}
+	}
+	CHECK(allSame);
+}
+
+TEST(DecodersAgreeWithScalar, CorrelationEncoding)
+{
+	std::vector<std::uint16_t> halves;
+	std::vector<std::int16_t> q16;
+	std::vector<std::int8_t> q8;
+	for (int k = 0; k<67; k++) {
+		halves.push_back(VCGL::floatToHalf(std::sin(0.7f*k)));
+		q16.push_back(static_cast<std::int16_t>(k*977 - 32000));
+		q8.push_back(static_cast<std::int8_t>(k*3 - 100));
+	}
+
+	const std::vector<const VCGL::CorrelationDecoder*> decoders = VCGL::availableCorrelationDecoders();
+	CHECK(!decoders.empty());
+	CHECK(0 == strcmp("scalar", decoders.front()->name));
+	const VCGL::CorrelationDecoder& scalar = *decoders.front();
+	for (const VCGL::CorrelationDecoder* pDecoder: decoders) {
+		// every length, to cover the tails after the vectors
+		for (size_t count = 0; count<=halves.size(); count++) {
+			std::vector<float> expected(count + 1, -7.0f), actual(count + 1, -7.0f);
+			scalar.fromFloat16(halves.data(), count, expected.data());
+			pDecoder->fromFloat16(halves.data(), count, actual.data());
+			CHECK(memcmp(expected.data(), actual.data(), (count + 1)*sizeof(float)) == 0);
+
+			scalar.fromInt16(q16.data(), count, expected.data());
+			pDecoder->fromInt16(q16.data(), count, actual.data());
+			CHECK(memcmp(expected.data(), actual.data(), (count + 1)*sizeof(float)) == 0);
+
+			scalar.fromInt8(q8.data(), count, expected.data());
+			pDecoder->fromInt8(q8.data(), count, actual.data());
+			CHECK(memcmp(expected.data(), actual.data(), (count + 1)*sizeof(float)) == 0);
+		}
+	}
+}
+
+TEST(StoredTrianglesReadBack, CorrelationEncoding)
+{
+	const std::string floatName = "test-corr-encoded-float.bin";
+	const std::string fileName = "test-corr-encoded.bin";
+	const VCGL::SymmetricMatrix<float> matrix = distanceMatrix(7, 9);
+	CHECK(storeCorrelationsVersioned(matrix, 7, 9, floatName));
+	const long floatBytes = fileSize(floatName);
+	VCGL::CorrelationTriangleStore reference{ VCGL::SymmetricMatrix<float>(matrix) };
+
+	for (VCGL::CorrelationDataType dtype: encodedTypes) {
+		VCGL::QuantizationError error;
+		CHECK(storeCorrelationsVersioned(matrix, 7, 9, fileName, VCGL::GridSubsetRecord::whole(), dtype, &error));
+		CHECK(error.count == VCGL::triangleOffset(63));
+		CHECK(error.maxError <= VCGL::correlationEncodingError(dtype)*1.0001);
+		// the header and the subset record stay, the values shrink
+		CHECK(fileSize(fileName) - 128 == (floatBytes - 128)*static_cast<long>(VCGL::correlationValueSize(dtype))/4);
+
+		std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(fileName);
+		const VCGL::QuantizedTriangleStore* pQuantized = dynamic_cast<const VCGL::QuantizedTriangleStore*>(pStore.get());
+		CHECK(pQuantized != 0);
+		CHECK(pQuantized->isMapped());
+		CHECK(pQuantized->checksumMatches());
+		CHECK(pQuantized->dataType() == dtype);
+		LONGS_EQUAL(63, pStore->pointCount());
+
+		VCGL::SymmetricMatrix<float> read;
+		readCorrelationTriangle(fileName, read, true);
+		LONGS_EQUAL(63, read.size());
+
+		std::vector<float> row(63);
+		for (size_t i = 0; i<63; i++) {
+			pStore->row(i, row.data());
+			for (size_t j = 0; j<63; j++) {
+				DOUBLES_EQUAL(matrix(i, j), row[j], VCGL::correlationEncodingError(dtype)*1.0001);
+				CHECK(pStore->value(i, j) == row[j]);
+				CHECK(read(i, j) == row[j]);
+			}
+
+			// the minimum of the decoded row
+			float minCorr = 0.0f;
+			size_t minIndex = 0;
+			pStore->rowMinimum(i, &minCorr, &minIndex);
+			float expectedMin = 2.0f;
+			size_t expectedIndex = 0;
+			for (size_t j = 0; j<63; j++) {
+				if (j != i && row[j] < expectedMin) {
+					expectedMin = row[j];
+					expectedIndex = j;
+				}
+			}
+			CHECK(minCorr == expectedMin);
+			LONGS_EQUAL(expectedIndex, minIndex);
+		}
+	}
+	unlink(floatName.c_str());
+	unlink(fileName.c_str());
+}
+
+TEST(DamagedEncodedTriangle, CorrelationEncoding)
+{
+	const std::string fileName = "test-corr-encoded-damaged.bin";
+	CHECK(storeCorrelationsVersioned(distanceMatrix(3, 4), 3, 4, fileName, VCGL::GridSubsetRecord::whole(), VCGL::CORRELATION_INT8));
+	{
+		std::fstream file(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(128 + 5);
+		const char value = 99;
+		file.write(&value, 1);
+	}
+	CHECK(!VCGL::openCorrelationStore(fileName));
+
+	// a file one value short
+	CHECK(storeCorrelationsVersioned(distanceMatrix(3, 4), 3, 4, fileName, VCGL::GridSubsetRecord::whole(), VCGL::CORRELATION_INT16));
+	CHECK(truncate(fileName.c_str(), fileSize(fileName) - 2) == 0);
+	CHECK(!VCGL::openCorrelationStore(fileName));
+	unlink(fileName.c_str());
+}
+
+TEST(WriterResumesEncoded, CorrelationEncoding)
+{
+	const std::string wholeName = "test-corr-encoded-whole.bin";
+	const std::string resumedName = "test-corr-encoded-resumed.bin";
+	const VCGL::SymmetricMatrix<float> matrix = distanceMatrix(3, 5);
+	const float* values = matrix.data();
+	const size_t n = 15;
+
+	{
+		VCGL::CorrelationTriangleWriter writer(wholeName, 3, 5, VCGL::GridSubsetRecord::whole(), VCGL::CORRELATION_INT16);
+		writer.consumeRows(0, n, values);
+		CHECK(writer.quantizationError().count == VCGL::triangleOffset(n));
+		CHECK(writer.close());
+	}
+	{
+		VCGL::CorrelationTriangleWriter writer(resumedName, 3, 5, VCGL::GridSubsetRecord::whole(), VCGL::CORRELATION_INT16);
+		writer.consumeRows(0, 9, values);
+		CHECK(writer.flush());
+	}
+	{
+		// a file of another type is not continued
+		VCGL::CorrelationTriangleWriter otherType(resumedName, 3, 5, VCGL::GridSubsetRecord::whole(), 6, 0,
+				VCGL::CORRELATION_INT8);
+		CHECK(!otherType.good());
+	}
+	{
+		VCGL::CorrelationTriangleWriter writer(resumedName, 3, 5, VCGL::GridSubsetRecord::whole(), 6, 0,
+				VCGL::CORRELATION_INT16);
+		CHECK(writer.good());
+		writer.consumeRows(6, n, values + VCGL::triangleOffset(6));
+		CHECK(writer.close());
+	}
+
+	std::ifstream a(wholeName.c_str(), std::ios::binary), b(resumedName.c_str(), std::ios::binary);
+	const std::string whole((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+	const std::string resumed((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+	CHECK(whole == resumed);
+	unlink(wholeName.c_str());
+	unlink(resumedName.c_str());
+}
+
+TEST(InMemoryStore, CorrelationEncoding)
+{
+	const VCGL::SymmetricMatrix<float> matrix = distanceMatrix(4, 6);
+	for (VCGL::CorrelationDataType dtype: encodedTypes) {
+		VCGL::QuantizedTriangleStore store(matrix.view(), dtype);
+		CHECK(!store.isMapped());
+		LONGS_EQUAL(24, store.pointCount());
+		std::vector<float> row(24);
+		for (size_t i = 0; i<24; i++) {
+			store.row(i, row.data());
+			CHECK(row[i] == 1.0f);
+			for (size_t j = 0; j<24; j++) {
+				DOUBLES_EQUAL(matrix(i, j), row[j], VCGL::correlationEncodingError(dtype)*1.0001);
+				CHECK(store.value(i, j) == row[j]);
+			}
+		}
+	}
+}
+
+} // namespace Testing
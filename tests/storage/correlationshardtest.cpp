@@ -0,0 +1,170 @@
+/*! @file correlationshardtest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the shards of the correlation triangle
+ */
+
+#include "CppUnitLite/TestHarness.h"
+
+#include "storage/correlationshard.h"
+#include "symmetricmatrix.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace Testing {
+
+namespace {
+
+/// Triangle with a distinct value for every pair
+std::vector<float> makeTriangle(size_t npoints) {
+	std::vector<float> values(VCGL::triangleOffset(npoints));
+	for (size_t x = 0; x<npoints; x++) {
+		for (size_t y = 0; y<x; y++) {
+			values[VCGL::triangleOffset(x) + y] = static_cast<float>(x*1000 + y);
+		}
+	}
+	return values;
+}
+
+/// Rows passed to a consumer, packed as in the triangle
+struct TriangleCollector: public VCGL::CorrelationRowConsumer {
+	std::vector<float> values;
+	size_t nextRow;
+	bool inOrder;
+
+	explicit TriangleCollector(size_t firstRow): nextRow(firstRow), inOrder(true) {}
+
+	virtual void consumeRows(size_t rowBegin, size_t rowEnd, const float* rowValues) override {
+		inOrder = inOrder && (rowBegin == nextRow);
+		values.insert(values.end(), rowValues, rowValues + VCGL::triangleOffset(rowEnd) - VCGL::triangleOffset(rowBegin));
+		nextRow = rowEnd;
+	}
+};
+
+/// Write all shards of the triangle, false if any of them failed
+bool writeShards(const std::string& prefix, size_t nlat, size_t nlon, unsigned count, const std::string& key) {
+	const std::vector<float> triangle = makeTriangle(nlat*nlon);
+	bool bOk = true;
+	for (unsigned i = 0; i<count; i++) {
+		VCGL::CorrelationShardWriter writer(VCGL::correlationShardFileName(prefix, i), nlat, nlon,
+				VCGL::GridSubsetRecord::whole(), key, i, count);
+		// two blocks where there are rows enough
+		const size_t middle = (writer.rowBegin() + writer.rowEnd()) / 2;
+		writer.consumeRows(writer.rowBegin(), middle, &triangle[VCGL::triangleOffset(writer.rowBegin())]);
+		writer.consumeRows(middle, writer.rowEnd(), &triangle[VCGL::triangleOffset(middle)]);
+		bOk = writer.close() && bOk;
+	}
+	return bOk;
+}
+
+void removeShards(const std::string& prefix, unsigned count) {
+	for (unsigned i = 0; i<count; i++) {
+		unlink(VCGL::correlationShardFileName(prefix, i).c_str());
+	}
+}
+
+} // namespace
+
+TEST(RowRangesCoverTriangle, CorrelationShard)
+{
+	const size_t sizes[] = { 0, 1, 2, 7, 100, 1001 };
+	const unsigned counts[] = { 1, 2, 3, 8, 64 };
+	for (size_t npoints: sizes) {
+		for (unsigned count: counts) {
+			const unsigned long long total = VCGL::triangleOffset(npoints);
+			size_t previousEnd = 0;
+			for (unsigned i = 0; i<count; i++) {
+				size_t rowBegin = 0, rowEnd = 0;
+				VCGL::shardRowRange(npoints, count, i, &rowBegin, &rowEnd);
+				LONGS_EQUAL(previousEnd, rowBegin);
+				CHECK(rowEnd >= rowBegin);
+				// balanced up to one row
+				const unsigned long long pairs = VCGL::triangleOffset(rowEnd) - VCGL::triangleOffset(rowBegin);
+				CHECK(pairs <= total/count + npoints);
+				previousEnd = rowEnd;
+			}
+			LONGS_EQUAL(npoints, previousEnd);
+		}
+	}
+}
+
+TEST(MergeReplaysAllRows, CorrelationShard)
+{
+	const std::string prefix = "test-shard";
+	const std::string key = "0123456789abcdef0123456789abcdef";
+	CHECK(writeShards(prefix, 3, 7, 4, key));
+
+	VCGL::CorrelationShardSet shards;
+	CHECK(shards.open(prefix, 3, 7, VCGL::GridSubsetRecord::whole(), key));
+	LONGS_EQUAL(4, shards.shardCount());
+
+	TriangleCollector all(0);
+	CHECK(shards.replay(0, all));
+	CHECK(all.inOrder);
+	LONGS_EQUAL(21, all.nextRow);
+	CHECK(all.values == makeTriangle(21));
+
+	// continued from a row within a shard
+	TriangleCollector continued(13);
+	CHECK(shards.replay(13, continued));
+	CHECK(continued.inOrder);
+	LONGS_EQUAL(21, continued.nextRow);
+	const std::vector<float> triangle = makeTriangle(21);
+	CHECK(continued.values == std::vector<float>(triangle.begin() + VCGL::triangleOffset(13), triangle.end()));
+
+	// shards of other data or of another grid
+	CHECK(!shards.open(prefix, 3, 7, VCGL::GridSubsetRecord::whole(), "fedcba9876543210fedcba9876543210"));
+	CHECK(!shards.open(prefix, 7, 3, VCGL::GridSubsetRecord::whole(), key));
+	VCGL::GridSubsetRecord strided = VCGL::GridSubsetRecord::whole();
+	strided.latStride = 2;
+	CHECK(!shards.open(prefix, 3, 7, strided, key));
+	removeShards(prefix, 4);
+}
+
+TEST(MergeChecksShards, CorrelationShard)
+{
+	const std::string prefix = "test-shard-check";
+	const std::string key = "0123456789abcdef0123456789abcdef";
+	VCGL::CorrelationShardSet shards;
+
+	// a missing shard
+	CHECK(writeShards(prefix, 4, 5, 3, key));
+	unlink(VCGL::correlationShardFileName(prefix, 1).c_str());
+	CHECK(!shards.open(prefix, 4, 5, VCGL::GridSubsetRecord::whole(), key));
+
+	// a shard of another split
+	CHECK(writeShards(prefix + "-other", 4, 5, 2, key));
+	CHECK(rename(VCGL::correlationShardFileName(prefix + "-other", 1).c_str(),
+			VCGL::correlationShardFileName(prefix, 1).c_str()) == 0);
+	CHECK(!shards.open(prefix, 4, 5, VCGL::GridSubsetRecord::whole(), key));
+	removeShards(prefix + "-other", 2);
+
+	// an incomplete shard
+	CHECK(writeShards(prefix, 4, 5, 3, key));
+	{
+		VCGL::CorrelationShardWriter unfinished(VCGL::correlationShardFileName(prefix, 2), 4, 5,
+				VCGL::GridSubsetRecord::whole(), key, 2, 3);
+		CHECK(!unfinished.close());
+	}
+	CHECK(!shards.open(prefix, 4, 5, VCGL::GridSubsetRecord::whole(), key));
+
+	// a damaged value is found by the replay
+	CHECK(writeShards(prefix, 4, 5, 3, key));
+	{
+		std::fstream file(VCGL::correlationShardFileName(prefix, 1).c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(sizeof(VCGL::CorrelationShardHeader) + sizeof(VCGL::GridSubsetRecord));
+		const float damaged = -2.0f;
+		file.write(reinterpret_cast<const char*>(&damaged), sizeof(damaged));
+	}
+	CHECK(shards.open(prefix, 4, 5, VCGL::GridSubsetRecord::whole(), key));
+	TriangleCollector all(0);
+	CHECK(!shards.replay(0, all));
+	removeShards(prefix, 3);
+}
+
+} // namespace Testing
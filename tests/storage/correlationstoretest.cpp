@@ -0,0 +1,155 @@
+/*! @file correlationstoretest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for reading correlations through CorrelationStore
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+#include "typedefs.h"
+
+#include "storage/correlationstore.h"
+#include "storage/precomputeddata.h"
+
+#include <fstream>
+#include <memory>
+
+namespace Testing {
+
+namespace {
+	const std::vector< std::vector<float> > testCorrelations = sixPointCorrelations();
+	const VCGL::SymmetricMatrix<float> testMatrix = symmetricFromSquare(testCorrelations);
+
+	/// Full matrix read from the store row by row
+	std::vector< std::vector<float> > rowsOf(const VCGL::CorrelationStore& store) {
+		std::vector< std::vector<float> > result(store.pointCount(), std::vector<float>(store.pointCount()));
+		for (size_t i=0; i<result.size(); i++) {
+			store.row(i, result[i].data());
+		}
+		return result;
+	}
+
+	/// Full matrix read from the store value by value
+	std::vector< std::vector<float> > valuesOf(const VCGL::CorrelationStore& store) {
+		std::vector< std::vector<float> > result(store.pointCount(), std::vector<float>(store.pointCount()));
+		for (size_t i=0; i<result.size(); i++) {
+			for (size_t j=0; j<result.size(); j++) {
+				result[i][j] = store.value(i, j);
+			}
+		}
+		return result;
+	}
+}
+
+TEST(VersionedFileIsMapped, CorrelationStore)
+{
+	const std::string corrFileName = "test-corr-versioned.bin";
+	CHECK(storeCorrelationsVersioned(testMatrix, 2, 3, corrFileName));
+
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(corrFileName);
+	CHECK(pStore.get() != 0);
+	const VCGL::CorrelationTriangleStore* pTriangle = dynamic_cast<const VCGL::CorrelationTriangleStore*>(pStore.get());
+	CHECK(pTriangle != 0 && pTriangle->isMapped());
+	CHECK(pTriangle->checksumMatches());
+	CHECK_EQUAL(testCorrelations, rowsOf(*pStore));
+	CHECK_EQUAL(testCorrelations, valuesOf(*pStore));
+
+	// the old reader understands the new format as well
+	VCGL::SymmetricMatrix<float> correlationsIn;
+	readCorrelationTriangle(corrFileName, correlationsIn);
+	CHECK_EQUAL(testMatrix, correlationsIn);
+}
+
+TEST(LegacyFileIsLoaded, CorrelationStore)
+{
+	const std::string corrFileName = "test-corr-legacy.bin";
+	storeCorrelationsTriangle(testMatrix, corrFileName);
+
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(corrFileName);
+	CHECK(pStore.get() != 0);
+	const VCGL::CorrelationTriangleStore* pTriangle = dynamic_cast<const VCGL::CorrelationTriangleStore*>(pStore.get());
+	CHECK(pTriangle != 0 && !pTriangle->isMapped());
+	CHECK_EQUAL(testCorrelations, rowsOf(*pStore));
+	CHECK_EQUAL(testCorrelations, valuesOf(*pStore));
+}
+
+TEST(RowMinimumTakesFirstIndex, CorrelationStore)
+{
+	const std::string corrFileName = "test-corr-versioned.bin";
+	CHECK(storeCorrelationsVersioned(testMatrix, 2, 3, corrFileName));
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(corrFileName);
+
+	float minCorr = 0.0f;
+	size_t minIndex = 0;
+	pStore->rowMinimum(2, &minCorr, &minIndex);
+	DOUBLES_EQUAL(-0.6, minCorr, 1e-6);
+	LONGS_EQUAL(5, minIndex);
+	pStore->rowMinimum(5, &minCorr, &minIndex);
+	DOUBLES_EQUAL(-0.6, minCorr, 1e-6);
+	LONGS_EQUAL(1, minIndex);
+}
+
+TEST(CorruptedFileIsRejected, CorrelationStore)
+{
+	const std::string corrFileName = "test-corr-corrupted.bin";
+	CHECK(storeCorrelationsVersioned(testMatrix, 2, 3, corrFileName));
+
+	// flip one value: the header is still valid, the checksum is not
+	{
+		std::fstream f(corrFileName, std::ios::in | std::ios::out | std::ios::binary);
+		const float changed = 0.5f;
+		f.seekp(sizeof(VCGL::CorrelationFileHeader) + sizeof(VCGL::GridSubsetRecord));
+		f.write(reinterpret_cast<const char*>(&changed), sizeof(float));
+	}
+	CHECK(!VCGL::openCorrelationStore(corrFileName));
+
+	// unknown version
+	{
+		std::fstream f(corrFileName, std::ios::in | std::ios::out | std::ios::binary);
+		const uint32_t version = 99;
+		f.seekp(8);
+		f.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	}
+	CHECK(VCGL::openCorrelationStore(corrFileName).get() == 0);
+}
+
+TEST(GridSubsetIsStoredInHeader, CorrelationStore)
+{
+	VCGL::GridSubsetRecord subset = VCGL::GridSubsetRecord::whole();
+	subset.latStart = 4;
+	subset.latStride = 2;
+	subset.lonStart = 140;
+	subset.lonStride = 2;
+	subset.timeStart = 10;
+	subset.timeCount = 20;
+	subset.timeStride = 3;
+
+	const std::string corrFileName = "test-corr-subset.bin";
+	CHECK(storeCorrelationsVersioned(testMatrix, 2, 3, corrFileName, subset));
+	VCGL::GridSubsetRecord stored;
+	std::size_t nlat = 0;
+	std::size_t nlon = 0;
+	CHECK(VCGL::readGridSubset(corrFileName, stored, &nlat, &nlon));
+	LONGS_EQUAL(2, nlat);
+	LONGS_EQUAL(3, nlon);
+	LONGS_EQUAL(4, stored.latStart);
+	LONGS_EQUAL(140, stored.lonStart);
+	LONGS_EQUAL(2, stored.lonStride);
+	LONGS_EQUAL(20, stored.timeCount);
+	LONGS_EQUAL(3, stored.timeStride);
+
+	// the values follow the record
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(corrFileName);
+	CHECK(pStore.get() != 0);
+	DOUBLES_EQUAL(testMatrix(4, 1), pStore->value(4, 1), 0.0);
+
+	// files without a record are of the whole data
+	const std::string legacyFileName = "test-corr-legacy-subset.bin";
+	storeCorrelationsTriangle(testMatrix, legacyFileName);
+	CHECK(!VCGL::readGridSubset(legacyFileName, stored));
+	LONGS_EQUAL(1, stored.latStride);
+	LONGS_EQUAL(0, stored.timeCount);
+}
+
+} // namespace Testing
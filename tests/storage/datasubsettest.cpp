@@ -0,0 +1,154 @@
+/*! @file datasubsettest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the selection of a region, time range and grid stride
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "storage/datasubset.h"
+#include "storage/tcstorage.h"
+
+namespace Testing {
+
+namespace {
+
+/// 8 longitudes 0..315, 5 latitudes -60..60, value = 100*lat + 10*lon + time
+class GridDataStorage: public VCGL::DataStorage {
+public:
+	virtual std::size_t getNTime() override { return 6; }
+	virtual std::size_t getNLon() override { return 8; }
+	virtual std::size_t getNLat() override { return 5; }
+	virtual std::vector<float> loadLons() override {
+		return { 0.0f, 45.0f, 90.0f, 135.0f, 180.0f, 225.0f, 270.0f, 315.0f };
+	}
+	virtual std::vector<float> loadLats() override { return { -60.0f, -30.0f, 0.0f, 30.0f, 60.0f }; }
+	virtual VCGL::TimeSeriesField loadData(std::size_t latStart, std::size_t latCount) override {
+		return loadData(latStart, latCount, 0, getNTime());
+	}
+	virtual VCGL::TimeSeriesField loadData(std::size_t latStart, std::size_t latCount,
+			std::size_t timeStart, std::size_t timeCount) override {
+		VCGL::TimeSeriesField data(latCount, getNLon(), timeCount);
+		for (size_t lat=0; lat<latCount; lat++) {
+			for (size_t lon=0; lon<getNLon(); lon++) {
+				for (size_t t=0; t<timeCount; t++) {
+					data(lat, lon, t) = 100.0f*(latStart+lat) + 10.0f*lon + (timeStart+t);
+				}
+			}
+		}
+		return data;
+	}
+};
+
+} // namespace
+
+TEST(ParseOptions, DataSubset)
+{
+	VCGL::DataSubset subset;
+	CHECK(subset.isWhole());
+	CHECK(subset.fileNameTag().empty());
+
+	CHECK(subset.parseBox("-20.5,40,30,70"));
+	DOUBLES_EQUAL(-20.5, subset.lonFirst, 0.0);
+	DOUBLES_EQUAL(70.0, subset.latLast, 0.0);
+	CHECK(!subset.parseBox("0,10,50,40"));
+	CHECK(!subset.parseBox("0,10,50"));
+	CHECK(!subset.parseBox("0,10,50,60,"));
+
+	CHECK(subset.parseTime("12:"));
+	LONGS_EQUAL(12, subset.timeStart);
+	LONGS_EQUAL(0, subset.timeEnd);
+	CHECK(subset.parseTime("10:100:2"));
+	LONGS_EQUAL(100, subset.timeEnd);
+	LONGS_EQUAL(2, subset.timeStride);
+	CHECK(!subset.parseTime("10:5"));
+	CHECK(!subset.parseTime("0:10:0"));
+	CHECK(!subset.parseTime("a"));
+
+	CHECK(subset.parseGridStride("3"));
+	CHECK(!subset.parseGridStride("0"));
+
+	CHECK(!subset.isWhole());
+	CHECK(subset.fileNameTag() == "_boxm20.5-40_30-70_t10-100s2_g3");
+}
+
+TEST(BoxAcrossTheSeam, DataSubset)
+{
+	VCGL::DataSubset subset;
+	CHECK(subset.parseBox("260,50,-30,30"));
+	CHECK(subset.parseTime("1:6:2"));
+
+	VCGL::TCStorage storage(new GridDataStorage(), false, subset);
+	VCGL::GridSelection sel;
+	CHECK(storage.selection(sel));
+	LONGS_EQUAL(1, sel.latStart);
+	LONGS_EQUAL(3, sel.latCount);
+	LONGS_EQUAL(6, sel.lonStart);
+	LONGS_EQUAL(4, sel.lonCount);
+	LONGS_EQUAL(3, sel.timeCount);
+
+	// longitudes keep increasing past the seam
+	std::vector<float> lons, lats;
+	storage.loadGrid(lons, lats);
+	CHECK_EQUAL((std::vector<float>{ 270.0f, 315.0f, 360.0f, 405.0f }), lons);
+	CHECK_EQUAL((std::vector<float>{ -30.0f, 0.0f, 30.0f }), lats);
+
+	VCGL::TimeSeriesField data;
+	storage.loadData(data);
+	LONGS_EQUAL(3, data.nlat());
+	LONGS_EQUAL(4, data.nlon());
+	LONGS_EQUAL(3, data.timeCount());
+	DOUBLES_EQUAL(100.0*1 + 10.0*6 + 1, data(0, 0, 0), 0.0);
+	DOUBLES_EQUAL(100.0*3 + 10.0*1 + 5, data(2, 3, 2), 0.0);
+}
+
+TEST(BoxAroundTheGlobe, DataSubset)
+{
+	// 360 degrees wide from any start: all longitudes, in the order of the file
+	for (const char* box: { "0,360,-30,30", "-180,180,-30,30", "100,500,-30,30" }) {
+		VCGL::DataSubset subset;
+		CHECK(subset.parseBox(box));
+		VCGL::TCStorage storage(new GridDataStorage(), false, subset);
+		VCGL::GridSelection sel;
+		CHECK(storage.selection(sel));
+		LONGS_EQUAL(0, sel.lonStart);
+		LONGS_EQUAL(8, sel.lonCount);
+		LONGS_EQUAL(3, sel.latCount);
+	}
+
+	// narrower boxes as before
+	VCGL::DataSubset subset;
+	CHECK(subset.parseBox("0,359,-30,30"));
+	VCGL::TCStorage storage(new GridDataStorage(), false, subset);
+	VCGL::GridSelection sel;
+	CHECK(storage.selection(sel));
+	LONGS_EQUAL(8, sel.lonCount);
+	CHECK(subset.parseBox("10,350,-30,30"));
+	VCGL::TCStorage narrower(new GridDataStorage(), false, subset);
+	CHECK(narrower.selection(sel));
+	LONGS_EQUAL(1, sel.lonStart);
+	LONGS_EQUAL(7, sel.lonCount);
+}
+
+TEST(GridStrideAndNorthernHemisphere, DataSubset)
+{
+	VCGL::DataSubset subset;
+	CHECK(subset.parseGridStride("2"));
+
+	VCGL::TCStorage storage(new GridDataStorage(), true, subset);
+	std::vector<float> lons, lats;
+	storage.loadGrid(lons, lats);
+	CHECK_EQUAL((std::vector<float>{ 0.0f, 90.0f, 180.0f, 270.0f }), lons);
+	CHECK_EQUAL((std::vector<float>{ 0.0f, 60.0f }), lats);
+
+	VCGL::DataBandReader bands = storage.readBands(0);
+	LONGS_EQUAL(2, bands.bandCount());
+	VCGL::TimeSeriesField band = bands.readBand(1);
+	LONGS_EQUAL(1, band.nlat());
+	LONGS_EQUAL(4, band.nlon());
+	DOUBLES_EQUAL(100.0*4 + 10.0*6 + 3, band(0, 3, 3), 0.0);
+}
+
+} // namespace Testing
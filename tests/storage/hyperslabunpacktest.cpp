@@ -0,0 +1,69 @@
+/*! @file hyperslabunpacktest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the unpacking of NetCDF hyperslabs
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "storage/hyperslabunpack.h"
+
+#include <cmath>
+
+namespace Testing {
+
+TEST(TransposesAndUnpacks, HyperslabUnpack)
+{
+	// sizes not multiple of the tile size
+	const size_t ntime = 70, npoints = 131, stride = 80;
+	std::vector<float> raw(ntime*npoints);
+	for (size_t i=0; i<raw.size(); i++) {
+		raw[i] = static_cast<float>(i % 997);
+	}
+	raw[5*npoints + 7] = -999.0f;
+	raw[69*npoints + 130] = 32767.0f;
+	raw[64*npoints + 64] = NAN;
+	const std::vector<float> missingValues = { -999.0f, 32767.0f };
+
+	std::vector<float> rows(npoints*stride, 0.0f);
+	VCGL::UnpackStatistics statistics;
+	VCGL::unpackHyperslab(raw.data(), ntime, npoints, 0.5f, 100.0f, missingValues,
+			rows.data(), stride, statistics);
+
+	LONGS_EQUAL(3, statistics.missingCount);
+	float expectedMin = HUGE_VALF, expectedMax = -HUGE_VALF;
+	for (size_t t=0; t<ntime; t++) {
+		for (size_t p=0; p<npoints; p++) {
+			const float value = rows[p*stride + t];
+			const float r = raw[t*npoints + p];
+			if (std::isnan(r) || r == -999.0f || r == 32767.0f) {
+				CHECK(std::isnan(value));
+			}
+			else {
+				DOUBLES_EQUAL(r*0.5f + 100.0f, value, 1e-6);
+				expectedMin = std::min(expectedMin, value);
+				expectedMax = std::max(expectedMax, value);
+			}
+		}
+	}
+	// the padding is not touched
+	for (size_t p=0; p<npoints; p++) {
+		for (size_t pad=ntime; pad<stride; pad++) {
+			DOUBLES_EQUAL(0.0, rows[p*stride + pad], 0.0);
+		}
+	}
+	DOUBLES_EQUAL(expectedMin, statistics.dataMin, 0.0);
+	DOUBLES_EQUAL(expectedMax, statistics.dataMax, 0.0);
+
+	VCGL::UnpackStatistics other;
+	other.dataMin = -1.0f;
+	other.missingCount = 2;
+	statistics.merge(other);
+	DOUBLES_EQUAL(-1.0, statistics.dataMin, 0.0);
+	DOUBLES_EQUAL(expectedMax, statistics.dataMax, 0.0);
+	LONGS_EQUAL(5, statistics.missingCount);
+}
+
+} // namespace Testing
@@ -46,11 +46,16 @@ public:
 		return testLats;
 	}
 
-	virtual VCGL::vectorFloat3D loadData(std::size_t latStart, std::size_t latCount) override {
+	virtual VCGL::TimeSeriesField loadData(std::size_t latStart, std::size_t latCount) override {
 		if (latStart == 1 && latCount == 2 && testData.size() == 3) {
-			return (VCGL::vectorFloat3D{ testData[1], testData[2] });
+			return VCGL::TimeSeriesField(VCGL::vectorFloat3D{ testData[1], testData[2] });
 		}
-		return testData;
+		return VCGL::TimeSeriesField(testData);
+	}
+
+	virtual VCGL::TimeSeriesField loadData(std::size_t latStart, std::size_t latCount,
+			std::size_t /*timeStart*/, std::size_t /*timeCount*/) override {
+		return loadData(latStart, latCount);
 	}
 
 	virtual ~TestingDataStorage() {};
@@ -89,9 +94,9 @@ TEST(LoadFullGridData, TCStorage) {
 
 		VCGL::TCStorage storage(td);
 
-		VCGL::vectorFloat3D data;
+		VCGL::TimeSeriesField data;
 		storage.loadData(data);
-		CHECK_EQUAL( (VCGL::vectorFloat3D{
+		CHECK_EQUAL( VCGL::TimeSeriesField(VCGL::vectorFloat3D{
 							{ {1.0}, {2.0}, {3.0}, {4.0} },
 							{ {5.0}, {6.0}, {7.0}, {8.0} },
 							{ {9.0}, {10.0}, {11.0}, {12.0} } }), data );
@@ -127,9 +132,9 @@ TEST(LoadNorthernHemisphereGridDataBasic, TCStorage) {
 
 		VCGL::TCStorage storage(td, true);
 
-		VCGL::vectorFloat3D data;
+		VCGL::TimeSeriesField data;
 		storage.loadData(data);
-		CHECK_EQUAL( (VCGL::vectorFloat3D{
+		CHECK_EQUAL( VCGL::TimeSeriesField(VCGL::vectorFloat3D{
 					{ {5.0}, {6.0}, {7.0}, {8.0} },
 					{ {9.0}, {10.0}, {11.0}, {12.0} } }), data );
 
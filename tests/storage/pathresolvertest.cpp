@@ -12,6 +12,7 @@
 #include "CppUnitLite/TestHarness.h"
 #include <vector>
 #include <string>
+#include <cstdlib>
 
 //#include <iostream>
 
@@ -191,6 +192,46 @@ TEST(findDependentFileWhenGivenHasAbsolutePath, PathResolver) {
 	CHECK_EQUAL(("/cwd/data/extras/file2.txt"), path);
 }
 
+/// Saves an environment variable and restores it when leaving the scope (CppUnitLite has no tearDown)
+class SavedEnvironmentVariable {
+public:
+	explicit SavedEnvironmentVariable(const char* name): name(name), bSet(getenv(name) != 0) {
+		if (bSet) {
+			value = getenv(name);
+		}
+	}
+	~SavedEnvironmentVariable() {
+		if (bSet) {
+			setenv(name, value.c_str(), 1);
+		}
+		else {
+			unsetenv(name);
+		}
+	}
+private:
+	const char* name;
+	bool bSet;
+	std::string value;
+};
+
+TEST(cacheDirFromEnvironmentOrHome, PathResolver) {
+	FakeFileSystem ffs;
+	ffs.home = "/home/user";
+	VCGL::PathResolver pr(ffs);
+
+	const SavedEnvironmentVariable savedXdg("XDG_CACHE_HOME");
+	const SavedEnvironmentVariable savedTelcon("TELCON_CACHE_DIR");
+	unsetenv("XDG_CACHE_HOME");
+	unsetenv("TELCON_CACHE_DIR");
+	CHECK_EQUAL(("/home/user/.cache/telcon-explorer"), pr.getCacheDir());
+
+	setenv("XDG_CACHE_HOME", "/var/cache", 1);
+	CHECK_EQUAL(("/var/cache/telcon-explorer"), pr.getCacheDir());
+
+	setenv("TELCON_CACHE_DIR", "/shared/telcon", 1);
+	CHECK_EQUAL(("/shared/telcon"), pr.getCacheDir());
+}
+
 //test: relative file names
 //implement:
 // resolving relative paths
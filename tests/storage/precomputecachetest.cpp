@@ -0,0 +1,159 @@
+/*! @file precomputecachetest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the cache of precomputed files
+ */
+
+#include "CppUnitLite/TestHarness.h"
+
+#include "storage/precomputecache.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <utime.h>
+
+namespace Testing {
+
+namespace {
+
+/// Fresh directory under /tmp
+std::string makeTempDir() {
+	char pattern[] = "/tmp/telcon-cache-test-XXXXXX";
+	const char* dir = mkdtemp(pattern);
+	return dir ? std::string(dir) : std::string();
+}
+
+void writeText(const std::string& fileName, const std::string& text) {
+	std::ofstream out(fileName.c_str(), std::ios::binary);
+	out << text;
+}
+
+std::string readText(const std::string& fileName) {
+	std::ifstream in(fileName.c_str(), std::ios::binary);
+	std::ostringstream str;
+	str << in.rdbuf();
+	return str.str();
+}
+
+VCGL::PrecomputeCacheKey keyOf(const std::string& dataFile, std::uint64_t maxLag) {
+	VCGL::PrecomputeCacheKey key;
+	key.addDataFile(dataFile);
+	key.add("variable", "air");
+	key.add("maxLag", maxLag);
+	return key;
+}
+
+} // namespace
+
+TEST(KeyDependsOnDataAndParameters, PrecomputeCache)
+{
+	const std::string dir = makeTempDir();
+	CHECK(!dir.empty());
+	writeText(dir + "/a.nc", "CDF header and data");
+	writeText(dir + "/b.nc", "CDF header and other data");
+
+	VCGL::PrecomputeCacheKey missing;
+	CHECK(!missing.addDataFile(dir + "/none.nc"));
+
+	CHECK(keyOf(dir + "/a.nc", 0).hash() == keyOf(dir + "/a.nc", 0).hash());
+	CHECK(keyOf(dir + "/a.nc", 0).hash() != keyOf(dir + "/a.nc", 3).hash());
+	CHECK(keyOf(dir + "/a.nc", 0).hash() != keyOf(dir + "/b.nc", 0).hash());
+	LONGS_EQUAL(32, keyOf(dir + "/a.nc", 0).hash().size());
+
+	// the name of the data file does not matter
+	const VCGL::PrecomputeCacheKey before = keyOf(dir + "/a.nc", 0);
+	CHECK(rename((dir + "/a.nc").c_str(), (dir + "/renamed.nc").c_str()) == 0);
+	CHECK(before.description() == keyOf(dir + "/renamed.nc", 0).description());
+
+	unlink((dir + "/renamed.nc").c_str());
+	unlink((dir + "/b.nc").c_str());
+	rmdir(dir.c_str());
+}
+
+TEST(StoreAndRestore, PrecomputeCache)
+{
+	const std::string dir = makeTempDir();
+	writeText(dir + "/data.nc", "CDF data");
+	const std::string cacheDir = dir + "/cache/nested";
+	VCGL::PrecomputeCache cache(cacheDir, 0);
+	const VCGL::PrecomputeCacheKey key = keyOf(dir + "/data.nc", 0);
+
+	const std::vector<VCGL::CachedFile> files = {
+			VCGL::CachedFile("correlation", dir + "/data_correlation.txt"),
+			VCGL::CachedFile("autocorr", dir + "/data_autocorr.txt"),
+			VCGL::CachedFile("projection", dir + "/data_projection.txt") };
+	CHECK(!cache.restore(key, files));
+
+	// the projection is not produced by the run
+	writeText(dir + "/data_correlation.txt", "correlations");
+	writeText(dir + "/data_autocorr.txt", "autocorrelations");
+	LONGS_EQUAL(2, cache.store(key, files, 0));
+	// the files and the key with the list of the files
+	LONGS_EQUAL(12 + 16 + key.description().size() + std::string("correlation 12\nautocorr 16\n").size(),
+			cache.totalSize());
+
+	unlink((dir + "/data_correlation.txt").c_str());
+	unlink((dir + "/data_autocorr.txt").c_str());
+	CHECK(!cache.restore(keyOf(dir + "/data.nc", 1), files));
+	CHECK(cache.restore(key, files));
+	CHECK(readText(dir + "/data_correlation.txt") == "correlations");
+	CHECK(readText(dir + "/data_autocorr.txt") == "autocorrelations");
+	CHECK(access((dir + "/data_projection.txt").c_str(), F_OK) != 0);
+
+	// every stored role needs a path
+	const std::vector<VCGL::CachedFile> fewer(files.begin()+1, files.end());
+	CHECK(!cache.restore(key, fewer));
+
+	// a damaged entry is not used
+	writeText(cacheDir + "/" + key.hash() + "/correlation", "corr");
+	CHECK(!cache.restore(key, files));
+
+	VCGL::PrecomputeCache cleared(cacheDir, 1);
+	cleared.evict();
+	LONGS_EQUAL(0, cleared.totalSize());
+	unlink((dir + "/data_correlation.txt").c_str());
+	unlink((dir + "/data_autocorr.txt").c_str());
+	unlink((dir + "/data.nc").c_str());
+	rmdir(cacheDir.c_str());
+	rmdir((dir + "/cache").c_str());
+	rmdir(dir.c_str());
+}
+
+TEST(EvictsLeastRecentlyUsed, PrecomputeCache)
+{
+	const std::string dir = makeTempDir();
+	writeText(dir + "/data.nc", "CDF data");
+	writeText(dir + "/out.txt", std::string(1000, 'x'));
+	const std::vector<VCGL::CachedFile> files = { VCGL::CachedFile("correlation", dir + "/out.txt") };
+
+	// room for two entries
+	VCGL::PrecomputeCache cache(dir + "/cache", 2500);
+	std::vector<VCGL::PrecomputeCacheKey> keys;
+	for (std::uint64_t i = 0; i<3; i++) {
+		keys.push_back(keyOf(dir + "/data.nc", i));
+		CHECK(cache.store(keys[i], files, 0) == 1);
+		// entry i was used at time 1000*(i+1), except that the first one is used last
+		struct utimbuf times;
+		times.actime = times.modtime = (i == 0) ? 5000 : 1000*(i+1);
+		utime((dir + "/cache/" + keys[i].hash() + "/files.txt").c_str(), &times);
+	}
+	cache.evict();
+
+	CHECK(cache.restore(keys[0], files));
+	CHECK(!cache.restore(keys[1], files));
+	CHECK(cache.restore(keys[2], files));
+
+	VCGL::PrecomputeCache(dir + "/cache", 1).evict();
+	unlink((dir + "/out.txt").c_str());
+	unlink((dir + "/data.nc").c_str());
+	rmdir((dir + "/cache").c_str());
+	rmdir(dir.c_str());
+}
+
+} // namespace Testing
@@ -0,0 +1,95 @@
+/*! @file precomputecheckpointtest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the checkpoint of an interrupted precompute
+ */
+
+#include "CppUnitLite/TestHarness.h"
+
+#include "storage/precomputecheckpoint.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace Testing {
+
+TEST(SaveLoad, PrecomputeCheckpoint)
+{
+	const std::string fileName = "test-checkpoint.bin";
+	VCGL::PrecomputeCheckpoint checkpoint;
+	checkpoint.key = "0123456789abcdef0123456789abcdef";
+	checkpoint.startTime = 1234567;
+	checkpoint.complete(VCGL::PrecomputeCheckpoint::CORRELATIONS);
+	checkpoint.complete(VCGL::PrecomputeCheckpoint::LAGGED_CORRELATIONS);
+	checkpoint.correlationRows = 42;
+	checkpoint.correlationState = std::string("state\0with zero", 15);
+	checkpoint.projectionIteration = 7;
+	checkpoint.projection = { 0.5, -1.5, 2.25, 3.0 };
+	CHECK(checkpoint.save(fileName));
+	CHECK(access((fileName + ".part").c_str(), F_OK) != 0);
+
+	VCGL::PrecomputeCheckpoint loaded;
+	CHECK(loaded.load(fileName));
+	CHECK(loaded.key == checkpoint.key);
+	CHECK(loaded.startTime == checkpoint.startTime);
+	CHECK(loaded.isCompleted(VCGL::PrecomputeCheckpoint::CORRELATIONS));
+	CHECK(!loaded.isCompleted(VCGL::PrecomputeCheckpoint::AUTOCORRELATIONS));
+	CHECK(loaded.isCompleted(VCGL::PrecomputeCheckpoint::LAGGED_CORRELATIONS));
+	CHECK(!loaded.isCompleted(VCGL::PrecomputeCheckpoint::PROJECTION));
+	LONGS_EQUAL(42, loaded.correlationRows);
+	CHECK(loaded.correlationState == checkpoint.correlationState);
+	LONGS_EQUAL(7, loaded.projectionIteration);
+	CHECK(loaded.projection == checkpoint.projection);
+	unlink(fileName.c_str());
+}
+
+TEST(DamagedFileIsNotLoaded, PrecomputeCheckpoint)
+{
+	const std::string fileName = "test-checkpoint-damaged.bin";
+	VCGL::PrecomputeCheckpoint checkpoint;
+	checkpoint.key = "key";
+	checkpoint.projection.assign(100, 1.0);
+	CHECK(checkpoint.save(fileName));
+
+	// cut off in the middle of the projection
+	CHECK(truncate(fileName.c_str(), 200) == 0);
+	VCGL::PrecomputeCheckpoint loaded;
+	loaded.key = "previous";
+	CHECK(!loaded.load(fileName));
+	CHECK(loaded.key == "previous");
+
+	{
+		std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::trunc);
+		out << "not a checkpoint at all";
+	}
+	CHECK(!loaded.load(fileName));
+	unlink(fileName.c_str());
+	CHECK(!loaded.load(fileName));
+}
+
+TEST(SaverKeepsInterval, PrecomputeCheckpoint)
+{
+	VCGL::PrecomputeCheckpoint checkpoint;
+	VCGL::CheckpointSaver disabled("test-checkpoint-disabled.bin", 0, checkpoint);
+	CHECK(!disabled.enabled());
+	CHECK(!disabled.due());
+	disabled.save();
+	CHECK(access("test-checkpoint-disabled.bin", F_OK) != 0);
+
+	VCGL::CheckpointSaver saver("test-checkpoint-saver.bin", 3600, checkpoint);
+	CHECK(saver.enabled());
+	CHECK(!saver.due());
+	checkpoint.correlationRows = 5;
+	saver.save();
+	VCGL::PrecomputeCheckpoint loaded;
+	CHECK(loaded.load(saver.fileName()));
+	LONGS_EQUAL(5, loaded.correlationRows);
+	saver.remove();
+	CHECK(access(saver.fileName().c_str(), F_OK) != 0);
+}
+
+} // namespace Testing
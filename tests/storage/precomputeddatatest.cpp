@@ -40,32 +40,128 @@ TEST(AutocorrelationsWriteReadBinary, PrecomputedData)
 
 TEST(CorrelationsTriangleWriteReadText, PrecomputedData)
 {
-	const std::vector< std::vector<float> > correlations =
+	const VCGL::SymmetricMatrix<float> correlations = symmetricFromSquare<float>(
 		{ {1.0, 0.3, 0.7},
 		  {0.3, 1.0, 0.6},
-		  {0.7, 0.6, 1.0} };
+		  {0.7, 0.6, 1.0} });
 	const std::string corrFileName = "test-corr.txt";
 	storeCorrelationsTriangle(correlations, corrFileName, false);
 
-	std::vector< std::vector<float> > correlationsIn;
+	VCGL::SymmetricMatrix<float> correlationsIn;
 	readCorrelationTriangle(corrFileName, correlationsIn, false);
 	CHECK_EQUAL(correlations, correlationsIn);
 }
 
 TEST(CorrelationsTriangleWriteReadBinary, PrecomputedData)
 {
-	const std::vector< std::vector<float> > correlations =
+	const VCGL::SymmetricMatrix<float> correlations = symmetricFromSquare<float>(
 		{ {1.0, 0.3, 0.7},
 		  {0.3, 1.0, 0.6},
-		  {0.7, 0.6, 1.0} };
+		  {0.7, 0.6, 1.0} });
 	const std::string corrFileName = "test-corr.bin";
 	storeCorrelationsTriangle(correlations, corrFileName, true);
 
-	std::vector< std::vector<float> > correlationsIn;
+	VCGL::SymmetricMatrix<float> correlationsIn;
 	readCorrelationTriangle(corrFileName, correlationsIn, true);
 	CHECK_EQUAL(correlations, correlationsIn);
 }
 
+TEST(CorrelationsTriangleWriterMatchesStore, PrecomputedData)
+{
+	const VCGL::SymmetricMatrix<float> correlations = symmetricFromSquare<float>(
+		{ {1.0, 0.3, 0.7, 0.1},
+		  {0.3, 1.0, 0.6, -0.2},
+		  {0.7, 0.6, 1.0, -0.5},
+		  {0.1, -0.2, -0.5, 1.0} });
+	const std::string corrFileName = "test-corr-stream.bin";
+	{
+		VCGL::CorrelationTriangleWriter writer(corrFileName, 2, 2);
+		const std::vector<float> rows01 = { 0.3 };
+		const std::vector<float> rows23 = { 0.7, 0.6, 0.1, -0.2, -0.5 };
+		writer.consumeRows(0, 2, rows01.data());
+		writer.consumeRows(2, 4, rows23.data());
+		CHECK(writer.close());
+	}
+
+	VCGL::SymmetricMatrix<float> correlationsIn;
+	readCorrelationTriangle(corrFileName, correlationsIn, true);
+	CHECK_EQUAL(correlations, correlationsIn);
+}
+
+namespace {
+
+/// Rows passed to a consumer, packed as in the triangle file
+struct RowRecorder: public VCGL::CorrelationRowConsumer {
+	std::vector<float> values;
+	size_t rowEnd = 0;
+
+	virtual void consumeRows(size_t rowBegin, size_t end, const float* rowValues) override {
+		values.insert(values.end(), rowValues, rowValues + (end*(end-1) - rowBegin*(rowBegin-1))/2);
+		rowEnd = end;
+	}
+};
+
+} // namespace
+
+TEST(CorrelationsTriangleWriterResumes, PrecomputedData)
+{
+	const VCGL::SymmetricMatrix<float> correlations = symmetricFromSquare<float>(
+		{ {1.0, 0.3, 0.7, 0.1},
+		  {0.3, 1.0, 0.6, -0.2},
+		  {0.7, 0.6, 1.0, -0.5},
+		  {0.1, -0.2, -0.5, 1.0} });
+	const std::string corrFileName = "test-corr-resume.bin";
+	const std::vector<float> rows012 = { 0.3, 0.7, 0.6 };
+	const std::vector<float> rows3 = { 0.1, -0.2, -0.5 };
+	{
+		// interrupted before close
+		VCGL::CorrelationTriangleWriter writer(corrFileName, 2, 2);
+		writer.consumeRows(0, 3, rows012.data());
+		CHECK(writer.flush());
+	}
+	{
+		VCGL::CorrelationTriangleWriter beyond(corrFileName, 2, 2, VCGL::GridSubsetRecord::whole(), 4);
+		CHECK(!beyond.good());
+		VCGL::CorrelationTriangleWriter otherGrid(corrFileName, 1, 4, VCGL::GridSubsetRecord::whole(), 2);
+		CHECK(otherGrid.good());
+		VCGL::CorrelationTriangleWriter otherSize(corrFileName, 1, 5, VCGL::GridSubsetRecord::whole(), 2);
+		CHECK(!otherSize.good());
+	}
+	{
+		// the last of the written rows is overwritten
+		RowRecorder replay;
+		VCGL::CorrelationTriangleWriter writer(corrFileName, 2, 2, VCGL::GridSubsetRecord::whole(), 2, &replay);
+		CHECK(writer.good());
+		LONGS_EQUAL(2, replay.rowEnd);
+		CHECK(replay.values == std::vector<float>(1, 0.3f));
+		writer.consumeRows(2, 3, rows012.data() + 1);
+		writer.consumeRows(3, 4, rows3.data());
+		CHECK(writer.close());
+	}
+
+	VCGL::SymmetricMatrix<float> correlationsIn;
+	readCorrelationTriangle(corrFileName, correlationsIn, true);
+	CHECK_EQUAL(correlations, correlationsIn);
+
+	// a completed file is not continued
+	VCGL::CorrelationTriangleWriter completed(corrFileName, 2, 2, VCGL::GridSubsetRecord::whole(), 2);
+	CHECK(!completed.good());
+}
+
+TEST(TeleconnectivityWriteRead, PrecomputedData)
+{
+	const std::vector<float> minima = { -0.3, 1.0, -0.7 };
+	const std::vector<int> partners = { 2, 1, 0 };
+	const std::string tcFileName = "test-teleconn.bin";
+	storeTeleconnectivity(minima, partners, tcFileName);
+
+	std::vector<float> minimaIn;
+	std::vector<int> partnersIn;
+	readTeleconnectivity(tcFileName, minimaIn, partnersIn);
+	CHECK_EQUAL(minima, minimaIn);
+	CHECK_EQUAL(partners, partnersIn);
+}
+
 TEST(ProjectionResultsWriteReadText, PrecomputedData)
 {
 	const int nlon = 2;
@@ -102,4 +198,25 @@ TEST(ProjectionResultsWriteReadBinary, PrecomputedData)
 	CHECK_EQUAL(projection, projectionIn);
 }
 
+TEST(ProjectionResultsReadAnySize, PrecomputedData)
+{
+	std::vector<VCGL::ProjectedPointInfo> projection(3);
+	projection[0].pt = LSP::TSPoint(13.0, 3.0);
+	projection[1].pt = LSP::TSPoint(5.0, 2.0);
+	projection[2].pt = LSP::TSPoint(-1.5, 0.25);
+
+	const std::string projFileName = "test-proj-any.bin";
+	storeProjectionResults(projFileName, projection, true);
+
+	std::vector<VCGL::ProjectedPointInfo> projectionIn;
+	CHECK(readProjectionResults(projFileName, projectionIn));
+	CHECK_EQUAL(projection, projectionIn);
+
+	// a text file, or a missing one
+	storeProjectionResults(projFileName, projection, false);
+	CHECK(!readProjectionResults(projFileName, projectionIn));
+	CHECK(projectionIn.empty());
+	CHECK(!readProjectionResults("test-proj-missing.bin", projectionIn));
+}
+
 } // namespace Testing
@@ -0,0 +1,123 @@
+/*! @file sparsecorrelationstoretest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the top-k sparse correlation store
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+#include "typedefs.h"
+
+#include "storage/sparsecorrelationstore.h"
+#include "storage/correlationstore.h"
+#include "process/precompute.h"
+
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include <unistd.h>
+
+namespace Testing {
+
+namespace {
+	const std::vector< std::vector<float> > testCorrelations = sixPointCorrelations();
+	const VCGL::SymmetricMatrix<float> testMatrix = symmetricFromSquare(testCorrelations);
+
+	VCGL::SparseCorrelationRows topRows(size_t lowestCount, size_t highestCount) {
+		VCGL::TopCorrelations top(testMatrix.size(), lowestCount, highestCount);
+		top.consumeRows(0, testMatrix.size(), testMatrix.data());
+		VCGL::SparseCorrelationRows rows;
+		top.collect(rows);
+		return rows;
+	}
+}
+
+TEST(KeepsLowestPartners, SparseCorrelationStore)
+{
+	const std::string corrFileName = "test-corr-sparse.bin";
+	CHECK(VCGL::storeSparseCorrelations(topRows(1, 0), 2, 3, 1, 0, corrFileName));
+
+	std::unique_ptr<VCGL::CorrelationStore> pStore = VCGL::openCorrelationStore(corrFileName);
+	const VCGL::SparseCorrelationStore* pSparse = dynamic_cast<const VCGL::SparseCorrelationStore*>(pStore.get());
+	CHECK(pSparse != 0 && pSparse->isMapped());
+
+	// the minimum of every row survives, ties go to the smaller index
+	VCGL::CorrelationTriangleStore dense{ VCGL::SymmetricMatrix<float>(testMatrix) };
+	for (size_t i=0; i<testMatrix.size(); i++) {
+		float expectedMin = 0.0f, actualMin = 0.0f;
+		size_t expectedIndex = 0, actualIndex = 0;
+		dense.rowMinimum(i, &expectedMin, &expectedIndex);
+		pStore->rowMinimum(i, &actualMin, &actualIndex);
+		DOUBLES_EQUAL(expectedMin, actualMin, 0.0);
+		LONGS_EQUAL(expectedIndex, actualIndex);
+	}
+
+	// kept pairs are symmetric, the others read as uncorrelated
+	DOUBLES_EQUAL(-0.6, pStore->value(1, 5), 1e-6);
+	DOUBLES_EQUAL(-0.6, pStore->value(5, 1), 1e-6);
+	DOUBLES_EQUAL(0.0, pStore->value(0, 1), 0.0);
+	DOUBLES_EQUAL(1.0, pStore->value(3, 3), 0.0);
+}
+
+TEST(AllPartnersGiveFullMatrix, SparseCorrelationStore)
+{
+	const size_t n = testMatrix.size();
+	VCGL::SparseCorrelationStore store(topRows(n-1, 0));
+	LONGS_EQUAL(n*(n-1), store.entryCount());
+	for (size_t i=0; i<n; i++) {
+		std::vector<float> row(n);
+		store.row(i, row.data());
+		CHECK_EQUAL(testCorrelations[i], row);
+	}
+}
+
+TEST(KeepsHighestPartners, SparseCorrelationStore)
+{
+	VCGL::SparseCorrelationStore store(topRows(1, 1));
+	DOUBLES_EQUAL(0.9, store.value(3, 4), 1e-6);
+	DOUBLES_EQUAL(0.7, store.value(2, 0), 1e-6);
+	DOUBLES_EQUAL(-0.4, store.value(0, 4), 1e-6);
+	// kept by point 1 only, still readable from both sides
+	DOUBLES_EQUAL(0.6, store.value(2, 1), 1e-6);
+	DOUBLES_EQUAL(0.6, store.value(1, 2), 1e-6);
+}
+
+TEST(RejectsInvalidRows, SparseCorrelationStore)
+{
+	const std::string corrFileName = "test-corr-sparse-invalid.bin";
+	const size_t n = testMatrix.size();
+	// the columns of row 0 (1..5) follow the header, the subset record and the offsets
+	const std::streamoff columnsOffset = sizeof(VCGL::SparseCorrelationFileHeader) + sizeof(VCGL::GridSubsetRecord)
+			+ (n+1)*sizeof(std::uint64_t);
+	const auto storeWithColumns = [&](std::uint32_t first, std::uint32_t second) {
+		CHECK(VCGL::storeSparseCorrelations(topRows(n-1, 0), 2, 3, n-1, 0, corrFileName));
+		std::fstream f(corrFileName, std::ios::in | std::ios::out | std::ios::binary);
+		f.seekp(columnsOffset);
+		f.write(reinterpret_cast<const char*>(&first), sizeof(first));
+		f.write(reinterpret_cast<const char*>(&second), sizeof(second));
+	};
+
+	storeWithColumns(1, 2);
+	CHECK(VCGL::openCorrelationStore(corrFileName));
+	// unsorted, repeated, or the point itself
+	storeWithColumns(2, 1);
+	CHECK(!VCGL::openCorrelationStore(corrFileName));
+	storeWithColumns(1, 1);
+	CHECK(!VCGL::openCorrelationStore(corrFileName));
+	storeWithColumns(0, 2);
+	CHECK(!VCGL::openCorrelationStore(corrFileName));
+
+	// no lowest correlations kept
+	storeWithColumns(1, 2);
+	{
+		std::fstream f(corrFileName, std::ios::in | std::ios::out | std::ios::binary);
+		const std::uint32_t lowestCount = 0;
+		f.seekp(offsetof(VCGL::SparseCorrelationFileHeader, lowestCount));
+		f.write(reinterpret_cast<const char*>(&lowestCount), sizeof(lowestCount));
+	}
+	CHECK(!VCGL::openCorrelationStore(corrFileName));
+	unlink(corrFileName.c_str());
+}
+
+} // namespace Testing
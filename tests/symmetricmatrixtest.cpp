@@ -0,0 +1,78 @@
+/*! @file symmetricmatrixtest.cpp
+ * @author anantonov
+ * @date Created on Oct 17, 2026
+ *
+ * @brief Tests for the packed symmetric matrix
+ */
+
+#include "CppUnitLite/TestHarness.h"
+#include "cppunitextras.h"
+
+#include "symmetricmatrix.h"
+
+#include <vector>
+
+namespace Testing {
+
+TEST(SetIsSymmetric, SymmetricMatrix)
+{
+	VCGL::SymmetricMatrix<float> m(4, 1.0f, 0.0f);
+	LONGS_EQUAL(4, m.size());
+	LONGS_EQUAL(6, m.packedSize());
+
+	m.set(2, 0, 0.5f);
+	m.set(1, 3, -0.25f);
+	DOUBLES_EQUAL(0.5, m(2, 0), 0.0);
+	DOUBLES_EQUAL(0.5, m(0, 2), 0.0);
+	DOUBLES_EQUAL(-0.25, m(3, 1), 0.0);
+	DOUBLES_EQUAL(-0.25, m(1, 3), 0.0);
+	DOUBLES_EQUAL(1.0, m(3, 3), 0.0);
+	DOUBLES_EQUAL(0.0, m(1, 0), 0.0);
+
+	// packed layout: row x starts at x(x-1)/2
+	DOUBLES_EQUAL(0.5, m.data()[VCGL::triangleOffset(2)], 0.0);
+	DOUBLES_EQUAL(-0.25, m.triangleRow(3)[1], 0.0);
+}
+
+TEST(RowViewMatchesElements, SymmetricMatrix)
+{
+	const size_t n = 7;
+	VCGL::SymmetricMatrix<int> m(n, -1);
+	for (size_t i=0; i<n; i++) {
+		for (size_t j=0; j<i; j++) {
+			m.set(i, j, 10*i + j);
+		}
+	}
+
+	for (size_t i=0; i<n; i++) {
+		std::vector<int> fromIterator;
+		for (int value: m.row(i)) {
+			fromIterator.push_back(value);
+		}
+		std::vector<int> expected;
+		for (size_t j=0; j<n; j++) {
+			expected.push_back(m(i, j));
+		}
+		CHECK_EQUAL(expected, fromIterator);
+	}
+}
+
+TEST(ViewOfExternalValues, SymmetricMatrix)
+{
+	const float packed[] = { 0.1f, 0.2f, 0.3f };
+	VCGL::SymmetricMatrixView<float> v(packed, 3, 0.0f);
+	DOUBLES_EQUAL(0.1, v(0, 1), 1e-7);
+	DOUBLES_EQUAL(0.2, v(2, 0), 1e-7);
+	DOUBLES_EQUAL(0.3, v(1, 2), 1e-7);
+	DOUBLES_EQUAL(0.0, v(2, 2), 0.0);
+	LONGS_EQUAL(3, v.packedSize());
+}
+
+TEST(TriangleOffsetIsExact, SymmetricMatrix)
+{
+	for (size_t row=0; row<100; row++) {
+		LONGS_EQUAL(row*(row-1)/2 * (row > 0), VCGL::triangleOffset(row));
+	}
+}
+
+} // namespace Testing
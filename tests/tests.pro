@@ -34,10 +34,30 @@ SOURCES += \
 	cppunitextras.cpp \
 	exploration/maps/layouttest.cpp \
 	exploration/maps/mapsubviewtest.cpp \ 
+	exploration/explorationmodelimpltest.cpp \
 	storage/nhtests.cpp \
 	storage/pathresolvertest.cpp \
 	storage/precomputeddatatest.cpp \
+	storage/correlationstoretest.cpp \
+	storage/sparsecorrelationstoretest.cpp \
+	storage/hyperslabunpacktest.cpp \
+	storage/datasubsettest.cpp \
+	storage/precomputecachetest.cpp \
+	storage/precomputecheckpointtest.cpp \
+	storage/correlationshardtest.cpp \
+	storage/compressedcorrelationstoretest.cpp \
+	storage/correlationencodingtest.cpp \
 	preferences/preferencepanelogictest.cpp \
+	process/correlationenginetest.cpp \
+	process/correlationstatisticstest.cpp \
+	process/laggedcorrelationtest.cpp \
 	process/regionconnectivitytest.cpp \
 	process/regionsearchtest.cpp \
+	projection/distancematrixtest.cpp \
+	projection/sammontest.cpp \
+	projection/parallelsammontest.cpp \
+	projection/landmarkprojectiontest.cpp \
+	projection/classicalmdstest.cpp \
+	projection/sammoncontrollertest.cpp \
+	symmetricmatrixtest.cpp \
 	tests-main.cpp